@@ -831,7 +831,7 @@ class SettingsFragmentPresenter
                 SettingsFile.KEY_TEXCACHE_ACCURACY,
                 Settings.SECTION_GFX_SETTINGS, R.string.texture_cache_accuracy,
                 R.string.texture_cache_accuracy_description, R.array.textureCacheAccuracyEntries,
-                R.array.textureCacheAccuracyValues, 128, texCacheAccuracy
+                R.array.textureCacheAccuracyValues, 0, texCacheAccuracy
             )
         )
         sl.add(
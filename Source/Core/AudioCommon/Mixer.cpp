@@ -12,17 +12,22 @@
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Common/Swap.h"
+#include "Common/Thread.h"
 #include "Core/ConfigManager.h"
 
 Mixer::Mixer(unsigned int BackendSampleRate)
     : m_sampleRate(BackendSampleRate), m_stretcher(BackendSampleRate),
       m_surround_decoder(BackendSampleRate, SURROUND_BLOCK_SIZE)
 {
+  m_worker_thread = std::thread(&Mixer::WorkerThread, this);
   INFO_LOG(AUDIO_INTERFACE, "Mixer is initialized");
 }
 
 Mixer::~Mixer()
 {
+  m_worker_running.Clear();
+  m_worker_event.Set();
+  m_worker_thread.join();
 }
 
 void Mixer::DoState(PointerWrap& p)
@@ -124,7 +129,134 @@ unsigned int Mixer::MixerFifo::Mix(short* samples, unsigned int numSamples,
   return actual_sample_count;
 }
 
+void Mixer::WorkerThread()
+{
+  Common::SetCurrentThreadName("Audio mixer");
+
+  std::array<short, OUTPUT_BLOCK_SIZE * 2> stereo_block;
+  std::array<float, OUTPUT_BLOCK_SIZE * SURROUND_CHANNELS> surround_block;
+
+  while (m_worker_running.IsSet())
+  {
+    // Top up the output in use to the target latency, and wait for the audio thread to take some.
+    const u32 target = m_target_latency.load();
+    if (m_is_surround.load())
+    {
+      while (m_surround_output.Size() / SURROUND_CHANNELS < target &&
+             m_surround_output.FreeSpace() >= surround_block.size())
+      {
+        MixSurroundDirect(surround_block.data(), OUTPUT_BLOCK_SIZE);
+        m_surround_output.Push(surround_block.data(), surround_block.size());
+      }
+    }
+    else
+    {
+      while (m_stereo_output.Size() / 2 < target &&
+             m_stereo_output.FreeSpace() >= stereo_block.size())
+      {
+        MixDirect(stereo_block.data(), OUTPUT_BLOCK_SIZE);
+        m_stereo_output.Push(stereo_block.data(), stereo_block.size());
+      }
+    }
+
+    // Also wake up regularly, so that the output starts filling up while the audio thread is
+    // not running yet.
+    m_worker_event.WaitFor(std::chrono::milliseconds(5));
+  }
+}
+
+void Mixer::UpdateOutputLatency(u32 requested, u32 delivered)
+{
+  m_max_request = std::max(m_max_request, requested);
+
+  // Never aim for less than what the backend asks for at once, plus the block the worker thread
+  // may be in the middle of mixing.
+  const u32 min_latency = std::min(m_max_request + OUTPUT_BLOCK_SIZE, MAX_OUTPUT_LATENCY);
+  u32 target = std::max(m_target_latency.load(), min_latency);
+
+  if (delivered < requested)
+  {
+    m_underruns++;
+    m_samples_since_underrun = 0;
+    target = std::min(target + std::max(requested - delivered, OUTPUT_BLOCK_SIZE),
+                      MAX_OUTPUT_LATENCY);
+  }
+  else
+  {
+    m_samples_since_underrun += requested;
+    if (m_samples_since_underrun >= m_sampleRate * LATENCY_DECAY_SECONDS)
+    {
+      m_samples_since_underrun = 0;
+      target = std::max(target - OUTPUT_BLOCK_SIZE / 4, min_latency);
+    }
+  }
+
+  m_target_latency.store(target);
+  m_worker_event.Set();
+}
+
 unsigned int Mixer::Mix(short* samples, unsigned int num_samples)
+{
+  if (!samples)
+    return 0;
+
+  // Discard what was left over from the last time stereo output was used.
+  if (m_is_surround.exchange(false))
+    m_stereo_output.Clear();
+
+  const u32 delivered = static_cast<u32>(m_stereo_output.Pop(samples, num_samples * 2) / 2);
+  if (delivered != 0)
+    std::copy_n(&samples[(delivered - 1) * 2], 2, m_last_stereo_sample.begin());
+
+  // Hold the last sample for what is missing, like MixerFifo does when it runs out of input.
+  for (u32 i = delivered; i < num_samples; ++i)
+    std::copy_n(m_last_stereo_sample.begin(), 2, &samples[i * 2]);
+
+  UpdateOutputLatency(num_samples, delivered);
+  return num_samples;
+}
+
+unsigned int Mixer::MixSurround(float* samples, unsigned int num_samples)
+{
+  if (!num_samples)
+    return 0;
+
+  if (!m_is_surround.exchange(true))
+    m_surround_output.Clear();
+
+  const u32 delivered = static_cast<u32>(
+      m_surround_output.Pop(samples, num_samples * SURROUND_CHANNELS) / SURROUND_CHANNELS);
+  if (delivered != 0)
+  {
+    std::copy_n(&samples[(delivered - 1) * SURROUND_CHANNELS], SURROUND_CHANNELS,
+                m_last_surround_sample.begin());
+  }
+
+  for (u32 i = delivered; i < num_samples; ++i)
+  {
+    std::copy_n(m_last_surround_sample.begin(), SURROUND_CHANNELS,
+                &samples[i * SURROUND_CHANNELS]);
+  }
+
+  UpdateOutputLatency(num_samples, delivered);
+  return num_samples;
+}
+
+Mixer::Statistics Mixer::GetStatistics() const
+{
+  const size_t buffered = m_is_surround.load() ?
+                              m_surround_output.Size() / SURROUND_CHANNELS :
+                              m_stereo_output.Size() / 2;
+
+  Statistics stats;
+  stats.underruns = m_underruns.load();
+  stats.overruns = m_overruns.load();
+  stats.target_latency_ms = m_target_latency.load() * 1000 / m_sampleRate;
+  stats.buffered_ms = static_cast<u32>(buffered * 1000 / m_sampleRate);
+  return stats;
+}
+
+unsigned int Mixer::MixDirect(short* samples, unsigned int num_samples)
 {
   if (!samples)
     return 0;
@@ -161,7 +293,7 @@ unsigned int Mixer::Mix(short* samples, unsigned int num_samples)
   return num_samples;
 }
 
-unsigned int Mixer::MixSurround(float* samples, unsigned int num_samples)
+unsigned int Mixer::MixSurroundDirect(float* samples, unsigned int num_samples)
 {
   if (!num_samples)
     return 0;
@@ -170,9 +302,9 @@ unsigned int Mixer::MixSurround(float* samples, unsigned int num_samples)
 
   size_t needed_frames = m_surround_decoder.QueryFramesNeededForSurroundOutput(num_samples);
 
-  // Mix() may also use m_scratch_buffer internally, but is safe because it alternates reads
+  // MixDirect() may also use m_scratch_buffer internally, but is safe because it alternates reads
   // and writes.
-  size_t available_frames = Mix(m_scratch_buffer.data(), static_cast<u32>(needed_frames));
+  size_t available_frames = MixDirect(m_scratch_buffer.data(), static_cast<u32>(needed_frames));
   if (available_frames != needed_frames)
   {
     ERROR_LOG(AUDIO, "Error decoding surround frames.");
@@ -195,7 +327,10 @@ void Mixer::MixerFifo::PushSamples(const short* samples, unsigned int num_sample
   // Check if we have enough free space
   // indexW == m_indexR results in empty buffer, so indexR must always be smaller than indexW
   if (num_samples * 2 + ((indexW - m_indexR.load()) & INDEX_MASK) >= MAX_SAMPLES * 2)
+  {
+    m_mixer->m_overruns++;
     return;
+  }
 
   // AyuanX: Actual re-sampling work has been moved to sound thread
   // to alleviate the workload on main thread
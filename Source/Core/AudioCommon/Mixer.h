@@ -6,23 +6,41 @@
 
 #include <array>
 #include <atomic>
+#include <thread>
 
 #include "AudioCommon/AudioStretcher.h"
 #include "AudioCommon/SurroundDecoder.h"
 #include "AudioCommon/WaveFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Event.h"
+#include "Common/Flag.h"
+#include "Common/SPSCRingBuffer.h"
 
 class PointerWrap;
 
+// Samples are resampled, stretched and decoded to surround by a worker thread, which keeps a
+// few milliseconds of output ready ahead of the backend. How far ahead depends on how late the
+// backend has been asking for it.
 class Mixer final
 {
 public:
+  struct Statistics
+  {
+    // Times the backend asked for more samples than were ready.
+    u32 underruns;
+    // Times samples from the emulated hardware were dropped because the mixer was full.
+    u32 overruns;
+    // How much output the worker thread tries to keep ready.
+    u32 target_latency_ms;
+    u32 buffered_ms;
+  };
+
   explicit Mixer(unsigned int BackendSampleRate);
   ~Mixer();
 
   void DoState(PointerWrap& p);
 
-  // Called from audio threads
+  // Called from audio threads. These only copy samples the worker thread has mixed.
   unsigned int Mix(short* samples, unsigned int numSamples);
   unsigned int MixSurround(float* samples, unsigned int num_samples);
 
@@ -46,6 +64,8 @@ public:
   float GetCurrentSpeed() const { return m_speed.load(); }
   void UpdateSpeed(float val) { m_speed.store(val); }
 
+  Statistics GetStatistics() const;
+
 private:
   static constexpr u32 MAX_SAMPLES = 1024 * 4;  // 128 ms
   static constexpr u32 INDEX_MASK = MAX_SAMPLES * 2 - 1;
@@ -53,9 +73,16 @@ private:
   static constexpr float CONTROL_FACTOR = 0.2f;
   static constexpr u32 CONTROL_AVG = 32;  // In freq_shift per FIFO size offset
 
-  const unsigned int SURROUND_CHANNELS = 6;
+  static constexpr unsigned int SURROUND_CHANNELS = 6;
   const unsigned int SURROUND_BLOCK_SIZE = 512;
 
+  // The worker thread mixes this many samples at a time.
+  static constexpr u32 OUTPUT_BLOCK_SIZE = 256;
+  static constexpr u32 MAX_OUTPUT_LATENCY = 4096;
+  static constexpr u32 INITIAL_OUTPUT_LATENCY = OUTPUT_BLOCK_SIZE * 2;
+  // How long the output has to go without underruns before the latency is lowered again.
+  static constexpr u32 LATENCY_DECAY_SECONDS = 5;
+
   class MixerFifo final
   {
   public:
@@ -83,6 +110,14 @@ private:
     u32 m_frac = 0;
   };
 
+  // Run on the worker thread.
+  void WorkerThread();
+  unsigned int MixDirect(short* samples, unsigned int num_samples);
+  unsigned int MixSurroundDirect(float* samples, unsigned int num_samples);
+
+  // Run on the audio thread, after taking samples from the output ring.
+  void UpdateOutputLatency(u32 requested, u32 delivered);
+
   MixerFifo m_dma_mixer{this, 32000};
   MixerFifo m_streaming_mixer{this, 48000};
   MixerFifo m_wiimote_speaker_mixer{this, 3000};
@@ -101,4 +136,22 @@ private:
 
   // Current rate of emulation (1.0 = 100% speed)
   std::atomic<float> m_speed{0.0f};
+
+  // Mixed output, as interleaved stereo or surround samples. Only the one in use is filled.
+  Common::SPSCRingBuffer<short> m_stereo_output{MAX_OUTPUT_LATENCY * 2};
+  Common::SPSCRingBuffer<float> m_surround_output{MAX_OUTPUT_LATENCY * SURROUND_CHANNELS};
+  std::atomic<bool> m_is_surround{false};
+  std::atomic<u32> m_target_latency{INITIAL_OUTPUT_LATENCY};
+
+  std::array<short, 2> m_last_stereo_sample{};
+  std::array<float, SURROUND_CHANNELS> m_last_surround_sample{};
+  u32 m_max_request = 0;
+  u32 m_samples_since_underrun = 0;
+
+  std::atomic<u32> m_underruns{0};
+  std::atomic<u32> m_overruns{0};
+
+  Common::Flag m_worker_running{true};
+  Common::Event m_worker_event;
+  std::thread m_worker_thread;
 };
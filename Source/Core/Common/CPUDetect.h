@@ -45,6 +45,8 @@ struct CPUInfo
   bool bFMA = false;
   bool bFMA4 = false;
   bool bAES = false;
+  bool bSHA1 = false;
+  bool bSHA2 = false;
   // FXSAVE/FXRSTOR
   bool bFXSR = false;
   bool bMOVBE = false;
@@ -59,8 +61,6 @@ struct CPUInfo
   bool bFP = false;
   bool bASIMD = false;
   bool bCRC32 = false;
-  bool bSHA1 = false;
-  bool bSHA2 = false;
 
   // Call Detect()
   explicit CPUInfo();
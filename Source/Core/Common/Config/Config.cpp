@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
 #include <list>
 #include <map>
 
@@ -13,6 +14,7 @@ namespace Config
 static Layers s_layers;
 static std::list<ConfigChangedCallback> s_callbacks;
 static u32 s_callback_guards = 0;
+static std::atomic<u32> s_config_version{1};
 
 Layers* GetLayers()
 {
@@ -22,6 +24,7 @@ Layers* GetLayers()
 void AddLayer(std::unique_ptr<Layer> layer)
 {
   s_layers[layer->GetLayer()] = std::move(layer);
+  IncrementConfigVersion();
   InvokeConfigChangedCallbacks();
 }
 
@@ -40,6 +43,7 @@ Layer* GetLayer(LayerType layer)
 void RemoveLayer(LayerType layer)
 {
   s_layers.erase(layer);
+  IncrementConfigVersion();
   InvokeConfigChangedCallbacks();
 }
 bool LayerExists(LayerType layer)
@@ -86,11 +90,13 @@ void Shutdown()
 {
   s_layers.clear();
   s_callbacks.clear();
+  IncrementConfigVersion();
 }
 
 void ClearCurrentRunLayer()
 {
   s_layers[LayerType::CurrentRun] = std::make_unique<Layer>(LayerType::CurrentRun);
+  IncrementConfigVersion();
 }
 
 static const std::map<System, std::string> system_to_name = {
@@ -127,6 +133,18 @@ const std::string& GetLayerName(LayerType layer)
   return layer_to_name.at(layer);
 }
 
+u32 GetConfigVersion()
+{
+  return s_config_version.load(std::memory_order_acquire);
+}
+
+void IncrementConfigVersion()
+{
+  // 0 is used for values which were never cached.
+  if (s_config_version.fetch_add(1, std::memory_order_acq_rel) == UINT32_MAX)
+    s_config_version.fetch_add(1, std::memory_order_acq_rel);
+}
+
 LayerType GetActiveLayerForConfig(const ConfigLocation& config)
 {
   for (auto layer : SEARCH_ORDER)
@@ -43,6 +43,10 @@ std::optional<System> GetSystemFromName(const std::string& system);
 const std::string& GetLayerName(LayerType layer);
 LayerType GetActiveLayerForConfig(const ConfigLocation&);
 
+// Incremented whenever a value in any layer might have changed. Never 0.
+u32 GetConfigVersion();
+void IncrementConfigVersion();
+
 template <typename T>
 T Get(LayerType layer, const ConfigInfo<T>& info)
 {
@@ -54,7 +58,15 @@ T Get(LayerType layer, const ConfigInfo<T>& info)
 template <typename T>
 T Get(const ConfigInfo<T>& info)
 {
-  return GetLayer(GetActiveLayerForConfig(info.location))->Get(info);
+  // If the version changes while the value is looked up, the value is cached with the old
+  // version, and simply looked up again next time.
+  const u32 version = GetConfigVersion();
+  if (std::optional<T> cached = info.cached_value.Get(version))
+    return *std::move(cached);
+
+  T value = GetLayer(GetActiveLayerForConfig(info.location))->Get(info);
+  info.cached_value.Set(version, value);
+  return value;
 }
 
 template <typename T>
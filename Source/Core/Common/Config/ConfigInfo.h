@@ -4,9 +4,14 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <type_traits>
 
+#include "Common/CommonTypes.h"
 #include "Common/Config/Enums.h"
 
 namespace Config
@@ -16,6 +21,70 @@ namespace detail
 // std::underlying_type may only be used with enum types, so make sure T is an enum type first.
 template <typename T>
 using UnderlyingType = typename std::enable_if_t<std::is_enum<T>{}, std::underlying_type<T>>::type;
+
+// The value of a ConfigInfo as of a given config version (see Config::GetConfigVersion).
+// Copies start out empty, as they may be used for a different location.
+template <typename T, typename = void>
+class CachedValue
+{
+public:
+  CachedValue() = default;
+  CachedValue(const CachedValue&) {}
+  CachedValue& operator=(const CachedValue&) { return *this; }
+
+  std::optional<T> Get(u32 version) const
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_version != version)
+      return std::nullopt;
+    return m_value;
+  }
+
+  void Set(u32 version, const T& value) const
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_value = value;
+    m_version = version;
+  }
+
+private:
+  mutable std::mutex m_mutex;
+  mutable T m_value{};
+  mutable u32 m_version = 0;
+};
+
+// Small values are packed into one atomic together with their version, so that reading them
+// takes a single atomic load, and a value can never be paired with the wrong version.
+template <typename T>
+class CachedValue<T, std::enable_if_t<std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(u32)>>
+{
+public:
+  CachedValue() = default;
+  CachedValue(const CachedValue&) {}
+  CachedValue& operator=(const CachedValue&) { return *this; }
+
+  std::optional<T> Get(u32 version) const
+  {
+    const u64 packed = m_packed.load(std::memory_order_relaxed);
+    if (static_cast<u32>(packed >> 32) != version)
+      return std::nullopt;
+
+    const u32 bits = static_cast<u32>(packed);
+    T value;
+    std::memcpy(&value, &bits, sizeof(T));
+    return value;
+  }
+
+  void Set(u32 version, const T& value) const
+  {
+    u32 bits = 0;
+    std::memcpy(&bits, &value, sizeof(T));
+    m_packed.store(static_cast<u64>(version) << 32 | bits, std::memory_order_relaxed);
+  }
+
+private:
+  mutable std::atomic<u64> m_packed{0};
+};
 }  // namespace detail
 
 struct ConfigLocation
@@ -49,5 +118,8 @@ struct ConfigInfo
 
   ConfigLocation location;
   T default_value;
+
+  // Used by Config::Get to avoid looking up and parsing the value when nothing has changed.
+  detail::CachedValue<T> cached_value;
 };
 }  // namespace Config
@@ -48,9 +48,20 @@ bool Layer::DeleteKey(const ConfigLocation& location)
   m_is_dirty = true;
   bool had_value = m_map[location].has_value();
   m_map[location].reset();
+  IncrementConfigVersion();
   return had_value;
 }
 
+void Layer::Set(const ConfigLocation& location, const std::string& new_value)
+{
+  std::optional<std::string>& current_value = m_map[location];
+  if (current_value == new_value)
+    return;
+  m_is_dirty = true;
+  current_value = new_value;
+  IncrementConfigVersion();
+}
+
 void Layer::DeleteAllKeys()
 {
   m_is_dirty = true;
@@ -58,6 +69,7 @@ void Layer::DeleteAllKeys()
   {
     pair.second.reset();
   }
+  IncrementConfigVersion();
 }
 
 Section Layer::GetSection(System system, const std::string& section)
@@ -77,6 +89,7 @@ void Layer::Load()
   if (m_loader)
     m_loader->Load(this);
   m_is_dirty = false;
+  IncrementConfigVersion();
 }
 
 void Layer::Save()
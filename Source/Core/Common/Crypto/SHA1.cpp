@@ -0,0 +1,276 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/Crypto/SHA1.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include "Common/BitUtils.h"
+#include "Common/CPUDetect.h"
+#include "Common/Intrinsics.h"
+#include "Common/Swap.h"
+
+#if defined(_M_ARM_64)
+#include <arm_neon.h>
+#endif
+
+// GCC and MSVC can compile the ARMv8 SHA-1 instructions for single functions, but older versions of
+// Clang only declare the intrinsics when the whole file targets them.
+#if defined(_M_ARM_64) && (defined(__ARM_FEATURE_CRYPTO) || defined(_MSC_VER) ||                  \
+                           (defined(__GNUC__) && !defined(__clang__)))
+#define HAVE_ARM64_SHA1 1
+#if defined(__GNUC__) && !defined(__ARM_FEATURE_CRYPTO)
+#define FUNCTION_TARGET_ARM64_SHA1 [[gnu::target("+crypto")]]
+#endif
+#endif
+
+#ifndef FUNCTION_TARGET_ARM64_SHA1
+#define FUNCTION_TARGET_ARM64_SHA1
+#endif
+
+namespace Common::SHA1
+{
+namespace
+{
+constexpr size_t BLOCK_SIZE = 64;
+constexpr std::array<u32, 5> INITIAL_STATE = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476,
+                                              0xC3D2E1F0};
+constexpr std::array<u32, 4> ROUND_CONSTANTS = {0x5A827999, 0x6ED9EBA1, 0x8F1BBCDC, 0xCA62C1D6};
+
+using ProcessBlocksFunction = void (*)(u32* state, const u8* data, size_t num_blocks);
+
+void ProcessBlocksGeneric(u32* state, const u8* data, size_t num_blocks)
+{
+  for (; num_blocks > 0; --num_blocks, data += BLOCK_SIZE)
+  {
+    std::array<u32, 80> w;
+    for (size_t i = 0; i < 16; ++i)
+      w[i] = Common::swap32(data + i * 4);
+    for (size_t i = 16; i < 80; ++i)
+      w[i] = Common::RotateLeft(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+    u32 a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+    for (size_t i = 0; i < 80; ++i)
+    {
+      u32 f;
+      if (i < 20)
+        f = (b & c) | (~b & d);
+      else if (i < 40 || i >= 60)
+        f = b ^ c ^ d;
+      else
+        f = (b & c) | (b & d) | (c & d);
+
+      const u32 temp = Common::RotateLeft(a, 5) + f + e + ROUND_CONSTANTS[i / 20] + w[i];
+      e = d;
+      d = c;
+      c = Common::RotateLeft(b, 30);
+      b = a;
+      a = temp;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+  }
+}
+
+#if defined(_M_X86_64)
+
+// One group of four rounds. The message schedule is computed four rounds ahead of its use.
+template <int GROUP>
+FUNCTION_TARGET_SHA inline void ProcessGroupSHANI(__m128i& abcd, __m128i (&e)[2],
+                                                  __m128i (&msg)[4])
+{
+  __m128i& e_in = e[GROUP % 2];
+  if constexpr (GROUP == 0)
+    e_in = _mm_add_epi32(e_in, msg[0]);
+  else
+    e_in = _mm_sha1nexte_epu32(e_in, msg[GROUP % 4]);
+
+  e[(GROUP + 1) % 2] = abcd;
+  if constexpr (GROUP >= 3 && GROUP <= 18)
+    msg[(GROUP + 1) % 4] = _mm_sha1msg2_epu32(msg[(GROUP + 1) % 4], msg[GROUP % 4]);
+  abcd = _mm_sha1rnds4_epu32(abcd, e_in, GROUP / 5);
+  if constexpr (GROUP >= 1 && GROUP <= 16)
+    msg[(GROUP + 3) % 4] = _mm_sha1msg1_epu32(msg[(GROUP + 3) % 4], msg[GROUP % 4]);
+  if constexpr (GROUP >= 2 && GROUP <= 17)
+    msg[(GROUP + 2) % 4] = _mm_xor_si128(msg[(GROUP + 2) % 4], msg[GROUP % 4]);
+}
+
+template <int... GROUPS>
+FUNCTION_TARGET_SHA inline void ProcessGroupsSHANI(__m128i& abcd, __m128i (&e)[2],
+                                                   __m128i (&msg)[4],
+                                                   std::integer_sequence<int, GROUPS...>)
+{
+  (ProcessGroupSHANI<GROUPS>(abcd, e, msg), ...);
+}
+
+FUNCTION_TARGET_SHA
+void ProcessBlocksSHANI(u32* state, const u8* data, size_t num_blocks)
+{
+  const __m128i byte_swap = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+
+  __m128i abcd = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1B);
+  __m128i e[2] = {_mm_set_epi32(state[4], 0, 0, 0), _mm_setzero_si128()};
+
+  for (; num_blocks > 0; --num_blocks, data += BLOCK_SIZE)
+  {
+    const __m128i abcd_saved = abcd;
+    const __m128i e_saved = e[0];
+
+    __m128i msg[4];
+    for (size_t i = 0; i < 4; ++i)
+    {
+      const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 16));
+      msg[i] = _mm_shuffle_epi8(bytes, byte_swap);
+    }
+
+    ProcessGroupsSHANI(abcd, e, msg, std::make_integer_sequence<int, 20>());
+
+    e[0] = _mm_sha1nexte_epu32(e[0], e_saved);
+    abcd = _mm_add_epi32(abcd, abcd_saved);
+  }
+
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state), _mm_shuffle_epi32(abcd, 0x1B));
+  state[4] = static_cast<u32>(_mm_extract_epi32(e[0], 3));
+}
+
+#elif defined(HAVE_ARM64_SHA1)
+
+FUNCTION_TARGET_ARM64_SHA1
+void ProcessBlocksARM64(u32* state, const u8* data, size_t num_blocks)
+{
+  uint32x4_t abcd = vld1q_u32(state);
+  u32 e[2] = {state[4], 0};
+
+  for (; num_blocks > 0; --num_blocks, data += BLOCK_SIZE)
+  {
+    const uint32x4_t abcd_saved = abcd;
+    const u32 e_saved = e[0];
+
+    uint32x4_t msg[4];
+    for (size_t i = 0; i < 4; ++i)
+      msg[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(data + i * 16)));
+
+    // The message schedule is computed two groups of four rounds ahead of its use.
+    uint32x4_t w[2] = {vaddq_u32(msg[0], vdupq_n_u32(ROUND_CONSTANTS[0])),
+                       vaddq_u32(msg[1], vdupq_n_u32(ROUND_CONSTANTS[0]))};
+    for (int group = 0; group < 20; ++group)
+    {
+      e[(group + 1) % 2] = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+      if (group < 5)
+        abcd = vsha1cq_u32(abcd, e[group % 2], w[group % 2]);
+      else if (group >= 10 && group < 15)
+        abcd = vsha1mq_u32(abcd, e[group % 2], w[group % 2]);
+      else
+        abcd = vsha1pq_u32(abcd, e[group % 2], w[group % 2]);
+
+      if (group <= 17)
+      {
+        const uint32x4_t k = vdupq_n_u32(ROUND_CONSTANTS[(group + 2) / 5]);
+        w[group % 2] = vaddq_u32(msg[(group + 2) % 4], k);
+      }
+      if (group >= 1 && group <= 16)
+        msg[(group + 3) % 4] = vsha1su1q_u32(msg[(group + 3) % 4], msg[(group + 2) % 4]);
+      if (group <= 15)
+      {
+        msg[group % 4] =
+            vsha1su0q_u32(msg[group % 4], msg[(group + 1) % 4], msg[(group + 2) % 4]);
+      }
+    }
+
+    e[0] += e_saved;
+    abcd = vaddq_u32(abcd, abcd_saved);
+  }
+
+  vst1q_u32(state, abcd);
+  state[4] = e[0];
+}
+
+#endif
+
+ProcessBlocksFunction GetProcessBlocksFunction()
+{
+#if defined(_M_X86_64)
+  if (cpu_info.bSHA1 && cpu_info.bSSE4_1)
+    return ProcessBlocksSHANI;
+#elif defined(HAVE_ARM64_SHA1)
+  if (cpu_info.bSHA1)
+    return ProcessBlocksARM64;
+#endif
+  return ProcessBlocksGeneric;
+}
+
+void ProcessBlocks(u32* state, const u8* data, size_t num_blocks)
+{
+  static const ProcessBlocksFunction process_blocks = GetProcessBlocksFunction();
+  process_blocks(state, data, num_blocks);
+}
+}  // namespace
+
+Context::Context() : m_state(INITIAL_STATE)
+{
+}
+
+void Context::Update(const u8* data, size_t size)
+{
+  m_total_size += size;
+
+  if (m_buffer_size > 0)
+  {
+    const size_t bytes_to_copy = std::min(size, BLOCK_SIZE - m_buffer_size);
+    std::memcpy(m_buffer.data() + m_buffer_size, data, bytes_to_copy);
+    m_buffer_size += bytes_to_copy;
+    data += bytes_to_copy;
+    size -= bytes_to_copy;
+
+    if (m_buffer_size < BLOCK_SIZE)
+      return;
+
+    ProcessBlocks(m_state.data(), m_buffer.data(), 1);
+    m_buffer_size = 0;
+  }
+
+  const size_t num_blocks = size / BLOCK_SIZE;
+  if (num_blocks > 0)
+    ProcessBlocks(m_state.data(), data, num_blocks);
+
+  m_buffer_size = size % BLOCK_SIZE;
+  std::memcpy(m_buffer.data(), data + num_blocks * BLOCK_SIZE, m_buffer_size);
+}
+
+Digest Context::Finish()
+{
+  const u64 total_bits = m_total_size * 8;
+
+  // Padding: a one bit, zeroes, and the size in bits, ending at a block boundary.
+  std::array<u8, BLOCK_SIZE + 8> padding{};
+  padding[0] = 0x80;
+  const size_t padding_size =
+      (m_buffer_size < BLOCK_SIZE - 8 ? BLOCK_SIZE : BLOCK_SIZE * 2) - 8 - m_buffer_size;
+  Update(padding.data(), padding_size);
+
+  const u64 total_bits_be = Common::swap64(total_bits);
+  Update(reinterpret_cast<const u8*>(&total_bits_be), sizeof(total_bits_be));
+
+  Digest digest;
+  for (size_t i = 0; i < m_state.size(); ++i)
+  {
+    const u32 word_be = Common::swap32(m_state[i]);
+    std::memcpy(digest.data() + i * 4, &word_be, sizeof(word_be));
+  }
+  return digest;
+}
+
+Digest CalculateDigest(const u8* data, size_t size)
+{
+  Context context;
+  context.Update(data, size);
+  return context.Finish();
+}
+}  // namespace Common::SHA1
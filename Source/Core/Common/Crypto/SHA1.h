@@ -0,0 +1,34 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+#include "Common/CommonTypes.h"
+
+// SHA-1 which uses the SHA extensions of x86-64 and ARMv8 CPUs when they're available, since
+// verifying and converting Wii discs spends much of its time computing SHA-1 hashes.
+namespace Common::SHA1
+{
+using Digest = std::array<u8, 20>;
+
+class Context final
+{
+public:
+  Context();
+
+  void Update(const u8* data, size_t size);
+  Digest Finish();
+
+private:
+  std::array<u32, 5> m_state;
+  std::array<u8, 64> m_buffer;
+  size_t m_buffer_size = 0;
+  u64 m_total_size = 0;
+};
+
+Digest CalculateDigest(const u8* data, size_t size);
+}  // namespace Common::SHA1
@@ -0,0 +1,203 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+// STL-look-a-like hash map with open addressing (linear probing) for integer keys.
+//
+// All entries live in a single contiguous array, so lookups touch one or two cache lines instead
+// of chasing tree or bucket nodes. Erasing uses backward-shift deletion, so there are no
+// tombstones and lookups don't degrade after many insert/erase cycles.
+//
+// Unlike std::unordered_map, references and iterators are invalidated by any insertion or
+// erasure, and the map must not be modified while iterating over it.
+template <typename K, typename V>
+class FlatHashMap
+{
+  static_assert(std::is_integral<K>::value, "FlatHashMap only supports integer keys");
+
+public:
+  using value_type = std::pair<K, V>;
+
+  template <typename MapType, typename ValueType>
+  class IteratorBase
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = ValueType;
+    using difference_type = std::ptrdiff_t;
+    using pointer = ValueType*;
+    using reference = ValueType&;
+
+    IteratorBase(MapType* map, std::size_t index) : m_map(map), m_index(index) { SkipEmpty(); }
+
+    reference operator*() const { return m_map->m_slots[m_index]; }
+    pointer operator->() const { return &m_map->m_slots[m_index]; }
+    IteratorBase& operator++()
+    {
+      ++m_index;
+      SkipEmpty();
+      return *this;
+    }
+    bool operator==(const IteratorBase& other) const { return m_index == other.m_index; }
+    bool operator!=(const IteratorBase& other) const { return m_index != other.m_index; }
+
+  private:
+    void SkipEmpty()
+    {
+      while (m_index < m_map->m_used.size() && !m_map->m_used[m_index])
+        ++m_index;
+    }
+
+    MapType* m_map;
+    std::size_t m_index;
+  };
+
+  using iterator = IteratorBase<FlatHashMap, value_type>;
+  using const_iterator = IteratorBase<const FlatHashMap, const value_type>;
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, m_used.size()); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, m_used.size()); }
+
+  std::size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  void clear()
+  {
+    m_slots.clear();
+    m_used.clear();
+    m_size = 0;
+    m_shift = 64;
+  }
+
+  V* find(K key)
+  {
+    const std::size_t index = FindIndex(key);
+    return index != NOT_FOUND ? &m_slots[index].second : nullptr;
+  }
+
+  const V* find(K key) const
+  {
+    const std::size_t index = FindIndex(key);
+    return index != NOT_FOUND ? &m_slots[index].second : nullptr;
+  }
+
+  bool contains(K key) const { return FindIndex(key) != NOT_FOUND; }
+
+  // Returns the value for key, default-constructing it if it doesn't exist yet.
+  V& operator[](K key)
+  {
+    if ((m_size + 1) * 4 > m_used.size() * 3)
+      Grow();
+
+    const std::size_t mask = m_used.size() - 1;
+    for (std::size_t i = IdealIndex(key);; i = (i + 1) & mask)
+    {
+      if (!m_used[i])
+      {
+        m_used[i] = true;
+        m_slots[i] = value_type(key, V());
+        ++m_size;
+        return m_slots[i].second;
+      }
+      if (m_slots[i].first == key)
+        return m_slots[i].second;
+    }
+  }
+
+  bool erase(K key)
+  {
+    std::size_t hole = FindIndex(key);
+    if (hole == NOT_FOUND)
+      return false;
+
+    // Shift back any following entries that were displaced past the hole, so that every entry
+    // stays reachable from its ideal slot without scanning over empty slots.
+    const std::size_t mask = m_used.size() - 1;
+    for (std::size_t i = (hole + 1) & mask; m_used[i]; i = (i + 1) & mask)
+    {
+      const std::size_t ideal = IdealIndex(m_slots[i].first);
+      if (((i - ideal) & mask) >= ((i - hole) & mask))
+      {
+        m_slots[hole] = std::move(m_slots[i]);
+        hole = i;
+      }
+    }
+
+    m_used[hole] = false;
+    m_slots[hole] = value_type();
+    --m_size;
+    return true;
+  }
+
+private:
+  static constexpr std::size_t NOT_FOUND = ~std::size_t(0);
+  static constexpr std::size_t INITIAL_CAPACITY = 16;
+
+  std::size_t IdealIndex(K key) const
+  {
+    // Fibonacci hashing: spreads sequential keys (e.g. addresses) over the whole table.
+    return static_cast<std::size_t>((static_cast<u64>(key) * 0x9E3779B97F4A7C15ULL) >> m_shift);
+  }
+
+  std::size_t FindIndex(K key) const
+  {
+    if (m_size == 0)
+      return NOT_FOUND;
+
+    const std::size_t mask = m_used.size() - 1;
+    for (std::size_t i = IdealIndex(key); m_used[i]; i = (i + 1) & mask)
+    {
+      if (m_slots[i].first == key)
+        return i;
+    }
+    return NOT_FOUND;
+  }
+
+  void Grow()
+  {
+    const std::size_t new_capacity = m_used.empty() ? INITIAL_CAPACITY : m_used.size() * 2;
+
+    std::vector<value_type> old_slots(new_capacity);
+    std::vector<u8> old_used(new_capacity, false);
+    std::swap(old_slots, m_slots);
+    std::swap(old_used, m_used);
+
+    m_shift = 64;
+    for (std::size_t capacity = new_capacity; capacity > 1; capacity >>= 1)
+      --m_shift;
+
+    const std::size_t mask = new_capacity - 1;
+    for (std::size_t i = 0; i < old_used.size(); ++i)
+    {
+      if (!old_used[i])
+        continue;
+
+      std::size_t index = IdealIndex(old_slots[i].first);
+      while (m_used[index])
+        index = (index + 1) & mask;
+      m_used[index] = true;
+      m_slots[index] = std::move(old_slots[i]);
+    }
+  }
+
+  std::vector<value_type> m_slots;
+  std::vector<u8> m_used;
+  std::size_t m_size = 0;
+  // 64 - log2(capacity); used to map hashes onto the table.
+  u32 m_shift = 64;
+};
+}  // namespace Common
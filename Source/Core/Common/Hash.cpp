@@ -6,6 +6,10 @@
 
 #include <algorithm>
 #include <cstring>
+
+#define XXH_STATIC_LINKING_ONLY
+#include <xxhash.h>
+
 #include "Common/BitUtils.h"
 #include "Common/CPUDetect.h"
 #include "Common/CommonFuncs.h"
@@ -17,7 +21,17 @@
 
 namespace Common
 {
+// XXH3 output isn't stable across xxhash versions before 0.8.0.
+static_assert(XXH_VERSION_NUMBER == 700,
+              "Check whether GetHash64 changed and bump HASH64_VERSION if it did");
+
+static u64 GetXXH3(const u8* src, u32 len)
+{
+  return XXH3_64bits(src, len);
+}
+
 static u64 (*ptrHashFunction)(const u8* src, u32 len, u32 samples) = nullptr;
+static u64 (*ptrFullHashFunction)(const u8* src, u32 len) = &GetXXH3;
 
 // uint32_t
 // WARNING - may read one more byte!
@@ -503,12 +517,22 @@ static u64 GetMurmurHash3(const u8* src, u32 len, u32 samples)
 
 u64 GetHash64(const u8* src, u32 len, u32 samples)
 {
+  // When every block gets hashed anyway, use XXH3. It's vectorized and several times faster than
+  // the functions below, which makes hashing whole textures affordable.
+  if (samples == 0 || samples >= len / 8)
+    return ptrFullHashFunction(src, len);
+
   return ptrHashFunction(src, len, samples);
 }
 
-// sets the hash function used for the texture cache
+// sets the hash function used for sampled hashes in the texture cache
 void SetHash64Function()
 {
+#if defined(_M_X86_64)
+  // Both variants of XXH3 return the same hashes.
+  ptrFullHashFunction = cpu_info.bAVX2 ? &GetXXH3AVX2 : &GetXXH3;
+#endif
+
 #if defined(_M_X86_64) || defined(_M_X86)
   if (cpu_info.bSSE4_2)  // sse crc32 version
   {
@@ -13,6 +13,16 @@ namespace Common
 u32 HashFletcher(const u8* data_u8, size_t length);  // FAST. Length & 1 == 0.
 u32 HashAdler32(const u8* data, size_t len);         // Fairly accurate, slightly slower
 u32 HashEctor(const u8* ptr, int length);            // JUNK. DO NOT USE FOR NEW THINGS
+// Hashes the whole input if samples is 0, otherwise only about that many 8-byte blocks of it.
 u64 GetHash64(const u8* src, u32 len, u32 samples);
 void SetHash64Function();
+
+// Bump this whenever GetHash64 returns different values for the same input, for example after
+// updating xxhash. Persistent caches keyed on GetHash64 include it in their keys.
+constexpr u32 HASH64_VERSION = 1;
+
+#ifdef _M_X86_64
+// XXH3 compiled for AVX2. Only call this if the CPU supports AVX2.
+u64 GetXXH3AVX2(const u8* src, u32 len);
+#endif
 }  // namespace Common
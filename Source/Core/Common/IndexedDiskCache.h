@@ -0,0 +1,451 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstddef>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
+#include "Common/MappedFile.h"
+#include "Common/Version.h"
+
+// On disk format:
+// header{
+// u32 'DCI2';
+// u16 sizeof(key_type);
+// u16 reserved;
+// char ver[40];  // scm_rev_git_str
+// u32 num_indexed;
+// u32 reserved;
+// u64 log_offset;  // offset of the first appended record
+//}
+//
+// index_entry[num_indexed]{  // sorted by the bytes of the key
+// key_type key;
+// u32 value_size;
+// u64 value_offset;
+//}
+//
+// u8 values[];
+//
+// record[]{  // appended since the file was last compacted
+// u32 value_size;
+// key_type key;
+// u8 value[value_size];
+// u32 checksum;  // Adler-32 of the fields above
+//}
+
+// Key-value store with an index sorted by key and lazily read values. Opening it maps the file and
+// reads the index, but the values are only read from disk the first time they're looked up.
+//
+// New values are appended to the end of the file. If the process dies while appending, the torn
+// record fails its checksum and is dropped the next time the file is opened. Once enough records
+// have been appended, or a key has been appended more than once, the file is compacted on open:
+// the latest value of each key is written to a new file with a full index, which then atomically
+// replaces the old one.
+//
+// Find may be called from any thread, also while another thread appends. Opening, closing and
+// compacting must not overlap with anything else.
+//
+// K must be trivially copyable and its padding bytes must be zero, as keys are compared bytewise.
+template <typename K>
+class IndexedDiskCache
+{
+public:
+  struct Value
+  {
+    const u8* data;
+    u32 size;
+  };
+
+  ~IndexedDiskCache() { Close(); }
+
+  // Returns the number of distinct keys in the cache. If the file is missing or was written by a
+  // different version, it is recreated empty.
+  u32 Open(const std::string& filename)
+  {
+    // Since we're reading/writing directly to the storage of K instances,
+    // K must be trivially copyable.
+    static_assert(std::is_trivially_copyable<K>::value, "K must be a trivially copyable type");
+
+    Close();
+    m_filename = filename;
+
+    if (!OpenExisting())
+    {
+      Recreate();
+    }
+    else if (m_num_stale_records > 0 || m_num_log_records * COMPACT_LOG_RATIO > m_num_indexed)
+    {
+      INFO_LOG(COMMON, "Compacting %s: %u indexed entries, %u appended, %u stale",
+               m_filename.c_str(), m_num_indexed, m_num_log_records, m_num_stale_records);
+      Compact();
+    }
+
+    return m_num_entries;
+  }
+
+  void Close()
+  {
+    if (m_file.IsOpen())
+      m_file.Close();
+    m_mapping.Close();
+
+    m_num_indexed = 0;
+    m_num_entries = 0;
+    m_num_log_records = 0;
+    m_num_stale_records = 0;
+    m_log_values.clear();
+    m_appended_values.clear();
+  }
+
+  void Sync()
+  {
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_file.Flush();
+  }
+
+  bool IsOpen() const { return m_file.IsOpen(); }
+  u32 GetEntryCount() const { return m_num_entries; }
+
+  // The returned data stays valid until the cache is closed or compacted.
+  std::optional<Value> Find(const K& key) const
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_lock);
+      const auto iter = m_log_values.find(key);
+      if (iter != m_log_values.end())
+        return iter->second;
+    }
+
+    return FindInIndex(key);
+  }
+
+  // Appends a key-value pair to the store. If the key is already present, the new value replaces
+  // it, and the old value is discarded when the file is next compacted.
+  void Append(const K& key, const u8* value, u32 value_size)
+  {
+    // Write the whole record at once, so that a torn write can only ever affect the last record.
+    std::vector<u8> record(RECORD_OVERHEAD + value_size);
+    std::memcpy(&record[0], &value_size, sizeof(value_size));
+    std::memcpy(&record[sizeof(value_size)], &key, sizeof(K));
+    if (value_size > 0)
+      std::memcpy(&record[sizeof(value_size) + sizeof(K)], value, value_size);
+    const u32 checksum = Common::HashAdler32(record.data(), record.size() - sizeof(u32));
+    std::memcpy(&record[record.size() - sizeof(u32)], &checksum, sizeof(checksum));
+
+    std::lock_guard<std::mutex> lock(m_lock);
+    m_file.WriteBytes(record.data(), record.size());
+
+    // Earlier values of the key may still be in use, so the buffers are kept until closing.
+    const std::vector<u8>& stored = m_appended_values.emplace_back(
+        record.begin() + sizeof(value_size) + sizeof(K), record.end() - sizeof(u32));
+    AddLogValue(key, Value{stored.data(), value_size});
+  }
+
+  // Rewrites the file with the latest value of each key in the index, dropping replaced values.
+  bool Compact()
+  {
+    std::vector<std::pair<K, Value>> entries = GetLatestEntries();
+
+    // Build the new file next to the old one, so that it can be swapped in atomically.
+    const std::string temp_filename = File::GetTempFilenameForAtomicWrite(m_filename);
+    if (!WriteCompactedFile(temp_filename, entries))
+    {
+      ERROR_LOG(COMMON, "Failed to write compacted cache %s", temp_filename.c_str());
+      File::Delete(temp_filename);
+      return false;
+    }
+
+    // The mapping must be gone before the file can be replaced on Windows.
+    const std::string filename = m_filename;
+    entries.clear();
+    Close();
+    m_filename = filename;
+
+    const bool renamed = File::RenameSync(temp_filename, m_filename);
+    if (!renamed)
+      File::Delete(temp_filename);
+
+    if (!OpenExisting())
+    {
+      Recreate();
+      return false;
+    }
+
+    return renamed;
+  }
+
+private:
+  struct Header
+  {
+    void Init(u32 num_indexed_, u64 log_offset_)
+    {
+      // Null-terminator is intentionally not copied.
+      std::memcpy(&id, "DCI2", sizeof(u32));
+      std::memcpy(ver, Common::scm_rev_git_str.c_str(),
+                  std::min(Common::scm_rev_git_str.size(), sizeof(ver)));
+      num_indexed = num_indexed_;
+      log_offset = log_offset_;
+    }
+
+    u32 id = 0;
+    u16 key_t_size = sizeof(K);
+    u16 reserved = 0;
+    char ver[40] = {};
+    u32 num_indexed = 0;
+    u32 reserved2 = 0;
+    u64 log_offset = 0;
+  };
+  static_assert(sizeof(Header) == 64, "Header must not contain padding");
+
+  struct KeyLess
+  {
+    bool operator()(const K& lhs, const K& rhs) const
+    {
+      return std::memcmp(&lhs, &rhs, sizeof(K)) < 0;
+    }
+  };
+
+  // Index entries are packed, so they're always accessed through memcpy.
+  static constexpr std::size_t INDEX_ENTRY_SIZE = sizeof(K) + sizeof(u32) + sizeof(u64);
+  static constexpr std::size_t RECORD_OVERHEAD = sizeof(u32) + sizeof(K) + sizeof(u32);
+
+  // Compact once there are more than an eighth as many appended records as indexed entries.
+  static constexpr u32 COMPACT_LOG_RATIO = 8;
+
+  const u8* GetIndexEntry(u32 index) const
+  {
+    return m_mapping.GetData() + sizeof(Header) + std::size_t(index) * INDEX_ENTRY_SIZE;
+  }
+
+  Value GetIndexValue(u32 index) const
+  {
+    const u8* const entry = GetIndexEntry(index);
+    u32 value_size;
+    u64 value_offset;
+    std::memcpy(&value_size, entry + sizeof(K), sizeof(value_size));
+    std::memcpy(&value_offset, entry + sizeof(K) + sizeof(value_size), sizeof(value_offset));
+    return Value{m_mapping.GetData() + value_offset, value_size};
+  }
+
+  std::optional<Value> FindInIndex(const K& key) const
+  {
+    u32 first = 0;
+    u32 last = m_num_indexed;
+    while (first < last)
+    {
+      const u32 middle = first + (last - first) / 2;
+      const int result = std::memcmp(GetIndexEntry(middle), &key, sizeof(K));
+      if (result == 0)
+        return GetIndexValue(middle);
+      if (result < 0)
+        first = middle + 1;
+      else
+        last = middle;
+    }
+
+    return std::nullopt;
+  }
+
+  void AddLogValue(const K& key, const Value& value)
+  {
+    m_num_log_records++;
+
+    const auto [iter, inserted] = m_log_values.insert_or_assign(key, value);
+    if (!inserted || FindInIndex(key))
+      m_num_stale_records++;
+    else
+      m_num_entries++;
+  }
+
+  // Maps the file and validates its index and appended records. A cut off or corrupted record
+  // means the process died while appending it, so it's truncated along with everything after it.
+  bool OpenExisting()
+  {
+    if (!m_mapping.Open(m_filename))
+      return false;
+
+    const u8* const data = m_mapping.GetData();
+    const u64 size = m_mapping.GetSize();
+
+    Header expected_header;
+    expected_header.Init(0, 0);
+    Header header;
+    if (size < sizeof(Header))
+      return false;
+    std::memcpy(&header, data, sizeof(Header));
+    if (std::memcmp(&header, &expected_header, offsetof(Header, num_indexed)) != 0)
+      return false;
+
+    const u64 values_offset = sizeof(Header) + u64(header.num_indexed) * INDEX_ENTRY_SIZE;
+    if (values_offset > header.log_offset || header.log_offset > size)
+      return false;
+
+    m_num_indexed = header.num_indexed;
+    for (u32 i = 0; i < m_num_indexed; i++)
+    {
+      const u8* const entry = GetIndexEntry(i);
+      u32 value_size;
+      u64 value_offset;
+      std::memcpy(&value_size, entry + sizeof(K), sizeof(value_size));
+      std::memcpy(&value_offset, entry + sizeof(K) + sizeof(value_size), sizeof(value_offset));
+      if (value_offset < values_offset || value_offset > header.log_offset ||
+          header.log_offset - value_offset < value_size)
+      {
+        m_num_indexed = 0;
+        return false;
+      }
+    }
+
+    std::vector<u64> record_offsets;
+    u64 offset = header.log_offset;
+    while (size - offset >= RECORD_OVERHEAD)
+    {
+      u32 value_size;
+      std::memcpy(&value_size, data + offset, sizeof(value_size));
+      if (size - offset - RECORD_OVERHEAD < value_size)
+        break;
+
+      const std::size_t checksummed_size = RECORD_OVERHEAD - sizeof(u32) + value_size;
+      u32 checksum;
+      std::memcpy(&checksum, data + offset + checksummed_size, sizeof(checksum));
+      if (checksum != Common::HashAdler32(data + offset, checksummed_size))
+        break;
+
+      record_offsets.push_back(offset);
+      offset += RECORD_OVERHEAD + value_size;
+    }
+
+    if (offset != size)
+    {
+      WARN_LOG(COMMON, "Dropping %" PRIu64 " bytes of incomplete records from %s", size - offset,
+               m_filename.c_str());
+
+      m_mapping.Close();
+      if (!File::IOFile(m_filename, "r+b").Resize(offset) || !m_mapping.Open(m_filename) ||
+          m_mapping.GetSize() != offset)
+      {
+        m_num_indexed = 0;
+        return false;
+      }
+    }
+
+    m_num_entries = m_num_indexed;
+    for (const u64 record_offset : record_offsets)
+    {
+      const u8* const record = m_mapping.GetData() + record_offset;
+      u32 value_size;
+      K key;
+      std::memcpy(&value_size, record, sizeof(value_size));
+      std::memcpy(&key, record + sizeof(value_size), sizeof(K));
+      AddLogValue(key, Value{record + sizeof(value_size) + sizeof(K), value_size});
+    }
+
+    // New records are only ever written to the end, after the ones which were just validated.
+    if (!m_file.Open(m_filename, "ab"))
+    {
+      Close();
+      return false;
+    }
+
+    return true;
+  }
+
+  void Recreate()
+  {
+    const std::string filename = m_filename;
+    Close();
+    m_filename = filename;
+
+    Header header;
+    header.Init(0, sizeof(Header));
+    m_file.Open(m_filename, "wb");
+    m_file.WriteBytes(&header, sizeof(header));
+  }
+
+  // Merges the index and the appended records, where the records take precedence.
+  std::vector<std::pair<K, Value>> GetLatestEntries() const
+  {
+    std::vector<std::pair<K, Value>> entries;
+    entries.reserve(m_num_entries);
+
+    auto log_iter = m_log_values.begin();
+    for (u32 i = 0; i < m_num_indexed; i++)
+    {
+      K key;
+      std::memcpy(&key, GetIndexEntry(i), sizeof(K));
+
+      const KeyLess less;
+      for (; log_iter != m_log_values.end() && less(log_iter->first, key); ++log_iter)
+        entries.emplace_back(*log_iter);
+
+      if (log_iter != m_log_values.end() && !less(key, log_iter->first))
+        entries.emplace_back(*log_iter++);
+      else
+        entries.emplace_back(key, GetIndexValue(i));
+    }
+    entries.insert(entries.end(), log_iter, m_log_values.end());
+
+    return entries;
+  }
+
+  static bool WriteCompactedFile(const std::string& filename,
+                                 const std::vector<std::pair<K, Value>>& entries)
+  {
+    u64 value_offset = sizeof(Header) + u64(entries.size()) * INDEX_ENTRY_SIZE;
+    std::vector<u8> index(entries.size() * INDEX_ENTRY_SIZE);
+    for (std::size_t i = 0; i < entries.size(); i++)
+    {
+      u8* const entry = &index[i * INDEX_ENTRY_SIZE];
+      std::memcpy(entry, &entries[i].first, sizeof(K));
+      std::memcpy(entry + sizeof(K), &entries[i].second.size, sizeof(u32));
+      std::memcpy(entry + sizeof(K) + sizeof(u32), &value_offset, sizeof(u64));
+      value_offset += entries[i].second.size;
+    }
+
+    Header header;
+    header.Init(static_cast<u32>(entries.size()), value_offset);
+
+    File::IOFile file(filename, "wb");
+    if (!file.WriteBytes(&header, sizeof(header)) || !file.WriteBytes(index.data(), index.size()))
+      return false;
+
+    for (const auto& entry : entries)
+    {
+      if (!file.WriteBytes(entry.second.data, entry.second.size))
+        return false;
+    }
+
+    return file.Flush();
+  }
+
+  std::string m_filename;
+  File::IOFile m_file;
+  Common::MappedFile m_mapping;
+  u32 m_num_indexed = 0;
+  u32 m_num_entries = 0;
+  u32 m_num_log_records = 0;
+  u32 m_num_stale_records = 0;
+
+  // Values which were appended after the index was written, either in an earlier session (these
+  // point into the mapping) or in this one (these point into m_appended_values).
+  mutable std::mutex m_lock;
+  std::map<K, Value, KeyLess> m_log_values;
+  std::deque<std::vector<u8>> m_appended_values;
+};
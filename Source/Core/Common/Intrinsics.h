@@ -28,11 +28,14 @@
  */
 
 #include <x86intrin.h>
+#ifndef __AVX2__
+#define FUNCTION_TARGET_AVX2 [[gnu::target("avx2")]]
+#endif
 #ifndef __SSE4_2__
 #define FUNCTION_TARGET_SSE42 [[gnu::target("sse4.2")]]
 #endif
 #ifndef __SSE4_1__
-#define FUNCTION_TARGET_SSR41 [[gnu::target("sse4.1")]]
+#define FUNCTION_TARGET_SSE41 [[gnu::target("sse4.1")]]
 #endif
 #ifndef __SSSE3__
 #define FUNCTION_TARGET_SSSE3 [[gnu::target("ssse3")]]
@@ -40,6 +43,9 @@
 #ifndef __SSE3__
 #define FUNCTION_TARGET_SSE3 [[gnu::target("sse3")]]
 #endif
+#ifndef __SHA__
+#define FUNCTION_TARGET_SHA [[gnu::target("sha,sse4.1")]]
+#endif
 
 #elif defined(_MSC_VER) || defined(__INTEL_COMPILER)
 
@@ -58,11 +64,14 @@
  * version without the macro around a #ifdef guard. Be careful when using intrinsics, as all use
  * should still be placed around a #ifdef _M_X86 if the file is compiled on all architectures.
  */
+#ifndef FUNCTION_TARGET_AVX2
+#define FUNCTION_TARGET_AVX2
+#endif
 #ifndef FUNCTION_TARGET_SSE42
 #define FUNCTION_TARGET_SSE42
 #endif
-#ifndef FUNCTION_TARGET_SSR41
-#define FUNCTION_TARGET_SSR41
+#ifndef FUNCTION_TARGET_SSE41
+#define FUNCTION_TARGET_SSE41
 #endif
 #ifndef FUNCTION_TARGET_SSSE3
 #define FUNCTION_TARGET_SSSE3
@@ -70,3 +79,6 @@
 #ifndef FUNCTION_TARGET_SSE3
 #define FUNCTION_TARGET_SSE3
 #endif
+#ifndef FUNCTION_TARGET_SHA
+#define FUNCTION_TARGET_SHA
+#endif
@@ -0,0 +1,88 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+// a simple lockless thread-safe,
+// multiple producer, single consumer queue
+
+#include <atomic>
+#include <utility>
+
+namespace Common
+{
+template <typename T>
+class MPSCQueue
+{
+public:
+  MPSCQueue() = default;
+  ~MPSCQueue() { DeleteList(m_head.exchange(nullptr, std::memory_order_acquire)); }
+
+  MPSCQueue(const MPSCQueue&) = delete;
+  MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+  bool Empty() const { return !m_head.load(std::memory_order_relaxed); }
+
+  // Can be called from any thread.
+  template <typename Arg>
+  void Push(Arg&& t)
+  {
+    Element* element = new Element{std::forward<Arg>(t), m_head.load(std::memory_order_relaxed)};
+    while (!m_head.compare_exchange_weak(element->next, element, std::memory_order_release,
+                                         std::memory_order_relaxed))
+    {
+    }
+  }
+
+  // Must only be called from the consumer thread. Takes all elements which have been pushed so
+  // far at once and calls func on each of them in the order they were pushed in.
+  template <typename Func>
+  void PopAll(Func func)
+  {
+    Element* element = m_head.exchange(nullptr, std::memory_order_acquire);
+    if (!element)
+      return;
+
+    // The elements are linked newest first, so reverse them.
+    Element* reversed = nullptr;
+    while (element)
+    {
+      Element* next = element->next;
+      element->next = reversed;
+      reversed = element;
+      element = next;
+    }
+
+    while (reversed)
+    {
+      Element* next = reversed->next;
+      func(std::move(reversed->current));
+      delete reversed;
+      reversed = next;
+    }
+  }
+
+  // not thread-safe
+  void Clear() { DeleteList(m_head.exchange(nullptr, std::memory_order_acquire)); }
+
+private:
+  struct Element
+  {
+    T current;
+    Element* next;
+  };
+
+  static void DeleteList(Element* element)
+  {
+    while (element)
+    {
+      Element* next = element->next;
+      delete element;
+      element = next;
+    }
+  }
+
+  std::atomic<Element*> m_head{nullptr};
+};
+}  // namespace Common
@@ -0,0 +1,166 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/MappedFile.h"
+
+#include <limits>
+#include <utility>
+
+#include "Common/CommonFuncs.h"
+#include "Common/Logging/Log.h"
+#include "Common/StringUtil.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Common
+{
+MappedFile::~MappedFile()
+{
+  Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+{
+  Swap(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+  Close();
+  Swap(other);
+  return *this;
+}
+
+void MappedFile::Swap(MappedFile& other) noexcept
+{
+  std::swap(m_data, other.m_data);
+  std::swap(m_size, other.m_size);
+  std::swap(m_is_open, other.m_is_open);
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path)
+{
+  Close();
+
+  // Sharing writes and deletes allows the file to be appended to or replaced while it's mapped.
+  const HANDLE file =
+      CreateFile(UTF8ToTStr(path).c_str(), GENERIC_READ,
+                 FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                 FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) ||
+      static_cast<u64>(size.QuadPart) > std::numeric_limits<std::size_t>::max())
+  {
+    CloseHandle(file);
+    return false;
+  }
+
+  // Empty files can't be mapped.
+  if (size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    m_is_open = true;
+    return true;
+  }
+
+  // The view keeps both the mapping and the file open, so the handles can be closed right away.
+  const HANDLE mapping = CreateFileMapping(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!mapping)
+  {
+    ERROR_LOG(COMMON, "Failed to create a mapping of %s: %s", path.c_str(),
+              GetLastErrorString().c_str());
+    return false;
+  }
+
+  void* const view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  CloseHandle(mapping);
+  if (!view)
+  {
+    ERROR_LOG(COMMON, "Failed to map %s: %s", path.c_str(), GetLastErrorString().c_str());
+    return false;
+  }
+
+  m_data = static_cast<const u8*>(view);
+  m_size = static_cast<std::size_t>(size.QuadPart);
+  m_is_open = true;
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (m_data)
+    UnmapViewOfFile(m_data);
+
+  m_data = nullptr;
+  m_size = 0;
+  m_is_open = false;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path)
+{
+  Close();
+
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return false;
+
+  struct stat file_info;
+  if (fstat(fd, &file_info) != 0 ||
+      static_cast<u64>(file_info.st_size) > std::numeric_limits<std::size_t>::max())
+  {
+    close(fd);
+    return false;
+  }
+
+  // Empty files can't be mapped.
+  if (file_info.st_size == 0)
+  {
+    close(fd);
+    m_is_open = true;
+    return true;
+  }
+
+  // The mapping keeps the file open, so the descriptor can be closed right away.
+  const std::size_t size = static_cast<std::size_t>(file_info.st_size);
+  void* const view = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (view == MAP_FAILED)
+  {
+    ERROR_LOG(COMMON, "Failed to map %s: %s", path.c_str(), LastStrerrorString().c_str());
+    return false;
+  }
+
+  m_data = static_cast<const u8*>(view);
+  m_size = size;
+  m_is_open = true;
+  return true;
+}
+
+void MappedFile::Close()
+{
+  if (m_data)
+    munmap(const_cast<u8*>(m_data), m_size);
+
+  m_data = nullptr;
+  m_size = 0;
+  m_is_open = false;
+}
+
+#endif
+}  // namespace Common
@@ -0,0 +1,46 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "Common/CommonTypes.h"
+
+namespace Common
+{
+// A read-only view of a whole file, mapped into the address space. Pages are only read from disk
+// when they're first accessed, so opening a large file is cheap even if little of it is used.
+//
+// The file must not be truncated by anyone else while it's mapped; appending to it is fine, but
+// the appended data isn't visible until the file is mapped again.
+class MappedFile final
+{
+public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  // Returns false if the file couldn't be opened or mapped. An empty file opens successfully,
+  // but has no data.
+  bool Open(const std::string& path);
+  void Close();
+
+  bool IsOpen() const { return m_is_open; }
+  const u8* GetData() const { return m_data; }
+  std::size_t GetSize() const { return m_size; }
+
+private:
+  void Swap(MappedFile& other) noexcept;
+
+  const u8* m_data = nullptr;
+  std::size_t m_size = 0;
+  bool m_is_open = false;
+};
+}  // namespace Common
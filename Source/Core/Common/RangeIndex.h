@@ -0,0 +1,128 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/FlatHashMap.h"
+
+namespace Common
+{
+// Index of values which cover address ranges [start, start + size].
+//
+// The address space is split into regions of (1 << RegionShift) bytes, and every value is listed
+// in each region its range touches. Looking up everything that overlaps a range therefore only
+// visits the values in the regions that range covers, instead of everything that starts within
+// the maximum value size below it, as an index sorted by start address would have to.
+//
+// Ranges which only touch each other are considered overlapping. Values are compared with
+// operator==, and the same value must not be inserted twice at the same start address.
+template <typename T, u32 RegionShift = 16>
+class RangeIndex
+{
+  static_assert(RegionShift > 0 && RegionShift < 32, "Invalid region size");
+
+public:
+  std::size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  void clear()
+  {
+    m_regions.clear();
+    m_size = 0;
+  }
+
+  void Insert(u32 start, u32 size, const T& value)
+  {
+    const u32 end = RangeEnd(start, size);
+    for (u32 region = start >> RegionShift; region <= (end >> RegionShift); ++region)
+      m_regions[region].push_back(Entry{start, end, value});
+    ++m_size;
+  }
+
+  // Removes a value which was inserted with the given start address.
+  // Returns false if it isn't in the index.
+  bool Erase(u32 start, const T& value)
+  {
+    const std::vector<Entry>* first_entries = m_regions.find(start >> RegionShift);
+    if (!first_entries)
+      return false;
+
+    const auto first =
+        std::find_if(first_entries->begin(), first_entries->end(),
+                     [&](const Entry& entry) { return entry.Matches(start, value); });
+    if (first == first_entries->end())
+      return false;
+
+    const u32 end = first->end;
+    for (u32 region = start >> RegionShift; region <= (end >> RegionShift); ++region)
+    {
+      std::vector<Entry>& entries = *m_regions.find(region);
+      const auto iter = std::find_if(entries.begin(), entries.end(), [&](const Entry& entry) {
+        return entry.Matches(start, value);
+      });
+
+      // The order within a region doesn't matter, so avoid shifting the remaining entries.
+      std::iter_swap(iter, entries.end() - 1);
+      entries.pop_back();
+      if (entries.empty())
+        m_regions.erase(region);
+    }
+
+    --m_size;
+    return true;
+  }
+
+  // Calls func(value) once for every value whose range overlaps [start, start + size], in no
+  // particular order. The index must not be modified from within func.
+  template <typename Func>
+  void ForEachOverlapping(u32 start, u32 size, Func func) const
+  {
+    const u32 end = RangeEnd(start, size);
+    const u32 first_region = start >> RegionShift;
+    for (u32 region = first_region; region <= (end >> RegionShift); ++region)
+    {
+      const std::vector<Entry>* entries = m_regions.find(region);
+      if (!entries)
+        continue;
+
+      for (const Entry& entry : *entries)
+      {
+        // Values spanning several regions are only reported from the first region which both
+        // ranges share.
+        if (entry.start <= end && entry.end >= start &&
+            std::max(entry.start >> RegionShift, first_region) == region)
+        {
+          func(entry.value);
+        }
+      }
+    }
+  }
+
+private:
+  struct Entry
+  {
+    bool Matches(u32 other_start, const T& other_value) const
+    {
+      return start == other_start && value == other_value;
+    }
+
+    u32 start;
+    u32 end;
+    T value;
+  };
+
+  static u32 RangeEnd(u32 start, u32 size)
+  {
+    return size > 0xFFFFFFFFU - start ? 0xFFFFFFFFU : start + size;
+  }
+
+  FlatHashMap<u32, std::vector<Entry>> m_regions;
+  std::size_t m_size = 0;
+};
+}  // namespace Common
@@ -0,0 +1,99 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+// a fixed size, lockless ring buffer of trivially copyable elements,
+// for a single producer and a single consumer
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace Common
+{
+template <typename T>
+class SPSCRingBuffer
+{
+  static_assert(std::is_trivially_copyable_v<T>, "elements are copied with memcpy");
+
+public:
+  // The capacity is rounded up to a power of two.
+  explicit SPSCRingBuffer(size_t capacity)
+  {
+    size_t size = 1;
+    while (size < capacity)
+      size *= 2;
+    m_buffer.resize(size);
+  }
+
+  SPSCRingBuffer(const SPSCRingBuffer&) = delete;
+  SPSCRingBuffer& operator=(const SPSCRingBuffer&) = delete;
+
+  size_t Capacity() const { return m_buffer.size(); }
+
+  // Can be called from either thread. The producer may see fewer elements than there are, and the
+  // consumer more free space, but never the other way around.
+  size_t Size() const
+  {
+    // Load the read position first, so that it can never be ahead of the write position.
+    const size_t read = m_read.load(std::memory_order_acquire);
+    return m_write.load(std::memory_order_acquire) - read;
+  }
+  size_t FreeSpace() const { return Capacity() - Size(); }
+
+  // Must only be called from the producer thread. Copies as many elements as there is room for,
+  // and returns how many that was.
+  size_t Push(const T* data, size_t count)
+  {
+    const size_t write = m_write.load(std::memory_order_relaxed);
+    count = std::min(count, Capacity() - (write - m_read.load(std::memory_order_acquire)));
+    CopyToRing(write, data, count);
+    m_write.store(write + count, std::memory_order_release);
+    return count;
+  }
+
+  // Must only be called from the consumer thread. Copies as many elements as are available, and
+  // returns how many that was.
+  size_t Pop(T* data, size_t count)
+  {
+    const size_t read = m_read.load(std::memory_order_relaxed);
+    count = std::min(count, m_write.load(std::memory_order_acquire) - read);
+    CopyFromRing(data, read, count);
+    m_read.store(read + count, std::memory_order_release);
+    return count;
+  }
+
+  // Must only be called from the consumer thread.
+  void Clear() { m_read.store(m_write.load(std::memory_order_acquire), std::memory_order_release); }
+
+private:
+  // Both copies are split in two where they wrap around the end of the buffer.
+  void CopyToRing(size_t position, const T* src, size_t count)
+  {
+    const size_t offset = position & (Capacity() - 1);
+    const size_t first = std::min(count, Capacity() - offset);
+    std::memcpy(&m_buffer[offset], src, first * sizeof(T));
+    std::memcpy(&m_buffer[0], src + first, (count - first) * sizeof(T));
+  }
+
+  void CopyFromRing(T* dest, size_t position, size_t count) const
+  {
+    const size_t offset = position & (Capacity() - 1);
+    const size_t first = std::min(count, Capacity() - offset);
+    std::memcpy(dest, &m_buffer[offset], first * sizeof(T));
+    std::memcpy(dest + first, &m_buffer[0], (count - first) * sizeof(T));
+  }
+
+  std::vector<T> m_buffer;
+
+  // Both positions only ever increase, and wrap around at the end of size_t. Keep them on
+  // separate cache lines, since each is written by a different thread.
+  alignas(64) std::atomic<size_t> m_write{0};
+  alignas(64) std::atomic<size_t> m_read{0};
+};
+}  // namespace Common
@@ -0,0 +1,103 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Common/ThreadPool.h"
+
+#include <algorithm>
+
+#include "Common/Thread.h"
+
+namespace Common
+{
+ThreadPool::ThreadPool(const std::string& name, unsigned int num_workers)
+{
+  if (num_workers == 0)
+    num_workers = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+
+  m_workers.reserve(num_workers);
+  for (unsigned int i = 0; i < num_workers; ++i)
+    m_workers.emplace_back(&ThreadPool::WorkerLoop, this, name);
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_shutdown = true;
+  }
+  m_work_available.notify_all();
+
+  for (std::thread& worker : m_workers)
+    worker.join();
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& func)
+{
+  if (count == 0)
+    return;
+
+  if (m_workers.empty() || count == 1)
+  {
+    for (size_t i = 0; i < count; ++i)
+      func(i);
+    return;
+  }
+
+  std::lock_guard<std::mutex> run_lk(m_run_mutex);
+
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_func = &func;
+    m_count = count;
+    m_next_index.store(0, std::memory_order_relaxed);
+    m_busy_workers = m_workers.size();
+    ++m_generation;
+  }
+  m_work_available.notify_all();
+
+  RunIterations();
+
+  std::unique_lock<std::mutex> lk(m_mutex);
+  m_work_done.wait(lk, [this] { return m_busy_workers == 0; });
+  m_func = nullptr;
+}
+
+void ThreadPool::RunIterations()
+{
+  while (true)
+  {
+    const size_t i = m_next_index.fetch_add(1, std::memory_order_relaxed);
+    if (i >= m_count)
+      return;
+    (*m_func)(i);
+  }
+}
+
+void ThreadPool::WorkerLoop(std::string name)
+{
+  Common::SetCurrentThreadName(name.c_str());
+
+  u64 last_generation = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lk(m_mutex);
+      m_work_available.wait(lk, [&] { return m_shutdown || m_generation != last_generation; });
+      if (m_shutdown)
+        return;
+      last_generation = m_generation;
+    }
+
+    RunIterations();
+
+    bool last_worker;
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      last_worker = --m_busy_workers == 0;
+    }
+    if (last_worker)
+      m_work_done.notify_one();
+  }
+}
+}  // namespace Common
@@ -0,0 +1,58 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+// A fixed set of worker threads that run the iterations of a loop in parallel.
+// The calling thread takes part in the work, so a pool with no workers runs loops serially.
+
+namespace Common
+{
+class ThreadPool final
+{
+public:
+  // Passing 0 creates one worker less than the number of hardware threads.
+  explicit ThreadPool(const std::string& name, unsigned int num_workers = 0);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Calls func(i) once for every i in [0, count) and returns when all calls are done.
+  // Calls from several threads are serialized. Must not be called from inside func.
+  void ParallelFor(size_t count, const std::function<void(size_t)>& func);
+
+  // The number of threads that take part in a loop, including the calling thread.
+  size_t GetThreadCount() const { return m_workers.size() + 1; }
+
+private:
+  void WorkerLoop(std::string name);
+  void RunIterations();
+
+  std::vector<std::thread> m_workers;
+
+  std::mutex m_run_mutex;
+  std::mutex m_mutex;
+  std::condition_variable m_work_available;
+  std::condition_variable m_work_done;
+
+  const std::function<void(size_t)>* m_func = nullptr;
+  size_t m_count = 0;
+  std::atomic<size_t> m_next_index{0};
+  size_t m_busy_workers = 0;
+  u64 m_generation = 0;
+  bool m_shutdown = false;
+};
+}  // namespace Common
@@ -0,0 +1,43 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+// A copy of XXH3 which uses AVX2 instead of SSE2. The rest of the build can't assume AVX2, so
+// XXH3 is compiled for it in this file only, and GetHash64 only calls it when available.
+
+#include "Common/Hash.h"
+
+#include <assert.h>
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Common/CommonTypes.h"
+
+// Everything xxhash includes is already included above, so this only applies to xxhash itself.
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+
+#define XXH_INLINE_ALL
+#define XXH_VECTOR XXH_AVX2
+#include <xxhash.h>
+
+namespace Common
+{
+u64 GetXXH3AVX2(const u8* src, u32 len)
+{
+  return XXH3_64bits(src, len);
+}
+}  // namespace Common
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
@@ -28,7 +28,7 @@ const ConfigInfo<AspectMode> GFX_SUGGESTED_ASPECT_RATIO{
 const ConfigInfo<bool> GFX_CROP{{System::GFX, "Settings", "Crop"}, false};
 const ConfigInfo<float> GFX_DISPLAY_SCALE{{System::GFX, "Settings", "DisplayScale"}, 1.0f};
 const ConfigInfo<int> GFX_SAFE_TEXTURE_CACHE_COLOR_SAMPLES{
-    {System::GFX, "Settings", "SafeTextureCacheColorSamples"}, 128};
+    {System::GFX, "Settings", "SafeTextureCacheColorSamples"}, 0};
 const ConfigInfo<bool> GFX_SHOW_FPS{{System::GFX, "Settings", "ShowFPS"}, false};
 const ConfigInfo<bool> GFX_SHOW_NETPLAY_PING{{System::GFX, "Settings", "ShowNetPlayPing"}, false};
 const ConfigInfo<bool> GFX_SHOW_NETPLAY_MESSAGES{{System::GFX, "Settings", "ShowNetPlayMessages"},
@@ -45,6 +45,7 @@ const ConfigInfo<bool> GFX_DUMP_EFB_TARGET{{System::GFX, "Settings", "DumpEFBTar
 const ConfigInfo<bool> GFX_DUMP_XFB_TARGET{{System::GFX, "Settings", "DumpXFBTarget"}, false};
 const ConfigInfo<bool> GFX_DUMP_FRAMES_AS_IMAGES{{System::GFX, "Settings", "DumpFramesAsImages"},
                                                  false};
+const ConfigInfo<bool> GFX_DUMP_PIPELINE_UIDS{{System::GFX, "Settings", "DumpPipelineUIDs"}, false};
 const ConfigInfo<bool> GFX_FREE_LOOK{{System::GFX, "Settings", "FreeLook"}, false};
 const ConfigInfo<bool> GFX_USE_FFV1{{System::GFX, "Settings", "UseFFV1"}, false};
 const ConfigInfo<std::string> GFX_DUMP_FORMAT{{System::GFX, "Settings", "DumpFormat"}, "avi"};
@@ -98,6 +99,7 @@ const ConfigInfo<bool> GFX_SW_DUMP_TEV_TEX_FETCHES{{System::GFX, "Settings", "SW
                                                    false};
 const ConfigInfo<int> GFX_SW_DRAW_START{{System::GFX, "Settings", "SWDrawStart"}, 0};
 const ConfigInfo<int> GFX_SW_DRAW_END{{System::GFX, "Settings", "SWDrawEnd"}, 100000};
+const ConfigInfo<int> GFX_SW_THREADS{{System::GFX, "Settings", "SWThreads"}, 0};
 
 const ConfigInfo<bool> GFX_PREFER_GLES{{System::GFX, "Settings", "PreferGLES"}, false};
 
@@ -143,6 +145,8 @@ const ConfigInfo<bool> GFX_HACK_TMEM_CACHE_EMULATION{{System::GFX, "Hacks", "TME
                                                      true};
 const ConfigInfo<bool> GFX_HACK_VERTEX_ROUDING{{System::GFX, "Hacks", "VertexRounding"}, false};
 const ConfigInfo<bool> GFX_HACK_VI_SKIP{{System::GFX, "Hacks", "VISkip"}, false};
+const ConfigInfo<bool> GFX_HACK_VERTEX_LOADER_CACHE{{System::GFX, "Hacks", "VertexLoaderCache"},
+                                                    false};
 
 // Graphics.GameSpecific
 
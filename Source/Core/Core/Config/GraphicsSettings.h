@@ -41,6 +41,7 @@ extern const ConfigInfo<bool> GFX_CACHE_HIRES_TEXTURES;
 extern const ConfigInfo<bool> GFX_DUMP_EFB_TARGET;
 extern const ConfigInfo<bool> GFX_DUMP_XFB_TARGET;
 extern const ConfigInfo<bool> GFX_DUMP_FRAMES_AS_IMAGES;
+extern const ConfigInfo<bool> GFX_DUMP_PIPELINE_UIDS;
 extern const ConfigInfo<bool> GFX_FREE_LOOK;
 extern const ConfigInfo<bool> GFX_USE_FFV1;
 extern const ConfigInfo<std::string> GFX_DUMP_FORMAT;
@@ -78,6 +79,7 @@ extern const ConfigInfo<bool> GFX_SW_DUMP_TEV_STAGES;
 extern const ConfigInfo<bool> GFX_SW_DUMP_TEV_TEX_FETCHES;
 extern const ConfigInfo<int> GFX_SW_DRAW_START;
 extern const ConfigInfo<int> GFX_SW_DRAW_END;
+extern const ConfigInfo<int> GFX_SW_THREADS;
 
 extern const ConfigInfo<bool> GFX_PREFER_GLES;
 
@@ -109,6 +111,7 @@ extern const ConfigInfo<bool> GFX_HACK_EFB_EMULATE_FORMAT_CHANGES;
 extern const ConfigInfo<bool> GFX_HACK_TMEM_CACHE_EMULATION;
 extern const ConfigInfo<bool> GFX_HACK_VERTEX_ROUDING;
 extern const ConfigInfo<bool> GFX_HACK_VI_SKIP;
+extern const ConfigInfo<bool> GFX_HACK_VERTEX_LOADER_CACHE;
 
 // Graphics.GameSpecific
 
@@ -21,6 +21,9 @@ const ConfigInfo<bool> MAIN_LOAD_IPL_DUMP{{System::Main, "Core", "LoadIPLDump"},
 const ConfigInfo<PowerPC::CPUCore> MAIN_CPU_CORE{{System::Main, "Core", "CPUCore"},
                                                  PowerPC::DefaultCPUCore()};
 const ConfigInfo<bool> MAIN_JIT_FOLLOW_BRANCH{{System::Main, "Core", "JITFollowBranch"}, true};
+const ConfigInfo<bool> MAIN_JIT_DISK_CACHE{{System::Main, "Core", "JITDiskCache"}, true};
+const ConfigInfo<int> MAIN_REWIND_SNAPSHOTS{{System::Main, "Core", "RewindSnapshots"}, 0};
+const ConfigInfo<int> MAIN_REWIND_INTERVAL{{System::Main, "Core", "RewindInterval"}, 30};
 const ConfigInfo<bool> MAIN_FASTMEM{{System::Main, "Core", "Fastmem"}, true};
 const ConfigInfo<bool> MAIN_DSP_HLE{{System::Main, "Core", "DSPHLE"}, true};
 const ConfigInfo<int> MAIN_TIMING_VARIANCE{{System::Main, "Core", "TimingVariance"}, 40};
@@ -89,6 +92,10 @@ const ConfigInfo<int> MAIN_SYNC_GPU_MAX_DISTANCE{{System::Main, "Core", "SyncGpu
 const ConfigInfo<int> MAIN_SYNC_GPU_MIN_DISTANCE{{System::Main, "Core", "SyncGpuMinDistance"},
                                                  -200000};
 const ConfigInfo<float> MAIN_SYNC_GPU_OVERCLOCK{{System::Main, "Core", "SyncGpuOverclock"}, 1.0f};
+const ConfigInfo<int> MAIN_GPU_WAKEUP_THRESHOLD{{System::Main, "Core", "GPUWakeupThreshold"}, 0};
+const ConfigInfo<int> MAIN_GPU_WAKEUP_MAX_DELAY{{System::Main, "Core", "GPUWakeupMaxDelay"},
+                                                20000};
+const ConfigInfo<bool> MAIN_GPU_SYNC_STATS{{System::Main, "Core", "GPUSyncStats"}, false};
 const ConfigInfo<bool> MAIN_FAST_DISC_SPEED{{System::Main, "Core", "FastDiscSpeed"}, false};
 const ConfigInfo<bool> MAIN_LOW_DCBZ_HACK{{System::Main, "Core", "LowDCBZHack"}, false};
 const ConfigInfo<bool> MAIN_FLOAT_EXCEPTIONS{{System::Main, "Core", "FloatExceptions"}, false};
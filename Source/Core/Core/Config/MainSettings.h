@@ -21,6 +21,9 @@ extern const ConfigInfo<bool> MAIN_SKIP_IPL;
 extern const ConfigInfo<bool> MAIN_LOAD_IPL_DUMP;
 extern const ConfigInfo<PowerPC::CPUCore> MAIN_CPU_CORE;
 extern const ConfigInfo<bool> MAIN_JIT_FOLLOW_BRANCH;
+extern const ConfigInfo<bool> MAIN_JIT_DISK_CACHE;
+extern const ConfigInfo<int> MAIN_REWIND_SNAPSHOTS;
+extern const ConfigInfo<int> MAIN_REWIND_INTERVAL;
 extern const ConfigInfo<bool> MAIN_FASTMEM;
 // Should really be in the DSP section, but we're kind of stuck with bad decisions made in the past.
 extern const ConfigInfo<bool> MAIN_DSP_HLE;
@@ -63,6 +66,9 @@ extern const ConfigInfo<bool> MAIN_SYNC_GPU;
 extern const ConfigInfo<int> MAIN_SYNC_GPU_MAX_DISTANCE;
 extern const ConfigInfo<int> MAIN_SYNC_GPU_MIN_DISTANCE;
 extern const ConfigInfo<float> MAIN_SYNC_GPU_OVERCLOCK;
+extern const ConfigInfo<int> MAIN_GPU_WAKEUP_THRESHOLD;
+extern const ConfigInfo<int> MAIN_GPU_WAKEUP_MAX_DELAY;
+extern const ConfigInfo<bool> MAIN_GPU_SYNC_STATS;
 extern const ConfigInfo<bool> MAIN_FAST_DISC_SPEED;
 extern const ConfigInfo<bool> MAIN_LOW_DCBZ_HACK;
 extern const ConfigInfo<bool> MAIN_FLOAT_EXCEPTIONS;
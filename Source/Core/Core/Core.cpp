@@ -139,6 +139,8 @@ void FrameUpdateOnCPUThread()
 
 void OnFrameEnd()
 {
+  ::State::OnFrameEnd();
+
 #ifdef USE_MEMORYWATCHER
   if (s_memory_watcher)
     s_memory_watcher->Step();
@@ -883,6 +885,14 @@ void UpdateTitle()
   {
     Mixer* pMixer = g_sound_stream->GetMixer();
     pMixer->UpdateSpeed(s_last_perf_stats.Speed / 100);
+
+    if (g_ActiveConfig.bShowFPS)
+    {
+      const Mixer::Statistics audio_stats = pMixer->GetStatistics();
+      SFPS += StringFromFormat("\nAudio: %u/%u ms - Underruns: %u - Overruns: %u",
+                               audio_stats.buffered_ms, audio_stats.target_latency_ms,
+                               audio_stats.underruns, audio_stats.overruns);
+    }
   }
 
   g_renderer->UpdateDebugTitle(SFPS);
@@ -5,16 +5,18 @@
 #include "Core/CoreTiming.h"
 
 #include <algorithm>
+#include <array>
 #include <cinttypes>
-#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "Common/Assert.h"
+#include "Common/BitSet.h"
 #include "Common/ChunkFile.h"
 #include "Common/Logging/Log.h"
-#include "Common/SPSCQueue.h"
+#include "Common/MPSCQueue.h"
+#include "Common/MathUtil.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
 
@@ -28,10 +30,15 @@
 
 namespace CoreTiming
 {
+// Ends the linked lists of the event queue.
+static constexpr u32 INVALID_NODE = UINT32_MAX;
+
 struct EventType
 {
   TimedCallback callback;
   const std::string* name;
+  // The first pending event of this type in the event queue.
+  u32 first_event;
 };
 
 struct Event
@@ -43,28 +50,349 @@ struct Event
 };
 
 // Sort by time, unless the times are the same, in which case sort by the order added to the queue
-static bool operator>(const Event& left, const Event& right)
-{
-  return std::tie(left.time, left.fifo_order) > std::tie(right.time, right.fifo_order);
-}
 static bool operator<(const Event& left, const Event& right)
 {
   return std::tie(left.time, left.fifo_order) < std::tie(right.time, right.fifo_order);
 }
 
+// A hierarchical timing wheel. Each level has 64 slots, and a slot of a level covers as many
+// cycles as the whole level below it. An event is stored in the lowest level in which its time
+// and the current time of the wheel only differ in the slot index, so level 0 has a slot for each
+// of the next cycles, and the events of a slot of a higher level are moved to the lower levels
+// ("cascaded") once the wheel reaches that slot. Scheduling and removing events takes constant
+// time, and finding the next event only looks at a bitmap of the used slots of each level.
+//
+// The events of a slot are kept in the order they were added in, and cascading doesn't change
+// that order. Since fifo_order only ever increases when events are added, events which have the
+// same time are therefore still run in the order they were scheduled in.
+//
+// Events which are scheduled before the current time of the wheel (which can happen when events
+// are scheduled from other threads or into the past) are kept in a separate sorted list and run
+// before all others.
+class EventQueue
+{
+public:
+  bool Empty() const { return m_size == 0; }
+
+  void Push(const Event& event)
+  {
+    const u32 index = AllocateNode();
+    Node& node = m_nodes[index];
+    node.event = event;
+
+    // Link the node into the list of events of its type, so that they can be removed quickly.
+    node.type_prev = INVALID_NODE;
+    node.type_next = event.type->first_event;
+    if (node.type_next != INVALID_NODE)
+      m_nodes[node.type_next].type_prev = index;
+    event.type->first_event = index;
+
+    Insert(index);
+    ++m_size;
+  }
+
+  // Returns the time of the next event. The queue must not be empty.
+  s64 GetNextTime()
+  {
+    const u32 list = FindFirstList();
+    if (list < SLOTS_PER_LEVEL || list == OVERDUE_LIST)
+      return m_nodes[m_lists[list].head].event.time;
+    return GetMinTime(list);
+  }
+
+  // Removes and returns the next event. The queue must not be empty.
+  Event Pop()
+  {
+    u32 list = FindFirstList();
+    while (list >= SLOTS_PER_LEVEL && list != OVERDUE_LIST)
+    {
+      Cascade(list);
+      list = FindFirstList();
+    }
+
+    const u32 index = m_lists[list].head;
+    const Event event = m_nodes[index].event;
+    m_now = std::max(m_now, event.time);
+    Unlink(index);
+    UnlinkType(index);
+    FreeNode(index);
+    --m_size;
+    return event;
+  }
+
+  void Remove(EventType* event_type)
+  {
+    u32 index = event_type->first_event;
+    while (index != INVALID_NODE)
+    {
+      const u32 next = m_nodes[index].type_next;
+      Unlink(index);
+      FreeNode(index);
+      --m_size;
+      index = next;
+    }
+    event_type->first_event = INVALID_NODE;
+  }
+
+  // Returns all events in no particular order.
+  std::vector<Event> GetEvents() const
+  {
+    std::vector<Event> events;
+    events.reserve(m_size);
+    for (const List& list : m_lists)
+    {
+      for (u32 index = list.head; index != INVALID_NODE; index = m_nodes[index].next)
+        events.push_back(m_nodes[index].event);
+    }
+    return events;
+  }
+
+  void Clear(s64 now)
+  {
+    for (const List& list : m_lists)
+    {
+      for (u32 index = list.head; index != INVALID_NODE; index = m_nodes[index].next)
+        m_nodes[index].event.type->first_event = INVALID_NODE;
+    }
+
+    m_nodes.clear();
+    m_free_node = INVALID_NODE;
+    m_lists.fill(List{});
+    m_occupied.fill(0);
+    m_now = std::max<s64>(now, 0);
+    m_size = 0;
+  }
+
+  // Replaces the contents of the queue, for example after loading a save state.
+  void Reset(std::vector<Event> events, s64 now)
+  {
+    Clear(now);
+
+    // Events which have the same time must be added in the order they were scheduled in.
+    std::sort(events.begin(), events.end(),
+              [](const Event& a, const Event& b) { return a.fifo_order < b.fifo_order; });
+    for (const Event& event : events)
+      Push(event);
+  }
+
+private:
+  static constexpr u32 SLOT_BITS = 6;
+  static constexpr u32 SLOTS_PER_LEVEL = 1 << SLOT_BITS;
+  static constexpr u32 NUM_LEVELS = (64 + SLOT_BITS - 1) / SLOT_BITS;
+  static constexpr u32 OVERDUE_LIST = NUM_LEVELS * SLOTS_PER_LEVEL;
+  static constexpr u32 NUM_LISTS = OVERDUE_LIST + 1;
+
+  struct Node
+  {
+    Event event;
+    // The list (slot) the node is in, and its neighbours in that list. Free nodes are linked
+    // through next.
+    u32 list;
+    u32 prev;
+    u32 next;
+    // The neighbours in the list of events of the same type.
+    u32 type_prev;
+    u32 type_next;
+  };
+
+  struct List
+  {
+    u32 head = INVALID_NODE;
+    u32 tail = INVALID_NODE;
+    // The earliest time in the list, which is recalculated when needed after that event has been
+    // removed. Only used for slots above level 0, which don't all have the same time.
+    s64 min_time = 0;
+    bool min_time_valid = false;
+  };
+
+  static u32 GetLevel(u32 list) { return list >> SLOT_BITS; }
+
+  u32 AllocateNode()
+  {
+    if (m_free_node == INVALID_NODE)
+    {
+      m_nodes.emplace_back();
+      return static_cast<u32>(m_nodes.size() - 1);
+    }
+
+    const u32 index = m_free_node;
+    m_free_node = m_nodes[index].next;
+    return index;
+  }
+
+  void FreeNode(u32 index)
+  {
+    m_nodes[index].next = m_free_node;
+    m_free_node = index;
+  }
+
+  void Insert(u32 index)
+  {
+    Node& node = m_nodes[index];
+    const s64 time = node.event.time;
+    if (time < m_now)
+    {
+      InsertOverdue(index);
+      return;
+    }
+
+    const u64 differing_bits = static_cast<u64>(time) ^ static_cast<u64>(m_now);
+    const u32 level = differing_bits == 0 ? 0 : IntLog2(differing_bits) / SLOT_BITS;
+    const u32 slot = (static_cast<u64>(time) >> (level * SLOT_BITS)) & (SLOTS_PER_LEVEL - 1);
+    const u32 list_index = level * SLOTS_PER_LEVEL + slot;
+    List& list = m_lists[list_index];
+
+    if (list.head == INVALID_NODE)
+    {
+      m_occupied[level] |= u64(1) << slot;
+      list.min_time = time;
+      list.min_time_valid = true;
+    }
+    else if (list.min_time_valid)
+    {
+      list.min_time = std::min(list.min_time, time);
+    }
+
+    node.list = list_index;
+    node.prev = list.tail;
+    node.next = INVALID_NODE;
+    if (list.tail != INVALID_NODE)
+      m_nodes[list.tail].next = index;
+    else
+      list.head = index;
+    list.tail = index;
+  }
+
+  // Overdue events are rare, so a sorted list is good enough for them.
+  void InsertOverdue(u32 index)
+  {
+    Node& node = m_nodes[index];
+    List& list = m_lists[OVERDUE_LIST];
+
+    u32 prev = list.tail;
+    while (prev != INVALID_NODE && node.event < m_nodes[prev].event)
+      prev = m_nodes[prev].prev;
+
+    const u32 next = prev == INVALID_NODE ? list.head : m_nodes[prev].next;
+    node.list = OVERDUE_LIST;
+    node.prev = prev;
+    node.next = next;
+    if (prev != INVALID_NODE)
+      m_nodes[prev].next = index;
+    else
+      list.head = index;
+    if (next != INVALID_NODE)
+      m_nodes[next].prev = index;
+    else
+      list.tail = index;
+  }
+
+  void Unlink(u32 index)
+  {
+    const Node& node = m_nodes[index];
+    List& list = m_lists[node.list];
+
+    if (node.prev != INVALID_NODE)
+      m_nodes[node.prev].next = node.next;
+    else
+      list.head = node.next;
+    if (node.next != INVALID_NODE)
+      m_nodes[node.next].prev = node.prev;
+    else
+      list.tail = node.prev;
+
+    if (node.list == OVERDUE_LIST)
+      return;
+
+    if (list.head == INVALID_NODE)
+      m_occupied[GetLevel(node.list)] &= ~(u64(1) << (node.list & (SLOTS_PER_LEVEL - 1)));
+    else if (node.event.time == list.min_time)
+      list.min_time_valid = false;
+  }
+
+  void UnlinkType(u32 index)
+  {
+    const Node& node = m_nodes[index];
+    if (node.type_prev != INVALID_NODE)
+      m_nodes[node.type_prev].type_next = node.type_next;
+    else
+      node.event.type->first_event = node.type_next;
+    if (node.type_next != INVALID_NODE)
+      m_nodes[node.type_next].type_prev = node.type_prev;
+  }
+
+  // Returns the list which contains the next event. The overdue events come before all others,
+  // and any event in a level comes before all events in the levels above it.
+  u32 FindFirstList() const
+  {
+    if (m_lists[OVERDUE_LIST].head != INVALID_NODE)
+      return OVERDUE_LIST;
+
+    for (u32 level = 0; level < NUM_LEVELS; ++level)
+    {
+      if (m_occupied[level] != 0)
+        return level * SLOTS_PER_LEVEL + Common::LeastSignificantSetBit(m_occupied[level]);
+    }
+
+    ASSERT_MSG(POWERPC, false, "The event queue is empty");
+    return OVERDUE_LIST;
+  }
+
+  s64 GetMinTime(u32 list_index)
+  {
+    List& list = m_lists[list_index];
+    if (!list.min_time_valid)
+    {
+      list.min_time = m_nodes[list.head].event.time;
+      for (u32 index = m_nodes[list.head].next; index != INVALID_NODE; index = m_nodes[index].next)
+        list.min_time = std::min(list.min_time, m_nodes[index].event.time);
+      list.min_time_valid = true;
+    }
+    return list.min_time;
+  }
+
+  // Moves the wheel to the start of a slot which contains the next event, and moves the events
+  // of that slot to the lower levels.
+  void Cascade(u32 list_index)
+  {
+    const u32 shift = GetLevel(list_index) * SLOT_BITS;
+    const u64 slot = list_index & (SLOTS_PER_LEVEL - 1);
+    const u64 upper_bits = static_cast<u64>(m_now) & ~((u64(SLOTS_PER_LEVEL) << shift) - 1);
+    m_now = static_cast<s64>(upper_bits | (slot << shift));
+
+    List& list = m_lists[list_index];
+    u32 index = list.head;
+    list = List{};
+    m_occupied[GetLevel(list_index)] &= ~(u64(1) << slot);
+
+    while (index != INVALID_NODE)
+    {
+      const u32 next = m_nodes[index].next;
+      Insert(index);
+      index = next;
+    }
+  }
+
+  std::vector<Node> m_nodes;
+  u32 m_free_node = INVALID_NODE;
+  std::array<List, NUM_LISTS> m_lists;
+  // A bit for each slot of each level which contains events.
+  std::array<u64, NUM_LEVELS> m_occupied{};
+  // The time of the wheel. All events which aren't overdue are at or after this time.
+  s64 m_now = 0;
+  std::size_t m_size = 0;
+};
+
 // unordered_map stores each element separately as a linked list node so pointers to elements
 // remain stable regardless of rehashes/resizing.
 static std::unordered_map<std::string, EventType> s_event_types;
 
 // STATE_TO_SAVE
-// The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-// We don't use std::priority_queue because we need to be able to serialize, unserialize and
-// erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't accomodated
-// by the standard adaptor class.
-static std::vector<Event> s_event_queue;
+static EventQueue s_event_queue;
 static u64 s_event_fifo_id;
-static std::mutex s_ts_write_lock;
-static Common::SPSCQueue<Event, false> s_ts_queue;
+// Events scheduled from other threads, which get their fifo_order once they are moved to the
+// event queue by the CPU thread.
+static Common::MPSCQueue<Event> s_ts_queue;
 
 static float s_last_OC_factor;
 static constexpr int MAX_SLICE_LENGTH = 20000;
@@ -124,7 +452,7 @@ EventType* RegisterEvent(const std::string& name, TimedCallback callback)
              "during Init to avoid breaking save states.",
              name.c_str());
 
-  auto info = s_event_types.emplace(name, EventType{callback, nullptr});
+  auto info = s_event_types.emplace(name, EventType{callback, nullptr, INVALID_NODE});
   EventType* event_type = &info.first->second;
   event_type->name = &info.first->first;
   return event_type;
@@ -132,7 +460,7 @@ EventType* RegisterEvent(const std::string& name, TimedCallback callback)
 
 void UnregisterAllEvents()
 {
-  ASSERT_MSG(POWERPC, s_event_queue.empty(), "Cannot unregister events with events pending");
+  ASSERT_MSG(POWERPC, s_event_queue.Empty(), "Cannot unregister events with events pending");
   s_event_types.clear();
 }
 
@@ -155,12 +483,12 @@ void Init()
   ResetThrottle(0);
 
   s_event_fifo_id = 0;
+  ClearPendingEvents();
   s_ev_lost = RegisterEvent("_lost_event", &EmptyTimedCallback);
 }
 
 void Shutdown()
 {
-  std::lock_guard<std::mutex> lk(s_ts_write_lock);
   MoveEvents();
   ClearPendingEvents();
   UnregisterAllEvents();
@@ -168,7 +496,6 @@ void Shutdown()
 
 void DoState(PointerWrap& p)
 {
-  std::lock_guard<std::mutex> lk(s_ts_write_lock);
   p.Do(g.slice_length);
   p.Do(g.global_timer);
   p.Do(s_idled_cycles);
@@ -183,7 +510,14 @@ void DoState(PointerWrap& p)
   p.DoMarker("CoreTimingData");
 
   MoveEvents();
-  p.DoEachElement(s_event_queue, [](PointerWrap& pw, Event& ev) {
+  std::vector<Event> events;
+  if (p.GetMode() != PointerWrap::MODE_READ)
+  {
+    // The order doesn't matter when loading, but keep it the same for identical states.
+    events = s_event_queue.GetEvents();
+    std::sort(events.begin(), events.end());
+  }
+  p.DoEachElement(events, [](PointerWrap& pw, Event& ev) {
     pw.Do(ev.time);
     pw.Do(ev.fifo_order);
 
@@ -216,15 +550,11 @@ void DoState(PointerWrap& p)
   });
   p.DoMarker("CoreTimingEvents");
 
-  // When loading from a save state, we must assume the Event order is random and meaningless.
-  // The exact layout of the heap in memory is implementation defined, therefore it is platform
-  // and library version specific.
   if (p.GetMode() == PointerWrap::MODE_READ)
   {
     // When loading from a save state, we must assume the Event order is random and meaningless.
-    // The exact layout of the heap in memory is implementation defined, therefore it is platform
-    // and library version specific.
-    std::make_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+    // Older versions saved the events in the order of a heap.
+    s_event_queue.Reset(std::move(events), g.global_timer);
 
     // The stave state has changed the time, so our previous Throttle targets are invalid.
     // Especially when global_time goes down; So we create a fake throttle update.
@@ -252,7 +582,7 @@ u64 GetIdleTicks()
 
 void ClearPendingEvents()
 {
-  s_event_queue.clear();
+  s_event_queue.Clear(g.global_timer);
 }
 
 void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata, FromThread from)
@@ -280,8 +610,7 @@ void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata,
     if (!s_is_global_timer_sane)
       ForceExceptionCheck(cycles_into_future);
 
-    s_event_queue.emplace_back(Event{timeout, s_event_fifo_id++, userdata, event_type});
-    std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
+    s_event_queue.Push(Event{timeout, s_event_fifo_id++, userdata, event_type});
   }
   else
   {
@@ -293,22 +622,17 @@ void ScheduleEvent(s64 cycles_into_future, EventType* event_type, u64 userdata,
                 event_type->name->c_str());
     }
 
-    std::lock_guard<std::mutex> lk(s_ts_write_lock);
     s_ts_queue.Push(Event{g.global_timer + cycles_into_future, 0, userdata, event_type});
   }
 }
 
 void RemoveEvent(EventType* event_type)
 {
-  auto itr = std::remove_if(s_event_queue.begin(), s_event_queue.end(),
-                            [&](const Event& e) { return e.type == event_type; });
-
-  // Removing random items breaks the invariant so we have to re-establish it.
-  if (itr != s_event_queue.end())
-  {
-    s_event_queue.erase(itr, s_event_queue.end());
-    std::make_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-  }
+  // Events may be removed before their type has been registered (e.g. PowerPC::Reset resets the
+  // decrementer before SystemTimers has registered its events), so only look at the type if there
+  // is anything to remove.
+  if (!s_event_queue.Empty())
+    s_event_queue.Remove(event_type);
 }
 
 void RemoveAllEvents(EventType* event_type)
@@ -331,12 +655,10 @@ void ForceExceptionCheck(s64 cycles)
 
 void MoveEvents()
 {
-  for (Event ev; s_ts_queue.Pop(ev);)
-  {
+  s_ts_queue.PopAll([](Event ev) {
     ev.fifo_order = s_event_fifo_id++;
-    s_event_queue.emplace_back(std::move(ev));
-    std::push_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-  }
+    s_event_queue.Push(ev);
+  });
 }
 
 void Advance()
@@ -351,21 +673,20 @@ void Advance()
 
   s_is_global_timer_sane = true;
 
-  while (!s_event_queue.empty())
+  while (!s_event_queue.Empty())
   {
-    Event evt = s_event_queue.front();
-    if (evt.time <= g.global_timer)
+    const s64 next_time = s_event_queue.GetNextTime();
+    if (next_time <= g.global_timer)
     {
-      std::pop_heap(s_event_queue.begin(), s_event_queue.end(), std::greater<Event>());
-      s_event_queue.pop_back();
-
+      const Event evt = s_event_queue.Pop();
       Throttle(evt.time);
       evt.type->callback(evt.userdata, g.global_timer - evt.time);
     }
     else
     {
       // Still events left (scheduled in the future)
-      g.slice_length = static_cast<int>(std::min<s64>(evt.time - g.global_timer, MAX_SLICE_LENGTH));
+      g.slice_length =
+          static_cast<int>(std::min<s64>(next_time - g.global_timer, MAX_SLICE_LENGTH));
       break;
     }
   }
@@ -446,7 +767,7 @@ bool GetVISkip()
 
 void LogPendingEvents()
 {
-  auto clone = s_event_queue;
+  auto clone = s_event_queue.GetEvents();
   std::sort(clone.begin(), clone.end());
   for (const Event& ev : clone)
   {
@@ -461,11 +782,13 @@ void AdjustEventQueueTimes(u32 new_ppc_clock, u32 old_ppc_clock)
   s_throttle_clock_per_sec = new_ppc_clock;
   s_throttle_min_clock_per_sleep = new_ppc_clock / 1200;
 
-  for (Event& ev : s_event_queue)
+  std::vector<Event> events = s_event_queue.GetEvents();
+  for (Event& ev : events)
   {
     const s64 ticks = (ev.time - g.global_timer) * new_ppc_clock / old_ppc_clock;
     ev.time = g.global_timer + ticks;
   }
+  s_event_queue.Reset(std::move(events), g.global_timer);
 }
 
 void Idle()
@@ -488,7 +811,7 @@ std::string GetScheduledEventsSummary()
   std::string text = "Scheduled events\n";
   text.reserve(1000);
 
-  auto clone = s_event_queue;
+  auto clone = s_event_queue.GetEvents();
   std::sort(clone.begin(), clone.end());
   for (const Event& ev : clone)
   {
@@ -161,6 +161,62 @@ u16 Accelerator::Read(const s16* coefs)
   return val;
 }
 
+void Accelerator::ReadSamples(const s16* coefs, s16* samples, u32 count)
+{
+  u32 i = 0;
+  while (i < count)
+  {
+    if (m_sample_format == 0x00 && !m_reads_stopped)
+      i += DecodeADPCMRun(coefs, samples + i, count - i);
+
+    // Frame headers, the end address and the other formats are left to Read().
+    if (i < count)
+      samples[i++] = static_cast<s16>(Read(coefs));
+  }
+}
+
+// Decodes ADPCM samples for as long as none of the special cases of Read() can happen, which is
+// until the next frame header or the end address. Returns the number of samples decoded.
+u32 Accelerator::DecodeADPCMRun(const s16* coefs, s16* samples, u32 count)
+{
+  const int scale = 1 << (m_pred_scale & 0xF);
+  const int coef_idx = (m_pred_scale >> 4) & 0x7;
+
+  const s32 coef1 = coefs[coef_idx * 2 + 0];
+  const s32 coef2 = coefs[coef_idx * 2 + 1];
+
+  s32 yn1 = m_yn1;
+  s32 yn2 = m_yn2;
+  u32 address = m_current_address;
+  u8 data = 0;
+
+  u32 i = 0;
+  for (; i < count; ++i)
+  {
+    const u32 next = address + 1;
+    if ((next & 15) == 0 || next - (m_end_address - 1) <= 2)
+      break;
+
+    if (i == 0 || !(address & 1))
+      data = ReadMemory(address >> 1);
+
+    int temp = (address & 1) ? (data & 0xF) : (data >> 4);
+    if (temp >= 8)
+      temp -= 16;
+
+    const s32 val32 = (scale * temp) + ((0x400 + coef1 * yn1 + coef2 * yn2) >> 11);
+    yn2 = yn1;
+    yn1 = static_cast<s16>(std::clamp<s32>(val32, -0x7FFF, 0x7FFF));
+    samples[i] = static_cast<s16>(yn1);
+    address = next;
+  }
+
+  m_yn1 = static_cast<s16>(yn1);
+  m_yn2 = static_cast<s16>(yn2);
+  m_current_address = address;
+  return i;
+}
+
 void Accelerator::DoState(PointerWrap& p)
 {
   p.Do(m_start_address);
@@ -16,6 +16,8 @@ public:
   virtual ~Accelerator() = default;
 
   u16 Read(const s16* coefs);
+  // Equivalent to calling Read() count times, but decodes ADPCM a frame at a time.
+  void ReadSamples(const s16* coefs, s16* samples, u32 count);
   // Zelda ucode reads ARAM through 0xffd3.
   u16 ReadD3();
   void WriteD3(u16 value);
@@ -55,5 +57,8 @@ protected:
   // and updating the current address register, unless the YN2 register is written to.
   // This is kept track of internally; this state is not exposed via any register.
   bool m_reads_stopped = false;
+
+private:
+  u32 DecodeADPCMRun(const s16* coefs, s16* samples, u32 count);
 };
 }  // namespace DSP
@@ -170,7 +170,7 @@ bool DSPCore_Init(const DSPInitOptions& opts)
   Common::WriteProtectMemory(g_dsp.iram, DSP_IRAM_BYTE_SIZE, false);
 
   // Initialize JIT, if necessary
-  if (opts.core_type == DSPInitOptions::CoreType::JIT64)
+  if (opts.core_type == DSPInitOptions::CoreType::JIT)
     g_dsp_jit = JIT::CreateDSPEmitter();
 
   g_dsp_cap.reset(opts.capture_logger);
@@ -10,6 +10,8 @@
 #include <string>
 #include <vector>
 
+#include <zstd.h>
+
 #include "Common/File.h"
 #include "Common/MsgHandler.h"
 #include "Core/Config/MainSettings.h"
@@ -18,11 +20,12 @@
 enum
 {
   FILE_ID = 0x0d01f1f0,
-  VERSION_NUMBER = 5,
+  VERSION_NUMBER = 6,
   MIN_LOADER_VERSION = 1,
   // This value is only used if the DFF file was created with overridden RAM sizes.
   // If the MIN_LOADER_VERSION ever exceeds this, it's alright to remove it.
   MIN_LOADER_VERSION_FOR_RAM_OVERRIDE = 5,
+  MIN_LOADER_VERSION_FOR_COMPRESSION = 6,
 };
 
 #pragma pack(push, 1)
@@ -61,7 +64,11 @@ struct FileFrameInfo
   u32 fifoEnd;
   u64 memoryUpdatesOffset;
   u32 numMemoryUpdates;
-  u8 reserved[32];
+  // Only used by compressed files. The offsets above are then offsets into the decompressed data.
+  u64 compressedDataOffset;
+  u32 compressedDataSize;
+  u32 decompressedDataSize;
+  u8 reserved[16];
 };
 static_assert(sizeof(FileFrameInfo) == 64, "FileFrameInfo should be 64 bytes");
 
@@ -78,6 +85,103 @@ static_assert(sizeof(FileMemoryUpdate) == 24, "FileMemoryUpdate should be 24 byt
 
 #pragma pack(pop)
 
+// Returns a pointer to the given range of the data, or nullptr if it's out of bounds.
+static const u8* GetRange(const u8* data, u64 size, u64 offset, u64 length)
+{
+  if (offset > size || length > size - offset)
+    return nullptr;
+  return data + offset;
+}
+
+template <typename T>
+static bool ReadArray(const u8* data, u64 size, u64 offset, T* out, u32 count)
+{
+  const u8* src = GetRange(data, size, offset, static_cast<u64>(count) * sizeof(T));
+  if (!src)
+    return false;
+  std::memcpy(out, src, count * sizeof(T));
+  return true;
+}
+
+template <typename T>
+static void Append(std::vector<u8>& data, const T* src, std::size_t count)
+{
+  const std::size_t offset = data.size();
+  data.resize(offset + count * sizeof(T));
+  std::memcpy(data.data() + offset, src, count * sizeof(T));
+}
+
+// Lays out a frame the way it's stored in files: the fifo data, followed by the memory update list
+// and the data of the memory updates. The offsets in the file structures start at base_offset.
+static std::vector<u8> SerializeFrame(const FifoFrameInfo& frame, u64 base_offset,
+                                      FileFrameInfo* info)
+{
+  std::vector<u8> data;
+  Append(data, frame.fifoData.data(), frame.fifoData.size());
+
+  const std::size_t updates_offset = data.size();
+  std::vector<FileMemoryUpdate> updates(frame.memoryUpdates.size());
+  Append(data, updates.data(), updates.size());
+
+  for (std::size_t i = 0; i < frame.memoryUpdates.size(); ++i)
+  {
+    const MemoryUpdate& src_update = frame.memoryUpdates[i];
+
+    FileMemoryUpdate dst_update{};
+    dst_update.address = src_update.address;
+    dst_update.dataOffset = base_offset + data.size();
+    dst_update.dataSize = static_cast<u32>(src_update.data.size());
+    dst_update.fifoPosition = src_update.fifoPosition;
+    dst_update.type = src_update.type;
+    std::memcpy(data.data() + updates_offset + i * sizeof(FileMemoryUpdate), &dst_update,
+                sizeof(FileMemoryUpdate));
+
+    Append(data, src_update.data.data(), src_update.data.size());
+  }
+
+  info->fifoDataOffset = base_offset;
+  info->fifoDataSize = static_cast<u32>(frame.fifoData.size());
+  info->fifoStart = frame.fifoStart;
+  info->fifoEnd = frame.fifoEnd;
+  info->memoryUpdatesOffset = base_offset + updates_offset;
+  info->numMemoryUpdates = static_cast<u32>(frame.memoryUpdates.size());
+  return data;
+}
+
+// The opposite of SerializeFrame, with the offsets starting at the beginning of the data. The
+// frame refers to the data rather than copying it.
+static bool ReadFrame(const u8* data, u64 size, const FileFrameInfo& info, FifoFrameInfo* frame)
+{
+  const u8* fifo_data = GetRange(data, size, info.fifoDataOffset, info.fifoDataSize);
+  if (!fifo_data)
+    return false;
+
+  frame->fifoData = FifoData(fifo_data, info.fifoDataSize);
+  frame->fifoStart = info.fifoStart;
+  frame->fifoEnd = info.fifoEnd;
+
+  std::vector<FileMemoryUpdate> updates(info.numMemoryUpdates);
+  if (!ReadArray(data, size, info.memoryUpdatesOffset, updates.data(), info.numMemoryUpdates))
+    return false;
+
+  frame->memoryUpdates.resize(updates.size());
+  for (std::size_t i = 0; i < updates.size(); ++i)
+  {
+    const FileMemoryUpdate& src_update = updates[i];
+    const u8* update_data = GetRange(data, size, src_update.dataOffset, src_update.dataSize);
+    if (!update_data)
+      return false;
+
+    MemoryUpdate& dst_update = frame->memoryUpdates[i];
+    dst_update.address = src_update.address;
+    dst_update.fifoPosition = src_update.fifoPosition;
+    dst_update.data = FifoData(update_data, src_update.dataSize);
+    dst_update.type = static_cast<MemoryUpdate::Type>(src_update.type);
+  }
+
+  return true;
+}
+
 FifoDataFile::FifoDataFile() = default;
 
 FifoDataFile::~FifoDataFile() = default;
@@ -107,7 +211,39 @@ void FifoDataFile::AddFrame(const FifoFrameInfo& frameInfo)
   m_Frames.push_back(frameInfo);
 }
 
-bool FifoDataFile::Save(const std::string& filename)
+const FifoFrameInfo& FifoDataFile::GetFrame(u32 frame) const
+{
+  if (m_frames_loaded)
+    std::call_once(m_frames_loaded[frame], [this, frame] { LoadCompressedFrame(frame); });
+  return m_Frames[frame];
+}
+
+void FifoDataFile::LoadCompressedFrame(u32 frame) const
+{
+  const u8* const file_data = m_mapped_file.GetData();
+  const u64 file_size = m_mapped_file.GetSize();
+
+  // The frame list and the location of the compressed data were checked by Load.
+  FileFrameInfo info;
+  ReadArray(file_data, file_size, m_frame_list_offset + frame * sizeof(FileFrameInfo), &info, 1);
+
+  std::vector<u8>& data = m_decompressed_frames[frame];
+  data.resize(info.decompressedDataSize);
+  const size_t size = ZSTD_decompress(data.data(), data.size(),
+                                      file_data + info.compressedDataOffset,
+                                      info.compressedDataSize);
+
+  FifoFrameInfo& dst_frame = m_Frames[frame];
+  if (ZSTD_isError(size) || size != data.size() ||
+      !ReadFrame(data.data(), data.size(), info, &dst_frame))
+  {
+    PanicAlertT("Frame %u of the FIFO log is corrupted.", frame);
+    dst_frame.fifoData = {};
+    dst_frame.memoryUpdates.clear();
+  }
+}
+
+bool FifoDataFile::Save(const std::string& filename, bool compress)
 {
   File::IOFile file;
   if (!file.Open(filename, "wb"))
@@ -136,11 +272,13 @@ bool FifoDataFile::Save(const std::string& filename)
   file.WriteArray(m_TexMem, TEX_MEM_SIZE);
 
   // Write header
-  FileHeader header;
+  FileHeader header{};
   header.fileId = FILE_ID;
   header.file_version = VERSION_NUMBER;
   // Maintain backwards compatability so long as the RAM sizes aren't overridden.
-  if (Config::Get(Config::MAIN_RAM_OVERRIDE_ENABLE))
+  if (compress)
+    header.min_loader_version = MIN_LOADER_VERSION_FOR_COMPRESSION;
+  else if (Config::Get(Config::MAIN_RAM_OVERRIDE_ENABLE))
     header.min_loader_version = MIN_LOADER_VERSION_FOR_RAM_OVERRIDE;
   else
     header.min_loader_version = MIN_LOADER_VERSION;
@@ -163,7 +301,7 @@ bool FifoDataFile::Save(const std::string& filename)
   header.frameListOffset = frameListOffset;
   header.frameCount = (u32)m_Frames.size();
 
-  header.flags = m_Flags;
+  header.flags = compress ? (m_Flags | FLAG_IS_COMPRESSED) : (m_Flags & ~FLAG_IS_COMPRESSED);
 
   header.mem1_size = Memory::GetRamSizeReal();
   header.mem2_size = Memory::GetExRamSizeReal();
@@ -172,24 +310,35 @@ bool FifoDataFile::Save(const std::string& filename)
   file.WriteBytes(&header, sizeof(FileHeader));
 
   // Write frames list
-  for (unsigned int i = 0; i < m_Frames.size(); ++i)
+  for (u32 i = 0; i < GetFrameCount(); ++i)
   {
-    const FifoFrameInfo& srcFrame = m_Frames[i];
-
-    // Write FIFO data
+    // Write FIFO data and memory updates
     file.Seek(0, SEEK_END);
     u64 dataOffset = file.Tell();
-    file.WriteBytes(srcFrame.fifoData.data(), srcFrame.fifoData.size());
-
-    u64 memoryUpdatesOffset = WriteMemoryUpdates(srcFrame.memoryUpdates, file);
 
-    FileFrameInfo dstFrame;
-    dstFrame.fifoDataSize = static_cast<u32>(srcFrame.fifoData.size());
-    dstFrame.fifoDataOffset = dataOffset;
-    dstFrame.fifoStart = srcFrame.fifoStart;
-    dstFrame.fifoEnd = srcFrame.fifoEnd;
-    dstFrame.memoryUpdatesOffset = memoryUpdatesOffset;
-    dstFrame.numMemoryUpdates = static_cast<u32>(srcFrame.memoryUpdates.size());
+    // The offsets of compressed frames are relative to the decompressed data.
+    FileFrameInfo dstFrame{};
+    const std::vector<u8> frameData =
+        SerializeFrame(GetFrame(i), compress ? 0 : dataOffset, &dstFrame);
+
+    if (compress)
+    {
+      std::vector<u8> compressedData(ZSTD_compressBound(frameData.size()));
+      const size_t compressedSize =
+          ZSTD_compress(compressedData.data(), compressedData.size(), frameData.data(),
+                        frameData.size(), ZSTD_CLEVEL_DEFAULT);
+      if (ZSTD_isError(compressedSize))
+        return false;
+
+      file.WriteBytes(compressedData.data(), compressedSize);
+      dstFrame.compressedDataOffset = dataOffset;
+      dstFrame.compressedDataSize = static_cast<u32>(compressedSize);
+      dstFrame.decompressedDataSize = static_cast<u32>(frameData.size());
+    }
+    else
+    {
+      file.WriteBytes(frameData.data(), frameData.size());
+    }
 
     // Write frame info
     u64 frameOffset = frameListOffset + (i * sizeof(FileFrameInfo));
@@ -205,20 +354,23 @@ bool FifoDataFile::Save(const std::string& filename)
 
 std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bool flagsOnly)
 {
-  File::IOFile file;
-  file.Open(filename, "rb");
-  if (!file)
+  auto dataFile = std::make_unique<FifoDataFile>();
+  Common::MappedFile& file = dataFile->m_mapped_file;
+  if (!file.Open(filename))
     return nullptr;
 
+  const u8* const data = file.GetData();
+  const u64 data_size = file.GetSize();
+
   FileHeader header;
-  file.ReadBytes(&header, sizeof(header));
+  if (!ReadArray(data, data_size, 0, &header, 1))
+    return nullptr;
 
   if (header.fileId != FILE_ID || header.min_loader_version > VERSION_NUMBER)
   {
     CriticalAlertT(
         "The DFF's minimum loader version (%d) exceeds the version of this FIFO Player (%d)",
         header.min_loader_version, VERSION_NUMBER);
-    file.Close();
     return nullptr;
   }
 
@@ -231,9 +383,7 @@ std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bo
     header.mem2_size = Memory::MEM2_SIZE_RETAIL;
   }
 
-  auto dataFile = std::make_unique<FifoDataFile>();
-
-  dataFile->m_Flags = header.flags;
+  dataFile->m_Flags = header.flags & ~FLAG_IS_COMPRESSED;
   dataFile->m_Version = header.file_version;
 
   if (flagsOnly)
@@ -245,7 +395,6 @@ std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bo
     Config::SetCurrent(Config::MAIN_MEM1_SIZE, header.mem1_size);
     Config::SetCurrent(Config::MAIN_MEM2_SIZE, header.mem2_size);
 
-    file.Close();
     return dataFile;
   }
 
@@ -264,62 +413,68 @@ std::unique_ptr<FifoDataFile> FifoDataFile::Load(const std::string& filename, bo
                    Memory::GetExRamSizeReal(), Memory::GetExRamSizeReal() / 0x100000,
                    header.mem1_size, header.mem1_size / 0x100000, header.mem2_size,
                    header.mem2_size / 0x100000);
-    file.Close();
     return nullptr;
   }
 
-  u32 size = std::min<u32>(BP_MEM_SIZE, header.bpMemSize);
-  file.Seek(header.bpMemOffset, SEEK_SET);
-  file.ReadArray(dataFile->m_BPMem, size);
-
-  size = std::min<u32>(CP_MEM_SIZE, header.cpMemSize);
-  file.Seek(header.cpMemOffset, SEEK_SET);
-  file.ReadArray(dataFile->m_CPMem, size);
-
-  size = std::min<u32>(XF_MEM_SIZE, header.xfMemSize);
-  file.Seek(header.xfMemOffset, SEEK_SET);
-  file.ReadArray(dataFile->m_XFMem, size);
-
-  size = std::min<u32>(XF_REGS_SIZE, header.xfRegsSize);
-  file.Seek(header.xfRegsOffset, SEEK_SET);
-  file.ReadArray(dataFile->m_XFRegs, size);
+  bool success =
+      ReadArray(data, data_size, header.bpMemOffset, dataFile->m_BPMem,
+                std::min<u32>(BP_MEM_SIZE, header.bpMemSize)) &&
+      ReadArray(data, data_size, header.cpMemOffset, dataFile->m_CPMem,
+                std::min<u32>(CP_MEM_SIZE, header.cpMemSize)) &&
+      ReadArray(data, data_size, header.xfMemOffset, dataFile->m_XFMem,
+                std::min<u32>(XF_MEM_SIZE, header.xfMemSize)) &&
+      ReadArray(data, data_size, header.xfRegsOffset, dataFile->m_XFRegs,
+                std::min<u32>(XF_REGS_SIZE, header.xfRegsSize));
 
   // Texture memory saving was added in version 4.
   std::memset(dataFile->m_TexMem, 0, TEX_MEM_SIZE);
   if (dataFile->m_Version >= 4)
   {
-    size = std::min<u32>(TEX_MEM_SIZE, header.texMemSize);
-    file.Seek(header.texMemOffset, SEEK_SET);
-    file.ReadArray(dataFile->m_TexMem, size);
+    success &= ReadArray(data, data_size, header.texMemOffset, dataFile->m_TexMem,
+                         std::min<u32>(TEX_MEM_SIZE, header.texMemSize));
   }
 
   // idk what else these could be used for, but it'd be a shame to not make them available.
   dataFile->m_ram_size_real = header.mem1_size;
   dataFile->m_exram_size_real = header.mem2_size;
 
-  // Read frames
-  for (u32 i = 0; i < header.frameCount; ++i)
+  // Read frames. Their data refers to the mapping, or is decompressed when it's first needed.
+  const u8* const frame_list =
+      GetRange(data, data_size, header.frameListOffset,
+               static_cast<u64>(header.frameCount) * sizeof(FileFrameInfo));
+  success = success && frame_list;
+
+  const bool compressed = (header.flags & FLAG_IS_COMPRESSED) != 0;
+  const u32 frame_count = success ? header.frameCount : 0;
+  dataFile->m_Frames.resize(frame_count);
+  for (u32 i = 0; success && i < frame_count; ++i)
   {
-    u64 frameOffset = header.frameListOffset + (i * sizeof(FileFrameInfo));
-    file.Seek(frameOffset, SEEK_SET);
     FileFrameInfo srcFrame;
-    file.ReadBytes(&srcFrame, sizeof(FileFrameInfo));
-
-    FifoFrameInfo dstFrame;
-    dstFrame.fifoData.resize(srcFrame.fifoDataSize);
-    dstFrame.fifoStart = srcFrame.fifoStart;
-    dstFrame.fifoEnd = srcFrame.fifoEnd;
-
-    file.Seek(srcFrame.fifoDataOffset, SEEK_SET);
-    file.ReadBytes(dstFrame.fifoData.data(), srcFrame.fifoDataSize);
-
-    ReadMemoryUpdates(srcFrame.memoryUpdatesOffset, srcFrame.numMemoryUpdates,
-                      dstFrame.memoryUpdates, file);
+    std::memcpy(&srcFrame, frame_list + i * sizeof(FileFrameInfo), sizeof(FileFrameInfo));
+
+    if (compressed)
+    {
+      success = GetRange(data, data_size, srcFrame.compressedDataOffset,
+                         srcFrame.compressedDataSize) != nullptr;
+    }
+    else
+    {
+      success = ReadFrame(data, data_size, srcFrame, &dataFile->m_Frames[i]);
+    }
+  }
 
-    dataFile->AddFrame(dstFrame);
+  if (!success)
+  {
+    PanicAlertT("The FIFO log is truncated or corrupted.");
+    return nullptr;
   }
 
-  file.Close();
+  if (compressed)
+  {
+    dataFile->m_frame_list_offset = header.frameListOffset;
+    dataFile->m_frames_loaded = std::make_unique<std::once_flag[]>(frame_count);
+    dataFile->m_decompressed_frames.resize(frame_count);
+  }
 
   return dataFile;
 }
@@ -342,57 +497,3 @@ bool FifoDataFile::GetFlag(u32 flag) const
 {
   return !!(m_Flags & flag);
 }
-
-u64 FifoDataFile::WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates,
-                                     File::IOFile& file)
-{
-  // Add space for memory update list
-  u64 updateListOffset = file.Tell();
-  PadFile(memUpdates.size() * sizeof(FileMemoryUpdate), file);
-
-  for (unsigned int i = 0; i < memUpdates.size(); ++i)
-  {
-    const MemoryUpdate& srcUpdate = memUpdates[i];
-
-    // Write memory
-    file.Seek(0, SEEK_END);
-    u64 dataOffset = file.Tell();
-    file.WriteBytes(srcUpdate.data.data(), srcUpdate.data.size());
-
-    FileMemoryUpdate dstUpdate;
-    dstUpdate.address = srcUpdate.address;
-    dstUpdate.dataOffset = dataOffset;
-    dstUpdate.dataSize = static_cast<u32>(srcUpdate.data.size());
-    dstUpdate.fifoPosition = srcUpdate.fifoPosition;
-    dstUpdate.type = srcUpdate.type;
-
-    u64 updateOffset = updateListOffset + (i * sizeof(FileMemoryUpdate));
-    file.Seek(updateOffset, SEEK_SET);
-    file.WriteBytes(&dstUpdate, sizeof(FileMemoryUpdate));
-  }
-
-  return updateListOffset;
-}
-
-void FifoDataFile::ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
-                                     std::vector<MemoryUpdate>& memUpdates, File::IOFile& file)
-{
-  memUpdates.resize(numUpdates);
-
-  for (u32 i = 0; i < numUpdates; ++i)
-  {
-    u64 updateOffset = fileOffset + (i * sizeof(FileMemoryUpdate));
-    file.Seek(updateOffset, SEEK_SET);
-    FileMemoryUpdate srcUpdate;
-    file.ReadBytes(&srcUpdate, sizeof(FileMemoryUpdate));
-
-    MemoryUpdate& dstUpdate = memUpdates[i];
-    dstUpdate.address = srcUpdate.address;
-    dstUpdate.fifoPosition = srcUpdate.fifoPosition;
-    dstUpdate.data.resize(srcUpdate.dataSize);
-    dstUpdate.type = static_cast<MemoryUpdate::Type>(srcUpdate.type);
-
-    file.Seek(srcUpdate.dataOffset, SEEK_SET);
-    file.ReadBytes(dstUpdate.data.data(), srcUpdate.dataSize);
-  }
-}
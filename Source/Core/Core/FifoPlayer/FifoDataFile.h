@@ -4,11 +4,15 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/MappedFile.h"
 #include "VideoCommon/XFMemory.h"
 
 namespace File
@@ -16,6 +20,29 @@ namespace File
 class IOFile;
 }
 
+// Bytes which are either owned, or refer to memory owned by the FifoDataFile they belong to, like
+// the mapping of the file it was loaded from.
+class FifoData
+{
+public:
+  FifoData() = default;
+  FifoData(std::vector<u8> data) : m_owned(std::move(data)) {}
+  FifoData(const u8* data, std::size_t size) : m_view(data), m_view_size(size) {}
+
+  const u8* data() const { return m_view ? m_view : m_owned.data(); }
+  std::size_t size() const { return m_view ? m_view_size : m_owned.size(); }
+  bool empty() const { return size() == 0; }
+
+  const u8* begin() const { return data(); }
+  const u8* end() const { return data() + size(); }
+  const u8& operator[](std::size_t index) const { return data()[index]; }
+
+private:
+  std::vector<u8> m_owned;
+  const u8* m_view = nullptr;
+  std::size_t m_view_size = 0;
+};
+
 struct MemoryUpdate
 {
   enum Type
@@ -28,13 +55,13 @@ struct MemoryUpdate
 
   u32 fifoPosition;
   u32 address;
-  std::vector<u8> data;
+  FifoData data;
   Type type;
 };
 
 struct FifoFrameInfo
 {
-  std::vector<u8> fifoData;
+  FifoData fifoData;
 
   u32 fifoStart;
   u32 fifoEnd;
@@ -73,16 +100,22 @@ public:
   u32 GetExRamSizeReal() { return m_exram_size_real; }
 
   void AddFrame(const FifoFrameInfo& frameInfo);
-  const FifoFrameInfo& GetFrame(u32 frame) const { return m_Frames[frame]; }
+  // Frames of compressed files are decompressed the first time they're accessed, so a single frame
+  // can be looked at without reading the whole file.
+  const FifoFrameInfo& GetFrame(u32 frame) const;
   u32 GetFrameCount() const { return static_cast<u32>(m_Frames.size()); }
-  bool Save(const std::string& filename);
+  // Compressed files can't be played by versions of Dolphin from before they were added.
+  bool Save(const std::string& filename, bool compress = false);
 
+  // The file is mapped rather than read, and the data of the frames refers to the mapping, so it
+  // must not be modified while the returned FifoDataFile exists.
   static std::unique_ptr<FifoDataFile> Load(const std::string& filename, bool flagsOnly);
 
 private:
   enum
   {
-    FLAG_IS_WII = 1
+    FLAG_IS_WII = 1,
+    FLAG_IS_COMPRESSED = 2,
   };
 
   void PadFile(size_t numBytes, File::IOFile& file);
@@ -90,9 +123,7 @@ private:
   void SetFlag(u32 flag, bool set);
   bool GetFlag(u32 flag) const;
 
-  u64 WriteMemoryUpdates(const std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
-  static void ReadMemoryUpdates(u64 fileOffset, u32 numUpdates,
-                                std::vector<MemoryUpdate>& memUpdates, File::IOFile& file);
+  void LoadCompressedFrame(u32 frame) const;
 
   u32 m_BPMem[BP_MEM_SIZE];
   u32 m_CPMem[CP_MEM_SIZE];
@@ -105,5 +136,12 @@ private:
   u32 m_Flags = 0;
   u32 m_Version = 0;
 
-  std::vector<FifoFrameInfo> m_Frames;
+  // Mutable for decompressing frames on demand.
+  mutable std::vector<FifoFrameInfo> m_Frames;
+
+  Common::MappedFile m_mapped_file;
+  u64 m_frame_list_offset = 0;
+  // Only allocated for compressed files.
+  std::unique_ptr<std::once_flag[]> m_frames_loaded;
+  mutable std::vector<std::vector<u8>> m_decompressed_frames;
 };
@@ -92,6 +92,9 @@ public:
   // If enabled then all memory updates happen at once before the first frame
   // Default is disabled
   void SetEarlyMemoryUpdates(bool enabled) { m_EarlyMemoryUpdates = enabled; }
+  // Whether playback starts over after the last frame of the range. Defaults to the LoopReplay
+  // setting.
+  void SetLoop(bool loop) { m_Loop = loop; }
   // Callbacks
   void SetFileLoadedCallback(CallbackFunc callback) { m_FileLoadedCb = callback; }
   void SetFrameWrittenCallback(CallbackFunc callback) { m_FrameWrittenCb = callback; }
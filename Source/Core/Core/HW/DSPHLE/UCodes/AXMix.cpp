@@ -0,0 +1,158 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/HW/DSPHLE/UCodes/AXMix.h"
+
+#include <algorithm>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/Intrinsics.h"
+
+#if defined(_M_ARM_64)
+#include <arm_neon.h>
+#endif
+
+namespace DSP::HLE
+{
+namespace
+{
+// The product of a sample and a volume always fits in 32 bits, so the kernels below can work on
+// 32-bit lanes and still match this exactly.
+s16 ScaleSample(s16 sample, u16 volume)
+{
+  s64 scaled = sample;
+  scaled *= volume;
+  scaled >>= 15;
+  return static_cast<s16>(std::clamp(static_cast<s32>(scaled), -32767, 32767));  // -32768 ?
+}
+
+// The kernels mix as many whole vectors as they can, and return how many samples they mixed.
+// <volume> and <delta> are the volume of the first sample and the per sample delta.
+using MixAddKernel = u32 (*)(int* out, const s16* input, u32 count, u16 volume, u16 delta);
+
+#if defined(_M_X86)
+FUNCTION_TARGET_AVX2
+u32 MixAddAVX2(int* out, const s16* input, u32 count, u16 volume, u16 delta)
+{
+  const __m256i min = _mm256_set1_epi32(-32767);
+  const __m256i max = _mm256_set1_epi32(32767);
+  const __m256i mask = _mm256_set1_epi32(0xFFFF);
+  const __m256i step = _mm256_set1_epi32(static_cast<u16>(delta * 8));
+  __m256i volumes = _mm256_and_si256(
+      _mm256_add_epi32(_mm256_set1_epi32(volume),
+                       _mm256_mullo_epi32(_mm256_set1_epi32(delta),
+                                          _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7))),
+      mask);
+
+  u32 i = 0;
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m256i samples =
+        _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)));
+    __m256i scaled = _mm256_srai_epi32(_mm256_mullo_epi32(samples, volumes), 15);
+    scaled = _mm256_max_epi32(_mm256_min_epi32(scaled, max), min);
+
+    __m256i* dest = reinterpret_cast<__m256i*>(out + i);
+    _mm256_storeu_si256(dest, _mm256_add_epi32(_mm256_loadu_si256(dest), scaled));
+
+    volumes = _mm256_and_si256(_mm256_add_epi32(volumes, step), mask);
+  }
+  return i;
+}
+
+FUNCTION_TARGET_SSE41
+u32 MixAddSSE41(int* out, const s16* input, u32 count, u16 volume, u16 delta)
+{
+  const __m128i min = _mm_set1_epi32(-32767);
+  const __m128i max = _mm_set1_epi32(32767);
+  const __m128i mask = _mm_set1_epi32(0xFFFF);
+  const __m128i step = _mm_set1_epi32(static_cast<u16>(delta * 4));
+  __m128i volumes = _mm_and_si128(
+      _mm_add_epi32(_mm_set1_epi32(volume),
+                    _mm_mullo_epi32(_mm_set1_epi32(delta), _mm_setr_epi32(0, 1, 2, 3))),
+      mask);
+
+  u32 i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    const __m128i samples =
+        _mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(input + i)));
+    __m128i scaled = _mm_srai_epi32(_mm_mullo_epi32(samples, volumes), 15);
+    scaled = _mm_max_epi32(_mm_min_epi32(scaled, max), min);
+
+    __m128i* dest = reinterpret_cast<__m128i*>(out + i);
+    _mm_storeu_si128(dest, _mm_add_epi32(_mm_loadu_si128(dest), scaled));
+
+    volumes = _mm_and_si128(_mm_add_epi32(volumes, step), mask);
+  }
+  return i;
+}
+#elif defined(_M_ARM_64)
+u32 MixAddNEON(int* out, const s16* input, u32 count, u16 volume, u16 delta)
+{
+  const int32x4_t min = vdupq_n_s32(-32767);
+  const int32x4_t max = vdupq_n_s32(32767);
+  const uint32x4_t mask = vdupq_n_u32(0xFFFF);
+  const uint32x4_t step = vdupq_n_u32(static_cast<u16>(delta * 4));
+  const u32 lanes[4] = {0, 1, 2, 3};
+  uint32x4_t volumes =
+      vandq_u32(vmlaq_n_u32(vdupq_n_u32(volume), vld1q_u32(lanes), delta), mask);
+
+  u32 i = 0;
+  for (; i + 4 <= count; i += 4)
+  {
+    const int32x4_t samples = vmovl_s16(vld1_s16(input + i));
+    int32x4_t scaled = vshrq_n_s32(vmulq_s32(samples, vreinterpretq_s32_u32(volumes)), 15);
+    scaled = vmaxq_s32(vminq_s32(scaled, max), min);
+
+    vst1q_s32(out + i, vaddq_s32(vld1q_s32(out + i), scaled));
+
+    volumes = vandq_u32(vaddq_u32(volumes, step), mask);
+  }
+  return i;
+}
+#endif
+
+MixAddKernel GetMixAddKernel()
+{
+#if defined(_M_X86)
+  if (cpu_info.bAVX2)
+    return MixAddAVX2;
+  if (cpu_info.bSSE4_1)
+    return MixAddSSE41;
+#elif defined(_M_ARM_64)
+  return MixAddNEON;
+#endif
+  return nullptr;
+}
+}  // namespace
+
+void MixAdd(const s16* input, u32 count, const AXMixBus* buses, size_t num_buses)
+{
+  const MixAddKernel kernel = GetMixAddKernel();
+
+  for (size_t i = 0; i < num_buses; ++i)
+  {
+    const AXMixBus& bus = buses[i];
+    const u16 start_volume = bus.volume[0];
+
+    // If volume ramping is disabled, set the delta to 0. That way, the mixing loops can avoid
+    // testing if volume ramping is enabled at each step, and just add the delta.
+    const u16 delta = bus.ramp ? bus.volume[1] : 0;
+
+    u32 mixed = kernel ? kernel(bus.out, input, count, start_volume, delta) : 0;
+    u16 volume = static_cast<u16>(start_volume + mixed * delta);
+    for (; mixed < count; ++mixed)
+    {
+      bus.out[mixed] += ScaleSample(input[mixed], volume);
+      volume += delta;
+    }
+
+    bus.volume[0] = volume;
+    if (count != 0)
+      *bus.dpop = ScaleSample(input[count - 1], static_cast<u16>(volume - delta));
+  }
+}
+}  // namespace DSP::HLE
@@ -0,0 +1,29 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+
+#include "Common/CommonTypes.h"
+
+namespace DSP::HLE
+{
+// An output buffer a voice is mixed to, along with the state the PB keeps for it.
+struct AXMixBus
+{
+  int* out;
+  // Current volume, followed by the per sample volume delta.
+  u16* volume;
+  s16* dpop;
+  bool ramp;
+};
+
+// Scales <count> samples by the volume of each bus and adds them to the bus, with optional
+// volume ramping. The volume and dpop values of each bus are updated.
+//
+// This is bit-exact with mixing the buses one sample at a time, but uses SIMD kernels where the
+// host has them.
+void MixAdd(const s16* input, u32 count, const AXMixBus* buses, size_t num_buses);
+}  // namespace DSP::HLE
@@ -13,13 +13,14 @@
 #endif
 
 #include <algorithm>
-#include <functional>
+#include <array>
 #include <memory>
 
 #include "Common/CommonTypes.h"
 #include "Core/DSP/DSPAccelerator.h"
 #include "Core/HW/DSP.h"
 #include "Core/HW/DSPHLE/UCodes/AX.h"
+#include "Core/HW/DSPHLE/UCodes/AXMix.h"
 #include "Core/HW/DSPHLE/UCodes/AXStructs.h"
 #include "Core/HW/Memmap.h"
 
@@ -28,11 +29,17 @@ namespace DSP::HLE
 #ifdef AX_GC
 #define PB_TYPE AXPB
 #define MAX_SAMPLES_PER_FRAME 32
+#define MAX_MIX_BUSES 9
 #else
 #define PB_TYPE AXPBWii
 #define MAX_SAMPLES_PER_FRAME 96
+#define MAX_MIX_BUSES 12
 #endif
 
+// Up to this many input samples are decoded ahead of resampling. Voices going faster than that
+// (a ratio above 16) read them one at a time instead.
+#define MAX_INPUT_SAMPLES_PER_FRAME (MAX_SAMPLES_PER_FRAME * 16)
+
 // Put all of that in an anonymous namespace to avoid stupid compilers merging
 // functions from AX GC and AX Wii.
 namespace
@@ -238,6 +245,33 @@ u16 AcceleratorGetSample()
   return s_accelerator->Read(acc_pb->adpcm.coefs);
 }
 
+// Reads <count> samples from the accelerator at once. This is the same as calling
+// AcceleratorGetSample <count> times: once the end is reached, the accelerator stops reading and
+// returns zeros just like we do.
+void AcceleratorGetSamples(s16* samples, u32 count)
+{
+  if (acc_end_reached)
+    std::fill(samples, samples + count, 0);
+  else
+    s_accelerator->ReadSamples(acc_pb->adpcm.coefs, samples, count);
+}
+
+// Returns how many input samples ResampleAudio will read to produce <count> samples.
+u32 GetResampleInputCount(u32 count, u32 curr_pos, u32 ratio, int srctype)
+{
+  if (srctype != SRCTYPE_LINEAR && srctype != SRCTYPE_POLYPHASE)
+    return count;
+
+  u32 input_count = 0;
+  for (u32 i = 0; i < count; ++i)
+  {
+    curr_pos += ratio;
+    input_count += curr_pos >> 16;
+    curr_pos &= 0xFFFF;
+  }
+  return input_count;
+}
+
 // Reads samples from the input callback, resamples them to <count> samples at
 // the wanted sample rate (computed from the ratio, see below).
 //
@@ -258,7 +292,8 @@ u16 AcceleratorGetSample()
 // We start getting samples not from sample 0, but 0.<curr_pos_frac>. This
 // avoids discontinuities in the audio stream, especially with very low ratios
 // which interpolate a lot of values between two "real" samples.
-u32 ResampleAudio(std::function<s16(u32)> input_callback, s16* output, u32 count, s16* last_samples,
+template <typename InputCallback>
+u32 ResampleAudio(InputCallback input_callback, s16* output, u32 count, s16* last_samples,
                   u32 curr_pos, u32 ratio, int srctype, const s16* coeffs)
 {
   int read_samples_count = 0;
@@ -381,9 +416,24 @@ void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
 
   if (coeffs)
     coeffs += pb.coef_select * 0x200;
-  u32 curr_pos =
-      ResampleAudio([](u32) { return AcceleratorGetSample(); }, samples, count, pb.src.last_samples,
-                    pb.src.cur_addr_frac, HILO_TO_32(pb.src.ratio), pb.src_type, coeffs);
+
+  // Decoding all the samples the resampler needs in one go is much faster than reading them from
+  // the accelerator one by one as they are needed.
+  const u32 ratio = HILO_TO_32(pb.src.ratio);
+  const u32 input_count = GetResampleInputCount(count, pb.src.cur_addr_frac, ratio, pb.src_type);
+  u32 curr_pos;
+  if (input_count <= MAX_INPUT_SAMPLES_PER_FRAME)
+  {
+    std::array<s16, MAX_INPUT_SAMPLES_PER_FRAME> input;
+    AcceleratorGetSamples(input.data(), input_count);
+    curr_pos = ResampleAudio([&input](u32 i) { return input[i]; }, samples, count,
+                             pb.src.last_samples, pb.src.cur_addr_frac, ratio, pb.src_type, coeffs);
+  }
+  else
+  {
+    curr_pos = ResampleAudio([](u32) { return AcceleratorGetSample(); }, samples, count,
+                             pb.src.last_samples, pb.src.cur_addr_frac, ratio, pb.src_type, coeffs);
+  }
   pb.src.cur_addr_frac = (curr_pos & 0xFFFF);
 
   // Update current position, YN1, YN2 and pred scale in the PB.
@@ -394,32 +444,6 @@ void GetInputSamples(PB_TYPE& pb, s16* samples, u16 count, const s16* coeffs)
   pb.adpcm.pred_scale = s_accelerator->GetPredScale();
 }
 
-// Add samples to an output buffer, with optional volume ramping.
-void MixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
-{
-  u16& volume = pvol[0];
-  u16 volume_delta = pvol[1];
-
-  // If volume ramping is disabled, set volume_delta to 0. That way, the
-  // mixing loop can avoid testing if volume ramping is enabled at each step,
-  // and just add volume_delta.
-  if (!ramp)
-    volume_delta = 0;
-
-  for (u32 i = 0; i < count; ++i)
-  {
-    s64 sample = input[i];
-    sample *= volume;
-    sample >>= 15;
-    sample = std::clamp((s32)sample, -32767, 32767);  // -32768 ?
-
-    out[i] += (s16)sample;
-    volume += volume_delta;
-
-    *dpop = (s16)sample;
-  }
-}
-
 // Execute a low pass filter on the samples using one history value. Returns
 // the new history value.
 s16 LowPassFilter(s16* samples, u32 count, s16 yn1, u16 a0, u16 b0)
@@ -463,46 +487,34 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
 
 #define MIX_ON(C) (0 != (mctrl & MIX_##C))
 #define RAMP_ON(C) (0 != (mctrl & MIX_##C##_RAMP))
+#define ADD_BUS(C, name)                                                                           \
+  if (MIX_ON(C))                                                                                   \
+    buses[num_buses++] = {buffers.name, &pb.mixer.name, &pb.dpop.name, RAMP_ON(C)}
+
+  std::array<AXMixBus, MAX_MIX_BUSES> buses;
+  size_t num_buses = 0;
+
+  ADD_BUS(L, left);
+  ADD_BUS(R, right);
+  ADD_BUS(S, surround);
 
-  if (MIX_ON(L))
-    MixAdd(buffers.left, samples, count, &pb.mixer.left, &pb.dpop.left, RAMP_ON(L));
-  if (MIX_ON(R))
-    MixAdd(buffers.right, samples, count, &pb.mixer.right, &pb.dpop.right, RAMP_ON(R));
-  if (MIX_ON(S))
-    MixAdd(buffers.surround, samples, count, &pb.mixer.surround, &pb.dpop.surround, RAMP_ON(S));
-
-  if (MIX_ON(AUXA_L))
-    MixAdd(buffers.auxA_left, samples, count, &pb.mixer.auxA_left, &pb.dpop.auxA_left,
-           RAMP_ON(AUXA_L));
-  if (MIX_ON(AUXA_R))
-    MixAdd(buffers.auxA_right, samples, count, &pb.mixer.auxA_right, &pb.dpop.auxA_right,
-           RAMP_ON(AUXA_R));
-  if (MIX_ON(AUXA_S))
-    MixAdd(buffers.auxA_surround, samples, count, &pb.mixer.auxA_surround, &pb.dpop.auxA_surround,
-           RAMP_ON(AUXA_S));
-
-  if (MIX_ON(AUXB_L))
-    MixAdd(buffers.auxB_left, samples, count, &pb.mixer.auxB_left, &pb.dpop.auxB_left,
-           RAMP_ON(AUXB_L));
-  if (MIX_ON(AUXB_R))
-    MixAdd(buffers.auxB_right, samples, count, &pb.mixer.auxB_right, &pb.dpop.auxB_right,
-           RAMP_ON(AUXB_R));
-  if (MIX_ON(AUXB_S))
-    MixAdd(buffers.auxB_surround, samples, count, &pb.mixer.auxB_surround, &pb.dpop.auxB_surround,
-           RAMP_ON(AUXB_S));
+  ADD_BUS(AUXA_L, auxA_left);
+  ADD_BUS(AUXA_R, auxA_right);
+  ADD_BUS(AUXA_S, auxA_surround);
+
+  ADD_BUS(AUXB_L, auxB_left);
+  ADD_BUS(AUXB_R, auxB_right);
+  ADD_BUS(AUXB_S, auxB_surround);
 
 #ifdef AX_WII
-  if (MIX_ON(AUXC_L))
-    MixAdd(buffers.auxC_left, samples, count, &pb.mixer.auxC_left, &pb.dpop.auxC_left,
-           RAMP_ON(AUXC_L));
-  if (MIX_ON(AUXC_R))
-    MixAdd(buffers.auxC_right, samples, count, &pb.mixer.auxC_right, &pb.dpop.auxC_right,
-           RAMP_ON(AUXC_R));
-  if (MIX_ON(AUXC_S))
-    MixAdd(buffers.auxC_surround, samples, count, &pb.mixer.auxC_surround, &pb.dpop.auxC_surround,
-           RAMP_ON(AUXC_S));
+  ADD_BUS(AUXC_L, auxC_left);
+  ADD_BUS(AUXC_R, auxC_right);
+  ADD_BUS(AUXC_S, auxC_surround);
 #endif
 
+  MixAdd(samples, count, buses.data(), num_buses);
+
+#undef ADD_BUS
 #undef MIX_ON
 #undef RAMP_ON
 
@@ -533,30 +545,26 @@ void ProcessVoice(PB_TYPE& pb, const AXBuffers& buffers, u16 count, AXMixControl
 #define WMCHAN_MIX_ON(n) (0 != ((pb.remote_mixer_control >> (2 * n)) & 3))
 #define WMCHAN_MIX_RAMP(n) (0 != ((pb.remote_mixer_control >> (2 * n)) & 2))
 
-    if (WMCHAN_MIX_ON(0))
-      MixAdd(buffers.wm_main0, wm_samples, wm_count, &pb.remote_mixer.main0, &pb.remote_dpop.main0,
-             WMCHAN_MIX_RAMP(0));
-    if (WMCHAN_MIX_ON(1))
-      MixAdd(buffers.wm_aux0, wm_samples, wm_count, &pb.remote_mixer.aux0, &pb.remote_dpop.aux0,
-             WMCHAN_MIX_RAMP(1));
-    if (WMCHAN_MIX_ON(2))
-      MixAdd(buffers.wm_main1, wm_samples, wm_count, &pb.remote_mixer.main1, &pb.remote_dpop.main1,
-             WMCHAN_MIX_RAMP(2));
-    if (WMCHAN_MIX_ON(3))
-      MixAdd(buffers.wm_aux1, wm_samples, wm_count, &pb.remote_mixer.aux1, &pb.remote_dpop.aux1,
-             WMCHAN_MIX_RAMP(3));
-    if (WMCHAN_MIX_ON(4))
-      MixAdd(buffers.wm_main2, wm_samples, wm_count, &pb.remote_mixer.main2, &pb.remote_dpop.main2,
-             WMCHAN_MIX_RAMP(4));
-    if (WMCHAN_MIX_ON(5))
-      MixAdd(buffers.wm_aux2, wm_samples, wm_count, &pb.remote_mixer.aux2, &pb.remote_dpop.aux2,
-             WMCHAN_MIX_RAMP(5));
-    if (WMCHAN_MIX_ON(6))
-      MixAdd(buffers.wm_main3, wm_samples, wm_count, &pb.remote_mixer.main3, &pb.remote_dpop.main3,
-             WMCHAN_MIX_RAMP(6));
-    if (WMCHAN_MIX_ON(7))
-      MixAdd(buffers.wm_aux3, wm_samples, wm_count, &pb.remote_mixer.aux3, &pb.remote_dpop.aux3,
-             WMCHAN_MIX_RAMP(7));
+#define ADD_WMCHAN_BUS(n, name)                                                                    \
+  if (WMCHAN_MIX_ON(n))                                                                            \
+    wm_buses[num_wm_buses++] = {buffers.wm_##name, &pb.remote_mixer.name, &pb.remote_dpop.name,    \
+                                WMCHAN_MIX_RAMP(n)}
+
+    std::array<AXMixBus, 8> wm_buses;
+    size_t num_wm_buses = 0;
+
+    ADD_WMCHAN_BUS(0, main0);
+    ADD_WMCHAN_BUS(1, aux0);
+    ADD_WMCHAN_BUS(2, main1);
+    ADD_WMCHAN_BUS(3, aux1);
+    ADD_WMCHAN_BUS(4, main2);
+    ADD_WMCHAN_BUS(5, aux2);
+    ADD_WMCHAN_BUS(6, main3);
+    ADD_WMCHAN_BUS(7, aux3);
+
+    MixAdd(wm_samples, wm_count, wm_buses.data(), num_wm_buses);
+
+#undef ADD_WMCHAN_BUS
   }
 #undef WMCHAN_MIX_RAMP
 #undef WMCHAN_MIX_ON
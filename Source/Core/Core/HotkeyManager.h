@@ -172,6 +172,7 @@ enum Hotkey
   HK_UNDO_SAVE_STATE,
   HK_SAVE_STATE_FILE,
   HK_LOAD_STATE_FILE,
+  HK_REWIND,
 
   NUM_HOTKEYS,
 };
@@ -4,6 +4,9 @@
 
 #include "Core/PowerPC/CachedInterpreter/CachedInterpreter.h"
 
+#include <array>
+
+#include "Common/BitUtils.h"
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Core/ConfigManager.h"
@@ -12,40 +15,372 @@
 #include "Core/HW/CPU.h"
 #include "Core/PowerPC/Gekko.h"
 #include "Core/PowerPC/Jit64Common/Jit64Constants.h"
+#include "Core/PowerPC/MMU.h"
 #include "Core/PowerPC/PPCAnalyst.h"
 #include "Core/PowerPC/PowerPC.h"
 
+// Blocks are made of Instructions which are run one after another. Each Instruction has a handler
+// which runs it and returns the next Instruction to run, or nullptr to leave the block, so that
+// running a block doesn't need a central dispatch. Common instruction sequences are fused into
+// single Instructions with their operands decoded ahead of time.
 struct CachedInterpreter::Instruction
 {
+  using Handler = const Instruction* (*)(const Instruction& instruction);
   using CommonCallback = void (*)(UGeckoInstruction);
   using ConditionalCallback = bool (*)(u32);
 
-  Instruction() {}
+  Instruction() : handler(Abort), link_target(nullptr) {}
   Instruction(const CommonCallback c, UGeckoInstruction i)
-      : common_callback(c), data(i.hex), type(Type::Common)
+      : handler(RunCommon), common_callback(c), data(i.hex)
   {
   }
 
   Instruction(const ConditionalCallback c, u32 d)
-      : conditional_callback(c), data(d), type(Type::Conditional)
+      : handler(RunConditional), conditional_callback(c), data(d)
   {
   }
 
-  enum class Type
+  static bool IsCompare(UGeckoInstruction inst)
   {
-    Abort,
-    Common,
-    Conditional,
-  };
+    return inst.OPCD == 10 || inst.OPCD == 11 ||
+           (inst.OPCD == 31 && (inst.SUBOP10 == 0 || inst.SUBOP10 == 32));
+  }
+
+  static bool IsImmediateCompare(UGeckoInstruction inst)
+  {
+    return inst.OPCD == 10 || inst.OPCD == 11;
+  }
+
+  // lbz, lhz and lwz.
+  static bool IsLoad(UGeckoInstruction inst)
+  {
+    return inst.OPCD == 34 || inst.OPCD == 40 || inst.OPCD == 32;
+  }
+
+  static bool IsRotateAndMask(UGeckoInstruction inst) { return inst.OPCD == 21 && !inst.Rc; }
+
+  // addi, addis, and add, subf, and, or and xor without OE or Rc.
+  static bool IsIntegerOperation(UGeckoInstruction inst)
+  {
+    if (inst.OPCD == 14 || inst.OPCD == 15)
+      return true;
+    if (inst.OPCD != 31 || inst.Rc)
+      return false;
+    return inst.SUBOP10 == 266 || inst.SUBOP10 == 40 || inst.SUBOP10 == 28 ||
+           inst.SUBOP10 == 444 || inst.SUBOP10 == 316;
+  }
+
+  // A compare can be fused with a following bcx which only tests the CR bit it sets.
+  static bool CanFuseCompareAndBranch(UGeckoInstruction compare, UGeckoInstruction branch)
+  {
+    return IsCompare(compare) && branch.OPCD == 16 && (branch.BO & BO_DONT_DECREMENT_FLAG) &&
+           !(branch.BO & 0x10) && (branch.BI >> 2) == compare.CRFD;
+  }
+
+  static bool CanFuseLoadAndCompare(UGeckoInstruction load, UGeckoInstruction compare)
+  {
+    return IsLoad(load) && IsImmediateCompare(compare) && compare.RA == load.RD;
+  }
+
+  static Instruction CompareAndBranch(UGeckoInstruction compare, const PPCAnalyst::CodeOp& branch)
+  {
+    Instruction instruction;
+    if (compare.OPCD == 11)
+      instruction.handler = RunCompareAndBranch<true, true>;
+    else if (compare.OPCD == 10)
+      instruction.handler = RunCompareAndBranch<false, true>;
+    else if (compare.SUBOP10 == 0)
+      instruction.handler = RunCompareAndBranch<true, false>;
+    else
+      instruction.handler = RunCompareAndBranch<false, false>;
+
+    instruction.data = GetCompareImmediate(compare);
+    instruction.branch = {branch.address, branch.branchTo};
+    instruction.operands = {static_cast<u8>(compare.RA), static_cast<u8>(compare.RB),
+                            static_cast<u8>(compare.CRFD),
+                            static_cast<u8>((3 - (branch.inst.BI & 3)) |
+                                            ((branch.inst.BO >> 3) & 1) << 2 |
+                                            branch.inst.LK << 3)};
+    return instruction;
+  }
+
+  static Instruction LoadAndCompare(UGeckoInstruction load, UGeckoInstruction compare)
+  {
+    Instruction instruction = Load(load);
+    const bool is_signed = compare.OPCD == 11;
+    if (load.OPCD == 34)
+      instruction.handler = is_signed ? RunLoadAndCompare<PowerPC::Read_U8_ZX, true> :
+                                        RunLoadAndCompare<PowerPC::Read_U8_ZX, false>;
+    else if (load.OPCD == 40)
+      instruction.handler = is_signed ? RunLoadAndCompare<PowerPC::Read_U16_ZX, true> :
+                                        RunLoadAndCompare<PowerPC::Read_U16_ZX, false>;
+    else
+      instruction.handler = is_signed ? RunLoadAndCompare<PowerPC::Read_U32, true> :
+                                        RunLoadAndCompare<PowerPC::Read_U32, false>;
+
+    instruction.immediate = GetCompareImmediate(compare);
+    instruction.operands[2] = static_cast<u8>(compare.CRFD);
+    return instruction;
+  }
+
+  static Instruction Load(UGeckoInstruction load)
+  {
+    Instruction instruction;
+    if (load.OPCD == 34)
+      instruction.handler = RunLoad<PowerPC::Read_U8_ZX>;
+    else if (load.OPCD == 40)
+      instruction.handler = RunLoad<PowerPC::Read_U16_ZX>;
+    else
+      instruction.handler = RunLoad<PowerPC::Read_U32>;
+
+    instruction.data = static_cast<u32>(static_cast<s32>(load.SIMM_16));
+    instruction.operands = {static_cast<u8>(load.RD), static_cast<u8>(load.RA), 0, 0};
+    return instruction;
+  }
+
+  static Instruction IntegerOperation(UGeckoInstruction inst)
+  {
+    Instruction instruction;
+    if (inst.OPCD == 14 || inst.OPCD == 15)
+    {
+      instruction.handler = RunAddImmediate;
+      const u32 immediate = static_cast<u32>(static_cast<s32>(inst.SIMM_16));
+      instruction.data = inst.OPCD == 15 ? immediate << 16 : immediate;
+      instruction.operands = {static_cast<u8>(inst.RD), static_cast<u8>(inst.RA), 0, 0};
+      return instruction;
+    }
+
+    switch (inst.SUBOP10)
+    {
+    case 266:
+      instruction.handler = RunIntegerOperation<Add>;
+      break;
+    case 40:
+      instruction.handler = RunIntegerOperation<Subtract>;
+      break;
+    case 28:
+      instruction.handler = RunIntegerOperation<And>;
+      break;
+    case 444:
+      instruction.handler = RunIntegerOperation<Or>;
+      break;
+    default:
+      instruction.handler = RunIntegerOperation<Xor>;
+      break;
+    }
+
+    // The logical operations have their operands the other way around.
+    if (inst.SUBOP10 == 266 || inst.SUBOP10 == 40)
+      instruction.operands = {static_cast<u8>(inst.RD), static_cast<u8>(inst.RA),
+                              static_cast<u8>(inst.RB), 0};
+    else
+      instruction.operands = {static_cast<u8>(inst.RA), static_cast<u8>(inst.RS),
+                              static_cast<u8>(inst.RB), 0};
+    return instruction;
+  }
+
+  // The first of a run of count rlwinm instructions.
+  static Instruction RotateAndMask(UGeckoInstruction inst, u32 count)
+  {
+    Instruction instruction;
+    instruction.handler = RunRotateAndMask;
+    instruction.data = MakeRotationMask(inst.MB, inst.ME);
+    instruction.operands = {static_cast<u8>(inst.RA), static_cast<u8>(inst.RS),
+                            static_cast<u8>(inst.SH), static_cast<u8>(count)};
+    return instruction;
+  }
 
+  static Instruction EndBlock(u32 downcount, u32 num_load_stores, u32 num_floating_point)
+  {
+    Instruction instruction;
+    instruction.handler = RunEndBlock;
+    instruction.data = downcount;
+    instruction.counts = {num_load_stores, num_floating_point};
+    return instruction;
+  }
+
+  // Continues in the block at link_target if the block is left to address and there's time left
+  // in the slice.
+  static Instruction LinkedExit(u32 address)
+  {
+    Instruction instruction;
+    instruction.handler = RunLinkedExit;
+    instruction.data = address;
+    return instruction;
+  }
+
+  Handler handler;
   union
   {
-    const CommonCallback common_callback;
-    const ConditionalCallback conditional_callback;
+    CommonCallback common_callback;
+    ConditionalCallback conditional_callback;
+    // Written by BlockCache::WriteLinkBlock.
+    const u8* link_target;
+    struct
+    {
+      u32 address;
+      u32 target;
+    } branch;
+    u32 immediate;
+    struct
+    {
+      u32 num_load_stores;
+      u32 num_floating_point;
+    } counts;
   };
 
   u32 data = 0;
-  Type type = Type::Abort;
+  // Register numbers and other fields decoded ahead of time for the fused instructions.
+  std::array<u8, 4> operands{};
+
+private:
+  static u32 GetCompareImmediate(UGeckoInstruction compare)
+  {
+    if (compare.OPCD == 11)
+      return static_cast<u32>(static_cast<s32>(compare.SIMM_16));
+    return compare.UIMM;
+  }
+
+  template <bool is_signed>
+  static u32 Compare(u32 a, u32 b)
+  {
+    u32 field;
+    if (is_signed ? static_cast<s32>(a) < static_cast<s32>(b) : a < b)
+      field = 0x8;
+    else if (is_signed ? static_cast<s32>(a) > static_cast<s32>(b) : a > b)
+      field = 0x4;
+    else
+      field = 0x2;
+
+    if (PowerPC::GetXER_SO())
+      field |= 0x1;
+
+    return field;
+  }
+
+  static u32 Add(u32 a, u32 b) { return a + b; }
+  static u32 Subtract(u32 a, u32 b) { return b - a; }
+  static u32 And(u32 a, u32 b) { return a & b; }
+  static u32 Or(u32 a, u32 b) { return a | b; }
+  static u32 Xor(u32 a, u32 b) { return a ^ b; }
+
+  static const Instruction* Abort(const Instruction&) { return nullptr; }
+
+  static const Instruction* RunCommon(const Instruction& instruction)
+  {
+    instruction.common_callback(UGeckoInstruction(instruction.data));
+    return &instruction + 1;
+  }
+
+  static const Instruction* RunConditional(const Instruction& instruction)
+  {
+    return instruction.conditional_callback(instruction.data) ? nullptr : &instruction + 1;
+  }
+
+  static const Instruction* RunEndBlock(const Instruction& instruction)
+  {
+    PC = NPC;
+    PowerPC::ppcState.downcount -= instruction.data;
+    PowerPC::UpdatePerformanceMonitor(instruction.data, instruction.counts.num_load_stores,
+                                      instruction.counts.num_floating_point);
+    return &instruction + 1;
+  }
+
+  static const Instruction* RunLinkedExit(const Instruction& instruction)
+  {
+    // The exits of a block are next to each other and followed by an abort.
+    if (PC != instruction.data)
+      return &instruction + 1;
+
+    if (!instruction.link_target || PowerPC::ppcState.downcount <= 0 ||
+        CPU::GetState() != CPU::State::Running)
+    {
+      return nullptr;
+    }
+
+    return reinterpret_cast<const Instruction*>(instruction.link_target);
+  }
+
+  // operands: ra, rb, crf, and the bit to test | the value to branch on << 2 | LK << 3.
+  template <bool is_signed, bool immediate>
+  static const Instruction* RunCompareAndBranch(const Instruction& instruction)
+  {
+    const u32 a = rGPR[instruction.operands[0]];
+    const u32 b = immediate ? instruction.data : rGPR[instruction.operands[1]];
+    const u32 field = Compare<is_signed>(a, b);
+    PowerPC::ppcState.cr.SetField(instruction.operands[2], field);
+
+    const u32 flags = instruction.operands[3];
+    PC = instruction.branch.address;
+    NPC = PC + 4;
+    if (((field >> (flags & 3)) & 1) == ((flags >> 2) & 1))
+    {
+      if (flags & 8)
+        LR = PC + 4;
+      NPC = instruction.branch.target;
+    }
+
+    return &instruction + 1;
+  }
+
+  // operands: rd, ra.
+  template <u32 (*read)(u32)>
+  static const Instruction* RunLoad(const Instruction& instruction)
+  {
+    const u32 ra = instruction.operands[1];
+    const u32 value = read(ra ? rGPR[ra] + instruction.data : instruction.data);
+    if (!(PowerPC::ppcState.Exceptions & EXCEPTION_DSI))
+      rGPR[instruction.operands[0]] = value;
+
+    return &instruction + 1;
+  }
+
+  // operands: rd, ra, crf. On a DSI the compare isn't run, and the CheckDSI which follows the
+  // instruction when memchecks are on leaves the block.
+  template <u32 (*read)(u32), bool is_signed>
+  static const Instruction* RunLoadAndCompare(const Instruction& instruction)
+  {
+    const u32 ra = instruction.operands[1];
+    const u32 value = read(ra ? rGPR[ra] + instruction.data : instruction.data);
+    if (PowerPC::ppcState.Exceptions & EXCEPTION_DSI)
+      return &instruction + 1;
+
+    rGPR[instruction.operands[0]] = value;
+    PowerPC::ppcState.cr.SetField(instruction.operands[2],
+                                  Compare<is_signed>(rGPR[instruction.operands[0]],
+                                                     instruction.immediate));
+    return &instruction + 1;
+  }
+
+  // operands: rd, ra.
+  static const Instruction* RunAddImmediate(const Instruction& instruction)
+  {
+    const u32 ra = instruction.operands[1];
+    rGPR[instruction.operands[0]] = ra ? rGPR[ra] + instruction.data : instruction.data;
+    return &instruction + 1;
+  }
+
+  // operands: the destination and the two sources.
+  template <u32 (*operation)(u32, u32)>
+  static const Instruction* RunIntegerOperation(const Instruction& instruction)
+  {
+    rGPR[instruction.operands[0]] =
+        operation(rGPR[instruction.operands[1]], rGPR[instruction.operands[2]]);
+    return &instruction + 1;
+  }
+
+  // operands: ra, rs, sh, and the number of rlwinm instructions left in the run.
+  static const Instruction* RunRotateAndMask(const Instruction& instruction)
+  {
+    const Instruction* current = &instruction;
+    const Instruction* const end = current + instruction.operands[3];
+    for (; current != end; ++current)
+    {
+      rGPR[current->operands[0]] =
+          Common::RotateLeft(rGPR[current->operands[1]], current->operands[2]) & current->data;
+    }
+    return end;
+  }
 };
 
 CachedInterpreter::CachedInterpreter() = default;
@@ -56,7 +391,7 @@ void CachedInterpreter::Init()
 {
   m_code.reserve(CODE_SIZE / sizeof(Instruction));
 
-  jo.enableBlocklink = false;
+  jo.enableBlocklink = !SConfig::GetInstance().bJITNoBlockLinking;
 
   m_block_cache.Init();
   UpdateMemoryAndExceptionOptions();
@@ -86,25 +421,8 @@ void CachedInterpreter::ExecuteOneBlock()
   }
 
   const Instruction* code = reinterpret_cast<const Instruction*>(normal_entry);
-
-  for (; code->type != Instruction::Type::Abort; ++code)
-  {
-    switch (code->type)
-    {
-    case Instruction::Type::Common:
-      code->common_callback(UGeckoInstruction(code->data));
-      break;
-
-    case Instruction::Type::Conditional:
-      if (code->conditional_callback(code->data))
-        return;
-      break;
-
-    default:
-      ERROR_LOG(POWERPC, "Unknown CachedInterpreter Instruction: %d", static_cast<int>(code->type));
-      break;
-    }
-  }
+  while (code)
+    code = code->handler(*code);
 }
 
 void CachedInterpreter::Run()
@@ -130,23 +448,6 @@ void CachedInterpreter::SingleStep()
   ExecuteOneBlock();
 }
 
-static void EndBlock(UGeckoInstruction data)
-{
-  PC = NPC;
-  PowerPC::ppcState.downcount -= data.hex;
-  PowerPC::UpdatePerformanceMonitor(data.hex, 0, 0);
-}
-
-static void UpdateNumLoadStoreInstructions(UGeckoInstruction data)
-{
-  PowerPC::UpdatePerformanceMonitor(0, data.hex, 0);
-}
-
-static void UpdateNumFloatingPointInstructions(UGeckoInstruction data)
-{
-  PowerPC::UpdatePerformanceMonitor(0, 0, data.hex);
-}
-
 static void WritePC(UGeckoInstruction data)
 {
   PC = data.hex;
@@ -221,12 +522,94 @@ bool CachedInterpreter::HandleFunctionHooking(u32 address)
     if (type != HLE::HookType::Replace)
       return false;
 
-    m_code.emplace_back(EndBlock, js.downcountAmount);
+    m_code.push_back(Instruction::EndBlock(js.downcountAmount, 0, 0));
     m_code.emplace_back();
     return true;
   });
 }
 
+static bool CanFuse(const PPCAnalyst::CodeOp& op)
+{
+  return !op.skip &&
+         !(SConfig::GetInstance().bEnableDebugging &&
+           PowerPC::breakpoints.IsAddressBreakPoint(op.address)) &&
+         HLE::GetFirstFunctionIndex(op.address) == 0;
+}
+
+u32 CachedInterpreter::EmitInstruction(u32 index)
+{
+  const u32 num_instructions = code_block.m_num_instructions;
+  const PPCAnalyst::CodeOp& op = m_code_buffer[index];
+  const PPCAnalyst::CodeOp* next = nullptr;
+  if (index + 1 < num_instructions && CanFuse(m_code_buffer[index + 1]))
+    next = &m_code_buffer[index + 1];
+
+  if (next && Instruction::CanFuseCompareAndBranch(op.inst, next->inst))
+  {
+    m_code.push_back(Instruction::CompareAndBranch(op.inst, *next));
+    return 1;
+  }
+
+  // Don't take the compare away from a branch it could be fused with instead.
+  if (next && Instruction::CanFuseLoadAndCompare(op.inst, next->inst) &&
+      !(index + 2 < num_instructions && CanFuse(m_code_buffer[index + 2]) &&
+        Instruction::CanFuseCompareAndBranch(next->inst, m_code_buffer[index + 2].inst)))
+  {
+    m_code.push_back(Instruction::LoadAndCompare(op.inst, next->inst));
+    return 1;
+  }
+
+  if (Instruction::IsRotateAndMask(op.inst))
+  {
+    u32 count = 1;
+    while (index + count < num_instructions && count < 0xFF &&
+           CanFuse(m_code_buffer[index + count]) &&
+           Instruction::IsRotateAndMask(m_code_buffer[index + count].inst))
+    {
+      count++;
+    }
+
+    for (u32 i = 0; i < count; i++)
+      m_code.push_back(Instruction::RotateAndMask(m_code_buffer[index + i].inst, count - i));
+    return count - 1;
+  }
+
+  if (Instruction::IsLoad(op.inst))
+  {
+    m_code.push_back(Instruction::Load(op.inst));
+    return 0;
+  }
+
+  if (Instruction::IsIntegerOperation(op.inst))
+  {
+    m_code.push_back(Instruction::IntegerOperation(op.inst));
+    return 0;
+  }
+
+  m_code.emplace_back(PPCTables::GetInterpreterOp(op.inst), op.inst);
+  return 0;
+}
+
+void CachedInterpreter::EmitLinkedExits(JitBlock* block, const PPCAnalyst::CodeOp& op)
+{
+  if (op.branchTo == UINT32_MAX)
+    return;
+
+  const std::array<u32, 2> exits = {op.branchTo, op.address + 4};
+  const std::size_t num_exits = op.inst.OPCD == 16 ? 2 : 1;
+  for (std::size_t i = 0; i < num_exits; i++)
+  {
+    m_code.push_back(Instruction::LinkedExit(exits[i]));
+
+    JitBlock::LinkData link_data;
+    link_data.exitPtrs = reinterpret_cast<u8*>(&m_code.back().link_target);
+    link_data.exitAddress = exits[i];
+    link_data.linkStatus = false;
+    link_data.call = op.inst.LK;
+    block->linkData.push_back(link_data);
+  }
+}
+
 void CachedInterpreter::Jit(u32 address)
 {
   if (m_code.size() >= CODE_SIZE / sizeof(Instruction) - 0x1000 ||
@@ -259,6 +642,11 @@ void CachedInterpreter::Jit(u32 address)
   b->checkedEntry = GetCodePtr();
   b->normalEntry = GetCodePtr();
 
+  // Blocks are only linked when they won't have to stop between each other.
+  bool link_block = jo.enableBlocklink && !CPU::IsStepping();
+  // The number of following instructions which have already been emitted fused with an earlier one.
+  u32 fused_instructions = 0;
+
   for (u32 i = 0; i < code_block.m_num_instructions; i++)
   {
     PPCAnalyst::CodeOp& op = m_code_buffer[i];
@@ -282,19 +670,31 @@ void CachedInterpreter::Jit(u32 address)
       const bool check_program_exception = !endblock && ShouldHandleFPExceptionForInstruction(&op);
       const bool idle_loop = op.branchIsIdleLoop;
 
-      if (breakpoint || check_fpu || endblock || memcheck || check_program_exception)
-        m_code.emplace_back(WritePC, op.address);
-
       if (breakpoint)
-        m_code.emplace_back(CheckBreakpoint, js.downcountAmount);
+        link_block = false;
 
-      if (check_fpu)
+      if (fused_instructions > 0)
+      {
+        // Fused instructions never need any checks before them.
+        fused_instructions--;
+      }
+      else
       {
-        m_code.emplace_back(CheckFPU, js.downcountAmount);
-        js.firstFPInstructionFound = true;
+        if (breakpoint || check_fpu || endblock || memcheck || check_program_exception)
+          m_code.emplace_back(WritePC, op.address);
+
+        if (breakpoint)
+          m_code.emplace_back(CheckBreakpoint, js.downcountAmount);
+
+        if (check_fpu)
+        {
+          m_code.emplace_back(CheckFPU, js.downcountAmount);
+          js.firstFPInstructionFound = true;
+        }
+
+        fused_instructions = EmitInstruction(i);
       }
 
-      m_code.emplace_back(PPCTables::GetInterpreterOp(op.inst), op.inst);
       if (memcheck)
         m_code.emplace_back(CheckDSI, js.downcountAmount);
       if (check_program_exception)
@@ -303,30 +703,31 @@ void CachedInterpreter::Jit(u32 address)
         m_code.emplace_back(CheckIdle, js.blockStart);
       if (endblock)
       {
-        m_code.emplace_back(EndBlock, js.downcountAmount);
-        m_code.emplace_back(UpdateNumLoadStoreInstructions, js.numLoadStoreInst);
-        m_code.emplace_back(UpdateNumFloatingPointInstructions, js.numFloatingPointInst);
+        m_code.push_back(Instruction::EndBlock(js.downcountAmount, js.numLoadStoreInst,
+                                                js.numFloatingPointInst));
+        if (link_block && (op.inst.OPCD == 16 || op.inst.OPCD == 18))
+          EmitLinkedExits(b, op);
       }
     }
   }
   if (code_block.m_broken)
   {
     m_code.emplace_back(WriteBrokenBlockNPC, nextPC);
-    m_code.emplace_back(EndBlock, js.downcountAmount);
-    m_code.emplace_back(UpdateNumLoadStoreInstructions, js.numLoadStoreInst);
-    m_code.emplace_back(UpdateNumFloatingPointInstructions, js.numFloatingPointInst);
+    m_code.push_back(Instruction::EndBlock(js.downcountAmount, js.numLoadStoreInst,
+                                           js.numFloatingPointInst));
   }
   m_code.emplace_back();
 
   b->codeSize = (u32)(GetCodePtr() - b->checkedEntry);
   b->originalSize = code_block.m_num_instructions;
 
-  m_block_cache.FinalizeBlock(*b, jo.enableBlocklink, code_block.m_physical_addresses);
+  m_block_cache.FinalizeBlock(*b, link_block, code_block.m_physical_addresses);
 }
 
 void CachedInterpreter::ClearCache()
 {
-  m_code.clear();
+  // Clearing the block cache unlinks the blocks, which writes to the code.
   m_block_cache.Clear();
+  m_code.clear();
   UpdateMemoryAndExceptionOptions();
 }
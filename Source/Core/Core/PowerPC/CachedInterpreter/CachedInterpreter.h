@@ -40,6 +40,11 @@ private:
 
   bool HandleFunctionHooking(u32 address);
 
+  // Emits the instruction at index in m_code_buffer, possibly fused with the ones following it.
+  // Returns how many of the following instructions have been emitted with it.
+  u32 EmitInstruction(u32 index);
+  void EmitLinkedExits(JitBlock* block, const PPCAnalyst::CodeOp& op);
+
   BlockCache m_block_cache{*this};
   std::vector<Instruction> m_code;
 };
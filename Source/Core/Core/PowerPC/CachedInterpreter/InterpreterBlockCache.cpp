@@ -12,4 +12,6 @@ BlockCache::BlockCache(JitBase& jit) : JitBaseBlockCache{jit}
 
 void BlockCache::WriteLinkBlock(const JitBlock::LinkData& source, const JitBlock* dest)
 {
+  // exitPtrs points at the link target of an exit instruction.
+  *reinterpret_cast<const u8**>(source.exitPtrs) = dest ? dest->normalEntry : nullptr;
 }
@@ -363,6 +363,7 @@ void Jit64::Init()
     AllocStack();
 
   blocks.Init();
+  InitDiskCache();
   asm_routines.Init(m_stack ? (m_stack + STACK_SIZE) : nullptr);
 
   // important: do this *after* generating the global asm routines, because we can't use farcode in
@@ -408,6 +409,7 @@ void Jit64::Shutdown()
 
   Memory::ShutdownFastmemArena();
 
+  ShutdownDiskCache();
   blocks.Shutdown();
   m_far_code.Shutdown();
   m_const_pool.Shutdown();
@@ -822,7 +824,7 @@ void Jit64::Jit(u32 em_address, bool clear_cache_and_retry_on_failure)
   // Analyze the block, collect all instructions it is made of (including inlining,
   // if that is enabled), reorder instructions for optimal performance, and join joinable
   // instructions.
-  const u32 nextPC = analyzer.Analyze(em_address, &code_block, &m_code_buffer, block_size);
+  const u32 nextPC = AnalyzeBlock(em_address, block_size);
 
   if (code_block.m_memory_exception)
   {
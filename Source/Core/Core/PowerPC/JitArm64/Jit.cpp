@@ -72,6 +72,7 @@ void JitArm64::Init()
   gpr.Init(this);
   fpr.Init(this);
   blocks.Init();
+  InitDiskCache();
 
   code_block.m_stats = &js.st;
   code_block.m_gpa = &js.gpa;
@@ -188,6 +189,7 @@ void JitArm64::Shutdown()
 {
   Memory::ShutdownFastmemArena();
   FreeCodeSpace();
+  ShutdownDiskCache();
   blocks.Shutdown();
   FreeStack();
 }
@@ -694,7 +696,7 @@ void JitArm64::Jit(u32 em_address, bool clear_cache_and_retry_on_failure)
   // Analyze the block, collect all instructions it is made of (including inlining,
   // if that is enabled), reorder instructions for optimal performance, and join joinable
   // instructions.
-  const u32 nextPC = analyzer.Analyze(em_address, &code_block, &m_code_buffer, block_size);
+  const u32 nextPC = AnalyzeBlock(em_address, block_size);
 
   if (code_block.m_memory_exception)
   {
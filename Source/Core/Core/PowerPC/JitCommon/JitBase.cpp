@@ -4,7 +4,10 @@
 
 #include "Core/PowerPC/JitCommon/JitBase.h"
 
+#include <chrono>
+
 #include "Common/CommonTypes.h"
+#include "Core/Config/MainSettings.h"
 #include "Core/ConfigManager.h"
 #include "Core/HW/CPU.h"
 #include "Core/PowerPC/PPCAnalyst.h"
@@ -26,6 +29,53 @@ JitBase::JitBase() : m_code_buffer(code_buffer_size)
 
 JitBase::~JitBase() = default;
 
+void JitBase::InitDiskCache()
+{
+  if (Config::Get(Config::MAIN_JIT_DISK_CACHE))
+    m_disk_cache.Init(SConfig::GetInstance().GetGameID());
+}
+
+void JitBase::ShutdownDiskCache()
+{
+  m_disk_cache.Shutdown();
+}
+
+u32 JitBase::AnalyzeBlock(u32 em_address, std::size_t block_size)
+{
+  // Single stepping and breakpoints shrink blocks, don't pollute the cache with those.
+  const bool use_disk_cache = m_disk_cache.IsEnabled() && block_size == m_code_buffer.size() &&
+                              !SConfig::GetInstance().bEnableDebugging;
+  if (!use_disk_cache)
+    return analyzer.Analyze(em_address, &code_block, &m_code_buffer, block_size);
+
+  const u32 msr_bits = MSR.Hex & JitBaseBlockCache::JIT_CACHE_MSR_MASK;
+  const u32 options = JitDiskCache::GetKeyOptions(analyzer);
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto elapsed_us = [&start] {
+    return static_cast<u64>(std::chrono::duration_cast<std::chrono::microseconds>(
+                                std::chrono::steady_clock::now() - start)
+                                .count());
+  };
+
+  u32 next_pc;
+  if (m_disk_cache.Lookup(em_address, msr_bits, options, block_size, &code_block, &m_code_buffer,
+                          &next_pc))
+  {
+    code_block.m_memory_exception = false;
+    m_disk_cache.AddLookupTime(elapsed_us());
+    return next_pc;
+  }
+
+  next_pc = analyzer.Analyze(em_address, &code_block, &m_code_buffer, block_size);
+  if (!code_block.m_memory_exception)
+  {
+    m_disk_cache.Store(msr_bits, options, code_block, m_code_buffer, next_pc);
+    m_disk_cache.AddAnalyzeTime(elapsed_us());
+  }
+  return next_pc;
+}
+
 bool JitBase::CanMergeNextInstructions(int count) const
 {
   if (CPU::IsStepping() || js.instructionsLeft < count)
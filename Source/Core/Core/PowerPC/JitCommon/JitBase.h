@@ -16,6 +16,7 @@
 #include "Core/PowerPC/CPUCoreBase.h"
 #include "Core/PowerPC/JitCommon/JitAsmCommon.h"
 #include "Core/PowerPC/JitCommon/JitCache.h"
+#include "Core/PowerPC/JitCommon/JitDiskCache.h"
 #include "Core/PowerPC/PPCAnalyst.h"
 
 //#define JIT_LOG_GENERATED_CODE  // Enables logging of generated code
@@ -101,6 +102,14 @@ protected:
   PPCAnalyst::CodeBlock code_block;
   PPCAnalyst::CodeBuffer m_code_buffer;
   PPCAnalyst::PPCAnalyzer analyzer;
+  JitDiskCache m_disk_cache;
+
+  // Fills code_block and m_code_buffer for the block at em_address, either from the disk cache
+  // or by running the analyzer. Returns the PC following the block.
+  u32 AnalyzeBlock(u32 em_address, std::size_t block_size);
+
+  void InitDiskCache();
+  void ShutdownDiskCache();
 
   bool CanMergeNextInstructions(int count) const;
 
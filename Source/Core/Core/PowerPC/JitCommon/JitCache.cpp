@@ -13,7 +13,6 @@
 #include <array>
 #include <cstring>
 #include <functional>
-#include <map>
 #include <set>
 #include <utility>
 
@@ -34,8 +33,9 @@ using namespace Gen;
 
 bool JitBlock::OverlapsPhysicalRange(u32 address, u32 length) const
 {
-  return physical_addresses.lower_bound(address) !=
-         physical_addresses.lower_bound(address + length);
+  const auto iter =
+      std::lower_bound(physical_addresses.begin(), physical_addresses.end(), address);
+  return iter != physical_addresses.end() && *iter - address < length;
 }
 
 JitBaseBlockCache::JitBaseBlockCache(JitBase& jit) : m_jit{jit}
@@ -67,13 +67,16 @@ void JitBaseBlockCache::Clear()
   m_jit.js.pairedQuantizeAddresses.clear();
   for (auto& e : block_map)
   {
-    DestroyBlock(e.second);
+    for (JitBlock* block = e.second; block; block = block->next_in_block_map)
+      DestroyBlock(*block);
   }
   block_map.clear();
   links_to.clear();
   block_range_map.clear();
+  ResetBlockPool();
 
   valid_block.ClearAll();
+  range_pages.ClearAll();
 
   fast_block_map.fill(nullptr);
 }
@@ -92,19 +95,60 @@ JitBlock** JitBaseBlockCache::GetFastBlockMap()
 void JitBaseBlockCache::RunOnBlocks(std::function<void(const JitBlock&)> f)
 {
   for (const auto& e : block_map)
-    f(e.second);
+  {
+    for (const JitBlock* block = e.second; block; block = block->next_in_block_map)
+      f(*block);
+  }
+}
+
+JitBlock* JitBaseBlockCache::NewBlockFromPool()
+{
+  if (free_blocks.empty())
+  {
+    block_pool.emplace_back(std::make_unique<JitBlock[]>(BLOCK_POOL_CHUNK_SIZE));
+    JitBlock* chunk = block_pool.back().get();
+    for (size_t i = BLOCK_POOL_CHUNK_SIZE; i > 0; i--)
+      free_blocks.push_back(&chunk[i - 1]);
+  }
+
+  JitBlock* block = free_blocks.back();
+  free_blocks.pop_back();
+
+  // Keep the storage of the vectors from the block's previous use.
+  std::vector<JitBlock::LinkData> link_data = std::move(block->linkData);
+  std::vector<u32> physical_addresses = std::move(block->physical_addresses);
+  *block = JitBlock();
+  block->linkData = std::move(link_data);
+  block->linkData.clear();
+  block->physical_addresses = std::move(physical_addresses);
+  block->physical_addresses.clear();
+  return block;
+}
+
+void JitBaseBlockCache::ResetBlockPool()
+{
+  free_blocks.clear();
+  free_blocks.reserve(block_pool.size() * BLOCK_POOL_CHUNK_SIZE);
+  for (auto chunk = block_pool.rbegin(); chunk != block_pool.rend(); ++chunk)
+  {
+    for (size_t i = BLOCK_POOL_CHUNK_SIZE; i > 0; i--)
+      free_blocks.push_back(&(*chunk)[i - 1]);
+  }
 }
 
 JitBlock* JitBaseBlockCache::AllocateBlock(u32 em_address)
 {
   u32 physicalAddress = PowerPC::JitCache_TranslateAddress(em_address).address;
-  JitBlock& b = block_map.emplace(physicalAddress, JitBlock())->second;
-  b.effectiveAddress = em_address;
-  b.physicalAddress = physicalAddress;
-  b.msrBits = MSR.Hex & JIT_CACHE_MSR_MASK;
-  b.linkData.clear();
-  b.fast_block_map_index = 0;
-  return &b;
+  JitBlock* b = NewBlockFromPool();
+  b->effectiveAddress = em_address;
+  b->physicalAddress = physicalAddress;
+  b->msrBits = MSR.Hex & JIT_CACHE_MSR_MASK;
+  b->fast_block_map_index = 0;
+
+  JitBlock*& head = block_map[physicalAddress];
+  b->next_in_block_map = head;
+  head = b;
+  return b;
 }
 
 void JitBaseBlockCache::FinalizeBlock(JitBlock& block, bool block_link,
@@ -114,20 +158,31 @@ void JitBaseBlockCache::FinalizeBlock(JitBlock& block, bool block_link,
   fast_block_map[index] = &block;
   block.fast_block_map_index = index;
 
-  block.physical_addresses = physical_addresses;
+  block.physical_addresses.assign(physical_addresses.begin(), physical_addresses.end());
 
+  // The addresses are sorted, so each macro block only shows up in one run.
   u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
-  for (u32 addr : physical_addresses)
+  u32 previous_range = 0;
+  bool first = true;
+  for (u32 addr : block.physical_addresses)
   {
     valid_block.Set(addr / 32);
-    block_range_map[addr & range_mask].insert(&block);
+
+    const u32 range = addr & range_mask;
+    if (first || range != previous_range)
+    {
+      block_range_map[range].push_back(&block);
+      range_pages.Set(range / RANGE_PAGE_SIZE);
+      previous_range = range;
+      first = false;
+    }
   }
 
   if (block_link)
   {
     for (const auto& e : block.linkData)
     {
-      links_to.emplace(e.exitAddress, &block);
+      links_to[e.exitAddress].push_back(&block);
     }
 
     LinkBlock(block);
@@ -160,12 +215,14 @@ JitBlock* JitBaseBlockCache::GetBlockFromStartAddress(u32 addr, u32 msr)
     translated_addr = translated.address;
   }
 
-  auto iter = block_map.equal_range(translated_addr);
-  for (; iter.first != iter.second; iter.first++)
+  JitBlock* const* head = block_map.find(translated_addr);
+  if (!head)
+    return nullptr;
+
+  for (JitBlock* b = *head; b; b = b->next_in_block_map)
   {
-    JitBlock& b = iter.first->second;
-    if (b.effectiveAddress == addr && b.msrBits == (msr & JIT_CACHE_MSR_MASK))
-      return &b;
+    if (b->effectiveAddress == addr && b->msrBits == (msr & JIT_CACHE_MSR_MASK))
+      return b;
   }
 
   return nullptr;
@@ -223,51 +280,94 @@ void JitBaseBlockCache::InvalidateICache(u32 address, u32 length, bool forced)
 
 void JitBaseBlockCache::ErasePhysicalRange(u32 address, u32 length)
 {
-  // Iterate over all macro blocks which overlap the given range.
-  u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
-  auto start = block_range_map.lower_bound(address & range_mask);
-  auto end = block_range_map.lower_bound(address + length);
-  while (start != end)
+  // Collect all blocks overlapping the range first, as removing blocks modifies the maps.
+  // A block is only collected from the first of its macro blocks inside the range, so that
+  // blocks spanning several macro blocks aren't collected twice.
+  const u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
+  const u64 range_start = address & range_mask;
+  const u64 range_end = static_cast<u64>(address) + length;
+  blocks_to_erase.clear();
+
+  // Iterate over all pages with code which overlap the given range.
+  for (u64 page = address & ~(RANGE_PAGE_SIZE - 1); page < range_end; page += RANGE_PAGE_SIZE)
   {
-    // Iterate over all blocks in the macro block.
-    auto iter = start->second.begin();
-    while (iter != start->second.end())
+    if (!range_pages.Test(static_cast<u32>(page / RANGE_PAGE_SIZE)))
+      continue;
+
+    // Iterate over all macro blocks in the page which overlap the given range.
+    const u64 first = std::max(page, range_start);
+    const u64 last = std::min(page + RANGE_PAGE_SIZE, range_end);
+    for (u64 range = first; range < last; range += BLOCK_RANGE_MAP_ELEMENTS)
     {
-      JitBlock* block = *iter;
-      if (block->OverlapsPhysicalRange(address, length))
+      const std::vector<JitBlock*>* blocks = block_range_map.find(static_cast<u32>(range));
+      if (!blocks)
+        continue;
+
+      for (JitBlock* block : *blocks)
       {
-        // If the block overlaps, also remove all other occupied slots in the other macro blocks.
-        // This will leak empty macro blocks, but they may be reused or cleared later on.
-        for (u32 addr : block->physical_addresses)
-          if ((addr & range_mask) != start->first)
-            block_range_map[addr & range_mask].erase(block);
-
-        // And remove the block.
-        DestroyBlock(*block);
-        auto block_map_iter = block_map.equal_range(block->physicalAddress);
-        while (block_map_iter.first != block_map_iter.second)
-        {
-          if (&block_map_iter.first->second == block)
-          {
-            block_map.erase(block_map_iter.first);
-            break;
-          }
-          block_map_iter.first++;
-        }
-        iter = start->second.erase(iter);
+        if (!block->OverlapsPhysicalRange(address, length))
+          continue;
+
+        const auto first_in_range =
+            std::lower_bound(block->physical_addresses.begin(), block->physical_addresses.end(),
+                             static_cast<u32>(range_start));
+        if ((*first_in_range & range_mask) == range)
+          blocks_to_erase.push_back(block);
       }
-      else
+    }
+  }
+
+  for (JitBlock* block : blocks_to_erase)
+  {
+    DestroyBlock(*block);
+    RemoveBlock(*block);
+  }
+}
+
+void JitBaseBlockCache::RemoveBlock(JitBlock& block)
+{
+  // Remove the block from all its macro blocks, and drop the ones which become empty.
+  const u32 range_mask = ~(BLOCK_RANGE_MAP_ELEMENTS - 1);
+  u32 previous_range = 0;
+  bool first = true;
+  for (u32 addr : block.physical_addresses)
+  {
+    const u32 range = addr & range_mask;
+    if (!first && range == previous_range)
+      continue;
+    previous_range = range;
+    first = false;
+
+    std::vector<JitBlock*>* blocks = block_range_map.find(range);
+    if (!blocks)
+      continue;
+    const auto iter = std::find(blocks->begin(), blocks->end(), &block);
+    if (iter != blocks->end())
+    {
+      *iter = blocks->back();
+      blocks->pop_back();
+    }
+    if (blocks->empty())
+      block_range_map.erase(range);
+  }
+
+  // Unchain the block from block_map.
+  JitBlock** head = block_map.find(block.physicalAddress);
+  if (head)
+  {
+    for (JitBlock** b = head; *b; b = &(*b)->next_in_block_map)
+    {
+      if (*b == &block)
       {
-        iter++;
+        *b = block.next_in_block_map;
+        break;
       }
     }
-
-    // If the macro block is empty, drop it.
-    if (start->second.empty())
-      start = block_range_map.erase(start);
-    else
-      start++;
+    if (!*head)
+      block_map.erase(block.physicalAddress);
   }
+
+  free_blocks.push_back(&block);
 }
 
 void JitBaseBlockCache::WriteDestroyBlock(const JitBlock& block)
@@ -299,13 +399,14 @@ void JitBaseBlockCache::LinkBlockExits(JitBlock& block)
 void JitBaseBlockCache::LinkBlock(JitBlock& block)
 {
   LinkBlockExits(block);
-  auto ppp = links_to.equal_range(block.effectiveAddress);
+  const std::vector<JitBlock*>* sources = links_to.find(block.effectiveAddress);
+  if (!sources)
+    return;
 
-  for (auto iter = ppp.first; iter != ppp.second; ++iter)
+  for (JitBlock* b2 : *sources)
   {
-    JitBlock& b2 = *iter->second;
-    if (block.msrBits == b2.msrBits)
-      LinkBlockExits(b2);
+    if (block.msrBits == b2->msrBits)
+      LinkBlockExits(*b2);
   }
 }
 
@@ -318,10 +419,13 @@ void JitBaseBlockCache::UnlinkBlock(const JitBlock& block)
   }
 
   // Unlink all exits of other blocks which points to this block
-  auto ppp = links_to.equal_range(block.effectiveAddress);
-  for (auto iter = ppp.first; iter != ppp.second; ++iter)
+  const std::vector<JitBlock*>* sources = links_to.find(block.effectiveAddress);
+  if (!sources)
+    return;
+
+  for (JitBlock* source : *sources)
   {
-    JitBlock& sourceBlock = *iter->second;
+    JitBlock& sourceBlock = *source;
     if (sourceBlock.msrBits != block.msrBits)
       continue;
 
@@ -346,14 +450,13 @@ void JitBaseBlockCache::DestroyBlock(JitBlock& block)
   // Delete linking addresses
   for (const auto& e : block.linkData)
   {
-    auto it = links_to.equal_range(e.exitAddress);
-    while (it.first != it.second)
-    {
-      if (it.first->second == &block)
-        it.first = links_to.erase(it.first);
-      else
-        it.first++;
-    }
+    std::vector<JitBlock*>* sources = links_to.find(e.exitAddress);
+    if (!sources)
+      continue;
+
+    sources->erase(std::remove(sources->begin(), sources->end(), &block), sources->end());
+    if (sources->empty())
+      links_to.erase(e.exitAddress);
   }
 
   // Raise an signal if we are going to call this block again
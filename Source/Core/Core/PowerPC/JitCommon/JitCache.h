@@ -8,12 +8,12 @@
 #include <bitset>
 #include <cstring>
 #include <functional>
-#include <map>
 #include <memory>
 #include <set>
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/FlatHashMap.h"
 
 class JitBase;
 
@@ -67,8 +67,8 @@ struct JitBlock
   };
   std::vector<LinkData> linkData;
 
-  // This set stores all physical addresses of all occupied instructions.
-  std::set<u32> physical_addresses;
+  // The sorted physical addresses of all occupied instructions.
+  std::vector<u32> physical_addresses;
 
   // Block profiling data, structure is inlined in Jit.cpp
   struct ProfileData
@@ -83,40 +83,47 @@ struct JitBlock
   // This tracks the position if this block within the fast block cache.
   // We allow each block to have only one map entry.
   size_t fast_block_map_index;
+
+  // The next block starting at the same physical address, if any. Blocks in block_map are
+  // chained through this, as most addresses only ever have a single block.
+  JitBlock* next_in_block_map;
 };
 
 typedef void (*CompiledCode)();
 
 // This is essentially just an std::bitset, but Visual Studia 2013's
 // implementation of std::bitset is slow.
-class ValidBlockBitSet final
+template <u32 GRANULARITY>
+class AddressBitSet final
 {
 public:
-  ValidBlockBitSet()
+  AddressBitSet()
   {
-    m_valid_block.reset(new u32[VALID_BLOCK_ALLOC_ELEMENTS]);
+    m_bits.reset(new u32[ALLOC_ELEMENTS]);
     ClearAll();
   }
 
-  void Set(u32 bit) { m_valid_block[bit / 32] |= 1u << (bit % 32); }
-  void Clear(u32 bit) { m_valid_block[bit / 32] &= ~(1u << (bit % 32)); }
-  void ClearAll() { memset(m_valid_block.get(), 0, sizeof(u32) * VALID_BLOCK_ALLOC_ELEMENTS); }
-  bool Test(u32 bit) { return (m_valid_block[bit / 32] & (1u << (bit % 32))) != 0; }
+  void Set(u32 bit) { m_bits[bit / 32] |= 1u << (bit % 32); }
+  void Clear(u32 bit) { m_bits[bit / 32] &= ~(1u << (bit % 32)); }
+  void ClearAll() { memset(m_bits.get(), 0, sizeof(u32) * ALLOC_ELEMENTS); }
+  bool Test(u32 bit) { return (m_bits[bit / 32] & (1u << (bit % 32))) != 0; }
 
 private:
   enum
   {
-    // ValidBlockBitSet covers the whole 32-bit address-space in 32-byte
-    // chunks.
+    // The bitset covers the whole 32-bit address-space in chunks of GRANULARITY bytes.
     // FIXME: Maybe we can get away with less? There isn't any actual
     // RAM in most of this space.
-    VALID_BLOCK_MASK_SIZE = (1ULL << 32) / 32,
+    MASK_SIZE = (1ULL << 32) / GRANULARITY,
     // The number of elements in the allocated array. Each u32 contains 32 bits.
-    VALID_BLOCK_ALLOC_ELEMENTS = VALID_BLOCK_MASK_SIZE / 32
+    ALLOC_ELEMENTS = MASK_SIZE / 32
   };
-  std::unique_ptr<u32[]> m_valid_block;
+  std::unique_ptr<u32[]> m_bits;
 };
 
+// One bit per 32-byte cacheline.
+using ValidBlockBitSet = AddressBitSet<32>;
+
 class JitBaseBlockCache
 {
 public:
@@ -169,6 +176,10 @@ private:
   void LinkBlock(JitBlock& block);
   void UnlinkBlock(const JitBlock& block);
 
+  JitBlock* NewBlockFromPool();
+  void ResetBlockPool();
+  void RemoveBlock(JitBlock& block);
+
   JitBlock* MoveBlockIntoFastCache(u32 em_address, u32 msr);
 
   // Fast but risky block lookup based on fast_block_map.
@@ -176,17 +187,32 @@ private:
 
   // links_to hold all exit points of all valid blocks in a reverse way.
   // It is used to query all blocks which links to an address.
-  std::multimap<u32, JitBlock*> links_to;  // destination_PC -> number
+  Common::FlatHashMap<u32, std::vector<JitBlock*>> links_to;  // destination_PC -> number
 
-  // Map indexed by the physical address of the entry point.
+  // Map indexed by the physical address of the entry point, pointing to the most recently
+  // allocated block at that address. Other blocks at that address follow via next_in_block_map.
   // This is used to query the block based on the current PC in a slow way.
-  std::multimap<u32, JitBlock> block_map;  // start_addr -> block
+  Common::FlatHashMap<u32, JitBlock*> block_map;  // start_addr -> block
 
   // Range of overlapping code indexed by a masked physical address.
   // This is used for invalidation of memory regions. The range is grouped
   // in macro blocks of each 0x100 bytes.
   static constexpr u32 BLOCK_RANGE_MAP_ELEMENTS = 0x100;
-  std::map<u32, std::set<JitBlock*>> block_range_map;
+  Common::FlatHashMap<u32, std::vector<JitBlock*>> block_range_map;
+
+  // This bitset shows which pages contain any macro blocks in block_range_map, so that
+  // invalidating large ranges (e.g. after a DMA) can skip pages without code in a single test.
+  static constexpr u32 RANGE_PAGE_SIZE = 0x1000;
+  AddressBitSet<RANGE_PAGE_SIZE> range_pages;
+
+  // Pooled storage for the blocks. Blocks never move once allocated, as the fast block map,
+  // the other maps and the generated code hold pointers to them.
+  static constexpr size_t BLOCK_POOL_CHUNK_SIZE = 0x1000;
+  std::vector<std::unique_ptr<JitBlock[]>> block_pool;
+  std::vector<JitBlock*> free_blocks;
+
+  // Scratch space for ErasePhysicalRange, kept around to avoid allocating on every call.
+  std::vector<JitBlock*> blocks_to_erase;
 
   // This bitsets shows which cachelines overlap with any blocks.
   // It is used to provide a fast way to query if no icache invalidation is needed.
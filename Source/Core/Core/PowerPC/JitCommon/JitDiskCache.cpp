@@ -0,0 +1,398 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/PowerPC/JitCommon/JitDiskCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "Common/ChunkFile.h"
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/Logging/Log.h"
+#include "Core/ConfigManager.h"
+#include "Core/PowerPC/MMU.h"
+#include "Core/PowerPC/PPCTables.h"
+
+// Bump this whenever the layout of the serialized data or the analyzer's output changes.
+// The LinearDiskCache header already invalidates the file on every new build; this is only
+// needed for local changes that don't alter the revision.
+constexpr u32 JIT_DISK_CACHE_VERSION = 2;
+
+// Compact once more than an eighth of the records in the file aren't needed anymore.
+constexpr u64 COMPACT_RATIO = 8;
+
+namespace
+{
+class NullReader : public LinearDiskCacheReader<JitDiskCache::Key, u8>
+{
+public:
+  void Read(const JitDiskCache::Key&, const u8*, u32) override {}
+};
+}  // namespace
+
+static std::string GetDiskCacheFileName(const std::string& game_id)
+{
+  const std::string dir = File::GetUserPath(D_CACHE_IDX) + "JIT" DIR_SEP;
+  if (!File::Exists(dir))
+    File::CreateFullPath(dir);
+  return dir + game_id + ".cache";
+}
+
+static u64 HashInstructions(const PPCAnalyst::CodeBuffer& buffer, u32 num_instructions)
+{
+  std::vector<u32> hexes(num_instructions);
+  for (u32 i = 0; i < num_instructions; i++)
+    hexes[i] = buffer[i].inst.hex;
+  return Common::GetHash64(reinterpret_cast<const u8*>(hexes.data()),
+                           static_cast<u32>(hexes.size() * sizeof(u32)), 0);
+}
+
+void JitDiskCache::Init(const std::string& game_id, u64 max_data_size)
+{
+  Shutdown();
+
+  // Without a game ID (e.g. booting the IPL or an ELF) there's nothing stable to key on.
+  if (game_id.empty() || game_id == "00000000")
+    return;
+
+  class CacheReader : public LinearDiskCacheReader<Key, u8>
+  {
+  public:
+    explicit CacheReader(JitDiskCache& cache_) : cache(cache_) {}
+    void Read(const Key& key, const u8* value, u32 value_size) override
+    {
+      cache.AddEntry(key, std::vector<u8>(value, value + value_size));
+    }
+
+  private:
+    JitDiskCache& cache;
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+  const std::string filename = GetDiskCacheFileName(game_id);
+  CacheReader reader(*this);
+  m_stats.loaded_records = m_disk_cache.OpenAndRead(filename, reader);
+
+  u64 data_size = 0;
+  for (const auto& [index, entries] : m_entries)
+  {
+    m_stats.loaded_entries += entries.size();
+    for (const Entry& entry : entries)
+      data_size += entry.data.size();
+  }
+
+  const u64 unused_records = m_stats.loaded_records - m_stats.loaded_entries;
+  if (unused_records * COMPACT_RATIO > m_stats.loaded_records || data_size > max_data_size)
+  {
+    INFO_LOG(DYNA_REC, "Compacting %s: %" PRIu64 " records, %" PRIu64 " entries, %" PRIu64 " bytes",
+             filename.c_str(), m_stats.loaded_records, m_stats.loaded_entries, data_size);
+    Compact(filename, max_data_size);
+    m_stats.compacted = true;
+  }
+  m_refresh_sequence = m_next_sequence / 2;
+
+  m_stats.load_time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+  INFO_LOG(DYNA_REC, "Loaded %" PRIu64 " cached JIT block analyses from %s in %" PRIu64 " us",
+           m_stats.loaded_entries, filename.c_str(), m_stats.load_time_us);
+
+  m_enabled = true;
+}
+
+void JitDiskCache::Compact(const std::string& filename, u64 max_data_size)
+{
+  std::vector<Entry*> entries;
+  for (auto& [index, bucket] : m_entries)
+  {
+    for (Entry& entry : bucket)
+      entries.push_back(&entry);
+  }
+
+  // Keep the most recently used entries which fit, and write them in the order they were used.
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry* a, const Entry* b) { return a->sequence > b->sequence; });
+  u64 data_size = 0;
+  std::size_t num_kept = 0;
+  while (num_kept < entries.size() && data_size + entries[num_kept]->data.size() <= max_data_size)
+    data_size += entries[num_kept++]->data.size();
+
+  for (std::size_t i = num_kept; i < entries.size(); i++)
+    entries[i]->sequence = std::numeric_limits<u64>::max();
+  entries.resize(num_kept);
+  std::reverse(entries.begin(), entries.end());
+
+  // Build the new file next to the old one, so that it can be swapped in atomically.
+  m_disk_cache.Close();
+  const std::string temp_filename = File::GetTempFilenameForAtomicWrite(filename);
+  File::Delete(temp_filename);
+  NullReader null_reader;
+  {
+    LinearDiskCache<Key, u8> temp_cache;
+    temp_cache.OpenAndRead(temp_filename, null_reader);
+    m_next_sequence = 0;
+    for (Entry* entry : entries)
+    {
+      temp_cache.Append(entry->key, entry->data.data(), static_cast<u32>(entry->data.size()));
+      entry->sequence = m_next_sequence++;
+    }
+    temp_cache.Sync();
+    temp_cache.Close();
+  }
+
+  if (!File::RenameSync(temp_filename, filename))
+  {
+    ERROR_LOG(DYNA_REC, "Failed to replace %s with its compacted version", filename.c_str());
+    File::Delete(temp_filename);
+  }
+
+  for (auto iter = m_entries.begin(); iter != m_entries.end();)
+  {
+    std::vector<Entry>& bucket = iter->second;
+    bucket.erase(std::remove_if(bucket.begin(), bucket.end(),
+                                [](const Entry& entry) {
+                                  return entry.sequence == std::numeric_limits<u64>::max();
+                                }),
+                 bucket.end());
+    iter = bucket.empty() ? m_entries.erase(iter) : std::next(iter);
+  }
+
+  // Reopen the file for appending.
+  m_disk_cache.OpenAndRead(filename, null_reader);
+}
+
+void JitDiskCache::Shutdown()
+{
+  if (m_enabled)
+  {
+    const u64 cached_avg =
+        m_stats.cached_blocks ? m_stats.lookup_time_us * 1000 / m_stats.cached_blocks : 0;
+    const u64 analyzed_avg =
+        m_stats.analyzed_blocks ? m_stats.analyze_time_us * 1000 / m_stats.analyzed_blocks : 0;
+    NOTICE_LOG(DYNA_REC,
+               "JIT disk cache: %" PRIu64 " blocks from cache (%" PRIu64 " ns/block), %" PRIu64
+               " blocks analyzed (%" PRIu64 " ns/block), %" PRIu64 " stale entries",
+               m_stats.cached_blocks, cached_avg, m_stats.analyzed_blocks, analyzed_avg,
+               m_stats.stale_entries);
+
+    m_disk_cache.Sync();
+    m_disk_cache.Close();
+  }
+
+  m_enabled = false;
+  m_stats = {};
+  m_entries.clear();
+  m_next_sequence = 0;
+  m_refresh_sequence = 0;
+}
+
+u32 JitDiskCache::GetKeyOptions(const PPCAnalyst::PPCAnalyzer& analyzer)
+{
+  const SConfig& config = SConfig::GetInstance();
+
+  u32 options = analyzer.GetOptions();
+  if (config.bJITFollowBranch)
+    options |= FLAG_BRANCH_FOLLOW;
+  if (config.bFloatExceptions)
+    options |= FLAG_FLOAT_EXCEPTIONS;
+  if (config.bDivideByZeroExceptions)
+    options |= FLAG_DIVIDE_BY_ZERO_EXCEPTIONS;
+  return options;
+}
+
+bool JitDiskCache::AddEntry(const Key& key, std::vector<u8> data)
+{
+  // The instruction hash of entries from another hash version would never match, and data from
+  // another version of the serialization would fail to deserialize.
+  u32 version = 0;
+  if (data.size() >= sizeof(version))
+    std::memcpy(&version, data.data(), sizeof(version));
+  if (key.hash_version != Common::HASH64_VERSION || version != JIT_DISK_CACHE_VERSION)
+    return false;
+
+  std::vector<Entry>& entries = m_entries[IndexForAddress(key.effective_address, key.msr_bits)];
+  const auto iter = std::find_if(entries.begin(), entries.end(), [&key](const Entry& entry) {
+    return std::memcmp(&entry.key, &key, sizeof(Key)) == 0;
+  });
+  if (iter != entries.end())
+  {
+    iter->data = std::move(data);
+    iter->sequence = m_next_sequence++;
+  }
+  else
+  {
+    entries.push_back({key, std::move(data), m_next_sequence++});
+  }
+  return true;
+}
+
+bool JitDiskCache::Lookup(u32 em_address, u32 msr_bits, u32 analyzer_options,
+                          std::size_t block_size, PPCAnalyst::CodeBlock* block,
+                          PPCAnalyst::CodeBuffer* buffer, u32* next_pc)
+{
+  const auto iter = m_entries.find(IndexForAddress(em_address, msr_bits));
+  if (iter == m_entries.end())
+    return false;
+
+  const PowerPC::TranslateResult translated = PowerPC::JitCache_TranslateAddress(em_address);
+  if (!translated.valid)
+    return false;
+
+  for (Entry& entry : iter->second)
+  {
+    if (entry.key.analyzer_options != analyzer_options ||
+        entry.key.physical_address != translated.address)
+    {
+      continue;
+    }
+
+    if (!DeserializeBlock(entry.data, block_size, block, buffer, next_pc))
+      continue;
+
+    if (HashInstructions(*buffer, block->m_num_instructions) != entry.key.instruction_hash ||
+        !ValidateAgainstMemory(block, *buffer))
+    {
+      m_stats.stale_entries++;
+      continue;
+    }
+
+    m_stats.cached_blocks++;
+    if (entry.sequence < m_refresh_sequence)
+    {
+      m_disk_cache.Append(entry.key, entry.data.data(), static_cast<u32>(entry.data.size()));
+      entry.sequence = m_next_sequence++;
+    }
+    return true;
+  }
+
+  return false;
+}
+
+void JitDiskCache::Store(u32 msr_bits, u32 analyzer_options, const PPCAnalyst::CodeBlock& block,
+                         const PPCAnalyst::CodeBuffer& buffer, u32 next_pc)
+{
+  m_stats.analyzed_blocks++;
+
+  const PowerPC::TranslateResult translated = PowerPC::JitCache_TranslateAddress(block.m_address);
+  if (!translated.valid || block.m_num_instructions == 0)
+    return;
+
+  Key key = {};
+  key.effective_address = block.m_address;
+  key.physical_address = translated.address;
+  key.msr_bits = msr_bits;
+  key.analyzer_options = analyzer_options;
+  key.hash_version = Common::HASH64_VERSION;
+  key.instruction_hash = HashInstructions(buffer, block.m_num_instructions);
+
+  std::vector<u8> data = SerializeBlock(block, buffer, next_pc);
+  m_disk_cache.Append(key, data.data(), static_cast<u32>(data.size()));
+  AddEntry(key, std::move(data));
+}
+
+bool JitDiskCache::ValidateAgainstMemory(PPCAnalyst::CodeBlock* block,
+                                         const PPCAnalyst::CodeBuffer& buffer)
+{
+  // Re-read every instruction the analyzer looked at. This is far cheaper than analyzing the
+  // block again, and catches both modified code and changed address translation.
+  block->m_physical_addresses.clear();
+  for (u32 i = 0; i < block->m_num_instructions; i++)
+  {
+    const PowerPC::TryReadInstResult result = PowerPC::TryReadInstruction(buffer[i].address);
+    if (!result.valid || result.hex != buffer[i].inst.hex)
+      return false;
+    block->m_physical_addresses.insert(result.physical_address);
+  }
+
+  return true;
+}
+
+void JitDiskCache::DoBlock(PointerWrap& p, PPCAnalyst::CodeBlock& block,
+                           PPCAnalyst::CodeBuffer& buffer, u32& next_pc, std::size_t block_size,
+                           std::size_t data_size)
+{
+  u8* const start = *p.ptr;
+
+  u32 version = JIT_DISK_CACHE_VERSION;
+  u32 code_op_size = sizeof(PPCAnalyst::CodeOp);
+  p.Do(version);
+  p.Do(code_op_size);
+  p.Do(next_pc);
+  p.Do(block.m_address);
+  p.Do(block.m_num_instructions);
+
+  if (p.GetMode() == PointerWrap::MODE_READ)
+  {
+    // PointerWrap doesn't do any bounds checking, so make sure the rest of the entry has exactly
+    // the size implied by the instruction count before reading it.
+    constexpr std::size_t fixed_size =
+        sizeof(PPCAnalyst::BlockStats) + sizeof(PPCAnalyst::BlockRegStats) * 2 + sizeof(u8) +
+        sizeof(BitSet8) * 2 + sizeof(BitSet32);
+    const std::size_t expected_size = static_cast<std::size_t>(*p.ptr - start) + fixed_size +
+                                      block.m_num_instructions * sizeof(PPCAnalyst::CodeOp);
+    if (version != JIT_DISK_CACHE_VERSION || code_op_size != sizeof(PPCAnalyst::CodeOp) ||
+        block.m_num_instructions > block_size || expected_size != data_size)
+    {
+      p.SetMode(PointerWrap::MODE_MEASURE);
+      return;
+    }
+  }
+
+  p.Do(*block.m_stats);
+  p.Do(*block.m_gpa);
+  p.Do(*block.m_fpa);
+  p.Do(block.m_broken);
+  p.Do(block.m_gqr_used);
+  p.Do(block.m_gqr_modified);
+  p.Do(block.m_gpr_inputs);
+  p.DoArray(buffer.data(), block.m_num_instructions);
+
+  // The opinfo pointers point into the static instruction tables and have to be looked up again.
+  // The physical addresses are filled in when the block is validated against memory.
+  if (p.GetMode() == PointerWrap::MODE_READ)
+  {
+    for (u32 i = 0; i < block.m_num_instructions; i++)
+      buffer[i].opinfo = PPCTables::GetOpInfo(buffer[i].inst);
+  }
+}
+
+std::vector<u8> JitDiskCache::SerializeBlock(const PPCAnalyst::CodeBlock& block,
+                                             const PPCAnalyst::CodeBuffer& buffer, u32 next_pc)
+{
+  // PointerWrap only reads from the block and buffer when writing.
+  auto& mutable_block = const_cast<PPCAnalyst::CodeBlock&>(block);
+  auto& mutable_buffer = const_cast<PPCAnalyst::CodeBuffer&>(buffer);
+
+  u8* ptr = nullptr;
+  PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+  DoBlock(p, mutable_block, mutable_buffer, next_pc, buffer.size(), 0);
+  const size_t data_size = reinterpret_cast<size_t>(ptr);
+
+  std::vector<u8> data(data_size);
+  ptr = data.data();
+  p.SetMode(PointerWrap::MODE_WRITE);
+  DoBlock(p, mutable_block, mutable_buffer, next_pc, buffer.size(), data_size);
+  return data;
+}
+
+bool JitDiskCache::DeserializeBlock(const std::vector<u8>& data, std::size_t block_size,
+                                    PPCAnalyst::CodeBlock* block, PPCAnalyst::CodeBuffer* buffer,
+                                    u32* next_pc)
+{
+  // Enough for the fields preceding the instruction count, which are always read.
+  if (data.size() < sizeof(u32) * 5)
+    return false;
+
+  u8* ptr = const_cast<u8*>(data.data());
+  PointerWrap p(&ptr, PointerWrap::MODE_READ);
+  DoBlock(p, *block, *buffer, *next_pc, std::min(block_size, buffer->size()), data.size());
+  return p.GetMode() == PointerWrap::MODE_READ;
+}
@@ -0,0 +1,136 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/LinearDiskCache.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+
+class PointerWrap;
+
+// Persistent, per-game cache of PPCAnalyst results.
+//
+// Only the analysis is cached, not the emitted host code. Generated blocks embed absolute
+// pointers to the near/far code regions, the constant pool, trampolines and ppcState, none of
+// which are stable between sessions, so the backends still run their code generators on a hit.
+//
+// Entries are read from disk when the JIT is initialized but only deserialized on first use,
+// and every entry is validated against the current contents of emulated memory before being
+// handed to the JIT. Stale entries (e.g. code overlays that have since been replaced) are
+// simply ignored and the block is analyzed again.
+//
+// The file is only ever appended to while a game runs. An entry from the older half of the file is
+// appended again when it is used, so that the entries used least recently stay at the start of the
+// file. When it is loaded, the file is compacted if more than an eighth of its records were
+// replaced or can't be used anymore, or if its entries don't fit in the size limit, in which case
+// the entries from the start of the file are dropped.
+class JitDiskCache
+{
+public:
+  struct Key
+  {
+    u32 effective_address;
+    u32 physical_address;
+    u32 msr_bits;
+    // See GetKeyOptions.
+    u32 analyzer_options;
+    // Common::HASH64_VERSION at the time instruction_hash was computed.
+    u32 hash_version;
+    // Keys are compared and stored bytewise, so they can't have implicit padding.
+    u32 padding;
+    // Hash of all the instructions making up the block, in analyzed order.
+    u64 instruction_hash;
+  };
+  static_assert(std::has_unique_object_representations_v<Key>);
+
+  // Settings which change the result of the analysis without being analyzer options themselves.
+  // These are or'd into the analyzer options in keys.
+  static constexpr u32 FLAG_BRANCH_FOLLOW = 1u << 31;
+  static constexpr u32 FLAG_FLOAT_EXCEPTIONS = 1u << 30;
+  static constexpr u32 FLAG_DIVIDE_BY_ZERO_EXCEPTIONS = 1u << 29;
+
+  // Total size of the serialized analyses kept when compacting.
+  static constexpr u64 DEFAULT_MAX_DATA_SIZE = 64 * 1024 * 1024;
+
+  struct Stats
+  {
+    u64 loaded_records = 0;
+    u64 loaded_entries = 0;
+    u64 load_time_us = 0;
+    bool compacted = false;
+    u64 analyzed_blocks = 0;
+    u64 cached_blocks = 0;
+    u64 stale_entries = 0;
+    u64 analyze_time_us = 0;
+    u64 lookup_time_us = 0;
+  };
+
+  void Init(const std::string& game_id, u64 max_data_size = DEFAULT_MAX_DATA_SIZE);
+  void Shutdown();
+
+  bool IsEnabled() const { return m_enabled; }
+
+  // Returns the analyzer options to key entries on, which include every setting the analyzer
+  // looks at. Any new setting read by PPCAnalyzer::Analyze needs to be added here.
+  static u32 GetKeyOptions(const PPCAnalyst::PPCAnalyzer& analyzer);
+  const Stats& GetStats() const { return m_stats; }
+
+  // Fills block and buffer from the cache. Returns false if there is no entry which matches the
+  // current contents of memory, in which case block and buffer may have been clobbered.
+  bool Lookup(u32 em_address, u32 msr_bits, u32 analyzer_options, std::size_t block_size,
+              PPCAnalyst::CodeBlock* block, PPCAnalyst::CodeBuffer* buffer, u32* next_pc);
+  void Store(u32 msr_bits, u32 analyzer_options, const PPCAnalyst::CodeBlock& block,
+             const PPCAnalyst::CodeBuffer& buffer, u32 next_pc);
+
+  void AddAnalyzeTime(u64 us) { m_stats.analyze_time_us += us; }
+  void AddLookupTime(u64 us) { m_stats.lookup_time_us += us; }
+
+  static std::vector<u8> SerializeBlock(const PPCAnalyst::CodeBlock& block,
+                                        const PPCAnalyst::CodeBuffer& buffer, u32 next_pc);
+  static bool DeserializeBlock(const std::vector<u8>& data, std::size_t block_size,
+                               PPCAnalyst::CodeBlock* block, PPCAnalyst::CodeBuffer* buffer,
+                               u32* next_pc);
+
+private:
+  struct Entry
+  {
+    Key key;
+    std::vector<u8> data;
+    // Position of the entry's latest record in the file.
+    u64 sequence;
+  };
+
+  static u64 IndexForAddress(u32 em_address, u32 msr_bits)
+  {
+    return (static_cast<u64>(msr_bits) << 32) | em_address;
+  }
+
+  static void DoBlock(PointerWrap& p, PPCAnalyst::CodeBlock& block, PPCAnalyst::CodeBuffer& buffer,
+                      u32& next_pc, std::size_t block_size, std::size_t data_size);
+  static bool ValidateAgainstMemory(PPCAnalyst::CodeBlock* block,
+                                    const PPCAnalyst::CodeBuffer& buffer);
+
+  // Returns false if the record can't be used, and adds it or replaces an entry with the same key
+  // otherwise.
+  bool AddEntry(const Key& key, std::vector<u8> data);
+  void Compact(const std::string& filename, u64 max_data_size);
+
+  bool m_enabled = false;
+  Stats m_stats;
+  u64 m_next_sequence = 0;
+  // Entries with a lower sequence number are appended again when they're used.
+  u64 m_refresh_sequence = 0;
+
+  // Indexed by (msr_bits, effective_address). There is usually only one entry per index, but
+  // overlays can map different code to the same address.
+  std::unordered_map<u64, std::vector<Entry>> m_entries;
+  LinearDiskCache<Key, u8> m_disk_cache;
+};
@@ -0,0 +1,313 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "Core/RewindRing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+#include <zstd.h>
+
+#include "Common/Thread.h"
+
+namespace State
+{
+// Snapshots are taken often and thrown away soon, so favour speed over ratio.
+constexpr int ZSTD_COMPRESSION_LEVEL = 1;
+
+static std::vector<u8> Compress(const u8* data, size_t size)
+{
+  std::vector<u8> compressed(ZSTD_compressBound(size));
+  const size_t compressed_size =
+      ZSTD_compress(compressed.data(), compressed.size(), data, size, ZSTD_COMPRESSION_LEVEL);
+  if (ZSTD_isError(compressed_size))
+    return {};
+
+  compressed.resize(compressed_size);
+  return compressed;
+}
+
+static bool Decompress(const std::vector<u8>& compressed, u8* data, size_t size)
+{
+  const size_t result = ZSTD_decompress(data, size, compressed.data(), compressed.size());
+  return !ZSTD_isError(result) && result == size;
+}
+
+static size_t GetPageLength(size_t state_size, size_t page)
+{
+  return std::min(RewindRing::PAGE_SIZE, state_size - page * RewindRing::PAGE_SIZE);
+}
+
+RewindRing::RewindRing() = default;
+
+RewindRing::~RewindRing()
+{
+  SetCapacity(0);
+}
+
+void RewindRing::SetCapacity(size_t max_snapshots)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  m_capacity = max_snapshots;
+  if (max_snapshots == 0)
+  {
+    StopWorker(lock);
+    m_snapshots.clear();
+    m_stats = {};
+    m_last_frame = 0;
+    m_keyframe.reset();
+    m_keyframe_state = {};
+    m_delta = {};
+    m_pending_state = {};
+    m_spare_buffer = {};
+    return;
+  }
+
+  if (!m_worker.joinable())
+  {
+    m_stop_worker = false;
+    m_worker = std::thread(&RewindRing::WorkerThread, this);
+  }
+
+  while (m_snapshots.size() > m_capacity)
+    m_snapshots.pop_front();
+}
+
+size_t RewindRing::GetCapacity() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_capacity;
+}
+
+std::vector<u8> RewindRing::GetBuffer()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return std::move(m_spare_buffer);
+}
+
+void RewindRing::Push(std::vector<u8> state, u64 frame, double capture_ms)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_capacity == 0)
+    return;
+
+  m_stats.capture_ms += capture_ms;
+
+  // Only the newest state is worth keeping if the worker can't keep up.
+  if (m_has_pending)
+  {
+    m_stats.dropped_snapshots++;
+    m_spare_buffer = std::move(m_pending_state);
+  }
+
+  m_pending_state = std::move(state);
+  m_pending_frame = frame;
+  m_has_pending = true;
+  m_work_available.notify_one();
+}
+
+bool RewindRing::Pop(std::vector<u8>* state)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  WaitForWorker(lock);
+  if (m_snapshots.empty())
+    return false;
+
+  const Snapshot snapshot = std::move(m_snapshots.back());
+  m_snapshots.pop_back();
+
+  if (snapshot.keyframe == m_keyframe)
+  {
+    *state = m_keyframe_state;
+  }
+  else
+  {
+    state->resize(snapshot.keyframe->state_size);
+    if (!Decompress(snapshot.keyframe->compressed_state, state->data(), state->size()))
+      return false;
+  }
+
+  if (snapshot.compressed_delta.empty())
+    return true;
+
+  std::vector<u8> delta(snapshot.delta_size);
+  return Decompress(snapshot.compressed_delta, delta.data(), delta.size()) &&
+         ApplyDelta(delta, state);
+}
+
+size_t RewindRing::GetSize()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  WaitForWorker(lock);
+  return m_snapshots.size();
+}
+
+RewindStats RewindRing::GetStats()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  WaitForWorker(lock);
+  return m_stats;
+}
+
+bool RewindRing::BuildDelta(const std::vector<u8>& state, const std::vector<u8>& keyframe_state,
+                            std::vector<u8>* delta)
+{
+  if (state.size() != keyframe_state.size())
+    return false;
+
+  const size_t num_pages = (state.size() + PAGE_SIZE - 1) / PAGE_SIZE;
+  size_t dirty_pages = 0;
+  delta->clear();
+
+  for (size_t page = 0; page < num_pages; ++page)
+  {
+    const size_t offset = page * PAGE_SIZE;
+    const size_t length = GetPageLength(state.size(), page);
+    if (std::memcmp(&state[offset], &keyframe_state[offset], length) == 0)
+      continue;
+
+    if (++dirty_pages > num_pages / 2)
+      return false;
+
+    const u32 page_index = static_cast<u32>(page);
+    const size_t delta_offset = delta->size();
+    delta->resize(delta_offset + sizeof(page_index) + length);
+    std::memcpy(&(*delta)[delta_offset], &page_index, sizeof(page_index));
+    std::memcpy(&(*delta)[delta_offset + sizeof(page_index)], &state[offset], length);
+  }
+
+  return true;
+}
+
+bool RewindRing::ApplyDelta(const std::vector<u8>& delta, std::vector<u8>* state)
+{
+  size_t position = 0;
+  while (position < delta.size())
+  {
+    u32 page_index;
+    if (delta.size() - position < sizeof(page_index))
+      return false;
+    std::memcpy(&page_index, &delta[position], sizeof(page_index));
+    position += sizeof(page_index);
+
+    const size_t offset = static_cast<size_t>(page_index) * PAGE_SIZE;
+    if (offset >= state->size())
+      return false;
+    const size_t length = GetPageLength(state->size(), page_index);
+    if (delta.size() - position < length)
+      return false;
+
+    std::memcpy(&(*state)[offset], &delta[position], length);
+    position += length;
+  }
+
+  return true;
+}
+
+void RewindRing::WorkerThread()
+{
+  Common::SetCurrentThreadName("Rewind Worker");
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true)
+  {
+    m_work_available.wait(lock, [this] { return m_has_pending || m_stop_worker; });
+    if (m_stop_worker)
+      return;
+
+    std::vector<u8> state = std::move(m_pending_state);
+    const u64 frame = m_pending_frame;
+    m_has_pending = false;
+    m_worker_busy = true;
+
+    lock.unlock();
+    AddSnapshot(std::move(state), frame);
+    lock.lock();
+
+    m_worker_busy = false;
+    m_work_done.notify_all();
+  }
+}
+
+// Runs on the worker without the lock held. Nothing else touches the keyframe members while the
+// worker is busy, as Pop waits for it to finish first.
+void RewindRing::AddSnapshot(std::vector<u8> state, u64 frame)
+{
+  const auto start = std::chrono::steady_clock::now();
+
+  Snapshot snapshot;
+  size_t compressed_size;
+  bool is_keyframe = false;
+  if (m_keyframe && BuildDelta(state, m_keyframe_state, &m_delta))
+  {
+    snapshot.keyframe = m_keyframe;
+    snapshot.delta_size = m_delta.size();
+    snapshot.compressed_delta = Compress(m_delta.data(), m_delta.size());
+    if (!m_delta.empty() && snapshot.compressed_delta.empty())
+      return;
+    compressed_size = snapshot.compressed_delta.size();
+  }
+  else
+  {
+    auto keyframe = std::make_shared<Keyframe>();
+    keyframe->state_size = state.size();
+    keyframe->compressed_state = Compress(state.data(), state.size());
+    if (keyframe->compressed_state.empty())
+      return;
+
+    compressed_size = keyframe->compressed_state.size();
+    is_keyframe = true;
+    m_keyframe = std::move(keyframe);
+    m_keyframe_state.swap(state);
+    snapshot.keyframe = m_keyframe;
+  }
+
+  const auto end = std::chrono::steady_clock::now();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (m_capacity == 0)
+    return;
+
+  m_snapshots.push_back(std::move(snapshot));
+  while (m_snapshots.size() > m_capacity)
+    m_snapshots.pop_front();
+
+  if (m_stats.snapshots != 0 && frame > m_last_frame)
+    m_stats.frames += frame - m_last_frame;
+  m_last_frame = frame;
+
+  m_stats.snapshots++;
+  if (is_keyframe)
+    m_stats.keyframes++;
+  m_stats.compressed_bytes += compressed_size;
+  m_stats.compress_ms += std::chrono::duration<double, std::milli>(end - start).count();
+
+  // Either the snapshot or the keyframe it replaced, both have the size of the next snapshot.
+  if (m_spare_buffer.empty())
+    m_spare_buffer = std::move(state);
+}
+
+void RewindRing::WaitForWorker(std::unique_lock<std::mutex>& lock)
+{
+  m_work_done.wait(lock, [this] { return !m_has_pending && !m_worker_busy; });
+}
+
+void RewindRing::StopWorker(std::unique_lock<std::mutex>& lock)
+{
+  if (!m_worker.joinable())
+    return;
+
+  m_stop_worker = true;
+  m_work_available.notify_one();
+  lock.unlock();
+  m_worker.join();
+  lock.lock();
+
+  m_has_pending = false;
+  m_worker_busy = false;
+}
+}  // namespace State
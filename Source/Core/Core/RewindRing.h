@@ -0,0 +1,109 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Core/State.h"
+
+namespace State
+{
+// An in-memory ring of recent serialized states.
+//
+// Each snapshot only stores the pages of the state that differ from the most recent keyframe,
+// compressed with zstd. A snapshot becomes a new keyframe when there is no keyframe yet, when the
+// state size changes, or when more than half of the pages changed. Keyframes are shared between
+// the snapshots that use them and are freed once the last of those snapshots leaves the ring.
+//
+// Diffing and compressing happen on a worker thread, so pushing a snapshot only costs the caller
+// the serialization into a buffer from GetBuffer.
+class RewindRing final
+{
+public:
+  static constexpr size_t PAGE_SIZE = 4096;
+
+  RewindRing();
+  ~RewindRing();
+
+  RewindRing(const RewindRing&) = delete;
+  RewindRing& operator=(const RewindRing&) = delete;
+
+  // Keeps at most max_snapshots snapshots. Passing 0 frees all snapshots and stops the worker.
+  void SetCapacity(size_t max_snapshots);
+  size_t GetCapacity() const;
+
+  // Returns a buffer to serialize the next snapshot into, reusing the storage of an earlier one.
+  std::vector<u8> GetBuffer();
+  // Queues a serialized state to be added to the ring. capture_ms is the time the caller spent
+  // serializing it, which only goes into the statistics.
+  void Push(std::vector<u8> state, u64 frame, double capture_ms);
+  // Removes the newest snapshot and stores its state in state. Returns false if the ring is empty
+  // or the snapshot could not be decompressed, which leaves state unspecified.
+  bool Pop(std::vector<u8>* state);
+
+  // Both wait for the worker to add any pending snapshot first.
+  size_t GetSize();
+  RewindStats GetStats();
+
+  // Builds the uncompressed delta of state against keyframe_state: a sequence of (u32 page index,
+  // page data) pairs for every page that differs. Returns false if so many pages changed that the
+  // state should become a new keyframe instead.
+  static bool BuildDelta(const std::vector<u8>& state, const std::vector<u8>& keyframe_state,
+                         std::vector<u8>* delta);
+  // Applies a delta built by BuildDelta. Returns false if the delta doesn't fit the state.
+  static bool ApplyDelta(const std::vector<u8>& delta, std::vector<u8>* state);
+
+private:
+  struct Keyframe
+  {
+    std::vector<u8> compressed_state;
+    size_t state_size;
+  };
+
+  struct Snapshot
+  {
+    std::shared_ptr<const Keyframe> keyframe;
+    // Empty if the snapshot is the keyframe itself.
+    std::vector<u8> compressed_delta;
+    size_t delta_size = 0;
+  };
+
+  void WorkerThread();
+  void AddSnapshot(std::vector<u8> state, u64 frame);
+  void WaitForWorker(std::unique_lock<std::mutex>& lock);
+  void StopWorker(std::unique_lock<std::mutex>& lock);
+
+  // Guards everything below.
+  mutable std::mutex m_mutex;
+  std::condition_variable m_work_available;
+  std::condition_variable m_work_done;
+
+  std::thread m_worker;
+  bool m_worker_busy = false;
+  bool m_stop_worker = false;
+  bool m_has_pending = false;
+  std::vector<u8> m_pending_state;
+  u64 m_pending_frame = 0;
+  std::vector<u8> m_spare_buffer;
+
+  size_t m_capacity = 0;
+  std::deque<Snapshot> m_snapshots;
+  RewindStats m_stats;
+  u64 m_last_frame = 0;
+
+  // The most recent keyframe and its uncompressed contents, which new snapshots are diffed
+  // against. Only the worker changes these while it runs.
+  std::shared_ptr<const Keyframe> m_keyframe;
+  std::vector<u8> m_keyframe_state;
+  std::vector<u8> m_delta;
+};
+}  // namespace State
@@ -4,26 +4,37 @@
 
 #include "Core/State.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstring>
 #include <lzo/lzo1x.h>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
 #include <utility>
 #include <vector>
 
+#include <zstd.h>
+
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
 #include "Common/Event.h"
 #include "Common/File.h"
 #include "Common/FileUtil.h"
+#include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/ScopeGuard.h"
 #include "Common/StringUtil.h"
 #include "Common/Thread.h"
+#include "Common/ThreadPool.h"
 #include "Common/Timer.h"
 #include "Common/Version.h"
 
+#include "Core/Config/MainSettings.h"
 #include "Core/ConfigManager.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
@@ -35,6 +46,7 @@
 #include "Core/Movie.h"
 #include "Core/NetPlayClient.h"
 #include "Core/PowerPC/PowerPC.h"
+#include "Core/RewindRing.h"
 
 #include "VideoCommon/FrameDump.h"
 #include "VideoCommon/OnScreenDisplay.h"
@@ -54,10 +66,31 @@ static const u32 OUT_LEN = IN_LEN + (IN_LEN / 16) + 64 + 3;
 
 static unsigned char __LZO_MMODEL out[OUT_LEN];
 
-#define HEAP_ALLOC(var, size)                                                                      \
-  lzo_align_t __LZO_MMODEL var[((size) + (sizeof(lzo_align_t) - 1)) / sizeof(lzo_align_t)]
+// The state version is stored as this plus the version number.
+constexpr u32 STATE_COOKIE_BASE = 0xBAADBABE;
+
+// Compressed states are written as independent zstd chunks preceded by an index of their
+// compressed sizes, so that both saving and loading can spread the work across all cores.
+//
+// States written by older versions use LZO instead, and those versions take any state with a
+// non-zero size in its header for an LZO state. zstd states are therefore written with a size of
+// 0, like uncompressed states, and the index starts with the version cookie of the (nonexistent)
+// state version 0. Older versions reject such a state right after reading that cookie.
+constexpr u32 ZSTD_STATE_COOKIE = STATE_COOKIE_BASE + 0;
+constexpr u32 ZSTD_CHUNK_SIZE = 1024 * 1024;
+constexpr int ZSTD_COMPRESSION_LEVEL = 1;
+
+struct ZstdStateIndexHeader
+{
+  u32 cookie;
+  u32 uncompressed_size;
+  u32 chunk_size;
+  u32 num_chunks;
+};
 
-static HEAP_ALLOC(wrkmem, LZO1X_1_MEM_COMPRESS);
+// Compresses and decompresses the chunks of zstd states. Shared by all saves and loads, so that
+// each of them doesn't have to start its own threads.
+static std::unique_ptr<Common::ThreadPool> s_compression_thread_pool;
 
 static AfterLoadCallbackFunc s_on_after_load_callback;
 
@@ -110,10 +143,9 @@ static bool DoStateVersion(PointerWrap& p, std::string* version_created_by)
 {
   u32 version = STATE_VERSION;
   {
-    static const u32 COOKIE_BASE = 0xBAADBABE;
-    u32 cookie = version + COOKIE_BASE;
+    u32 cookie = version + STATE_COOKIE_BASE;
     p.Do(cookie);
-    version = cookie - COOKIE_BASE;
+    version = cookie - STATE_COOKIE_BASE;
   }
 
   *version_created_by = Common::scm_rev_str;
@@ -249,6 +281,118 @@ void SaveToBuffer(std::vector<u8>& buffer)
       true);
 }
 
+static RewindRing s_rewind_ring;
+static int s_rewind_interval = 0;
+static int s_frames_until_rewind_snapshot = 0;
+
+void SetRewindCapacity(size_t max_snapshots)
+{
+  if (max_snapshots == 0 && s_rewind_ring.GetCapacity() != 0)
+  {
+    const RewindStats stats = s_rewind_ring.GetStats();
+    if (stats.snapshots != 0)
+    {
+      NOTICE_LOG(CORE, "Rewind: %" PRIu64 " snapshots (%" PRIu64 " keyframes, %" PRIu64
+                       " dropped), %.1f bytes/frame, %.2f ms/snapshot on the CPU thread, "
+                       "%.2f ms/snapshot on the worker",
+                 stats.snapshots, stats.keyframes, stats.dropped_snapshots,
+                 stats.frames ? static_cast<double>(stats.compressed_bytes) / stats.frames : 0.0,
+                 stats.capture_ms / (stats.snapshots + stats.dropped_snapshots),
+                 stats.compress_ms / stats.snapshots);
+    }
+  }
+
+  s_rewind_ring.SetCapacity(max_snapshots);
+}
+
+void SaveRewindSnapshot()
+{
+  Core::RunOnCPUThread(
+      [] {
+        if (s_rewind_ring.GetCapacity() == 0)
+          return;
+
+        const u64 start_time = Common::Timer::GetTimeUs();
+
+        std::vector<u8> state = s_rewind_ring.GetBuffer();
+        u8* ptr = nullptr;
+        PointerWrap p(&ptr, PointerWrap::MODE_MEASURE);
+        DoState(p);
+        state.resize(reinterpret_cast<size_t>(ptr));
+
+        ptr = state.data();
+        p.SetMode(PointerWrap::MODE_WRITE);
+        DoState(p);
+        if (p.GetMode() != PointerWrap::MODE_WRITE)
+          return;
+
+        // Diffing and compressing happen on the ring's worker.
+        s_rewind_ring.Push(std::move(state), Movie::GetCurrentFrame(),
+                           (Common::Timer::GetTimeUs() - start_time) / 1000.0);
+      },
+      true);
+}
+
+void OnFrameEnd()
+{
+  if (s_rewind_interval <= 0 || --s_frames_until_rewind_snapshot > 0)
+    return;
+
+  s_frames_until_rewind_snapshot = s_rewind_interval;
+  SaveRewindSnapshot();
+}
+
+bool Rewind()
+{
+  if (NetPlay::IsNetPlayRunning())
+  {
+    OSD::AddMessage("Loading savestates is disabled in Netplay to prevent desyncs");
+    return false;
+  }
+
+  bool success = false;
+  Core::RunOnCPUThread(
+      [&] {
+        if (s_rewind_ring.GetSize() == 0)
+        {
+          Core::DisplayMessage("No rewind snapshots left", 2000);
+          return;
+        }
+
+        std::vector<u8> state;
+        if (!s_rewind_ring.Pop(&state))
+        {
+          Core::DisplayMessage("Failed to decompress rewind snapshot", 4000);
+          return;
+        }
+
+        u8* ptr = state.data();
+        PointerWrap p(&ptr, PointerWrap::MODE_READ);
+        DoState(p);
+        success = p.GetMode() == PointerWrap::MODE_READ;
+        if (!success)
+        {
+          Core::DisplayMessage("Failed to load rewind snapshot", 4000);
+          return;
+        }
+
+        s_frames_until_rewind_snapshot = s_rewind_interval;
+      },
+      true);
+
+  return success;
+}
+
+size_t GetRewindSnapshotCount()
+{
+  return s_rewind_ring.GetSize();
+}
+
+RewindStats GetRewindStats()
+{
+  return s_rewind_ring.GetStats();
+}
+
 // return state number not in map
 static int GetEmptySlot(std::map<double, int> m)
 {
@@ -296,6 +440,175 @@ static std::map<double, int> GetSavedStates()
   return m;
 }
 
+// Splits [0, num_chunks) into one contiguous range per thread of the compression thread pool and
+// calls func(start, end) for each range in parallel.
+template <typename Func>
+static void ForEachChunkRangeInParallel(size_t num_chunks, Func func)
+{
+  const size_t ranges = std::min(num_chunks, s_compression_thread_pool->GetThreadCount());
+  s_compression_thread_pool->ParallelFor(ranges, [&](size_t i) {
+    func(i * num_chunks / ranges, (i + 1) * num_chunks / ranges);
+  });
+}
+
+static size_t GetChunkLength(size_t buffer_size, size_t chunk)
+{
+  return std::min<size_t>(ZSTD_CHUNK_SIZE, buffer_size - chunk * ZSTD_CHUNK_SIZE);
+}
+
+static bool WriteCompressedState(File::IOFile& f, const u8* buffer_data, size_t buffer_size)
+{
+  const size_t num_chunks = (buffer_size + ZSTD_CHUNK_SIZE - 1) / ZSTD_CHUNK_SIZE;
+  std::vector<std::vector<u8>> chunks(num_chunks);
+  std::atomic<bool> success{true};
+
+  ForEachChunkRangeInParallel(num_chunks, [&](size_t start, size_t end) {
+    ZSTD_CCtx* context = ZSTD_createCCtx();
+    for (size_t i = start; i < end && success; ++i)
+    {
+      const size_t in_len = GetChunkLength(buffer_size, i);
+      std::vector<u8>& chunk = chunks[i];
+      chunk.resize(ZSTD_compressBound(in_len));
+
+      const size_t out_len =
+          ZSTD_compressCCtx(context, chunk.data(), chunk.size(), buffer_data + i * ZSTD_CHUNK_SIZE,
+                            in_len, ZSTD_COMPRESSION_LEVEL);
+      if (ZSTD_isError(out_len))
+        success = false;
+      else
+        chunk.resize(out_len);
+    }
+    ZSTD_freeCCtx(context);
+  });
+
+  if (!success)
+  {
+    PanicAlertT("Internal zstd Error - compression failed");
+    return false;
+  }
+
+  const ZstdStateIndexHeader index_header{ZSTD_STATE_COOKIE, static_cast<u32>(buffer_size),
+                                          ZSTD_CHUNK_SIZE, static_cast<u32>(num_chunks)};
+  std::vector<u32> compressed_sizes(num_chunks);
+  for (size_t i = 0; i < num_chunks; ++i)
+    compressed_sizes[i] = static_cast<u32>(chunks[i].size());
+
+  if (!f.WriteArray(&index_header, 1) || !f.WriteArray(compressed_sizes.data(), num_chunks))
+    return false;
+
+  for (const std::vector<u8>& chunk : chunks)
+  {
+    if (!f.WriteBytes(chunk.data(), chunk.size()))
+      return false;
+  }
+
+  return true;
+}
+
+static bool ReadCompressedState(File::IOFile& f, std::vector<u8>& buffer)
+{
+  ZstdStateIndexHeader index_header;
+  if (!f.ReadArray(&index_header, 1) || index_header.cookie != ZSTD_STATE_COOKIE ||
+      index_header.chunk_size != ZSTD_CHUNK_SIZE)
+  {
+    return false;
+  }
+
+  const size_t uncompressed_size = index_header.uncompressed_size;
+  const size_t num_chunks = index_header.num_chunks;
+  if (num_chunks != (uncompressed_size + ZSTD_CHUNK_SIZE - 1) / ZSTD_CHUNK_SIZE)
+    return false;
+
+  // Nothing is allocated based on the index before checking it against the size of the file.
+  const u64 remaining_size = f.GetSize() - f.Tell();
+  if (num_chunks * sizeof(u32) > remaining_size)
+    return false;
+
+  std::vector<u32> compressed_sizes(num_chunks);
+  if (!f.ReadArray(compressed_sizes.data(), num_chunks))
+    return false;
+
+  // The index makes every chunk seekable, so all of the compressed data is read at once and
+  // each thread decompresses its chunks straight into their final place in the buffer.
+  std::vector<u64> offsets(num_chunks + 1);
+  for (size_t i = 0; i < num_chunks; ++i)
+  {
+    if (compressed_sizes[i] > ZSTD_compressBound(GetChunkLength(uncompressed_size, i)))
+      return false;
+    offsets[i + 1] = offsets[i] + compressed_sizes[i];
+  }
+  if (offsets[num_chunks] != remaining_size - num_chunks * sizeof(u32))
+    return false;
+
+  std::vector<u8> compressed_data(offsets[num_chunks]);
+  if (!f.ReadBytes(compressed_data.data(), compressed_data.size()))
+    return false;
+
+  // Every chunk's frame records how large it is once decompressed. Check those against the size
+  // from the index before allocating the buffer, so that its size is backed by data in the file.
+  for (size_t i = 0; i < num_chunks; ++i)
+  {
+    if (ZSTD_getFrameContentSize(compressed_data.data() + offsets[i], compressed_sizes[i]) !=
+        GetChunkLength(uncompressed_size, i))
+    {
+      return false;
+    }
+  }
+
+  buffer.resize(uncompressed_size);
+  std::atomic<bool> success{true};
+
+  ForEachChunkRangeInParallel(num_chunks, [&](size_t start, size_t end) {
+    ZSTD_DCtx* context = ZSTD_createDCtx();
+    for (size_t i = start; i < end && success; ++i)
+    {
+      const size_t out_len = GetChunkLength(uncompressed_size, i);
+      const size_t result =
+          ZSTD_decompressDCtx(context, buffer.data() + i * ZSTD_CHUNK_SIZE, out_len,
+                              compressed_data.data() + offsets[i], compressed_sizes[i]);
+      if (ZSTD_isError(result) || result != out_len)
+        success = false;
+    }
+    ZSTD_freeDCtx(context);
+  });
+
+  return success;
+}
+
+static bool ReadLZOCompressedState(File::IOFile& f, std::vector<u8>& buffer)
+{
+  lzo_uint i = 0;
+  while (true)
+  {
+    lzo_uint32 cur_len = 0;  // number of bytes to read
+    lzo_uint new_len = 0;    // number of bytes to write
+
+    if (!f.ReadArray(&cur_len, 1))
+      break;
+
+    if (cur_len > OUT_LEN || !f.ReadBytes(out, cur_len))
+    {
+      PanicAlertT("Internal LZO Error - the state is corrupted");
+      return false;
+    }
+
+    new_len = buffer.size() - i;
+    const int res = lzo1x_decompress_safe(out, cur_len, buffer.data() + i, &new_len, nullptr);
+    if (res != LZO_E_OK)
+    {
+      // This doesn't seem to happen anymore.
+      PanicAlertT("Internal LZO Error - decompression failed (%d) (%li, %li) \n"
+                  "Try loading the state again",
+                  res, i, new_len);
+      return false;
+    }
+
+    i += new_len;
+  }
+
+  return true;
+}
+
 struct CompressAndDumpState_args
 {
   std::vector<u8>* buffer_vector;
@@ -357,39 +670,17 @@ static void CompressAndDumpState(CompressAndDumpState_args save_args)
   // Setting up the header
   StateHeader header;
   strncpy(header.gameID, SConfig::GetInstance().GetGameID().c_str(), 6);
-  header.size = g_use_compression ? (u32)buffer_size : 0;
+  header.size = 0;
   header.time = Common::Timer::GetDoubleTime();
 
   f.WriteArray(&header, 1);
 
-  if (header.size != 0)  // non-zero header size means the state is compressed
+  if (g_use_compression)
   {
-    lzo_uint i = 0;
-    while (true)
+    if (!WriteCompressedState(f, buffer_data, buffer_size))
     {
-      lzo_uint32 cur_len = 0;
-      lzo_uint out_len = 0;
-
-      if ((i + IN_LEN) >= buffer_size)
-      {
-        cur_len = (lzo_uint32)(buffer_size - i);
-      }
-      else
-      {
-        cur_len = IN_LEN;
-      }
-
-      if (lzo1x_1_compress(buffer_data + i, cur_len, out, &out_len, wrkmem) != LZO_E_OK)
-        PanicAlertT("Internal LZO Error - compression failed");
-
-      // The size of the data to write is 'out_len'
-      f.WriteArray((lzo_uint32*)&out_len, 1);
-      f.WriteBytes(out, out_len);
-
-      if (cur_len != IN_LEN)
-        break;
-
-      i += cur_len;
+      Core::DisplayMessage("Could not save state", 4000);
+      return;
     }
   }
   else  // uncompressed
@@ -497,31 +788,24 @@ static void LoadFileStateData(const std::string& filename, std::vector<u8>& ret_
 
   std::vector<u8> buffer;
 
-  if (header.size != 0)  // non-zero size means the state is compressed
+  u32 cookie = 0;
+  f.ReadArray(&cookie, 1);
+  f.Seek(sizeof(StateHeader), SEEK_SET);
+
+  if (header.size != 0)  // non-zero size means the state is compressed with LZO
   {
     buffer.resize(header.size);
 
-    lzo_uint i = 0;
-    while (true)
+    if (!ReadLZOCompressedState(f, buffer))
+      return;
+  }
+  else if (cookie == ZSTD_STATE_COOKIE)
+  {
+    if (!ReadCompressedState(f, buffer))
     {
-      lzo_uint32 cur_len = 0;  // number of bytes to read
-      lzo_uint new_len = 0;    // number of bytes to write
-
-      if (!f.ReadArray(&cur_len, 1))
-        break;
-
-      f.ReadBytes(out, cur_len);
-      const int res = lzo1x_decompress(out, cur_len, &buffer[i], &new_len, nullptr);
-      if (res != LZO_E_OK)
-      {
-        // This doesn't seem to happen anymore.
-        PanicAlertT("Internal LZO Error - decompression failed (%d) (%li, %li) \n"
-                    "Try loading the state again",
-                    res, i, new_len);
-        return;
-      }
-
-      i += new_len;
+      PanicAlertT("Internal zstd Error - decompression failed\n"
+                  "Try loading the state again");
+      return;
     }
   }
   else  // uncompressed
@@ -622,12 +906,21 @@ void Init()
 {
   if (lzo_init() != LZO_E_OK)
     PanicAlertT("Internal LZO Error - lzo_init() failed");
+
+  s_compression_thread_pool = std::make_unique<Common::ThreadPool>("State compression");
+
+  s_rewind_interval = Config::Get(Config::MAIN_REWIND_INTERVAL);
+  s_frames_until_rewind_snapshot = s_rewind_interval;
+  SetRewindCapacity(std::max(Config::Get(Config::MAIN_REWIND_SNAPSHOTS), 0));
 }
 
 void Shutdown()
 {
   Flush();
 
+  SetRewindCapacity(0);
+  s_compression_thread_pool.reset();
+
   // swapping with an empty vector, rather than clear()ing
   // this gives a better guarantee to free the allocated memory right NOW (as opposed to, actually,
   // never)
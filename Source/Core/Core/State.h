@@ -20,6 +20,7 @@ static const u32 NUM_STATES = 10;
 struct StateHeader
 {
   char gameID[6];
+  // The uncompressed size of LZO compressed states. 0 for uncompressed and zstd compressed states.
   u32 size;
   double time;
 };
@@ -50,6 +51,32 @@ void LoadAs(const std::string& filename);
 void SaveToBuffer(std::vector<u8>& buffer);
 void LoadFromBuffer(std::vector<u8>& buffer);
 
+// Rewind keeps an in-memory ring of recent states. Each snapshot only stores the pages of the
+// serialized state that differ from the most recent keyframe, compressed with zstd.
+struct RewindStats
+{
+  u64 snapshots = 0;
+  u64 keyframes = 0;
+  // Snapshots that were dropped because the worker was still busy with the previous one.
+  u64 dropped_snapshots = 0;
+  u64 frames = 0;
+  u64 compressed_bytes = 0;
+  // Time spent serializing on the CPU thread, and diffing and compressing on the worker.
+  double capture_ms = 0.0;
+  double compress_ms = 0.0;
+};
+
+// Keeps at most max_snapshots snapshots. Passing 0 disables rewind and frees all snapshots.
+void SetRewindCapacity(size_t max_snapshots);
+void SaveRewindSnapshot();
+// Saves a snapshot every Core.RewindInterval frames. Called from the CPU thread.
+void OnFrameEnd();
+// Loads the most recent snapshot and removes it from the ring. Returns false if there is none or
+// it couldn't be loaded, which is reported on screen.
+bool Rewind();
+size_t GetRewindSnapshotCount();
+RewindStats GetRewindStats();
+
 void LoadLastSaved(int i = 1);
 void SaveFirstSaved();
 void UndoSaveState();
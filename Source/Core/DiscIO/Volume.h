@@ -117,7 +117,8 @@ public:
   virtual bool IsDatelDisc() const = 0;
   virtual bool SupportsIntegrityCheck() const { return false; }
   virtual bool CheckH3TableIntegrity(const Partition& partition) const { return false; }
-  virtual bool CheckBlockIntegrity(u64 block_index, const std::vector<u8>& encrypted_data,
+  // encrypted_data must contain BLOCK_TOTAL_SIZE bytes.
+  virtual bool CheckBlockIntegrity(u64 block_index, const u8* encrypted_data,
                                    const Partition& partition) const
   {
     return false;
@@ -17,7 +17,6 @@
 #include <unordered_set>
 
 #include <mbedtls/md5.h>
-#include <mbedtls/sha1.h>
 #include <pugixml.hpp>
 #include <unzip.h>
 #include <zlib.h>
@@ -35,6 +34,7 @@
 #include "Common/ScopeGuard.h"
 #include "Common/StringUtil.h"
 #include "Common/Swap.h"
+#include "Common/ThreadPool.h"
 #include "Common/Version.h"
 #include "Core/IOS/Device.h"
 #include "Core/IOS/ES/ES.h"
@@ -361,7 +361,8 @@ constexpr u64 SL_DVD_R_SIZE = 4707319808;  // Wii RVT-R
 constexpr u64 DL_DVD_SIZE = 8511160320;    // Wii retail
 constexpr u64 DL_DVD_R_SIZE = 8543666176;  // Wii RVT-R
 
-constexpr u64 BLOCK_SIZE = 0x20000;
+// Big enough that a chunk contains many Wii blocks, which are verified in parallel
+constexpr u64 BLOCK_SIZE = 0x200000;
 
 VolumeVerifier::VolumeVerifier(const Volume& volume, bool redump_verification,
                                Hashes<bool> hashes_to_calculate)
@@ -1061,11 +1062,8 @@ void VolumeVerifier::SetUpHashing()
     mbedtls_md5_starts_ret(&m_md5_context);
   }
 
-  if (m_hashes_to_calculate.sha1)
-  {
-    mbedtls_sha1_init(&m_sha1_context);
-    mbedtls_sha1_starts_ret(&m_sha1_context);
-  }
+  if (!m_blocks.empty())
+    m_block_thread_pool = std::make_unique<Common::ThreadPool>("Block verifier");
 }
 
 void VolumeVerifier::WaitForAsyncOperations() const
@@ -1122,7 +1120,16 @@ void VolumeVerifier::Process()
   }
   else if (m_block_index < m_blocks.size() && m_blocks[m_block_index].offset == m_progress)
   {
-    bytes_to_read = VolumeWii::BLOCK_TOTAL_SIZE;
+    // Read as many consecutive blocks as fit in a chunk
+    size_t block_count = 1;
+    while (m_block_index + block_count < m_blocks.size() &&
+           (block_count + 1) * VolumeWii::BLOCK_TOTAL_SIZE <= BLOCK_SIZE &&
+           m_blocks[m_block_index + block_count].offset ==
+               m_progress + block_count * VolumeWii::BLOCK_TOTAL_SIZE)
+    {
+      block_count++;
+    }
+    bytes_to_read = block_count * VolumeWii::BLOCK_TOTAL_SIZE;
     block_read = true;
   }
   else if (m_block_index < m_blocks.size() && m_blocks[m_block_index].offset > m_progress)
@@ -1163,9 +1170,8 @@ void VolumeVerifier::Process()
 
     if (m_hashes_to_calculate.sha1)
     {
-      m_sha1_future = std::async(std::launch::async, [this] {
-        mbedtls_sha1_update_ret(&m_sha1_context, m_data.data(), m_data.size());
-      });
+      m_sha1_future = std::async(std::launch::async,
+                                 [this] { m_sha1_context.Update(m_data.data(), m_data.size()); });
     }
   }
 
@@ -1186,55 +1192,59 @@ void VolumeVerifier::Process()
   if (m_block_index < m_blocks.size() &&
       m_blocks[m_block_index].offset < m_progress + bytes_to_read)
   {
+    size_t end_index = m_block_index;
+    while (end_index < m_blocks.size() && m_blocks[end_index].offset < m_progress + bytes_to_read)
+      end_index++;
+
     m_block_future = std::async(
         std::launch::async,
-        [this, read_succeeded, bytes_to_read](size_t block_index, u64 progress) {
-          while (block_index < m_blocks.size() &&
-                 m_blocks[block_index].offset < progress + bytes_to_read)
-          {
-            bool success;
-            if (m_blocks[block_index].offset == progress)
+        [this, read_succeeded, bytes_to_read](size_t begin_index, size_t count, u64 progress) {
+          const std::unique_ptr<bool[]> results = std::make_unique<bool[]>(count);
+
+          m_block_thread_pool->ParallelFor(count, [&](size_t i) {
+            const BlockToVerify& block = m_blocks[begin_index + i];
+            if (block.offset >= progress &&
+                block.offset + VolumeWii::BLOCK_TOTAL_SIZE <= progress + bytes_to_read)
             {
-              success = read_succeeded &&
-                        m_volume.CheckBlockIntegrity(m_blocks[block_index].block_index, m_data,
-                                                     m_blocks[block_index].partition);
+              results[i] = read_succeeded &&
+                           m_volume.CheckBlockIntegrity(block.block_index,
+                                                        m_data.data() + (block.offset - progress),
+                                                        block.partition);
             }
             else
             {
               std::lock_guard lk(m_volume_mutex);
-              success = m_volume.CheckBlockIntegrity(m_blocks[block_index].block_index,
-                                                     m_blocks[block_index].partition);
+              results[i] = m_volume.CheckBlockIntegrity(block.block_index, block.partition);
             }
+          });
 
-            const u64 offset = m_blocks[block_index].offset;
-            if (success)
+          for (size_t i = 0; i < count; ++i)
+          {
+            const BlockToVerify& block = m_blocks[begin_index + i];
+            if (results[i])
             {
               m_biggest_verified_offset =
-                  std::max(m_biggest_verified_offset, offset + VolumeWii::BLOCK_TOTAL_SIZE);
+                  std::max(m_biggest_verified_offset, block.offset + VolumeWii::BLOCK_TOTAL_SIZE);
             }
             else
             {
-              if (m_scrubber.CanBlockBeScrubbed(offset))
+              if (m_scrubber.CanBlockBeScrubbed(block.offset))
               {
-                WARN_LOG(DISCIO, "Integrity check failed for unused block at 0x%" PRIx64, offset);
-                m_unused_block_errors[m_blocks[block_index].partition]++;
+                WARN_LOG(DISCIO, "Integrity check failed for unused block at 0x%" PRIx64,
+                         block.offset);
+                m_unused_block_errors[block.partition]++;
               }
               else
               {
-                WARN_LOG(DISCIO, "Integrity check failed for block at 0x%" PRIx64, offset);
-                m_block_errors[m_blocks[block_index].partition]++;
+                WARN_LOG(DISCIO, "Integrity check failed for block at 0x%" PRIx64, block.offset);
+                m_block_errors[block.partition]++;
               }
             }
-            block_index++;
           }
         },
-        m_block_index, m_progress);
+        m_block_index, end_index - m_block_index, m_progress);
 
-    while (m_block_index < m_blocks.size() &&
-           m_blocks[m_block_index].offset < m_progress + bytes_to_read)
-    {
-      m_block_index++;
-    }
+    m_block_index = end_index;
   }
 
   m_progress += bytes_to_read;
@@ -1276,8 +1286,8 @@ void VolumeVerifier::Finish()
 
     if (m_hashes_to_calculate.sha1)
     {
-      m_result.hashes.sha1 = std::vector<u8>(20);
-      mbedtls_sha1_finish_ret(&m_sha1_context, m_result.hashes.sha1.data());
+      const Common::SHA1::Digest sha1 = m_sha1_context.Finish();
+      m_result.hashes.sha1 = std::vector<u8>(sha1.begin(), sha1.end());
     }
   }
 
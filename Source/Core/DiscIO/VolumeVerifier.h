@@ -6,15 +6,16 @@
 
 #include <future>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
 #include <vector>
 
 #include <mbedtls/md5.h>
-#include <mbedtls/sha1.h>
 
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
 #include "Core/IOS/ES/Formats.h"
 #include "DiscIO/DiscScrubber.h"
 #include "DiscIO/Volume.h"
@@ -32,6 +33,11 @@
 //
 // GetResult() can be called before the processing is finished, but the result will be incomplete.
 
+namespace Common
+{
+class ThreadPool;
+}
+
 namespace DiscIO
 {
 class FileInfo;
@@ -180,10 +186,11 @@ private:
   bool m_calculating_any_hash = false;
   unsigned long m_crc32_context = 0;
   mbedtls_md5_context m_md5_context;
-  mbedtls_sha1_context m_sha1_context;
+  Common::SHA1::Context m_sha1_context;
 
   std::vector<u8> m_data;
   std::mutex m_volume_mutex;
+  std::unique_ptr<Common::ThreadPool> m_block_thread_pool;
   std::future<void> m_crc32_future;
   std::future<void> m_md5_future;
   std::future<void> m_sha1_future;
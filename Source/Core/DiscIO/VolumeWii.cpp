@@ -18,11 +18,11 @@
 #include <vector>
 
 #include <mbedtls/aes.h>
-#include <mbedtls/sha1.h>
 
 #include "Common/Align.h"
 #include "Common/Assert.h"
 #include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
 #include "Common/Swap.h"
@@ -37,6 +37,16 @@
 
 namespace DiscIO
 {
+namespace
+{
+void CalculateSHA1(const void* data, size_t size, u8* out)
+{
+  const Common::SHA1::Digest digest =
+      Common::SHA1::CalculateDigest(static_cast<const u8*>(data), size);
+  std::memcpy(out, digest.data(), digest.size());
+}
+}  // namespace
+
 VolumeWii::VolumeWii(std::unique_ptr<BlobReader> reader)
     : m_reader(std::move(reader)), m_game_partition(PARTITION_NONE),
       m_last_decrypted_block(UINT64_MAX)
@@ -448,17 +458,12 @@ bool VolumeWii::CheckH3TableIntegrity(const Partition& partition) const
   if (contents.size() != 1)
     return false;
 
-  std::array<u8, 20> h3_table_sha1;
-  mbedtls_sha1_ret(h3_table.data(), h3_table.size(), h3_table_sha1.data());
-  return h3_table_sha1 == contents[0].sha1;
+  return Common::SHA1::CalculateDigest(h3_table.data(), h3_table.size()) == contents[0].sha1;
 }
 
-bool VolumeWii::CheckBlockIntegrity(u64 block_index, const std::vector<u8>& encrypted_data,
+bool VolumeWii::CheckBlockIntegrity(u64 block_index, const u8* encrypted_data,
                                     const Partition& partition) const
 {
-  if (encrypted_data.size() != BLOCK_TOTAL_SIZE)
-    return false;
-
   auto it = m_partitions.find(partition);
   if (it == m_partitions.end())
     return false;
@@ -472,32 +477,33 @@ bool VolumeWii::CheckBlockIntegrity(u64 block_index, const std::vector<u8>& encr
     return false;
 
   HashBlock hashes;
-  DecryptBlockHashes(encrypted_data.data(), &hashes, aes_context);
+  DecryptBlockHashes(encrypted_data, &hashes, aes_context);
 
   u8 cluster_data[BLOCK_DATA_SIZE];
-  DecryptBlockData(encrypted_data.data(), cluster_data, aes_context);
+  DecryptBlockData(encrypted_data, cluster_data, aes_context);
 
   for (u32 hash_index = 0; hash_index < 31; ++hash_index)
   {
-    u8 h0_hash[SHA1_SIZE];
-    mbedtls_sha1_ret(cluster_data + hash_index * 0x400, 0x400, h0_hash);
-    if (memcmp(h0_hash, hashes.h0[hash_index], SHA1_SIZE))
+    const Common::SHA1::Digest h0_hash =
+        Common::SHA1::CalculateDigest(cluster_data + hash_index * 0x400, 0x400);
+    if (memcmp(h0_hash.data(), hashes.h0[hash_index], SHA1_SIZE))
       return false;
   }
 
-  u8 h1_hash[SHA1_SIZE];
-  mbedtls_sha1_ret(reinterpret_cast<u8*>(hashes.h0), sizeof(hashes.h0), h1_hash);
-  if (memcmp(h1_hash, hashes.h1[block_index % 8], SHA1_SIZE))
+  const Common::SHA1::Digest h1_hash = Common::SHA1::CalculateDigest(
+      reinterpret_cast<const u8*>(hashes.h0), sizeof(hashes.h0));
+  if (memcmp(h1_hash.data(), hashes.h1[block_index % 8], SHA1_SIZE))
     return false;
 
-  u8 h2_hash[SHA1_SIZE];
-  mbedtls_sha1_ret(reinterpret_cast<u8*>(hashes.h1), sizeof(hashes.h1), h2_hash);
-  if (memcmp(h2_hash, hashes.h2[block_index / 8 % 8], SHA1_SIZE))
+  const Common::SHA1::Digest h2_hash = Common::SHA1::CalculateDigest(
+      reinterpret_cast<const u8*>(hashes.h1), sizeof(hashes.h1));
+  if (memcmp(h2_hash.data(), hashes.h2[block_index / 8 % 8], SHA1_SIZE))
     return false;
 
-  u8 h3_hash[SHA1_SIZE];
-  mbedtls_sha1_ret(reinterpret_cast<u8*>(hashes.h2), sizeof(hashes.h2), h3_hash);
-  if (memcmp(h3_hash, partition_details.h3_table->data() + block_index / 64 * SHA1_SIZE, SHA1_SIZE))
+  const Common::SHA1::Digest h3_hash = Common::SHA1::CalculateDigest(
+      reinterpret_cast<const u8*>(hashes.h2), sizeof(hashes.h2));
+  if (memcmp(h3_hash.data(), partition_details.h3_table->data() + block_index / 64 * SHA1_SIZE,
+             SHA1_SIZE))
     return false;
 
   return true;
@@ -515,7 +521,7 @@ bool VolumeWii::CheckBlockIntegrity(u64 block_index, const Partition& partition)
   std::vector<u8> cluster(BLOCK_TOTAL_SIZE);
   if (!m_reader->Read(cluster_offset, cluster.size(), cluster.data()))
     return false;
-  return CheckBlockIntegrity(block_index, cluster, partition);
+  return CheckBlockIntegrity(block_index, cluster.data(), partition);
 }
 
 bool VolumeWii::HashGroup(const std::array<u8, BLOCK_DATA_SIZE> in[BLOCKS_PER_GROUP],
@@ -537,14 +543,13 @@ bool VolumeWii::HashGroup(const std::array<u8, BLOCK_DATA_SIZE> in[BLOCKS_PER_GR
       {
         // H0 hashes
         for (size_t j = 0; j < 31; ++j)
-          mbedtls_sha1_ret(in[i].data() + j * 0x400, 0x400, out[i].h0[j]);
+          CalculateSHA1(in[i].data() + j * 0x400, 0x400, out[i].h0[j]);
 
         // H0 padding
         std::memset(out[i].padding_0, 0, sizeof(HashBlock::padding_0));
 
         // H1 hash
-        mbedtls_sha1_ret(reinterpret_cast<u8*>(out[i].h0), sizeof(HashBlock::h0),
-                         out[h1_base].h1[i - h1_base]);
+        CalculateSHA1(out[i].h0, sizeof(HashBlock::h0), out[h1_base].h1[i - h1_base]);
       }
 
       if (i % 8 == 7)
@@ -562,8 +567,7 @@ bool VolumeWii::HashGroup(const std::array<u8, BLOCK_DATA_SIZE> in[BLOCKS_PER_GR
             std::memcpy(out[h1_base + j].h1, out[h1_base].h1, sizeof(HashBlock::h1));
 
           // H2 hash
-          mbedtls_sha1_ret(reinterpret_cast<u8*>(out[i].h1), sizeof(HashBlock::h1),
-                           out[0].h2[h1_base / 8]);
+          CalculateSHA1(out[i].h1, sizeof(HashBlock::h1), out[0].h2[h1_base / 8]);
         }
 
         if (i == BLOCKS_PER_GROUP - 1)
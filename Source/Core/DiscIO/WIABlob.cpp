@@ -6,13 +6,20 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
 #include <cinttypes>
+#include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <functional>
+#include <future>
 #include <limits>
+#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <thread>
 #include <type_traits>
 #include <utility>
 
@@ -25,10 +32,12 @@
 #include "Common/File.h"
 #include "Common/FileUtil.h"
 #include "Common/Logging/Log.h"
+#include "Common/MathUtil.h"
 #include "Common/MsgHandler.h"
 #include "Common/ScopeGuard.h"
 #include "Common/StringUtil.h"
 #include "Common/Swap.h"
+#include "Common/Thread.h"
 
 #include "DiscIO/Blob.h"
 #include "DiscIO/DiscExtractor.h"
@@ -42,6 +51,114 @@
 
 namespace DiscIO
 {
+// How many groups can be decompressed ahead of time but not used yet. The reader decompresses
+// further ahead the longer it has been reading groups in order.
+constexpr u64 MAX_PREFETCHED_GROUPS = 4;
+
+// The groups that have been used recently and the prefetched groups take up at most this much
+// memory, not counting the compressed data
+constexpr u64 GROUP_CACHE_SIZE = 32 * 1024 * 1024;
+constexpr size_t MAX_CACHED_GROUPS = 64;
+
+static u64 GetTimeUs()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+template <size_t N>
+static void AddToHistogram(std::array<u64, N>* histogram, u64 us)
+{
+  const size_t bucket = us == 0 ? 0 : static_cast<size_t>(IntLog2(us)) + 1;
+  (*histogram)[std::min(bucket, N - 1)]++;
+}
+
+template <size_t N>
+static std::string HistogramToString(const std::array<u64, N>& histogram)
+{
+  std::string result;
+  for (size_t i = 0; i < N; ++i)
+  {
+    if (histogram[i] == 0)
+      continue;
+
+    if (!result.empty())
+      result += ", ";
+    if (i == 0)
+      result += StringFromFormat("<1 us: %" PRIu64, histogram[i]);
+    else
+      result += StringFromFormat("%" PRIu64 " us: %" PRIu64, u64(1) << (i - 1), histogram[i]);
+  }
+  return result;
+}
+
+// Decompresses groups ahead of time for all WIA and RVZ readers. Readers that are used at the same
+// time, like a running game and a disc being verified, share the workers instead of each waiting
+// on one thread of its own, and the groups of one reader are decompressed in parallel.
+class PrefetchPool
+{
+public:
+  static PrefetchPool& GetInstance()
+  {
+    static PrefetchPool pool;
+    return pool;
+  }
+
+  void Push(std::function<void()> job)
+  {
+    {
+      std::lock_guard lk(m_mutex);
+      m_jobs.push_back(std::move(job));
+    }
+    m_job_available.notify_one();
+  }
+
+private:
+  PrefetchPool()
+  {
+    const unsigned int num_workers = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    for (unsigned int i = 0; i < num_workers; ++i)
+      m_workers.emplace_back([this] { WorkerLoop(); });
+  }
+
+  // Runs the queued jobs before stopping
+  ~PrefetchPool()
+  {
+    {
+      std::lock_guard lk(m_mutex);
+      m_shutdown = true;
+    }
+    m_job_available.notify_all();
+    for (std::thread& worker : m_workers)
+      worker.join();
+  }
+
+  void WorkerLoop()
+  {
+    Common::SetCurrentThreadName("WIA prefetch");
+    while (true)
+    {
+      std::function<void()> job;
+      {
+        std::unique_lock lk(m_mutex);
+        m_job_available.wait(lk, [this] { return m_shutdown || !m_jobs.empty(); });
+        if (m_jobs.empty())
+          return;
+        job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+      }
+      job();
+    }
+  }
+
+  std::vector<std::thread> m_workers;
+  std::mutex m_mutex;
+  std::condition_variable m_job_available;
+  std::deque<std::function<void()>> m_jobs;
+  bool m_shutdown = false;
+};
+
 static void PushBack(std::vector<u8>* vector, const u8* begin, const u8* end)
 {
   const size_t offset_in_vector = vector->size();
@@ -84,7 +201,30 @@ WIARVZFileReader<RVZ>::WIARVZFileReader(File::IOFile file, const std::string& pa
 }
 
 template <bool RVZ>
-WIARVZFileReader<RVZ>::~WIARVZFileReader() = default;
+WIARVZFileReader<RVZ>::~WIARVZFileReader()
+{
+  // Jobs that a worker has already started read from m_file, so they have to finish first
+  for (CachedGroup& cached_group : m_group_cache)
+    CancelPrefetch(&cached_group);
+  for (std::future<bool>& prefetch : m_running_prefetches)
+    prefetch.wait();
+
+  const GroupCacheStats& stats = m_group_cache_stats;
+  if (stats.lookups == 0)
+    return;
+
+  const auto percent = [&stats](u64 count) { return 100.0 * count / stats.lookups; };
+  INFO_LOG(DISCIO,
+           "Group cache: %" PRIu64 " lookups, %.1f%% hits, %.1f%% prefetch hits, "
+           "%.1f%% prefetch waits, %" PRIu64 " unused prefetches",
+           stats.lookups, percent(stats.hits), percent(stats.prefetch_hits),
+           percent(stats.prefetch_waits), stats.unused_prefetches);
+  INFO_LOG(DISCIO, "Group decompression times: %s",
+           HistogramToString(stats.decompression_us).c_str());
+  INFO_LOG(DISCIO, "Group prefetch wait times: %s", HistogramToString(stats.wait_us).c_str());
+  INFO_LOG(DISCIO, "Decompression times on the reading thread: %s",
+           HistogramToString(stats.sync_decompression_us).c_str());
+}
 
 template <bool RVZ>
 bool WIARVZFileReader<RVZ>::Initialize(const std::string& path)
@@ -151,6 +291,11 @@ bool WIARVZFileReader<RVZ>::Initialize(const std::string& path)
     return false;
   }
 
+  // The cache has to be able to hold the prefetched groups as well as the one being read
+  m_group_cache_capacity =
+      static_cast<size_t>(std::clamp<u64>(GROUP_CACHE_SIZE / std::max<u32>(chunk_size, 1),
+                                          MAX_PREFETCHED_GROUPS + 2, MAX_CACHED_GROUPS));
+
   const u32 compression_type = Common::swap32(m_header_2.compression_type);
   m_compression_type = static_cast<WIARVZCompressionType>(compression_type);
   if (m_compression_type > (RVZ ? WIARVZCompressionType::Zstd : WIARVZCompressionType::LZMA2) ||
@@ -498,6 +643,7 @@ bool WIARVZFileReader<RVZ>::ReadFromGroups(u64* offset, u64* size, u8** out_ptr,
   data_offset -= skipped_data;
   data_size += skipped_data;
 
+  const u64 group_size = chunk_size;
   const u64 start_group_index = (*offset - data_offset) / chunk_size;
   for (u64 i = start_group_index; i < number_of_groups && (*size) > 0; ++i)
   {
@@ -512,19 +658,10 @@ bool WIARVZFileReader<RVZ>::ReadFromGroups(u64* offset, u64* size, u8** out_ptr,
     chunk_size = std::min(chunk_size, data_size - group_offset_in_data);
 
     const u64 bytes_to_read = std::min(chunk_size - offset_in_group, *size);
-    u32 group_data_size = Common::swap32(group.data_size);
-
-    WIARVZCompressionType compression_type = m_compression_type;
-    u32 rvz_packed_size = 0;
-    if constexpr (RVZ)
-    {
-      if ((group_data_size & 0x80000000) == 0)
-        compression_type = WIARVZCompressionType::None;
-
-      group_data_size &= 0x7FFFFFFF;
-
-      rvz_packed_size = Common::swap32(group.rvz_packed_size);
-    }
+    u32 group_data_size;
+    u32 rvz_packed_size;
+    const WIARVZCompressionType compression_type =
+        GetGroupCompression(group, &group_data_size, &rvz_packed_size);
 
     if (group_data_size == 0)
     {
@@ -538,11 +675,16 @@ bool WIARVZFileReader<RVZ>::ReadFromGroups(u64* offset, u64* size, u8** out_ptr,
           ReadCompressedData(group_offset_in_file, group_data_size, chunk_size, compression_type,
                              exception_lists, rvz_packed_size, group_offset_in_data);
 
+      // Decompressing on this thread is the latency prefetching is meant to hide
+      const bool decompress = chunk.NeedsDecompression(offset_in_group, bytes_to_read);
+      const u64 start_time = decompress ? GetTimeUs() : 0;
       if (!chunk.Read(offset_in_group, bytes_to_read, *out_ptr))
       {
-        m_cached_chunk_offset = std::numeric_limits<u64>::max();  // Invalidate the cache
+        UncacheGroup(group_offset_in_file);
         return false;
       }
+      if (decompress)
+        AddToHistogram(&m_group_cache_stats.sync_decompression_us, GetTimeUs() - start_time);
 
       if (m_write_to_exception_list && m_exception_list_last_group_index != total_group_index)
       {
@@ -553,6 +695,8 @@ bool WIARVZFileReader<RVZ>::ReadFromGroups(u64* offset, u64* size, u8** out_ptr,
         chunk.GetHashExceptions(&m_exception_list, exception_list_index, additional_offset);
         m_exception_list_last_group_index = total_group_index;
       }
+
+      PrefetchGroups(group_size, data_size, group_index, number_of_groups, exception_lists, i);
     }
 
     *offset += bytes_to_read;
@@ -563,6 +707,115 @@ bool WIARVZFileReader<RVZ>::ReadFromGroups(u64* offset, u64* size, u8** out_ptr,
   return true;
 }
 
+template <bool RVZ>
+WIARVZCompressionType WIARVZFileReader<RVZ>::GetGroupCompression(const GroupEntry& group,
+                                                                 u32* group_data_size,
+                                                                 u32* rvz_packed_size) const
+{
+  *group_data_size = Common::swap32(group.data_size);
+  *rvz_packed_size = 0;
+
+  WIARVZCompressionType compression_type = m_compression_type;
+  if constexpr (RVZ)
+  {
+    if ((*group_data_size & 0x80000000) == 0)
+      compression_type = WIARVZCompressionType::None;
+
+    *group_data_size &= 0x7FFFFFFF;
+
+    *rvz_packed_size = Common::swap32(group.rvz_packed_size);
+  }
+
+  return compression_type;
+}
+
+template <bool RVZ>
+void WIARVZFileReader<RVZ>::PrefetchGroups(u64 chunk_size, u64 data_size, u32 group_index,
+                                           u32 number_of_groups, u32 exception_lists,
+                                           u64 current_group)
+{
+  // Files are stored contiguously on discs, so reading a file or streaming from one mostly shows
+  // up as reading groups in order. Random accesses end the run, which stops the prefetching.
+  const u64 total_group_index = group_index + current_group;
+  if (total_group_index == m_last_group_index + 1)
+    ++m_sequential_groups;
+  else if (total_group_index != m_last_group_index)
+    m_sequential_groups = 0;
+  m_last_group_index = total_group_index;
+
+  u64 prefetched_groups = std::count_if(m_group_cache.begin(), m_group_cache.end(),
+                                        [](const auto& g) { return g.prefetch.valid(); });
+
+  // The group that is being read stays the most recently used one, followed by the groups that
+  // are needed next in the order they're needed in
+  auto insert_position = std::next(m_group_cache.begin());
+
+  const u64 last_group =
+      std::min<u64>(current_group + std::min(m_sequential_groups, MAX_PREFETCHED_GROUPS),
+                    number_of_groups - 1);
+  for (u64 i = current_group + 1; i <= last_group; ++i)
+  {
+    if (prefetched_groups >= MAX_PREFETCHED_GROUPS || group_index + i >= m_group_entries.size())
+      break;
+
+    const GroupEntry& group = m_group_entries[group_index + i];
+    u32 group_data_size;
+    u32 rvz_packed_size;
+    const WIARVZCompressionType compression_type =
+        GetGroupCompression(group, &group_data_size, &rvz_packed_size);
+    if (group_data_size == 0)
+      continue;
+
+    const u64 group_offset_in_file = static_cast<u64>(Common::swap32(group.data_offset)) << 2;
+    const auto it = std::find_if(m_group_cache.begin(), m_group_cache.end(), [&](const auto& g) {
+      return g.offset_in_file == group_offset_in_file;
+    });
+    if (it != m_group_cache.end())
+    {
+      // Groups read since this one was queued have pushed it back, so move it up again
+      if (it->prefetch.valid())
+      {
+        m_group_cache.splice(insert_position, m_group_cache, it);
+        insert_position = std::next(it);
+      }
+      continue;
+    }
+
+    const u64 group_offset_in_data = i * chunk_size;
+    const auto cached_group = m_group_cache.emplace(insert_position);
+    insert_position = std::next(cached_group);
+    cached_group->offset_in_file = group_offset_in_file;
+    cached_group->chunk = CreateChunk(group_offset_in_file, group_data_size,
+                                      std::min(chunk_size, data_size - group_offset_in_data),
+                                      compression_type, exception_lists, rvz_packed_size,
+                                      group_offset_in_data);
+    cached_group->prefetch_job = std::make_shared<PrefetchJob>();
+    cached_group->prefetch_job->chunk = cached_group->chunk;
+    cached_group->prefetch = cached_group->prefetch_job->result.get_future();
+    PrefetchPool::GetInstance().Push(
+        [job = cached_group->prefetch_job] { RunPrefetchJob(job); });
+    ++prefetched_groups;
+  }
+
+  TrimGroupCache();
+}
+
+template <bool RVZ>
+void WIARVZFileReader<RVZ>::RunPrefetchJob(const std::shared_ptr<PrefetchJob>& job)
+{
+  auto expected = PrefetchJob::State::Queued;
+  if (!job->state.compare_exchange_strong(expected, PrefetchJob::State::Running))
+  {
+    job->result.set_value(false);
+    return;
+  }
+
+  const u64 start_time = GetTimeUs();
+  const bool success = job->chunk->DecompressAll();
+  job->decompression_us = GetTimeUs() - start_time;
+  job->result.set_value(success);
+}
+
 template <bool RVZ>
 typename WIARVZFileReader<RVZ>::Chunk&
 WIARVZFileReader<RVZ>::ReadCompressedData(u64 offset_in_file, u64 compressed_size,
@@ -570,9 +823,61 @@ WIARVZFileReader<RVZ>::ReadCompressedData(u64 offset_in_file, u64 compressed_siz
                                           WIARVZCompressionType compression_type,
                                           u32 exception_lists, u32 rvz_packed_size, u64 data_offset)
 {
-  if (offset_in_file == m_cached_chunk_offset)
-    return m_cached_chunk;
+  const auto it = std::find_if(m_group_cache.begin(), m_group_cache.end(), [&](const auto& g) {
+    return g.offset_in_file == offset_in_file;
+  });
+  if (it != m_group_cache.end() && it == m_group_cache.begin())
+    return *it->chunk;
+
+  ++m_group_cache_stats.lookups;
+  if (it != m_group_cache.end())
+  {
+    if (!it->prefetch.valid())
+    {
+      ++m_group_cache_stats.hits;
+      m_group_cache.splice(m_group_cache.begin(), m_group_cache, it);
+      return *it->chunk;
+    }
+
+    const u64 start_time = GetTimeUs();
+    const bool ready = it->prefetch.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    const std::shared_ptr<PrefetchJob> job = std::move(it->prefetch_job);
+    if (it->prefetch.get())
+    {
+      if (ready)
+      {
+        ++m_group_cache_stats.prefetch_hits;
+      }
+      else
+      {
+        ++m_group_cache_stats.prefetch_waits;
+        AddToHistogram(&m_group_cache_stats.wait_us, GetTimeUs() - start_time);
+      }
+      AddToHistogram(&m_group_cache_stats.decompression_us, job->decompression_us);
 
+      m_group_cache.splice(m_group_cache.begin(), m_group_cache, it);
+      return *it->chunk;
+    }
+
+    // Decompress the group again on this thread, so that the error gets handled like usual
+    m_group_cache.erase(it);
+  }
+
+  CachedGroup& cached_group = m_group_cache.emplace_front();
+  cached_group.offset_in_file = offset_in_file;
+  cached_group.chunk = CreateChunk(offset_in_file, compressed_size, decompressed_size,
+                                   compression_type, exception_lists, rvz_packed_size, data_offset);
+  TrimGroupCache();
+
+  return *cached_group.chunk;
+}
+
+template <bool RVZ>
+std::shared_ptr<typename WIARVZFileReader<RVZ>::Chunk>
+WIARVZFileReader<RVZ>::CreateChunk(u64 offset_in_file, u64 compressed_size, u64 decompressed_size,
+                                   WIARVZCompressionType compression_type, u32 exception_lists,
+                                   u32 rvz_packed_size, u64 data_offset)
+{
   std::unique_ptr<Decompressor> decompressor;
   switch (compression_type)
   {
@@ -601,11 +906,58 @@ WIARVZFileReader<RVZ>::ReadCompressedData(u64 offset_in_file, u64 compressed_siz
 
   const bool compressed_exception_lists = compression_type > WIARVZCompressionType::Purge;
 
-  m_cached_chunk =
-      Chunk(&m_file, offset_in_file, compressed_size, decompressed_size, exception_lists,
-            compressed_exception_lists, rvz_packed_size, data_offset, std::move(decompressor));
-  m_cached_chunk_offset = offset_in_file;
-  return m_cached_chunk;
+  return std::make_shared<Chunk>(&m_file, &m_file_mutex, offset_in_file, compressed_size,
+                                 decompressed_size, exception_lists, compressed_exception_lists,
+                                 rvz_packed_size, data_offset, std::move(decompressor));
+}
+
+template <bool RVZ>
+void WIARVZFileReader<RVZ>::TrimGroupCache()
+{
+  while (m_group_cache.size() > m_group_cache_capacity)
+  {
+    if (m_group_cache.back().prefetch.valid())
+      ++m_group_cache_stats.unused_prefetches;
+    CancelPrefetch(&m_group_cache.back());
+    m_group_cache.pop_back();
+  }
+}
+
+template <bool RVZ>
+void WIARVZFileReader<RVZ>::UncacheGroup(u64 offset_in_file)
+{
+  m_group_cache.remove_if([&](CachedGroup& g) {
+    if (g.offset_in_file != offset_in_file)
+      return false;
+    CancelPrefetch(&g);
+    return true;
+  });
+}
+
+template <bool RVZ>
+void WIARVZFileReader<RVZ>::CancelPrefetch(CachedGroup* cached_group)
+{
+  if (!cached_group->prefetch_job)
+    return;
+
+  auto expected = PrefetchJob::State::Queued;
+  if (cached_group->prefetch_job->state.compare_exchange_strong(expected,
+                                                                PrefetchJob::State::Cancelled))
+  {
+    return;
+  }
+
+  // The job keeps the chunk alive while it's running, so the group can be dropped right away, but
+  // the reader has to outlive the job
+  m_running_prefetches.erase(
+      std::remove_if(m_running_prefetches.begin(), m_running_prefetches.end(),
+                     [](const std::future<bool>& prefetch) {
+                       return prefetch.wait_for(std::chrono::seconds(0)) ==
+                              std::future_status::ready;
+                     }),
+      m_running_prefetches.end());
+  if (cached_group->prefetch.valid())
+    m_running_prefetches.push_back(std::move(cached_group->prefetch));
 }
 
 template <bool RVZ>
@@ -623,16 +975,15 @@ std::string WIARVZFileReader<RVZ>::VersionToString(u32 version)
 }
 
 template <bool RVZ>
-WIARVZFileReader<RVZ>::Chunk::Chunk() = default;
-
-template <bool RVZ>
-WIARVZFileReader<RVZ>::Chunk::Chunk(File::IOFile* file, u64 offset_in_file, u64 compressed_size,
-                                    u64 decompressed_size, u32 exception_lists,
-                                    bool compressed_exception_lists, u32 rvz_packed_size,
-                                    u64 data_offset, std::unique_ptr<Decompressor> decompressor)
-    : m_file(file), m_offset_in_file(offset_in_file), m_exception_lists(exception_lists),
-      m_compressed_exception_lists(compressed_exception_lists), m_rvz_packed_size(rvz_packed_size),
-      m_data_offset(data_offset), m_decompressor(std::move(decompressor))
+WIARVZFileReader<RVZ>::Chunk::Chunk(File::IOFile* file, std::mutex* file_mutex,
+                                    u64 offset_in_file, u64 compressed_size, u64 decompressed_size,
+                                    u32 exception_lists, bool compressed_exception_lists,
+                                    u32 rvz_packed_size, u64 data_offset,
+                                    std::unique_ptr<Decompressor> decompressor)
+    : m_file(file), m_file_mutex(file_mutex), m_offset_in_file(offset_in_file),
+      m_exception_lists(exception_lists), m_compressed_exception_lists(compressed_exception_lists),
+      m_rvz_packed_size(rvz_packed_size), m_data_offset(data_offset),
+      m_decompressor(std::move(decompressor))
 {
   constexpr size_t MAX_SIZE_PER_EXCEPTION_LIST =
       Common::AlignUp(VolumeWii::BLOCK_HEADER_SIZE, sizeof(SHA1)) / sizeof(SHA1) *
@@ -649,16 +1000,35 @@ WIARVZFileReader<RVZ>::Chunk::Chunk(File::IOFile* file, u64 offset_in_file, u64
 template <bool RVZ>
 bool WIARVZFileReader<RVZ>::Chunk::Read(u64 offset, u64 size, u8* out_ptr)
 {
-  if (!m_decompressor || !m_file ||
-      offset + size > m_out.data.size() - m_out_bytes_allocated_for_exceptions)
-  {
+  if (!DecompressUpTo(offset + size))
     return false;
-  }
 
-  while (offset + size > m_out.bytes_written - m_out_bytes_used_for_exceptions)
+  std::memcpy(out_ptr, m_out.data.data() + offset + m_out_bytes_used_for_exceptions, size);
+  return true;
+}
+
+template <bool RVZ>
+bool WIARVZFileReader<RVZ>::Chunk::NeedsDecompression(u64 offset, u64 size) const
+{
+  return offset + size > m_out.bytes_written - m_out_bytes_used_for_exceptions;
+}
+
+template <bool RVZ>
+bool WIARVZFileReader<RVZ>::Chunk::DecompressAll()
+{
+  return DecompressUpTo(m_out.data.size() - m_out_bytes_allocated_for_exceptions);
+}
+
+template <bool RVZ>
+bool WIARVZFileReader<RVZ>::Chunk::DecompressUpTo(u64 end)
+{
+  if (!m_decompressor || !m_file || end > m_out.data.size() - m_out_bytes_allocated_for_exceptions)
+    return false;
+
+  while (end > m_out.bytes_written - m_out_bytes_used_for_exceptions)
   {
     u64 bytes_to_read;
-    if (offset + size == m_out.data.size())
+    if (end == m_out.data.size())
     {
       // Read all the remaining data.
       bytes_to_read = m_in.data.size() - m_in.bytes_written;
@@ -670,8 +1040,7 @@ bool WIARVZFileReader<RVZ>::Chunk::Read(u64 offset, u64 size, u8* out_ptr)
 
       // The compressed data is probably not much bigger than the decompressed data.
       // Add a few bytes for possible compression overhead and for any hash exceptions.
-      bytes_to_read =
-          offset + size - (m_out.bytes_written - m_out_bytes_used_for_exceptions) + 0x100;
+      bytes_to_read = end - (m_out.bytes_written - m_out_bytes_used_for_exceptions) + 0x100;
 
       // Align the access in an attempt to gain speed. But we don't actually know the
       // block size of the underlying storage device, so we just use the Wii block size.
@@ -689,10 +1058,13 @@ bool WIARVZFileReader<RVZ>::Chunk::Read(u64 offset, u64 size, u8* out_ptr)
       return false;
     }
 
-    if (!m_file->Seek(m_offset_in_file, SEEK_SET))
-      return false;
-    if (!m_file->ReadBytes(m_in.data.data() + m_in.bytes_written, bytes_to_read))
-      return false;
+    {
+      std::lock_guard lk(*m_file_mutex);
+      if (!m_file->Seek(m_offset_in_file, SEEK_SET))
+        return false;
+      if (!m_file->ReadBytes(m_in.data.data() + m_in.bytes_written, bytes_to_read))
+        return false;
+    }
 
     m_offset_in_file += bytes_to_read;
     m_in.bytes_written += bytes_to_read;
@@ -751,7 +1123,6 @@ bool WIARVZFileReader<RVZ>::Chunk::Read(u64 offset, u64 size, u8* out_ptr)
     }
   }
 
-  std::memcpy(out_ptr, m_out.data.data() + offset + m_out_bytes_used_for_exceptions, size);
   return true;
 }
 
@@ -5,7 +5,10 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <future>
 #include <limits>
+#include <list>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -66,6 +69,28 @@ public:
                                       File::IOFile* outfile, WIARVZCompressionType compression_type,
                                       int compression_level, int chunk_size, CompressCB callback);
 
+  // How well decompressing groups ahead of time is working. Only groups that are read right after
+  // a different group count as lookups.
+  struct GroupCacheStats
+  {
+    // Bucket 0 counts durations below 1 us, bucket i durations in [2^(i-1), 2^i) us.
+    // The last bucket also counts everything longer.
+    using Histogram = std::array<u64, 24>;
+
+    u64 lookups = 0;
+    u64 hits = 0;            // The group had been read before and was still cached
+    u64 prefetch_hits = 0;   // The group had been decompressed ahead of time
+    u64 prefetch_waits = 0;  // The group was still being decompressed ahead of time
+    u64 unused_prefetches = 0;
+    Histogram decompression_us{};  // For the groups that were decompressed ahead of time
+    Histogram wait_us{};           // For the prefetch waits
+    // For the reads that had to decompress data on the reading thread, such as reads of groups
+    // that weren't prefetched
+    Histogram sync_decompression_us{};
+  };
+
+  const GroupCacheStats& GetGroupCacheStats() const { return m_group_cache_stats; }
+
 private:
   using SHA1 = std::array<u8, 20>;
   using WiiKey = std::array<u8, 16>;
@@ -180,13 +205,18 @@ private:
   class Chunk
   {
   public:
-    Chunk();
-    Chunk(File::IOFile* file, u64 offset_in_file, u64 compressed_size, u64 decompressed_size,
-          u32 exception_lists, bool compressed_exception_lists, u32 rvz_packed_size,
-          u64 data_offset, std::unique_ptr<Decompressor> decompressor);
+    Chunk(File::IOFile* file, std::mutex* file_mutex, u64 offset_in_file, u64 compressed_size,
+          u64 decompressed_size, u32 exception_lists, bool compressed_exception_lists,
+          u32 rvz_packed_size, u64 data_offset, std::unique_ptr<Decompressor> decompressor);
 
     bool Read(u64 offset, u64 size, u8* out_ptr);
 
+    // Whether reading the given range still has to decompress data
+    bool NeedsDecompression(u64 offset, u64 size) const;
+
+    // Decompresses all data, so that reads from this chunk don't have to access the file anymore
+    bool DecompressAll();
+
     // This can only be called once at least one byte of data has been read
     void GetHashExceptions(std::vector<HashExceptionEntry>* exception_list,
                            u64 exception_list_index, u16 additional_offset) const;
@@ -198,6 +228,7 @@ private:
     }
 
   private:
+    bool DecompressUpTo(u64 end);
     bool Decompress();
     bool HandleExceptions(const u8* data, size_t bytes_allocated, size_t bytes_written,
                           size_t* bytes_used, bool align);
@@ -208,6 +239,7 @@ private:
 
     std::unique_ptr<Decompressor> m_decompressor = nullptr;
     File::IOFile* m_file = nullptr;
+    std::mutex* m_file_mutex = nullptr;
     u64 m_offset_in_file = 0;
 
     size_t m_out_bytes_allocated_for_exceptions = 0;
@@ -228,9 +260,18 @@ private:
   bool ReadFromGroups(u64* offset, u64* size, u8** out_ptr, u64 chunk_size, u32 sector_size,
                       u64 data_offset, u64 data_size, u32 group_index, u32 number_of_groups,
                       u32 exception_lists);
+  WIARVZCompressionType GetGroupCompression(const GroupEntry& group, u32* group_data_size,
+                                            u32* rvz_packed_size) const;
+  void PrefetchGroups(u64 chunk_size, u64 data_size, u32 group_index, u32 number_of_groups,
+                      u32 exception_lists, u64 current_group);
   Chunk& ReadCompressedData(u64 offset_in_file, u64 compressed_size, u64 decompressed_size,
                             WIARVZCompressionType compression_type, u32 exception_lists = 0,
                             u32 rvz_packed_size = 0, u64 data_offset = 0);
+  std::shared_ptr<Chunk> CreateChunk(u64 offset_in_file, u64 compressed_size,
+                                     u64 decompressed_size, WIARVZCompressionType compression_type,
+                                     u32 exception_lists, u32 rvz_packed_size, u64 data_offset);
+  void TrimGroupCache();
+  void UncacheGroup(u64 offset_in_file);
 
   static bool ApplyHashExceptions(const std::vector<HashExceptionEntry>& exception_list,
                                   VolumeWii::HashBlock hash_blocks[VolumeWii::BLOCKS_PER_GROUP]);
@@ -356,8 +397,52 @@ private:
   WIARVZCompressionType m_compression_type;
 
   File::IOFile m_file;
-  Chunk m_cached_chunk;
-  u64 m_cached_chunk_offset = std::numeric_limits<u64>::max();
+  // Chunks that are decompressed ahead of time read from m_file on other threads
+  std::mutex m_file_mutex;
+
+  // Shared between the reader and the prefetch pool
+  struct PrefetchJob
+  {
+    enum class State
+    {
+      Queued,
+      Running,
+      // The group was evicted before a worker started on it, so it isn't decompressed needlessly
+      Cancelled,
+    };
+
+    std::shared_ptr<Chunk> chunk;
+    std::promise<bool> result;
+    // Only valid once result is ready
+    u64 decompression_us = 0;
+    std::atomic<State> state{State::Queued};
+  };
+
+  static void RunPrefetchJob(const std::shared_ptr<PrefetchJob>& job);
+
+  struct CachedGroup
+  {
+    u64 offset_in_file;
+    std::shared_ptr<Chunk> chunk;
+    // Valid until the reader uses a group that is decompressed ahead of time. Unlike futures from
+    // std::async, these don't wait for the job when destroyed, so evicting a group never blocks.
+    std::shared_ptr<PrefetchJob> prefetch_job;
+    std::future<bool> prefetch;
+  };
+
+  void CancelPrefetch(CachedGroup* cached_group);
+
+  // Jobs of evicted groups which were already running. They read from m_file, so the reader waits
+  // for them before it's destroyed.
+  std::vector<std::future<bool>> m_running_prefetches;
+
+  // Most recently used first
+  std::list<CachedGroup> m_group_cache;
+  size_t m_group_cache_capacity = 0;
+  u64 m_last_group_index = std::numeric_limits<u64>::max();
+  u64 m_sequential_groups = 0;
+  GroupCacheStats m_group_cache_stats;
+
   WiiEncryptionCache m_encryption_cache;
 
   std::vector<HashExceptionEntry> m_exception_list;
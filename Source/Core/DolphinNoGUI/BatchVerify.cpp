@@ -0,0 +1,94 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DolphinNoGUI/BatchVerify.h"
+
+#include <cstdio>
+#include <memory>
+
+#include "Common/CommonTypes.h"
+#include "Common/StringUtil.h"
+#include "DiscIO/Enums.h"
+#include "DiscIO/Volume.h"
+#include "DiscIO/VolumeVerifier.h"
+
+namespace BatchVerify
+{
+namespace
+{
+const char* GetSeverityName(DiscIO::VolumeVerifier::Severity severity)
+{
+  switch (severity)
+  {
+  case DiscIO::VolumeVerifier::Severity::Low:
+    return "Low";
+  case DiscIO::VolumeVerifier::Severity::Medium:
+    return "Medium";
+  case DiscIO::VolumeVerifier::Severity::High:
+    return "High";
+  default:
+    return "None";
+  }
+}
+
+void PrintHash(const char* name, const std::vector<u8>& hash)
+{
+  if (!hash.empty())
+  {
+    std::printf("  %s: %s\n", name,
+                ArrayToString(hash.data(), static_cast<u32>(hash.size()), 0, false).c_str());
+  }
+}
+
+bool Verify(const std::string& path, bool redump_verification)
+{
+  const std::unique_ptr<DiscIO::Volume> volume = DiscIO::CreateVolume(path);
+  if (!volume)
+  {
+    std::printf("%s\n  Could not open the file\n", path.c_str());
+    return false;
+  }
+
+  DiscIO::VolumeVerifier verifier(
+      *volume, redump_verification && DiscIO::IsDisc(volume->GetVolumeType()), {true, true, true});
+  verifier.Start();
+  while (verifier.GetBytesProcessed() != verifier.GetTotalBytes())
+    verifier.Process();
+  verifier.Finish();
+
+  const DiscIO::VolumeVerifier::Result& result = verifier.GetResult();
+  std::printf("%s\n  %s\n", path.c_str(), result.summary_text.c_str());
+  PrintHash("CRC32", result.hashes.crc32);
+  PrintHash("MD5", result.hashes.md5);
+  PrintHash("SHA-1", result.hashes.sha1);
+  if (!result.redump.message.empty())
+    std::printf("  Redump.org: %s\n", result.redump.message.c_str());
+
+  bool success = true;
+  for (const DiscIO::VolumeVerifier::Problem& problem : result.problems)
+  {
+    std::printf("  [%s] %s\n", GetSeverityName(problem.severity), problem.text.c_str());
+    if (problem.severity == DiscIO::VolumeVerifier::Severity::Medium ||
+        problem.severity == DiscIO::VolumeVerifier::Severity::High)
+    {
+      success = false;
+    }
+  }
+  std::fflush(stdout);
+
+  return success;
+}
+}  // namespace
+
+bool Run(const std::vector<std::string>& paths, bool redump_verification)
+{
+  bool success = true;
+  for (const std::string& path : paths)
+  {
+    if (!Verify(path, redump_verification))
+      success = false;
+  }
+  return success;
+}
+}  // namespace BatchVerify
@@ -0,0 +1,16 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace BatchVerify
+{
+// Verifies each disc image or WAD like the Verify tab of the game properties does, calculating all
+// hashes, and prints the results to stdout. Returns false if an image couldn't be opened or has
+// problems of medium or high severity.
+bool Run(const std::vector<std::string>& paths, bool redump_verification);
+}  // namespace BatchVerify
@@ -0,0 +1,324 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "DolphinNoGUI/FifoBenchmark.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <numeric>
+#include <optional>
+#include <thread>
+
+#include <picojson.h>
+
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Common/Flag.h"
+#include "Common/WindowSystemInfo.h"
+#include "Core/Boot/Boot.h"
+#include "Core/BootManager.h"
+#include "Core/Config/GraphicsSettings.h"
+#include "Core/Config/MainSettings.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/FifoPlayer/FifoPlayer.h"
+#include "VideoCommon/Fifo.h"
+#include "VideoCommon/FrameProfiler.h"
+
+namespace FifoBenchmark
+{
+namespace
+{
+// The wall time of a frame, followed by the FrameProfiler sections and the time the CPU and GPU
+// threads spent waiting for each other. These are measured in nanoseconds. The Fifo's counts of
+// those waits and of GPU wakeups it deferred to batch them come last.
+constexpr std::size_t NUM_TIME_METRICS = FrameProfiler::NUM_SECTIONS + 2;
+constexpr std::size_t NUM_METRICS = NUM_TIME_METRICS + 2;
+constexpr std::array<const char*, NUM_METRICS> METRIC_NAMES = {
+    "wall_ms",         "opcode_decoder_ms", "vertex_loader_ms", "texture_cache_ms",
+    "shader_cache_ms", "gpu_sync_stall_ms", "gpu_sync_stalls",  "gpu_deferred_wakeups"};
+static_assert(FrameProfiler::NUM_SECTIONS == 4, "Names are missing for some sections");
+
+using FrameSample = std::array<u64, NUM_METRICS>;
+using Loop = std::vector<FrameSample>;
+
+u64 GetTimeNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Collects a sample for each frame from the fifo player's frame callback, which runs on the CPU
+// thread before a frame is written. The previous frame has been processed by the GPU by then.
+class Recorder
+{
+public:
+  explicit Recorder(std::size_t num_loops) : m_num_loops(num_loops) {}
+
+  void OnFrameWritten()
+  {
+    const u64 now = GetTimeNs();
+    const FrameProfiler::Times times = FrameProfiler::TakeTimes();
+    const Fifo::SyncStats sync_stats = Fifo::GetSyncStats();
+    if (m_done.IsSet())
+      return;
+
+    const FifoPlayer& player = FifoPlayer::GetInstance();
+    if (m_loops.empty())
+    {
+      // Anything measured so far was for booting, not for a frame.
+      m_loops.emplace_back();
+    }
+    else
+    {
+      FrameSample& sample = m_loops.back().emplace_back();
+      sample[0] = now - m_frame_start;
+      std::copy(times.begin(), times.end(), sample.begin() + 1);
+      sample[NUM_TIME_METRICS - 1] = (sync_stats.stall_time_us - m_sync_stats.stall_time_us) * 1000;
+      sample[NUM_TIME_METRICS] = sync_stats.stalls - m_sync_stats.stalls;
+      sample[NUM_TIME_METRICS + 1] = sync_stats.deferred_wakeups - m_sync_stats.deferred_wakeups;
+
+      if (player.GetCurrentFrameNum() == player.GetFrameRangeStart())
+      {
+        if (m_loops.size() == m_num_loops)
+        {
+          m_done.Set();
+          return;
+        }
+        m_loops.emplace_back();
+      }
+    }
+
+    m_frame_start = now;
+    m_sync_stats = sync_stats;
+  }
+
+  bool IsDone() const { return m_done.IsSet(); }
+
+  // Only valid once the CPU thread has stopped.
+  const std::vector<Loop>& GetLoops() const { return m_loops; }
+
+private:
+  std::size_t m_num_loops;
+  std::vector<Loop> m_loops;
+  u64 m_frame_start = 0;
+  Fifo::SyncStats m_sync_stats;
+  Common::Flag m_done;
+};
+
+double ToMilliseconds(u64 ns)
+{
+  return ns / 1000000.0;
+}
+
+// Times are reported in milliseconds, counts as they are.
+double GetMetricValue(std::size_t metric, u64 value)
+{
+  return metric < NUM_TIME_METRICS ? ToMilliseconds(value) : static_cast<double>(value);
+}
+
+picojson::value Summarize(std::vector<double> values)
+{
+  picojson::object summary;
+  if (values.empty())
+    return picojson::value(summary);
+
+  std::sort(values.begin(), values.end());
+  const std::size_t count = values.size();
+  const double mean = std::accumulate(values.begin(), values.end(), 0.0) / count;
+  double variance = 0.0;
+  for (double value : values)
+    variance += (value - mean) * (value - mean);
+  if (count > 1)
+    variance /= count - 1;
+
+  summary["mean"] = picojson::value(mean);
+  summary["median"] = picojson::value(count % 2 ? values[count / 2] :
+                                                  (values[count / 2 - 1] + values[count / 2]) / 2);
+  summary["stddev"] = picojson::value(std::sqrt(variance));
+  summary["min"] = picojson::value(values.front());
+  summary["max"] = picojson::value(values.back());
+  return picojson::value(summary);
+}
+
+FrameSample GetTotals(const Loop& loop)
+{
+  FrameSample totals{};
+  for (const FrameSample& sample : loop)
+  {
+    for (std::size_t i = 0; i < NUM_METRICS; i++)
+      totals[i] += sample[i];
+  }
+  return totals;
+}
+
+picojson::value MakeMetricsObject(const FrameSample& sample)
+{
+  picojson::object object;
+  for (std::size_t i = 0; i < NUM_METRICS; i++)
+    object[METRIC_NAMES[i]] = picojson::value(GetMetricValue(i, sample[i]));
+  return picojson::value(object);
+}
+
+// The first loop is the warm-up loop, which isn't part of the summaries.
+picojson::value MakeLogResults(const std::string& path, const std::vector<Loop>& loops)
+{
+  const std::vector<Loop> measured_loops(loops.begin() + 1, loops.end());
+  std::size_t num_frames = measured_loops.front().size();
+  for (const Loop& loop : measured_loops)
+    num_frames = std::min(num_frames, loop.size());
+
+  picojson::object results;
+  results["path"] = picojson::value(path);
+  results["frame_count"] = picojson::value(static_cast<double>(num_frames));
+  results["warmup"] = MakeMetricsObject(GetTotals(loops.front()));
+
+  picojson::array loop_totals;
+  std::array<std::vector<double>, NUM_METRICS> totals_by_metric;
+  std::vector<double> fps;
+  std::vector<double> frame_wall_times;
+  for (const Loop& loop : measured_loops)
+  {
+    const FrameSample totals = GetTotals(loop);
+    loop_totals.push_back(MakeMetricsObject(totals));
+    for (std::size_t i = 0; i < NUM_METRICS; i++)
+      totals_by_metric[i].push_back(GetMetricValue(i, totals[i]));
+    fps.push_back(totals[0] ? loop.size() * 1000000000.0 / totals[0] : 0.0);
+    for (const FrameSample& sample : loop)
+      frame_wall_times.push_back(ToMilliseconds(sample[0]));
+  }
+  results["loops"] = picojson::value(loop_totals);
+
+  picojson::object summary;
+  summary["fps"] = Summarize(fps);
+  for (std::size_t i = 0; i < NUM_METRICS; i++)
+    summary[METRIC_NAMES[i]] = Summarize(totals_by_metric[i]);
+  summary["frame_wall_ms"] = Summarize(frame_wall_times);
+  results["summary"] = picojson::value(summary);
+
+  // The median of each frame over all loops, which isn't thrown off by a single slow loop.
+  picojson::array frames;
+  for (std::size_t frame = 0; frame < num_frames; frame++)
+  {
+    picojson::object medians;
+    for (std::size_t i = 0; i < NUM_METRICS; i++)
+    {
+      std::vector<double> values;
+      for (const Loop& loop : measured_loops)
+        values.push_back(GetMetricValue(i, loop[frame][i]));
+      medians[METRIC_NAMES[i]] = Summarize(std::move(values)).get("median");
+    }
+    frames.emplace_back(medians);
+  }
+  results["frames"] = picojson::value(frames);
+
+  return picojson::value(results);
+}
+
+// Plays the log, optionally with the given number of software renderer threads. Returns nothing
+// if it couldn't be played to the end.
+std::optional<picojson::value> PlayLog(const std::string& path, u32 loops,
+                                       std::optional<int> sw_threads, const WindowSystemInfo& wsi)
+{
+  FifoPlayer& player = FifoPlayer::GetInstance();
+  Recorder recorder(loops + 1);
+  player.SetFrameWrittenCallback([&recorder] { recorder.OnFrameWritten(); });
+  // The current run layer is cleared when the emulation stops.
+  Config::SetCurrent(Config::MAIN_GPU_SYNC_STATS, true);
+  if (sw_threads)
+    Config::SetCurrent(Config::GFX_SW_THREADS, *sw_threads);
+  if (BootManager::BootCore(BootParameters::GenerateFromFile(path), wsi))
+  {
+    while (!recorder.IsDone() && Core::GetState() != Core::State::Uninitialized)
+    {
+      Core::HostDispatchJobs();
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    Core::Stop();
+    Core::Shutdown();
+  }
+  player.SetFrameWrittenCallback(nullptr);
+
+  if (!recorder.IsDone())
+    return std::nullopt;
+
+  picojson::value results = MakeLogResults(path, recorder.GetLoops());
+  if (sw_threads)
+  {
+    results.get<picojson::object>()["sw_threads"] =
+        picojson::value(static_cast<double>(*sw_threads));
+  }
+  return results;
+}
+}  // namespace
+
+bool Run(const std::vector<std::string>& paths, u32 loops, const std::vector<int>& sw_threads,
+         const std::string& output_path, const WindowSystemInfo& wsi)
+{
+  FifoPlayer& player = FifoPlayer::GetInstance();
+  player.SetLoop(true);
+  Core::SetIsThrottlerTempDisabled(true);
+  FrameProfiler::SetEnabled(true);
+
+  bool success = true;
+  picojson::array results;
+  for (const std::string& path : paths)
+  {
+    // Without thread counts, each log is played once with the configured number of threads.
+    std::vector<std::optional<int>> runs(sw_threads.begin(), sw_threads.end());
+    if (runs.empty())
+      runs.emplace_back();
+
+    for (const std::optional<int>& threads : runs)
+    {
+      if (threads)
+        std::fprintf(stderr, "Playing %s with %d SW threads\n", path.c_str(), *threads);
+      else
+        std::fprintf(stderr, "Playing %s\n", path.c_str());
+
+      std::optional<picojson::value> log_results = PlayLog(path, loops, threads, wsi);
+      if (!log_results)
+      {
+        std::fprintf(stderr, "Could not play %s\n", path.c_str());
+        success = false;
+        continue;
+      }
+
+      if (threads)
+      {
+        const picojson::value& fps = log_results->get("summary").get("fps").get("median");
+        std::fprintf(stderr, "%d SW threads: %.2f FPS\n", *threads,
+                     fps.is<double>() ? fps.get<double>() : 0.0);
+      }
+      results.push_back(std::move(*log_results));
+    }
+  }
+
+  FrameProfiler::SetEnabled(false);
+  Core::SetIsThrottlerTempDisabled(false);
+
+  picojson::object root;
+  root["video_backend"] = picojson::value(SConfig::GetInstance().m_strVideoBackend);
+  root["cpu_thread"] = picojson::value(SConfig::GetInstance().bCPUThread);
+  root["gpu_wakeup_threshold"] =
+      picojson::value(static_cast<double>(Config::Get(Config::MAIN_GPU_WAKEUP_THRESHOLD)));
+  root["gpu_wakeup_max_delay"] =
+      picojson::value(static_cast<double>(Config::Get(Config::MAIN_GPU_WAKEUP_MAX_DELAY)));
+  root["loops"] = picojson::value(static_cast<double>(loops));
+  root["logs"] = picojson::value(results);
+  if (!File::WriteStringToFile(output_path, picojson::value(root).serialize(true)))
+  {
+    std::fprintf(stderr, "Could not write %s\n", output_path.c_str());
+    return false;
+  }
+
+  return success;
+}
+}  // namespace FifoBenchmark
@@ -0,0 +1,25 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+struct WindowSystemInfo;
+
+namespace FifoBenchmark
+{
+// Plays each fifo log once to warm up and then the given number of times, measuring the wall time
+// of each frame, the CPU time spent in the parts of the video emulation FrameProfiler knows about,
+// and how long and how often the CPU and GPU threads stalled on each other and GPU wakeups were
+// deferred (see GPUWakeupThreshold). The results are written to output_path as JSON. Returns
+// false if a log couldn't be played to the end, or the results couldn't be written.
+// If sw_threads isn't empty, each log is played once for every given number of software renderer
+// threads, to compare how the frame rate scales.
+bool Run(const std::vector<std::string>& paths, u32 loops, const std::vector<int>& sw_threads,
+         const std::string& output_path, const WindowSystemInfo& wsi);
+}  // namespace FifoBenchmark
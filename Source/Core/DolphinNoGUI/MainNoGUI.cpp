@@ -5,11 +5,13 @@
 #include "DolphinNoGUI/Platform.h"
 
 #include <OptionParser.h>
+#include <algorithm>
 #include <cstddef>
 #include <cstdio>
 #include <cstring>
 #include <signal.h>
 #include <string>
+#include <vector>
 #ifndef _WIN32
 #include <unistd.h>
 #endif
@@ -20,6 +22,9 @@
 #include "Core/Core.h"
 #include "Core/Host.h"
 
+#include "DolphinNoGUI/BatchVerify.h"
+#include "DolphinNoGUI/FifoBenchmark.h"
+
 #include "UICommon/CommandLineParse.h"
 #ifdef USE_DISCORD_PRESENCE
 #include "UICommon/DiscordPresence.h"
@@ -135,12 +140,55 @@ int main(int argc, char* argv[])
             "x11"
 #endif
       });
+  parser->add_option("--fifo_benchmark")
+      .action("store")
+      .metavar("<file>")
+      .type("string")
+      .help("Play the given fifo logs as a benchmark, and write the results to a JSON file");
+  parser->add_option("--fifo_benchmark_loops")
+      .action("store")
+      .type("int")
+      .set_default(5)
+      .help("Number of times the benchmark plays each fifo log after warming up [default: "
+            "%default]");
+  parser->add_option("--fifo_benchmark_sw_threads")
+      .action("append")
+      .type("int")
+      .metavar("<count>")
+      .help("Play the fifo logs with the given number of software renderer threads. Can be given "
+            "several times to compare thread counts");
+  parser->add_option("--verify")
+      .action("store_true")
+      .help("Verify the given disc images and WADs, print the results and exit");
+  parser->add_option("--verify_redump")
+      .action("store_true")
+      .help("Also compare the disc images that are verified with the Redump.org database");
 
   optparse::Values& options = CommandLineParse::ParseArguments(parser.get(), argc, argv);
   std::vector<std::string> args = parser->args();
 
+  const bool fifo_benchmark = options.is_set("fifo_benchmark");
+  const bool verify = options.is_set("verify");
   std::unique_ptr<BootParameters> boot;
-  if (options.is_set("exec"))
+  if (verify)
+  {
+    if (args.empty())
+    {
+      fprintf(stderr, "No files to verify\n");
+      parser->print_help();
+      return 1;
+    }
+  }
+  else if (fifo_benchmark)
+  {
+    if (args.empty())
+    {
+      fprintf(stderr, "No fifo logs to benchmark\n");
+      parser->print_help();
+      return 1;
+    }
+  }
+  else if (options.is_set("exec"))
   {
     const std::list<std::string> paths_list = options.all("exec");
     const std::vector<std::string> paths{std::make_move_iterator(std::begin(paths_list)),
@@ -177,6 +225,13 @@ int main(int argc, char* argv[])
   UICommon::SetUserDirectory(user_directory);
   UICommon::Init();
 
+  if (verify)
+  {
+    const bool success = BatchVerify::Run(args, options.is_set("verify_redump"));
+    UICommon::Shutdown();
+    return success ? 0 : 1;
+  }
+
   s_platform = GetPlatform(options);
   if (!s_platform || !s_platform->Init())
   {
@@ -199,6 +254,25 @@ int main(int argc, char* argv[])
 
   DolphinAnalytics::Instance().ReportDolphinStart("nogui");
 
+  if (fifo_benchmark)
+  {
+    const int loops = options.get("fifo_benchmark_loops");
+    std::vector<int> sw_threads;
+    if (options.is_set("fifo_benchmark_sw_threads"))
+    {
+      for (const std::string& count : options.all("fifo_benchmark_sw_threads"))
+        sw_threads.push_back(std::stoi(count));
+    }
+    const bool success =
+        FifoBenchmark::Run(args, static_cast<u32>(std::max(loops, 1)), sw_threads,
+                           static_cast<const char*>(options.get("fifo_benchmark")),
+                           s_platform->GetWindowSystemInfo());
+
+    s_platform.reset();
+    UICommon::Shutdown();
+    return success ? 0 : 1;
+  }
+
   if (!BootManager::BootCore(std::move(boot), s_platform->GetWindowSystemInfo()))
   {
     fprintf(stderr, "Could not boot the specified file\n");
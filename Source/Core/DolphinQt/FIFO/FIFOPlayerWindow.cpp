@@ -193,15 +193,19 @@ void FIFOPlayerWindow::LoadRecording()
 
 void FIFOPlayerWindow::SaveRecording()
 {
+  const QString filter = tr("Dolphin FIFO Log (*.dff)");
+  const QString compressed_filter = tr("Compressed Dolphin FIFO Log (*.dff)");
+  QString selected_filter;
   QString path = QFileDialog::getSaveFileName(this, tr("Save FIFO log"), QString(),
-                                              tr("Dolphin FIFO Log (*.dff)"));
+                                              filter + QStringLiteral(";;") + compressed_filter,
+                                              &selected_filter);
 
   if (path.isEmpty())
     return;
 
   FifoDataFile* file = FifoRecorder::GetInstance().GetRecordedFile();
 
-  bool result = file->Save(path.toStdString());
+  bool result = file->Save(path.toStdString(), selected_filter == compressed_filter);
 
   if (!result)
   {
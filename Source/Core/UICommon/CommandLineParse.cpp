@@ -112,7 +112,8 @@ std::unique_ptr<optparse::OptionParser> CreateParser(ParserOptions options)
 
 static void AddConfigLayer(const optparse::Values& options)
 {
-  if (options.is_set_by_user("config"))
+  if (options.is_set_by_user("config") || options.is_set_by_user("video_backend") ||
+      options.is_set_by_user("audio_emulation"))
   {
     const std::list<std::string>& config_args = options.all("config");
     Config::AddLayer(std::make_unique<CommandLineConfigLayerLoader>(
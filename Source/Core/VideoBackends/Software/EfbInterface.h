@@ -59,5 +59,5 @@ void EncodeXFB(u8* xfb_in_ram, u32 memory_stride, const MathUtil::Rectangle<int>
 
 u32 GetPerfQueryResult(PerfQueryType type);
 void ResetPerfQuery();
-void IncPerfCounterQuadCount(PerfQueryType type);
+void IncPerfCounterQuadCount(PerfQueryType type, u32 count);
 }  // namespace EfbInterface
@@ -5,12 +5,17 @@
 #include "VideoBackends/Software/Rasterizer.h"
 
 #include <algorithm>
+#include <array>
 #include <cstring>
+#include <memory>
+#include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/ThreadPool.h"
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/NativeVertexFormat.h"
 #include "VideoBackends/Software/Tev.h"
+#include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/PerfQueryBase.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VideoCommon.h"
@@ -21,28 +26,83 @@ namespace Rasterizer
 {
 static constexpr int BLOCK_SIZE = 2;
 
-static Slope ZSlope;
-static Slope WSlope;
-static Slope ColorSlopes[2][4];
-static Slope TexSlopes[8][3];
+// With more than one thread, triangles are set up as they're submitted, and binned into tiles of
+// the EFB. The tiles are drawn when the batch is flushed, in parallel. Every pixel belongs to one
+// tile, and each tile draws its triangles in the order they were submitted, so the depth test and
+// blending see the same order as when drawing serially. Each tile has its own Tev, but the Tev
+// starts every pixel from the same state, so which Tev draws a pixel doesn't change its color.
+// Tiles are made of whole blocks, since the LOD is calculated per block.
+static constexpr int TILE_SIZE = 32;
+static constexpr int TILES_X = (EFB_WIDTH + TILE_SIZE - 1) / TILE_SIZE;
+static constexpr int TILES_Y = (EFB_HEIGHT + TILE_SIZE - 1) / TILE_SIZE;
+static_assert(TILE_SIZE % BLOCK_SIZE == 0, "Tiles must be made of whole blocks");
+
+struct Triangle
+{
+  Slope ZSlope;
+  Slope WSlope;
+  Slope ColorSlopes[2][4];
+  Slope TexSlopes[8][3];
+
+  s32 vertex0X;
+  s32 vertex0Y;
+  float vertexOffsetX;
+  float vertexOffsetY;
+
+  // Half-edge constants and deltas, in 28.4 fixed point
+  s32 C1, C2, C3;
+  s32 DX12, DX23, DX31;
+  s32 DY12, DY23, DY31;
+
+  // Bounding rectangle, with minx and miny aligned to blocks
+  s32 minx, maxx, miny, maxy;
+};
+
+struct Tile
+{
+  std::vector<u32> triangles;
+  u32 rasterizedPixels = 0;
+  Tev tev;
+  RasterBlock rasterBlock;
+};
 
-static s32 vertex0X;
-static s32 vertex0Y;
-static float vertexOffsetX;
-static float vertexOffsetY;
+// The z slope is kept between triangles for zfreeze.
+static Slope ZSlope;
 
-static Tev tev;
-static RasterBlock rasterBlock;
+static std::vector<Triangle> s_triangles;
+static std::array<Tile, TILES_X * TILES_Y> s_tiles;
+static std::vector<Tile*> s_binned_tiles;
+static std::unique_ptr<Common::ThreadPool> s_thread_pool;
 
 void Init()
 {
-  tev.Init();
+  for (Tile& tile : s_tiles)
+    tile.tev.Init();
 
   // Set initial z reference plane in the unlikely case that zfreeze is enabled when drawing the
   // first primitive.
   // TODO: This is just a guess!
   ZSlope.dfdx = ZSlope.dfdy = 0.f;
   ZSlope.f0 = 1.f;
+
+  // 0 threads picks a count based on the number of cores. Without a pool, the first tile's Tev
+  // draws everything.
+  if (g_ActiveConfig.iSWThreads == 1)
+    s_thread_pool.reset();
+  else if (g_ActiveConfig.iSWThreads > 1)
+    s_thread_pool =
+        std::make_unique<Common::ThreadPool>("SW rasterizer", g_ActiveConfig.iSWThreads - 1);
+  else
+    s_thread_pool = std::make_unique<Common::ThreadPool>("SW rasterizer");
+}
+
+void Shutdown()
+{
+  s_thread_pool.reset();
+  s_triangles = {};
+  s_binned_tiles = {};
+  for (Tile& tile : s_tiles)
+    tile.triangles = {};
 }
 
 // Returns approximation of log2(f) in s28.4
@@ -69,32 +129,35 @@ static inline int iround(float x)
 
 void SetTevReg(int reg, int comp, s16 color)
 {
-  tev.SetRegColor(reg, comp, color);
+  for (Tile& tile : s_tiles)
+    tile.tev.SetRegColor(reg, comp, color);
 }
 
-static void Draw(s32 x, s32 y, s32 xi, s32 yi)
+static void Draw(Tile& tile, const Triangle& tri, s32 x, s32 y, s32 xi, s32 yi)
 {
-  INCSTAT(g_stats.this_frame.rasterized_pixels);
+  Tev& tev = tile.tev;
+  const RasterBlock& rasterBlock = tile.rasterBlock;
+  tile.rasterizedPixels++;
 
-  float dx = vertexOffsetX + (float)(x - vertex0X);
-  float dy = vertexOffsetY + (float)(y - vertex0Y);
+  float dx = tri.vertexOffsetX + (float)(x - tri.vertex0X);
+  float dy = tri.vertexOffsetY + (float)(y - tri.vertex0Y);
 
-  s32 z = (s32)std::clamp<float>(ZSlope.GetValue(dx, dy), 0.0f, 16777215.0f);
+  s32 z = (s32)std::clamp<float>(tri.ZSlope.GetValue(dx, dy), 0.0f, 16777215.0f);
 
   if (bpmem.zmode.testenable && bpmem.zcontrol.early_ztest && g_ActiveConfig.bZComploc)
   {
     // TODO: Test if perf regs are incremented even if test is disabled
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT_ZCOMPLOC);
+    tev.Updates.PerfQuadCounts[PQ_ZCOMP_INPUT_ZCOMPLOC]++;
     if (bpmem.zmode.testenable)
     {
       // early z
       if (!EfbInterface::ZCompare(x, y, z))
         return;
     }
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT_ZCOMPLOC);
+    tev.Updates.PerfQuadCounts[PQ_ZCOMP_OUTPUT_ZCOMPLOC]++;
   }
 
-  RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
+  const RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
 
   tev.Position[0] = x;
   tev.Position[1] = y;
@@ -105,7 +168,7 @@ static void Draw(s32 x, s32 y, s32 xi, s32 yi)
   {
     for (int comp = 0; comp < 4; comp++)
     {
-      u16 color = (u16)ColorSlopes[i][comp].GetValue(dx, dy);
+      u16 color = (u16)tri.ColorSlopes[i][comp].GetValue(dx, dy);
 
       // clamp color value to 0
       u16 mask = ~(color >> 8);
@@ -113,6 +176,10 @@ static void Draw(s32 x, s32 y, s32 xi, s32 yi)
       tev.Color[i][comp] = color & mask;
     }
   }
+  // Stages can still select channels and coordinates which aren't rasterized. Like the rest of
+  // the Tev state, they must not depend on which pixel the tile's Tev drew before.
+  for (unsigned int i = bpmem.genMode.numcolchans; i < 2; i++)
+    std::fill(std::begin(tev.Color[i]), std::end(tev.Color[i]), 0);
 
   // tex coords
   for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
@@ -121,6 +188,11 @@ static void Draw(s32 x, s32 y, s32 xi, s32 yi)
     tev.Uv[i].s = (s32)(pixel.Uv[i][0] * 128);
     tev.Uv[i].t = (s32)(pixel.Uv[i][1] * 128);
   }
+  for (unsigned int i = bpmem.genMode.numtexgens; i < 8; i++)
+  {
+    tev.Uv[i].s = 0;
+    tev.Uv[i].t = 0;
+  }
 
   for (unsigned int i = 0; i < bpmem.genMode.numindstages; i++)
   {
@@ -137,16 +209,16 @@ static void Draw(s32 x, s32 y, s32 xi, s32 yi)
   tev.Draw();
 }
 
-static void InitTriangle(float X1, float Y1, s32 xi, s32 yi)
+static void InitTriangle(Triangle* tri, float X1, float Y1, s32 xi, s32 yi)
 {
-  vertex0X = xi;
-  vertex0Y = yi;
+  tri->vertex0X = xi;
+  tri->vertex0Y = yi;
 
   // adjust a little less than 0.5
   const float adjust = 0.495f;
 
-  vertexOffsetX = ((float)xi - X1) + adjust;
-  vertexOffsetY = ((float)yi - Y1) + adjust;
+  tri->vertexOffsetX = ((float)xi - X1) + adjust;
+  tri->vertexOffsetY = ((float)yi - Y1) + adjust;
 }
 
 static void InitSlope(Slope* slope, float f1, float f2, float f3, float DX31, float DX12,
@@ -162,7 +234,8 @@ static void InitSlope(Slope* slope, float f1, float f2, float f3, float DX31, fl
   slope->f0 = f1;
 }
 
-static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoord)
+static inline void CalculateLOD(const RasterBlock& rasterBlock, s32* lodp, bool* linear,
+                                u32 texmap, u32 texcoord)
 {
   const FourTexUnits& texUnit = bpmem.tex[(texmap >> 2) & 1];
   const u8 subTexmap = texmap & 3;
@@ -175,17 +248,17 @@ static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoor
   float sDelta, tDelta;
   if (tm0.diag_lod)
   {
-    float* uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-    float* uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
+    const float* uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+    const float* uv1 = rasterBlock.Pixel[1][1].Uv[texcoord];
 
     sDelta = fabsf(uv0[0] - uv1[0]);
     tDelta = fabsf(uv0[1] - uv1[1]);
   }
   else
   {
-    float* uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
-    float* uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
-    float* uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
+    const float* uv0 = rasterBlock.Pixel[0][0].Uv[texcoord];
+    const float* uv1 = rasterBlock.Pixel[1][0].Uv[texcoord];
+    const float* uv2 = rasterBlock.Pixel[0][1].Uv[texcoord];
 
     sDelta = std::max(fabsf(uv0[0] - uv1[0]), fabsf(uv0[0] - uv2[0]));
     tDelta = std::max(fabsf(uv0[1] - uv1[1]), fabsf(uv0[1] - uv2[1]));
@@ -210,7 +283,7 @@ static inline void CalculateLOD(s32* lodp, bool* linear, u32 texmap, u32 texcoor
   *lodp = lod;
 }
 
-static void BuildBlock(s32 blockX, s32 blockY)
+static void BuildBlock(RasterBlock& rasterBlock, const Triangle& tri, s32 blockX, s32 blockY)
 {
   for (s32 yi = 0; yi < BLOCK_SIZE; yi++)
   {
@@ -218,10 +291,10 @@ static void BuildBlock(s32 blockX, s32 blockY)
     {
       RasterBlockPixel& pixel = rasterBlock.Pixel[xi][yi];
 
-      float dx = vertexOffsetX + (float)(xi + blockX - vertex0X);
-      float dy = vertexOffsetY + (float)(yi + blockY - vertex0Y);
+      float dx = tri.vertexOffsetX + (float)(xi + blockX - tri.vertex0X);
+      float dy = tri.vertexOffsetY + (float)(yi + blockY - tri.vertex0Y);
 
-      float invW = 1.0f / WSlope.GetValue(dx, dy);
+      float invW = 1.0f / tri.WSlope.GetValue(dx, dy);
       pixel.InvW = invW;
 
       // tex coords
@@ -230,13 +303,13 @@ static void BuildBlock(s32 blockX, s32 blockY)
         float projection = invW;
         if (xfmem.texMtxInfo[i].projection)
         {
-          float q = TexSlopes[i][2].GetValue(dx, dy) * invW;
+          float q = tri.TexSlopes[i][2].GetValue(dx, dy) * invW;
           if (q != 0.0f)
             projection = invW / q;
         }
 
-        pixel.Uv[i][0] = TexSlopes[i][0].GetValue(dx, dy) * projection;
-        pixel.Uv[i][1] = TexSlopes[i][1].GetValue(dx, dy) * projection;
+        pixel.Uv[i][0] = tri.TexSlopes[i][0].GetValue(dx, dy) * projection;
+        pixel.Uv[i][1] = tri.TexSlopes[i][1].GetValue(dx, dy) * projection;
       }
     }
   }
@@ -249,7 +322,8 @@ static void BuildBlock(s32 blockX, s32 blockY)
     u32 texcoord = indref & 3;
     indref >>= 3;
 
-    CalculateLOD(&rasterBlock.IndirectLod[i], &rasterBlock.IndirectLinear[i], texmap, texcoord);
+    CalculateLOD(rasterBlock, &rasterBlock.IndirectLod[i], &rasterBlock.IndirectLinear[i], texmap,
+                 texcoord);
   }
 
   for (unsigned int i = 0; i <= bpmem.genMode.numtevstages; i++)
@@ -261,7 +335,117 @@ static void BuildBlock(s32 blockX, s32 blockY)
       u32 texmap = order.getTexMap(stageOdd);
       u32 texcoord = order.getTexCoord(stageOdd);
 
-      CalculateLOD(&rasterBlock.TextureLod[i], &rasterBlock.TextureLinear[i], texmap, texcoord);
+      CalculateLOD(rasterBlock, &rasterBlock.TextureLod[i], &rasterBlock.TextureLinear[i], texmap,
+                   texcoord);
+    }
+  }
+}
+
+
+// Draws the blocks of the triangle which start within the given rectangle.
+static void DrawTriangle(Tile& tile, const Triangle& tri, s32 left, s32 top, s32 right,
+                         s32 bottom)
+{
+  const s32 C1 = tri.C1;
+  const s32 C2 = tri.C2;
+  const s32 C3 = tri.C3;
+  const s32 DX12 = tri.DX12;
+  const s32 DX23 = tri.DX23;
+  const s32 DX31 = tri.DX31;
+  const s32 DY12 = tri.DY12;
+  const s32 DY23 = tri.DY23;
+  const s32 DY31 = tri.DY31;
+
+  // Fixed-pos32 deltas
+  const s32 FDX12 = DX12 * 16;
+  const s32 FDX23 = DX23 * 16;
+  const s32 FDX31 = DX31 * 16;
+
+  const s32 FDY12 = DY12 * 16;
+  const s32 FDY23 = DY23 * 16;
+  const s32 FDY31 = DY31 * 16;
+
+  const s32 minx = std::max(tri.minx, left);
+  const s32 maxx = std::min(tri.maxx, right);
+  const s32 miny = std::max(tri.miny, top);
+  const s32 maxy = std::min(tri.maxy, bottom);
+
+  // Loop through blocks
+  for (s32 y = miny; y < maxy; y += BLOCK_SIZE)
+  {
+    for (s32 x = minx; x < maxx; x += BLOCK_SIZE)
+    {
+      // Corners of block
+      s32 x0 = x << 4;
+      s32 x1 = (x + BLOCK_SIZE - 1) << 4;
+      s32 y0 = y << 4;
+      s32 y1 = (y + BLOCK_SIZE - 1) << 4;
+
+      // Evaluate half-space functions
+      bool a00 = C1 + DX12 * y0 - DY12 * x0 > 0;
+      bool a10 = C1 + DX12 * y0 - DY12 * x1 > 0;
+      bool a01 = C1 + DX12 * y1 - DY12 * x0 > 0;
+      bool a11 = C1 + DX12 * y1 - DY12 * x1 > 0;
+      int a = (a00 << 0) | (a10 << 1) | (a01 << 2) | (a11 << 3);
+
+      bool b00 = C2 + DX23 * y0 - DY23 * x0 > 0;
+      bool b10 = C2 + DX23 * y0 - DY23 * x1 > 0;
+      bool b01 = C2 + DX23 * y1 - DY23 * x0 > 0;
+      bool b11 = C2 + DX23 * y1 - DY23 * x1 > 0;
+      int b = (b00 << 0) | (b10 << 1) | (b01 << 2) | (b11 << 3);
+
+      bool c00 = C3 + DX31 * y0 - DY31 * x0 > 0;
+      bool c10 = C3 + DX31 * y0 - DY31 * x1 > 0;
+      bool c01 = C3 + DX31 * y1 - DY31 * x0 > 0;
+      bool c11 = C3 + DX31 * y1 - DY31 * x1 > 0;
+      int c = (c00 << 0) | (c10 << 1) | (c01 << 2) | (c11 << 3);
+
+      // Skip block when outside an edge
+      if (a == 0x0 || b == 0x0 || c == 0x0)
+        continue;
+
+      BuildBlock(tile.rasterBlock, tri, x, y);
+
+      // Accept whole block when totally covered
+      if (a == 0xF && b == 0xF && c == 0xF)
+      {
+        for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
+        {
+          for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
+          {
+            Draw(tile, tri, x + ix, y + iy, ix, iy);
+          }
+        }
+      }
+      else  // Partially covered block
+      {
+        s32 CY1 = C1 + DX12 * y0 - DY12 * x0;
+        s32 CY2 = C2 + DX23 * y0 - DY23 * x0;
+        s32 CY3 = C3 + DX31 * y0 - DY31 * x0;
+
+        for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
+        {
+          s32 CX1 = CY1;
+          s32 CX2 = CY2;
+          s32 CX3 = CY3;
+
+          for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
+          {
+            if (CX1 > 0 && CX2 > 0 && CX3 > 0)
+            {
+              Draw(tile, tri, x + ix, y + iy, ix, iy);
+            }
+
+            CX1 -= FDY12;
+            CX2 -= FDY23;
+            CX3 -= FDY31;
+          }
+
+          CY1 += FDX12;
+          CY2 += FDX23;
+          CY3 += FDX31;
+        }
+      }
     }
   }
 }
@@ -292,15 +476,6 @@ void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v
   const s32 DY23 = Y2 - Y3;
   const s32 DY31 = Y3 - Y1;
 
-  // Fixed-pos32 deltas
-  const s32 FDX12 = DX12 * 16;
-  const s32 FDX23 = DX23 * 16;
-  const s32 FDX31 = DX31 * 16;
-
-  const s32 FDY12 = DY12 * 16;
-  const s32 FDY23 = DY23 * 16;
-  const s32 FDY31 = DY31 * 16;
-
   // Bounding rectangle
   s32 minx = (std::min(std::min(X1, X2), X3) + 0xF) >> 4;
   s32 maxx = (std::max(std::max(X1, X2), X3) + 0xF) >> 4;
@@ -335,6 +510,9 @@ void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v
   if (minx >= maxx || miny >= maxy)
     return;
 
+  const u32 index = static_cast<u32>(s_triangles.size());
+  Triangle& tri = s_triangles.emplace_back();
+
   // Setup slopes
   float fltx1 = v0->screenPosition.x;
   float flty1 = v0->screenPosition.y;
@@ -343,11 +521,11 @@ void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v
   float fltdy12 = flty1 - v1->screenPosition.y;
   float fltdy31 = v2->screenPosition.y - flty1;
 
-  InitTriangle(fltx1, flty1, (X1 + 0xF) >> 4, (Y1 + 0xF) >> 4);
+  InitTriangle(&tri, fltx1, flty1, (X1 + 0xF) >> 4, (Y1 + 0xF) >> 4);
 
   float w[3] = {1.0f / v0->projectedPosition.w, 1.0f / v1->projectedPosition.w,
                 1.0f / v2->projectedPosition.w};
-  InitSlope(&WSlope, w[0], w[1], w[2], fltdx31, fltdx12, fltdy12, fltdy31);
+  InitSlope(&tri.WSlope, w[0], w[1], w[2], fltdx31, fltdx12, fltdy12, fltdy31);
 
   // TODO: The zfreeze emulation is not quite correct, yet!
   // Many things might prevent us from reaching this line (culling, clipping, scissoring).
@@ -358,19 +536,21 @@ void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v
   if (!bpmem.genMode.zfreeze || !g_ActiveConfig.bZFreeze)
     InitSlope(&ZSlope, v0->screenPosition[2], v1->screenPosition[2], v2->screenPosition[2], fltdx31,
               fltdx12, fltdy12, fltdy31);
+  tri.ZSlope = ZSlope;
 
   for (unsigned int i = 0; i < bpmem.genMode.numcolchans; i++)
   {
     for (int comp = 0; comp < 4; comp++)
-      InitSlope(&ColorSlopes[i][comp], v0->color[i][comp], v1->color[i][comp], v2->color[i][comp],
-                fltdx31, fltdx12, fltdy12, fltdy31);
+      InitSlope(&tri.ColorSlopes[i][comp], v0->color[i][comp], v1->color[i][comp],
+                v2->color[i][comp], fltdx31, fltdx12, fltdy12, fltdy31);
   }
 
   for (unsigned int i = 0; i < bpmem.genMode.numtexgens; i++)
   {
     for (int comp = 0; comp < 3; comp++)
-      InitSlope(&TexSlopes[i][comp], v0->texCoords[i][comp] * w[0], v1->texCoords[i][comp] * w[1],
-                v2->texCoords[i][comp] * w[2], fltdx31, fltdx12, fltdy12, fltdy31);
+      InitSlope(&tri.TexSlopes[i][comp], v0->texCoords[i][comp] * w[0],
+                v1->texCoords[i][comp] * w[1], v2->texCoords[i][comp] * w[2], fltdx31, fltdx12,
+                fltdy12, fltdy31);
   }
 
   // Half-edge constants
@@ -386,87 +566,105 @@ void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v
   if (DY31 < 0 || (DY31 == 0 && DX31 > 0))
     C3++;
 
+  tri.C1 = C1;
+  tri.C2 = C2;
+  tri.C3 = C3;
+  tri.DX12 = DX12;
+  tri.DX23 = DX23;
+  tri.DX31 = DX31;
+  tri.DY12 = DY12;
+  tri.DY23 = DY23;
+  tri.DY31 = DY31;
+
   // Start in corner of 8x8 block
   minx &= ~(BLOCK_SIZE - 1);
   miny &= ~(BLOCK_SIZE - 1);
 
-  // Loop through blocks
-  for (s32 y = miny; y < maxy; y += BLOCK_SIZE)
-  {
-    for (s32 x = minx; x < maxx; x += BLOCK_SIZE)
-    {
-      // Corners of block
-      s32 x0 = x << 4;
-      s32 x1 = (x + BLOCK_SIZE - 1) << 4;
-      s32 y0 = y << 4;
-      s32 y1 = (y + BLOCK_SIZE - 1) << 4;
-
-      // Evaluate half-space functions
-      bool a00 = C1 + DX12 * y0 - DY12 * x0 > 0;
-      bool a10 = C1 + DX12 * y0 - DY12 * x1 > 0;
-      bool a01 = C1 + DX12 * y1 - DY12 * x0 > 0;
-      bool a11 = C1 + DX12 * y1 - DY12 * x1 > 0;
-      int a = (a00 << 0) | (a10 << 1) | (a01 << 2) | (a11 << 3);
+  tri.minx = minx;
+  tri.maxx = maxx;
+  tri.miny = miny;
+  tri.maxy = maxy;
 
-      bool b00 = C2 + DX23 * y0 - DY23 * x0 > 0;
-      bool b10 = C2 + DX23 * y0 - DY23 * x1 > 0;
-      bool b01 = C2 + DX23 * y1 - DY23 * x0 > 0;
-      bool b11 = C2 + DX23 * y1 - DY23 * x1 > 0;
-      int b = (b00 << 0) | (b10 << 1) | (b01 << 2) | (b11 << 3);
+  if (!s_thread_pool)
+  {
+    // Flush still has to add up the updates.
+    Tile& tile = s_tiles[0];
+    if (s_binned_tiles.empty())
+      s_binned_tiles.push_back(&tile);
+    DrawTriangle(tile, tri, 0, 0, EFB_WIDTH, EFB_HEIGHT);
+    s_triangles.clear();
+    return;
+  }
 
-      bool c00 = C3 + DX31 * y0 - DY31 * x0 > 0;
-      bool c10 = C3 + DX31 * y0 - DY31 * x1 > 0;
-      bool c01 = C3 + DX31 * y1 - DY31 * x0 > 0;
-      bool c11 = C3 + DX31 * y1 - DY31 * x1 > 0;
-      int c = (c00 << 0) | (c10 << 1) | (c01 << 2) | (c11 << 3);
+  // Bin the triangle into every tile its blocks start in
+  for (s32 tileY = miny / TILE_SIZE; tileY <= (maxy - 1) / TILE_SIZE; tileY++)
+  {
+    for (s32 tileX = minx / TILE_SIZE; tileX <= (maxx - 1) / TILE_SIZE; tileX++)
+    {
+      Tile& tile = s_tiles[tileY * TILES_X + tileX];
+      if (tile.triangles.empty())
+        s_binned_tiles.push_back(&tile);
+      tile.triangles.push_back(index);
+    }
+  }
+}
 
-      // Skip block when outside an edge
-      if (a == 0x0 || b == 0x0 || c == 0x0)
-        continue;
+static void DrawTile(Tile& tile)
+{
+  const s32 tileIndex = static_cast<s32>(&tile - s_tiles.data());
+  const s32 tileX = tileIndex % TILES_X * TILE_SIZE;
+  const s32 tileY = tileIndex / TILES_X * TILE_SIZE;
 
-      BuildBlock(x, y);
+  for (u32 index : tile.triangles)
+    DrawTriangle(tile, s_triangles[index], tileX, tileY, tileX + TILE_SIZE, tileY + TILE_SIZE);
+}
 
-      // Accept whole block when totally covered
-      if (a == 0xF && b == 0xF && c == 0xF)
-      {
-        for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
-        {
-          for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
-          {
-            Draw(x + ix, y + iy, ix, iy);
-          }
-        }
-      }
-      else  // Partially covered block
-      {
-        s32 CY1 = C1 + DX12 * y0 - DY12 * x0;
-        s32 CY2 = C2 + DX23 * y0 - DY23 * x0;
-        s32 CY3 = C3 + DX31 * y0 - DY31 * x0;
+void Flush()
+{
+  if (s_binned_tiles.empty())
+    return;
 
-        for (s32 iy = 0; iy < BLOCK_SIZE; iy++)
-        {
-          s32 CX1 = CY1;
-          s32 CX2 = CY2;
-          s32 CX3 = CY3;
+  // The temporary buffers used for dumping TEV stages are shared by all tiles. Without a pool, the
+  // triangles were already drawn as they came in, and only the updates are left.
+  const bool serial = !s_thread_pool || s_binned_tiles.size() == 1 ||
+                      g_ActiveConfig.bDumpTevStages || g_ActiveConfig.bDumpTevTextureFetches;
+  if (serial)
+  {
+    for (Tile* tile : s_binned_tiles)
+      DrawTile(*tile);
+  }
+  else
+  {
+    s_thread_pool->ParallelFor(s_binned_tiles.size(),
+                               [](size_t i) { DrawTile(*s_binned_tiles[i]); });
+  }
 
-          for (s32 ix = 0; ix < BLOCK_SIZE; ix++)
-          {
-            if (CX1 > 0 && CX2 > 0 && CX3 > 0)
-            {
-              Draw(x + ix, y + iy, ix, iy);
-            }
+  for (Tile* tile : s_binned_tiles)
+  {
+    Tev::SharedUpdates& updates = tile->tev.Updates;
+    ADDSTAT(g_stats.this_frame.rasterized_pixels, tile->rasterizedPixels);
+    ADDSTAT(g_stats.this_frame.tev_pixels_in, updates.PixelsIn);
+    ADDSTAT(g_stats.this_frame.tev_pixels_out, updates.PixelsOut);
 
-            CX1 -= FDY12;
-            CX2 -= FDY23;
-            CX3 -= FDY31;
-          }
+    for (int i = 0; i < PQ_NUM_MEMBERS; i++)
+    {
+      if (updates.PerfQuadCounts[i] != 0)
+        EfbInterface::IncPerfCounterQuadCount(static_cast<PerfQueryType>(i),
+                                              updates.PerfQuadCounts[i]);
+    }
 
-          CY1 += FDX12;
-          CY2 += FDX23;
-          CY3 += FDX31;
-        }
-      }
+    if (updates.BoundingBoxUpdated)
+    {
+      BoundingBox::Update(updates.BoundingBox[0], updates.BoundingBox[1], updates.BoundingBox[2],
+                          updates.BoundingBox[3]);
     }
+
+    updates = {};
+    tile->rasterizedPixels = 0;
+    tile->triangles.clear();
   }
+
+  s_binned_tiles.clear();
+  s_triangles.clear();
 }
 }  // namespace Rasterizer
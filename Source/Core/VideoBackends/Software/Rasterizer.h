@@ -11,10 +11,15 @@ struct OutputVertexData;
 namespace Rasterizer
 {
 void Init();
+void Shutdown();
 
+// Triangles are queued, and drawn by Flush.
 void DrawTriangleFrontFace(const OutputVertexData* v0, const OutputVertexData* v1,
                            const OutputVertexData* v2);
 
+// Draws the queued triangles. Must be called before the state they depend on changes.
+void Flush();
+
 void SetTevReg(int reg, int comp, s16 color);
 
 struct Slope
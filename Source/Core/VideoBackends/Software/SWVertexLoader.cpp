@@ -94,6 +94,9 @@ void SWVertexLoader::DrawCurrentBatch(u32 base_index, u32 num_indices, u32 base_
     INCSTAT(g_stats.this_frame.num_vertices_loaded)
   }
 
+  // State only changes between batches, so this is where the triangles have to be drawn.
+  Rasterizer::Flush();
+
   DebugUtil::OnObjectEnd();
 }
 
@@ -6,6 +6,9 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
 
 #include "Common/ChunkFile.h"
 #include "Common/CommonTypes.h"
@@ -13,10 +16,8 @@
 #include "VideoBackends/Software/EfbInterface.h"
 #include "VideoBackends/Software/TextureSampler.h"
 
-#include "VideoCommon/BoundingBox.h"
 #include "VideoCommon/PerfQueryBase.h"
 #include "VideoCommon/PixelShaderManager.h"
-#include "VideoCommon/Statistics.h"
 #include "VideoCommon/VideoCommon.h"
 #include "VideoCommon/VideoConfig.h"
 #include "VideoCommon/XFMemory.h"
@@ -160,6 +161,9 @@ void Tev::Init()
   m_ScaleRShiftLUT[1] = 0;
   m_ScaleRShiftLUT[2] = 0;
   m_ScaleRShiftLUT[3] = 1;
+
+  std::fill(std::begin(m_RegularStageKeys), std::end(m_RegularStageKeys),
+            std::numeric_limits<u64>::max());
 }
 
 static inline s16 Clamp255(s16 in)
@@ -377,6 +381,51 @@ void Tev::DrawAlphaCompare(const TevStageCombiner::AlphaCombiner& ac, const Inpu
   }
 }
 
+void Tev::DrawCombiners(const TevStageCombiner::ColorCombiner& cc,
+                        const TevStageCombiner::AlphaCombiner& ac)
+{
+  InputRegType inputs[4];
+  for (int i = 0; i < 3; i++)
+  {
+    inputs[BLU_C + i].a = *m_ColorInputLUT[cc.a][i];
+    inputs[BLU_C + i].b = *m_ColorInputLUT[cc.b][i];
+    inputs[BLU_C + i].c = *m_ColorInputLUT[cc.c][i];
+    inputs[BLU_C + i].d = *m_ColorInputLUT[cc.d][i];
+  }
+  inputs[ALP_C].a = *m_AlphaInputLUT[ac.a];
+  inputs[ALP_C].b = *m_AlphaInputLUT[ac.b];
+  inputs[ALP_C].c = *m_AlphaInputLUT[ac.c];
+  inputs[ALP_C].d = *m_AlphaInputLUT[ac.d];
+
+  if (cc.bias != 3)
+    DrawColorRegular(cc, inputs);
+  else
+    DrawColorCompare(cc, inputs);
+
+  if (cc.clamp)
+  {
+    Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
+    Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
+    Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
+  }
+  else
+  {
+    Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
+    Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
+    Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
+  }
+
+  if (ac.bias != 3)
+    DrawAlphaRegular(ac, inputs);
+  else
+    DrawAlphaCompare(ac, inputs);
+
+  if (ac.clamp)
+    Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
+  else
+    Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
+}
+
 static bool AlphaCompare(int alpha, int ref, AlphaTest::CompareMode comp)
 {
   switch (comp)
@@ -570,7 +619,7 @@ void Tev::Draw()
   ASSERT(Position[0] >= 0 && Position[0] < EFB_WIDTH);
   ASSERT(Position[1] >= 0 && Position[1] < EFB_HEIGHT);
 
-  INCSTAT(g_stats.this_frame.tev_pixels_in);
+  Updates.PixelsIn++;
 
   // initial color values
   for (int i = 0; i < 4; i++)
@@ -581,6 +630,16 @@ void Tev::Draw()
     Reg[i][ALP_C] = PixelShaderManager::constants.colors[i][3];
   }
 
+  // Stages can read state no earlier stage of this pixel wrote, such as the texture color of a
+  // stage with texturing disabled, the coordinate fb_addprev adds to, or an indirect texture which
+  // isn't sampled. Start every pixel from zero rather than from the last pixel this Tev drew, so
+  // that the result doesn't depend on the order pixels are drawn in or which tile draws them.
+  std::fill(std::begin(TexColor), std::end(TexColor), 0);
+  TexCoord.s = 0;
+  TexCoord.t = 0;
+  std::memset(IndirectTex, 0, sizeof(IndirectTex));
+  AlphaBump = 0;
+
   for (unsigned int stageNum = 0; stageNum < bpmem.genMode.numindstages; stageNum++)
   {
     const int stageNum2 = stageNum >> 1;
@@ -658,47 +717,40 @@ void Tev::Draw()
     // set color
     SetRasColor(order.getColorChan(stageOdd), ac.rswap * 2);
 
-    // combine inputs
-    InputRegType inputs[4];
-    for (int i = 0; i < 3; i++)
+    if (cc.bias != 3 && ac.bias != 3)
     {
-      inputs[BLU_C + i].a = *m_ColorInputLUT[cc.a][i];
-      inputs[BLU_C + i].b = *m_ColorInputLUT[cc.b][i];
-      inputs[BLU_C + i].c = *m_ColorInputLUT[cc.c][i];
-      inputs[BLU_C + i].d = *m_ColorInputLUT[cc.d][i];
+      // Combiner settings only use the low 24 bits, so the key can't match the initial value.
+      const u64 key = u64(cc.hex & 0xFFFFFF) << 24 | (ac.hex & 0xFFFFFF);
+      if (m_RegularStageKeys[stageNum] != key)
+      {
+        m_RegularStages[stageNum] = TevCombiner::MakeRegularStage(cc, ac);
+        m_RegularStageKeys[stageNum] = key;
+      }
+
+      s16 a[4], b[4], c[4], d[4];
+      for (int i = 0; i < 3; i++)
+      {
+        a[BLU_C + i] = *m_ColorInputLUT[cc.a][i];
+        b[BLU_C + i] = *m_ColorInputLUT[cc.b][i];
+        c[BLU_C + i] = *m_ColorInputLUT[cc.c][i];
+        d[BLU_C + i] = *m_ColorInputLUT[cc.d][i];
+      }
+      a[ALP_C] = *m_AlphaInputLUT[ac.a];
+      b[ALP_C] = *m_AlphaInputLUT[ac.b];
+      c[ALP_C] = *m_AlphaInputLUT[ac.c];
+      d[ALP_C] = *m_AlphaInputLUT[ac.d];
+
+      s16 result[4];
+      TevCombiner::CombineRegular(m_RegularStages[stageNum], a, b, c, d, result);
+      Reg[cc.dest][RED_C] = result[RED_C];
+      Reg[cc.dest][GRN_C] = result[GRN_C];
+      Reg[cc.dest][BLU_C] = result[BLU_C];
+      Reg[ac.dest][ALP_C] = result[ALP_C];
     }
-    inputs[ALP_C].a = *m_AlphaInputLUT[ac.a];
-    inputs[ALP_C].b = *m_AlphaInputLUT[ac.b];
-    inputs[ALP_C].c = *m_AlphaInputLUT[ac.c];
-    inputs[ALP_C].d = *m_AlphaInputLUT[ac.d];
-
-    if (cc.bias != 3)
-      DrawColorRegular(cc, inputs);
     else
-      DrawColorCompare(cc, inputs);
-
-    if (cc.clamp)
     {
-      Reg[cc.dest][RED_C] = Clamp255(Reg[cc.dest][RED_C]);
-      Reg[cc.dest][GRN_C] = Clamp255(Reg[cc.dest][GRN_C]);
-      Reg[cc.dest][BLU_C] = Clamp255(Reg[cc.dest][BLU_C]);
+      DrawCombiners(cc, ac);
     }
-    else
-    {
-      Reg[cc.dest][RED_C] = Clamp1024(Reg[cc.dest][RED_C]);
-      Reg[cc.dest][GRN_C] = Clamp1024(Reg[cc.dest][GRN_C]);
-      Reg[cc.dest][BLU_C] = Clamp1024(Reg[cc.dest][BLU_C]);
-    }
-
-    if (ac.bias != 3)
-      DrawAlphaRegular(ac, inputs);
-    else
-      DrawAlphaCompare(ac, inputs);
-
-    if (ac.clamp)
-      Reg[ac.dest][ALP_C] = Clamp255(Reg[ac.dest][ALP_C]);
-    else
-      Reg[ac.dest][ALP_C] = Clamp1024(Reg[ac.dest][ALP_C]);
 
 #if ALLOW_TEV_DUMPS
     if (g_ActiveConfig.bDumpTevStages)
@@ -833,18 +885,18 @@ void Tev::Draw()
   if (late_ztest && bpmem.zmode.testenable)
   {
     // TODO: Check against hw if these values get incremented even if depth testing is disabled
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_INPUT);
+    Updates.PerfQuadCounts[PQ_ZCOMP_INPUT]++;
 
     if (!EfbInterface::ZCompare(Position[0], Position[1], Position[2]))
       return;
 
-    EfbInterface::IncPerfCounterQuadCount(PQ_ZCOMP_OUTPUT);
+    Updates.PerfQuadCounts[PQ_ZCOMP_OUTPUT]++;
   }
 
   // The GC/Wii GPU rasterizes in 2x2 pixel groups, so bounding box values will be rounded to the
   // extents of these groups, rather than the exact pixel.
-  BoundingBox::Update(static_cast<u16>(Position[0] & ~1), static_cast<u16>(Position[0] | 1),
-                      static_cast<u16>(Position[1] & ~1), static_cast<u16>(Position[1] | 1));
+  UpdateBoundingBox(static_cast<u16>(Position[0] & ~1), static_cast<u16>(Position[0] | 1),
+                    static_cast<u16>(Position[1] & ~1), static_cast<u16>(Position[1] | 1));
 
 #if ALLOW_TEV_DUMPS
   if (g_ActiveConfig.bDumpTevStages)
@@ -866,12 +918,30 @@ void Tev::Draw()
   }
 #endif
 
-  INCSTAT(g_stats.this_frame.tev_pixels_out);
-  EfbInterface::IncPerfCounterQuadCount(PQ_BLEND_INPUT);
+  Updates.PixelsOut++;
+  Updates.PerfQuadCounts[PQ_BLEND_INPUT]++;
 
   EfbInterface::BlendTev(Position[0], Position[1], output);
 }
 
+void Tev::UpdateBoundingBox(u16 left, u16 right, u16 top, u16 bottom)
+{
+  if (!Updates.BoundingBoxUpdated)
+  {
+    Updates.BoundingBoxUpdated = true;
+    Updates.BoundingBox[0] = left;
+    Updates.BoundingBox[1] = right;
+    Updates.BoundingBox[2] = top;
+    Updates.BoundingBox[3] = bottom;
+    return;
+  }
+
+  Updates.BoundingBox[0] = std::min(Updates.BoundingBox[0], left);
+  Updates.BoundingBox[1] = std::max(Updates.BoundingBox[1], right);
+  Updates.BoundingBox[2] = std::min(Updates.BoundingBox[2], top);
+  Updates.BoundingBox[3] = std::max(Updates.BoundingBox[3], bottom);
+}
+
 void Tev::SetRegColor(int reg, int comp, s16 color)
 {
   KonstantColors[reg][comp] = color;
@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include "VideoBackends/Software/TevCombiner.h"
 #include "VideoCommon/BPMemory.h"
+#include "VideoCommon/PerfQueryBase.h"
 
 class Tev
 {
@@ -42,6 +44,11 @@ class Tev
   u8 m_ScaleLShiftLUT[4];
   u8 m_ScaleRShiftLUT[4];
 
+  // Constants of the stages which use the regular combiners for both color and alpha, along with
+  // the combiner settings they were made for.
+  TevCombiner::RegularStage m_RegularStages[16];
+  u64 m_RegularStageKeys[16];
+
   // enumeration for color input LUT
   enum
   {
@@ -63,10 +70,24 @@ class Tev
   void DrawColorCompare(const TevStageCombiner::ColorCombiner& cc, const InputRegType inputs[4]);
   void DrawAlphaRegular(const TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
   void DrawAlphaCompare(const TevStageCombiner::AlphaCombiner& ac, const InputRegType inputs[4]);
+  void DrawCombiners(const TevStageCombiner::ColorCombiner& cc,
+                     const TevStageCombiner::AlphaCombiner& ac);
 
   void Indirect(unsigned int stageNum, s32 s, s32 t);
+  void UpdateBoundingBox(u16 left, u16 right, u16 top, u16 bottom);
 
 public:
+  // Updates to state shared by all pixels. They're collected here rather than applied right away,
+  // so that several Tevs can draw at once. The rasterizer applies them after each batch.
+  struct SharedUpdates
+  {
+    u32 PixelsIn;
+    u32 PixelsOut;
+    u32 PerfQuadCounts[PQ_NUM_MEMBERS];
+    bool BoundingBoxUpdated;
+    u16 BoundingBox[4];  // left, right, top, bottom
+  };
+
   s32 Position[3];
   u8 Color[2][4];  // must be RGBA for correct swap table ordering
   TextureCoordinateType Uv[8];
@@ -74,6 +95,7 @@ public:
   bool IndirectLinear[4];
   s32 TextureLod[16];
   bool TextureLinear[16];
+  SharedUpdates Updates{};
 
   enum
   {
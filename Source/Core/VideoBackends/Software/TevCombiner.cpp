@@ -0,0 +1,171 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoBackends/Software/TevCombiner.h"
+
+#include <algorithm>
+
+#include "Common/Intrinsics.h"
+
+#ifdef _M_ARM_64
+#include <arm_neon.h>
+#endif
+
+namespace TevCombiner
+{
+namespace
+{
+void SetLane(RegularStage* stage, int lane, u32 bias, u32 op, u32 clamp, u32 shift,
+             bool negate_input)
+{
+  static constexpr s16 bias_lut[4] = {0, 128, -128, 0};
+
+  // Shift 3 is a divide by 2, which also turns off rounding.
+  stage->scale[lane] = shift == 3 ? 1 : 1 << shift;
+  stage->bias[lane] = bias_lut[bias];
+  stage->round[lane] = shift == 3 ? 0 : op ? 127 : 128;
+  stage->negate_result[lane] = op && !negate_input ? -1 : 0;
+  stage->negate_input[lane] = op && negate_input ? -1 : 0;
+  stage->halve[lane] = shift == 3 ? -1 : 0;
+  stage->min[lane] = clamp ? 0 : -1024;
+  stage->max[lane] = clamp ? 255 : 1023;
+}
+}  // namespace
+
+RegularStage MakeRegularStage(const TevStageCombiner::ColorCombiner& cc,
+                              const TevStageCombiner::AlphaCombiner& ac)
+{
+  // The color and alpha combiners round differently when subtracting. The color combiner negates
+  // after dividing by 256, the alpha combiner before.
+  RegularStage stage;
+  SetLane(&stage, 0, ac.bias, ac.op, ac.clamp, ac.shift, true);
+  for (int lane = 1; lane < 4; lane++)
+    SetLane(&stage, lane, cc.bias, cc.op, cc.clamp, cc.shift, false);
+  return stage;
+}
+
+#if defined(_M_X86)
+
+void CombineRegular(const RegularStage& stage, const s16 a[4], const s16 b[4], const s16 c[4],
+                    const s16 d[4], s16 out[4])
+{
+  const __m128i mask8 = _mm_set1_epi16(0xFF);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i scale = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(stage.scale));
+
+  // a, b and c are 8 bits wide, d is 11 bits and signed.
+  const __m128i va = _mm_and_si128(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(a)), mask8);
+  const __m128i vb = _mm_and_si128(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(b)), mask8);
+  __m128i vc = _mm_and_si128(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(c)), mask8);
+  __m128i vd = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(d));
+  vd = _mm_srai_epi16(_mm_slli_epi16(vd, 5), 5);
+  vc = _mm_add_epi16(vc, _mm_srli_epi16(vc, 7));
+
+  // (a * (256 - c) + b * c) << shift, with the shift folded into the factors. None of these
+  // exceed 16 bits, so a single multiply-add produces the 32 bit sums.
+  const __m128i factor_a = _mm_mullo_epi16(_mm_sub_epi16(_mm_set1_epi16(256), vc), scale);
+  const __m128i factor_b = _mm_mullo_epi16(vc, scale);
+  __m128i temp = _mm_madd_epi16(_mm_unpacklo_epi16(va, vb), _mm_unpacklo_epi16(factor_a, factor_b));
+  temp = _mm_add_epi32(temp, _mm_loadu_si128(reinterpret_cast<const __m128i*>(stage.round)));
+
+  const __m128i negate_result =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(stage.negate_result));
+  const __m128i negate_input =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(stage.negate_input));
+  const __m128i shifted = _mm_srai_epi32(temp, 8);
+  const __m128i negated_result = _mm_sub_epi32(zero, shifted);
+  const __m128i negated_input = _mm_srai_epi32(_mm_sub_epi32(zero, temp), 8);
+  temp = _mm_andnot_si128(_mm_or_si128(negate_result, negate_input), shifted);
+  temp = _mm_or_si128(temp, _mm_and_si128(negate_result, negated_result));
+  temp = _mm_or_si128(temp, _mm_and_si128(negate_input, negated_input));
+
+  // ((d + bias) << shift) + temp, then the divide by 2 where it applies.
+  __m128i result = _mm_mullo_epi16(
+      _mm_add_epi16(vd, _mm_loadl_epi64(reinterpret_cast<const __m128i*>(stage.bias))), scale);
+  result = _mm_unpacklo_epi16(result, _mm_srai_epi16(result, 15));
+  result = _mm_add_epi32(result, temp);
+  const __m128i halve = _mm_loadu_si128(reinterpret_cast<const __m128i*>(stage.halve));
+  result = _mm_or_si128(_mm_andnot_si128(halve, result),
+                        _mm_and_si128(halve, _mm_srai_epi32(result, 1)));
+
+  // Registers are 16 bits wide, so the result is truncated to that before clamping.
+  result = _mm_srai_epi32(_mm_slli_epi32(result, 16), 16);
+  result = _mm_packs_epi32(result, result);
+  result = _mm_max_epi16(result, _mm_loadl_epi64(reinterpret_cast<const __m128i*>(stage.min)));
+  result = _mm_min_epi16(result, _mm_loadl_epi64(reinterpret_cast<const __m128i*>(stage.max)));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(out), result);
+}
+
+#elif defined(_M_ARM_64)
+
+void CombineRegular(const RegularStage& stage, const s16 a[4], const s16 b[4], const s16 c[4],
+                    const s16 d[4], s16 out[4])
+{
+  const int16x4_t mask8 = vdup_n_s16(0xFF);
+  const int16x4_t scale = vld1_s16(stage.scale);
+
+  // a, b and c are 8 bits wide, d is 11 bits and signed.
+  const int16x4_t va = vand_s16(vld1_s16(a), mask8);
+  const int16x4_t vb = vand_s16(vld1_s16(b), mask8);
+  int16x4_t vc = vand_s16(vld1_s16(c), mask8);
+  int16x4_t vd = vshr_n_s16(vshl_n_s16(vld1_s16(d), 5), 5);
+  vc = vadd_s16(vc, vshr_n_s16(vc, 7));
+
+  // (a * (256 - c) + b * c) << shift, with the shift folded into the factors.
+  const int16x4_t factor_a = vmul_s16(vsub_s16(vdup_n_s16(256), vc), scale);
+  const int16x4_t factor_b = vmul_s16(vc, scale);
+  int32x4_t temp = vmlal_s16(vmull_s16(va, factor_a), vb, factor_b);
+  temp = vaddq_s32(temp, vld1q_s32(stage.round));
+
+  const uint32x4_t negate_result = vreinterpretq_u32_s32(vld1q_s32(stage.negate_result));
+  const uint32x4_t negate_input = vreinterpretq_u32_s32(vld1q_s32(stage.negate_input));
+  const int32x4_t shifted = vshrq_n_s32(temp, 8);
+  const int32x4_t negated_input = vshrq_n_s32(vnegq_s32(temp), 8);
+  temp = vbslq_s32(negate_result, vnegq_s32(shifted), shifted);
+  temp = vbslq_s32(negate_input, negated_input, temp);
+
+  // ((d + bias) << shift) + temp, then the divide by 2 where it applies.
+  const int16x4_t biased = vmul_s16(vadd_s16(vd, vld1_s16(stage.bias)), scale);
+  int32x4_t result = vaddq_s32(vmovl_s16(biased), temp);
+  const uint32x4_t halve = vreinterpretq_u32_s32(vld1q_s32(stage.halve));
+  result = vbslq_s32(halve, vshrq_n_s32(result, 1), result);
+
+  // Registers are 16 bits wide, so the result is truncated to that before clamping.
+  int16x4_t narrowed = vmovn_s32(result);
+  narrowed = vmax_s16(narrowed, vld1_s16(stage.min));
+  narrowed = vmin_s16(narrowed, vld1_s16(stage.max));
+  vst1_s16(out, narrowed);
+}
+
+#else
+
+void CombineRegular(const RegularStage& stage, const s16 a[4], const s16 b[4], const s16 c[4],
+                    const s16 d[4], s16 out[4])
+{
+  for (int i = 0; i < 4; i++)
+  {
+    const s32 input_a = a[i] & 0xFF;
+    const s32 input_b = b[i] & 0xFF;
+    const s32 input_c = (c[i] & 0xFF) + ((c[i] & 0xFF) >> 7);
+    const s32 input_d = static_cast<s16>(d[i] << 5) >> 5;
+
+    s32 temp = (input_a * (256 - input_c) + input_b * input_c) * stage.scale[i];
+    temp += stage.round[i];
+    if (stage.negate_input[i])
+      temp = -temp >> 8;
+    else if (stage.negate_result[i])
+      temp = -(temp >> 8);
+    else
+      temp >>= 8;
+
+    s32 result = (input_d + stage.bias[i]) * stage.scale[i] + temp;
+    if (stage.halve[i])
+      result >>= 1;
+
+    out[i] = std::clamp<s16>(static_cast<s16>(result), stage.min[i], stage.max[i]);
+  }
+}
+
+#endif
+}  // namespace TevCombiner
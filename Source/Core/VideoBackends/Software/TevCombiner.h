@@ -0,0 +1,39 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/BPMemory.h"
+
+// The regular (non-compare) TEV operation, done for all four components of a pixel at once.
+// Components are in the ABGR order Tev uses for its registers, so lane 0 is the alpha combiner
+// and lanes 1-3 are the color combiner.
+//
+// Only the combiners are vectorized, across the components of one pixel. Texture sampling, the
+// alpha test, the depth test and blending all stay per pixel, with early outs, so there is no quad
+// or span pipeline which would vectorize across pixels. Compare modes use the scalar combiners.
+namespace TevCombiner
+{
+// Everything about a stage which doesn't change from pixel to pixel.
+struct RegularStage
+{
+  s16 scale[4];  // 1 << shift
+  s16 bias[4];
+  s32 round[4];
+  s32 negate_result[4];  // all bits set where the color combiner subtracts
+  s32 negate_input[4];   // all bits set where the alpha combiner subtracts
+  s32 halve[4];          // all bits set for the divide by 2 scale
+  s16 min[4];
+  s16 max[4];
+};
+
+RegularStage MakeRegularStage(const TevStageCombiner::ColorCombiner& cc,
+                              const TevStageCombiner::AlphaCombiner& ac);
+
+// Computes d + bias +/- lerp(a, b, c) with the scale and clamp of the stage. The inputs are full
+// register values, and are truncated to the widths the hardware uses here.
+void CombineRegular(const RegularStage& stage, const s16 a[4], const s16 b[4], const s16 c[4],
+                    const s16 d[4], s16 out[4]);
+}  // namespace TevCombiner
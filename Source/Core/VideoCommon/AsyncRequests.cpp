@@ -4,6 +4,8 @@
 
 #include <mutex>
 
+#include "Common/Timer.h"
+
 #include "VideoCommon/AsyncRequests.h"
 #include "VideoCommon/Fifo.h"
 #include "VideoCommon/RenderBase.h"
@@ -98,7 +100,11 @@ void AsyncRequests::PushEvent(const AsyncRequests::Event& event, bool blocking)
   {
     Fifo::RunGpu();
     m_wake_me_up_again = true;
+    const bool collect_stats = Fifo::IsSyncStatsEnabled();
+    const u64 start = collect_stats ? Common::Timer::GetTimeUs() : 0;
     m_cond.wait(lock, [this] { return m_queue.empty(); });
+    if (collect_stats)
+      Fifo::AddSyncStall(Common::Timer::GetTimeUs() - start);
   }
 }
 
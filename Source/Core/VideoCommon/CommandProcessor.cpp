@@ -344,7 +344,7 @@ void GatherPipeBursted()
 
   Common::AtomicAdd(fifo.CPReadWriteDistance, GATHER_PIPE_SIZE);
 
-  Fifo::RunGpu();
+  Fifo::RunGpuBatched();
 
   ASSERT_MSG(COMMANDPROCESSOR, fifo.CPReadWriteDistance <= fifo.CPEnd - fifo.CPBase,
              "FIFO is overflowed by GatherPipe !\nCPU thread is too fast!");
@@ -4,7 +4,9 @@
 
 #include "VideoCommon/Fifo.h"
 
+#include <algorithm>
 #include <atomic>
+#include <cinttypes>
 #include <cstring>
 
 #include "Common/Assert.h"
@@ -13,9 +15,13 @@
 #include "Common/ChunkFile.h"
 #include "Common/Event.h"
 #include "Common/FPURoundMode.h"
+#include "Common/Logging/Log.h"
+#include "Common/MathUtil.h"
 #include "Common/MemoryUtil.h"
 #include "Common/MsgHandler.h"
+#include "Common/Timer.h"
 
+#include "Core/Config/MainSettings.h"
 #include "Core/ConfigManager.h"
 #include "Core/CoreTiming.h"
 #include "Core/HW/Memmap.h"
@@ -73,6 +79,35 @@ static std::atomic<int> s_sync_ticks;
 static bool s_syncing_suspended;
 static Common::Event s_sync_wakeup_event;
 
+// Wakeup batching, see RunGpuBatched.
+static u32 s_wakeup_threshold;
+static int s_wakeup_max_delay;
+static std::atomic<bool> s_wakeup_deferred;
+static CoreTiming::EventType* s_event_deferred_wakeup;
+
+// Set by the CPU thread when it wakes up the GPU thread, and cleared by the GPU thread once it
+// starts running.
+static std::atomic<u64> s_wakeup_request_time_us;
+
+// CPU/GPU synchronization statistics, only collected with GPUSyncStats set. Written by both the
+// CPU and the GPU thread, so every counter is updated on its own.
+template <size_t N>
+using AtomicHistogram = std::array<std::atomic<u64>, N>;
+constexpr size_t HISTOGRAM_SIZE = std::tuple_size<SyncStats::Histogram>::value;
+
+static struct
+{
+  std::atomic<u64> frames;
+  std::atomic<u64> stalls;
+  std::atomic<u64> stall_time_us;
+  std::atomic<u64> deferred_wakeups;
+  AtomicHistogram<HISTOGRAM_SIZE> stall_us;
+  AtomicHistogram<HISTOGRAM_SIZE> frame_stall_us;
+  AtomicHistogram<HISTOGRAM_SIZE> wakeup_latency_us;
+  std::atomic<u64> current_frame_stall_us;
+} s_sync_stats;
+static bool s_sync_stats_enabled;
+
 void DoState(PointerWrap& p)
 {
   p.DoArray(s_video_buffer, FIFO_SIZE);
@@ -90,10 +125,97 @@ void DoState(PointerWrap& p)
   p.Do(s_syncing_suspended);
 }
 
+template <size_t N>
+static void AddToHistogram(AtomicHistogram<N>& histogram, u64 us)
+{
+  const size_t bucket = us == 0 ? 0 : static_cast<size_t>(IntLog2(us)) + 1;
+  histogram[std::min(bucket, N - 1)].fetch_add(1, std::memory_order_relaxed);
+}
+
+template <size_t N>
+static void LoadHistogram(SyncStats::Histogram& dst, const AtomicHistogram<N>& histogram)
+{
+  for (size_t i = 0; i < N; i++)
+    dst[i] = histogram[i].load(std::memory_order_relaxed);
+}
+
+SyncStats GetSyncStats()
+{
+  SyncStats stats;
+  stats.frames = s_sync_stats.frames.load(std::memory_order_relaxed);
+  stats.stalls = s_sync_stats.stalls.load(std::memory_order_relaxed);
+  stats.stall_time_us = s_sync_stats.stall_time_us.load(std::memory_order_relaxed);
+  stats.deferred_wakeups = s_sync_stats.deferred_wakeups.load(std::memory_order_relaxed);
+  LoadHistogram(stats.stall_us, s_sync_stats.stall_us);
+  LoadHistogram(stats.frame_stall_us, s_sync_stats.frame_stall_us);
+  LoadHistogram(stats.wakeup_latency_us, s_sync_stats.wakeup_latency_us);
+  return stats;
+}
+
+void ResetSyncStats()
+{
+  s_sync_stats.frames = 0;
+  s_sync_stats.stalls = 0;
+  s_sync_stats.stall_time_us = 0;
+  s_sync_stats.deferred_wakeups = 0;
+  for (auto* histogram : {&s_sync_stats.stall_us, &s_sync_stats.frame_stall_us,
+                          &s_sync_stats.wakeup_latency_us})
+  {
+    for (std::atomic<u64>& bucket : *histogram)
+      bucket = 0;
+  }
+  s_sync_stats.current_frame_stall_us = 0;
+}
+
+bool IsSyncStatsEnabled()
+{
+  return s_sync_stats_enabled;
+}
+
+void AddSyncStall(u64 stall_us)
+{
+  if (!s_sync_stats_enabled)
+    return;
+
+  s_sync_stats.stalls.fetch_add(1, std::memory_order_relaxed);
+  s_sync_stats.stall_time_us.fetch_add(stall_us, std::memory_order_relaxed);
+  AddToHistogram(s_sync_stats.stall_us, stall_us);
+  s_sync_stats.current_frame_stall_us.fetch_add(stall_us, std::memory_order_relaxed);
+}
+
+static void EndSyncStatsFrame()
+{
+  if (!s_sync_stats_enabled)
+    return;
+
+  s_sync_stats.frames.fetch_add(1, std::memory_order_relaxed);
+  AddToHistogram(s_sync_stats.frame_stall_us,
+                 s_sync_stats.current_frame_stall_us.exchange(0, std::memory_order_relaxed));
+}
+
+static void WaitForGpuLoop()
+{
+  if (s_gpu_mainloop.IsDone())
+    return;
+
+  if (!s_sync_stats_enabled)
+  {
+    s_gpu_mainloop.Wait();
+    return;
+  }
+
+  const u64 start = Common::Timer::GetTimeUs();
+  s_gpu_mainloop.Wait();
+  AddSyncStall(Common::Timer::GetTimeUs() - start);
+}
+
 void PauseAndLock(bool doLock, bool unpauseOnUnlock)
 {
   if (doLock)
   {
+    if (s_wakeup_deferred)
+      RunGpu();
+
     SyncGPU(SyncGPUReason::Other);
     EmulatorState(false);
 
@@ -119,6 +241,14 @@ void Init()
   if (SConfig::GetInstance().bCPUThread)
     s_gpu_mainloop.Prepare();
   s_sync_ticks.store(0);
+
+  s_wakeup_threshold =
+      static_cast<u32>(std::max(Config::Get(Config::MAIN_GPU_WAKEUP_THRESHOLD), 0));
+  s_wakeup_max_delay = std::max(Config::Get(Config::MAIN_GPU_WAKEUP_MAX_DELAY), 1);
+  s_wakeup_deferred = false;
+  s_wakeup_request_time_us = 0;
+  s_sync_stats_enabled = Config::Get(Config::MAIN_GPU_SYNC_STATS);
+  ResetSyncStats();
 }
 
 void Shutdown()
@@ -126,6 +256,16 @@ void Shutdown()
   if (s_gpu_mainloop.IsRunning())
     PanicAlert("Fifo shutting down while active");
 
+  const SyncStats stats = GetSyncStats();
+  if (stats.frames != 0)
+  {
+    NOTICE_LOG(VIDEO,
+               "CPU waited %" PRIu64 " times on the GPU thread for %.2f ms (%.3f ms per frame), "
+               "%" PRIu64 " wakeups deferred",
+               stats.stalls, stats.stall_time_us / 1000.0,
+               stats.stall_time_us / 1000.0 / stats.frames, stats.deferred_wakeups);
+  }
+
   Common::FreeMemoryPages(s_video_buffer, FIFO_SIZE + 4);
   s_video_buffer = nullptr;
   s_video_buffer_write_ptr = nullptr;
@@ -160,9 +300,12 @@ void EmulatorState(bool running)
 
 void SyncGPU(SyncGPUReason reason, bool may_move_read_ptr)
 {
+  if (reason == SyncGPUReason::Swap)
+    EndSyncStatsFrame();
+
   if (s_use_deterministic_gpu_thread)
   {
-    s_gpu_mainloop.Wait();
+    WaitForGpuLoop();
     if (!s_gpu_mainloop.IsRunning())
       return;
 
@@ -308,6 +451,16 @@ void RunGpuLoop()
       [] {
         const SConfig& param = SConfig::GetInstance();
 
+        if (s_sync_stats_enabled && s_wakeup_request_time_us.load(std::memory_order_relaxed) != 0)
+        {
+          const u64 request_time = s_wakeup_request_time_us.exchange(0);
+          if (request_time != 0)
+          {
+            AddToHistogram(s_sync_stats.wakeup_latency_us,
+                           Common::Timer::GetTimeUs() - request_time);
+          }
+        }
+
         // Run events from the CPU thread.
         AsyncRequests::GetInstance()->PullEvents();
 
@@ -404,7 +557,10 @@ void FlushGpu()
   if (!param.bCPUThread || s_use_deterministic_gpu_thread)
     return;
 
-  s_gpu_mainloop.Wait();
+  if (s_wakeup_deferred)
+    RunGpu();
+
+  WaitForGpuLoop();
 }
 
 void GpuMaySleep()
@@ -425,6 +581,9 @@ void RunGpu()
   // wake up GPU thread
   if (param.bCPUThread && !s_use_deterministic_gpu_thread)
   {
+    s_wakeup_deferred = false;
+    if (s_sync_stats_enabled && s_wakeup_request_time_us.load(std::memory_order_relaxed) == 0)
+      s_wakeup_request_time_us = Common::Timer::GetTimeUs();
     s_gpu_mainloop.Wakeup();
   }
 
@@ -440,6 +599,32 @@ void RunGpu()
   }
 }
 
+// Called by the CPU thread for every gather pipe burst. Waking up the GPU thread for each 32 bytes
+// of new data is expensive when it keeps going back to sleep in between, so with
+// GPUWakeupThreshold set, a sleeping GPU thread is only woken once that many bytes are pending, or
+// at the latest GPUWakeupMaxDelay CPU cycles after the first deferred burst. Anything which waits
+// for the GPU thread goes through RunGpu or FlushGpu first, which don't defer.
+void RunGpuBatched()
+{
+  const SConfig& param = SConfig::GetInstance();
+
+  if (s_wakeup_threshold != 0 && param.bCPUThread && !s_use_deterministic_gpu_thread &&
+      !param.bSyncGPU && s_gpu_mainloop.IsDone() &&
+      CommandProcessor::fifo.CPReadWriteDistance < s_wakeup_threshold)
+  {
+    if (!s_wakeup_deferred)
+    {
+      s_wakeup_deferred = true;
+      CoreTiming::ScheduleEvent(s_wakeup_max_delay, s_event_deferred_wakeup);
+      if (s_sync_stats_enabled)
+        s_sync_stats.deferred_wakeups.fetch_add(1, std::memory_order_relaxed);
+    }
+    return;
+  }
+
+  RunGpu();
+}
+
 static int RunGpuOnCpu(int ticks)
 {
   CommandProcessor::SCPFifoStruct& fifo = CommandProcessor::fifo;
@@ -564,7 +749,12 @@ static int WaitForGpuThread(int ticks)
 
   // Wait for GPU
   if (now >= param.iSyncGpuMaxDistance)
+  {
+    const u64 start = s_sync_stats_enabled ? Common::Timer::GetTimeUs() : 0;
     s_sync_wakeup_event.Wait();
+    if (s_sync_stats_enabled)
+      AddSyncStall(Common::Timer::GetTimeUs() - start);
+  }
 
   return GPU_TIME_SLOT_SIZE;
 }
@@ -588,10 +778,18 @@ static void SyncGPUCallback(u64 ticks, s64 cyclesLate)
     CoreTiming::ScheduleEvent(next, s_event_sync_gpu, next);
 }
 
+static void DeferredWakeupCallback(u64 userdata, s64 cycles_late)
+{
+  if (s_wakeup_deferred)
+    RunGpu();
+}
+
 // Initialize GPU - CPU thread syncing, this gives us a deterministic way to start the GPU thread.
 void Prepare()
 {
   s_event_sync_gpu = CoreTiming::RegisterEvent("SyncGPUCallback", SyncGPUCallback);
+  s_event_deferred_wakeup =
+      CoreTiming::RegisterEvent("GPUDeferredWakeupCallback", DeferredWakeupCallback);
   s_syncing_suspended = true;
 }
 }  // namespace Fifo
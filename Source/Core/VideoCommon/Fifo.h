@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
 #include "Common/CommonTypes.h"
 
@@ -38,6 +39,7 @@ void* PopFifoAuxBuffer(size_t size);
 
 void FlushGpu();
 void RunGpu();
+void RunGpuBatched();
 void GpuMaySleep();
 void RunGpuLoop();
 void ExitGpuLoop();
@@ -45,4 +47,28 @@ void EmulatorState(bool running);
 bool AtBreakpoint();
 void ResetVideoBuffer();
 
+// How long the CPU thread spent waiting for the GPU thread in dual core mode, and how long the GPU
+// thread took to pick up new work after being woken up.
+struct SyncStats
+{
+  // Bucket 0 counts durations below 1 us, bucket i durations in [2^(i-1), 2^i) us.
+  // The last bucket also counts everything longer.
+  using Histogram = std::array<u64, 24>;
+
+  u64 frames = 0;
+  u64 stalls = 0;
+  u64 stall_time_us = 0;
+  u64 deferred_wakeups = 0;
+  Histogram stall_us{};
+  Histogram frame_stall_us{};
+  Histogram wakeup_latency_us{};
+};
+
+SyncStats GetSyncStats();
+void ResetSyncStats();
+// Set by GPUSyncStats. Nothing is collected otherwise.
+bool IsSyncStatsEnabled();
+// Used for waits on the GPU thread which happen outside of the Fifo code.
+void AddSyncStall(u64 stall_us);
+
 }  // namespace Fifo
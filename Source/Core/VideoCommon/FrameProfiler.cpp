@@ -0,0 +1,77 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/FrameProfiler.h"
+
+#include <atomic>
+#include <chrono>
+
+namespace FrameProfiler
+{
+namespace
+{
+std::atomic<bool> s_enabled{false};
+std::array<std::atomic<u64>, NUM_SECTIONS> s_times{};
+
+// The innermost section entered on this thread, and when time started counting towards it.
+thread_local std::optional<Section> s_current_section;
+thread_local u64 s_section_start;
+
+u64 GetTimeNs()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void AddTime(Section section, u64 time)
+{
+  s_times[static_cast<std::size_t>(section)].fetch_add(time, std::memory_order_relaxed);
+}
+}  // namespace
+
+void SetEnabled(bool enabled)
+{
+  s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool IsEnabled()
+{
+  return s_enabled.load(std::memory_order_relaxed);
+}
+
+Times TakeTimes()
+{
+  Times times;
+  for (std::size_t i = 0; i < NUM_SECTIONS; i++)
+    times[i] = s_times[i].exchange(0, std::memory_order_relaxed);
+  return times;
+}
+
+ScopedSection::ScopedSection(Section section)
+{
+  if (!IsEnabled())
+    return;
+
+  const u64 now = GetTimeNs();
+  if (s_current_section)
+    AddTime(*s_current_section, now - s_section_start);
+
+  m_active = true;
+  m_outer_section = s_current_section;
+  s_current_section = section;
+  s_section_start = now;
+}
+
+ScopedSection::~ScopedSection()
+{
+  if (!m_active)
+    return;
+
+  const u64 now = GetTimeNs();
+  AddTime(*s_current_section, now - s_section_start);
+  s_current_section = m_outer_section;
+  s_section_start = now;
+}
+}  // namespace FrameProfiler
@@ -0,0 +1,52 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+
+#include "Common/CommonTypes.h"
+
+// Measures the CPU time spent in some parts of the video emulation, for benchmarks like the fifo
+// log benchmark of DolphinNoGUI. The timers do nothing unless they have been enabled.
+namespace FrameProfiler
+{
+enum class Section
+{
+  OpcodeDecoder,
+  VertexLoader,
+  TextureCache,
+  ShaderCache,
+  Count
+};
+
+constexpr std::size_t NUM_SECTIONS = static_cast<std::size_t>(Section::Count);
+
+// Nanoseconds spent in each section.
+using Times = std::array<u64, NUM_SECTIONS>;
+
+void SetEnabled(bool enabled);
+bool IsEnabled();
+
+// Returns the time spent in each section since the last call, and starts over from zero.
+Times TakeTimes();
+
+// Counts the time until it goes out of scope towards a section. Time spent in a section which is
+// entered from another one only counts towards the inner section.
+class ScopedSection
+{
+public:
+  explicit ScopedSection(Section section);
+  ~ScopedSection();
+
+  ScopedSection(const ScopedSection&) = delete;
+  ScopedSection& operator=(const ScopedSection&) = delete;
+
+private:
+  bool m_active = false;
+  std::optional<Section> m_outer_section;
+};
+}  // namespace FrameProfiler
@@ -15,6 +15,13 @@
 // when they are called. The reason is that the vertex format affects the sizes of the vertices.
 
 #include "VideoCommon/OpcodeDecoding.h"
+
+#include <cstring>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "Common/CommonTypes.h"
 #include "Common/Logging/Log.h"
 #include "Common/MsgHandler.h"
@@ -25,6 +32,7 @@
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/Fifo.h"
+#include "VideoCommon/FrameProfiler.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
 #include "VideoCommon/VideoCommon.h"
@@ -36,6 +44,178 @@ namespace OpcodeDecoder
 {
 static bool s_bFifoErrorSeen = false;
 
+// The commands of a display list which have an effect, with their operands already parsed. Vertex
+// and XF data is referenced by its offset in the display list.
+struct DecodedCommand
+{
+  u8 cmd_byte;
+  u8 sub_cmd;
+  u16 num_vertices;
+  u32 value;
+  u32 offset;
+};
+
+// Display lists are called with the same contents many times per frame in most games. Decoding
+// one is cheap compared to what its commands do, but skipping it still saves walking the bytes and
+// looking up the vertex size of each primitive. Entries are checked against the vertex formats on
+// every call, since those determine the size of the primitives, and against the bytes of the
+// display list outside of its vertex and XF data. Replaying reads that data from memory again, so
+// only writes to the bytes the commands were decoded from need to invalidate an entry, and
+// comparing those is much cheaper than hashing the whole list when it is mostly vertices.
+struct DecodedDisplayList
+{
+  const u8* base = nullptr;
+  bool cacheable = true;
+  // The offset of the first byte after the last vertex or XF data seen while recording.
+  u32 structure_end = 0;
+
+  // (offset, length) of each run of bytes outside of vertex and XF data, and their contents.
+  std::vector<std::pair<u32, u32>> structure_spans;
+  std::vector<u8> structure;
+  TVtxDesc vtx_desc;
+  VAT vtx_attr[8];
+  u32 cycles = 0;
+  std::vector<DecodedCommand> commands;
+};
+
+// Cleared when it grows past this, which only happens with games that generate display lists.
+constexpr size_t MAX_CACHED_COMMANDS = 1024 * 1024;
+
+static std::unordered_map<u64, DecodedDisplayList> s_display_list_cache;
+static size_t s_num_cached_commands = 0;
+
+template <bool is_preprocess>
+static u8* RunCommands(DataReader src, u32* cycles, bool in_display_list, u32* need_size,
+                       DecodedDisplayList* recording);
+
+static bool MatchesVertexFormats(const DecodedDisplayList& display_list)
+{
+  return display_list.vtx_desc.Hex == g_main_cp_state.vtx_desc.Hex &&
+         std::memcmp(display_list.vtx_attr, g_main_cp_state.vtx_attr,
+                     sizeof(display_list.vtx_attr)) == 0;
+}
+
+static bool MatchesStructure(const DecodedDisplayList& display_list, const u8* start_address)
+{
+  const u8* expected = display_list.structure.data();
+  for (const auto& [offset, length] : display_list.structure_spans)
+  {
+    if (std::memcmp(start_address + offset, expected, length) != 0)
+      return false;
+    expected += length;
+  }
+  return true;
+}
+
+// Called while recording for vertex and XF data, which is skipped when comparing the contents.
+static void AddPayload(DecodedDisplayList* recording, const u8* data, u32 length)
+{
+  const u32 offset = u32(data - recording->base);
+  if (offset > recording->structure_end)
+  {
+    recording->structure_spans.emplace_back(recording->structure_end,
+                                            offset - recording->structure_end);
+  }
+  recording->structure_end = offset + length;
+}
+
+static void ReplayDisplayList(const DecodedDisplayList& display_list, u8* start_address, u32 size)
+{
+  u8* const end_address = start_address + size;
+  for (const DecodedCommand& command : display_list.commands)
+  {
+    switch (command.cmd_byte)
+    {
+    case GX_LOAD_CP_REG:
+      LoadCPReg(command.sub_cmd, command.value, false);
+      INCSTAT(g_stats.this_frame.num_cp_loads);
+      break;
+
+    case GX_LOAD_XF_REG:
+      LoadXFReg(((command.value >> 16) & 15) + 1, command.value & 0xFFFF,
+                DataReader(start_address + command.offset, end_address));
+      INCSTAT(g_stats.this_frame.num_xf_loads);
+      break;
+
+    case GX_LOAD_INDX_A:
+    case GX_LOAD_INDX_B:
+    case GX_LOAD_INDX_C:
+    case GX_LOAD_INDX_D:
+      LoadIndexedXF(command.value, command.sub_cmd);
+      break;
+
+    case GX_LOAD_BP_REG:
+      LoadBPReg(command.value);
+      INCSTAT(g_stats.this_frame.num_bp_loads);
+      break;
+
+    default:
+      VertexLoaderManager::RunVertices(
+          command.cmd_byte & GX_VAT_MASK,
+          (command.cmd_byte & GX_PRIMITIVE_MASK) >> GX_PRIMITIVE_SHIFT, command.num_vertices,
+          DataReader(start_address + command.offset, end_address));
+      break;
+    }
+  }
+}
+
+// Runs the display list from the cache if it was decoded before, or decodes it and adds it.
+static u32 RunCachedDisplayList(u32 address, u8* start_address, u32 size)
+{
+  const u64 key = static_cast<u64>(address) << 32 | size;
+
+  auto iter = s_display_list_cache.find(key);
+  if (iter != s_display_list_cache.end() && MatchesVertexFormats(iter->second) &&
+      MatchesStructure(iter->second, start_address))
+  {
+    ReplayDisplayList(iter->second, start_address, size);
+    return iter->second.cycles;
+  }
+
+  if (iter != s_display_list_cache.end())
+  {
+    s_num_cached_commands -= iter->second.commands.size();
+    s_display_list_cache.erase(iter);
+  }
+
+  DecodedDisplayList display_list;
+  display_list.base = start_address;
+  display_list.vtx_desc = g_main_cp_state.vtx_desc;
+  std::memcpy(display_list.vtx_attr, g_main_cp_state.vtx_attr, sizeof(display_list.vtx_attr));
+
+  // Running the commands can write to memory through EFB copies, so keep what was decoded.
+  const std::vector<u8> contents(start_address, start_address + size);
+  const u8* const end =
+      RunCommands<false>(DataReader(start_address, start_address + size), &display_list.cycles,
+                         true, nullptr, &display_list);
+
+  // Truncated commands are skipped or stop decoding depending on where they end, so they're
+  // always decoded again.
+  if (!display_list.cacheable || end != start_address + size)
+    return display_list.cycles;
+
+  if (s_num_cached_commands + display_list.commands.size() > MAX_CACHED_COMMANDS)
+  {
+    s_display_list_cache.clear();
+    s_num_cached_commands = 0;
+  }
+  s_num_cached_commands += display_list.commands.size();
+
+  const u32 structure_end = display_list.structure_end;
+  if (size > structure_end)
+    display_list.structure_spans.emplace_back(structure_end, size - structure_end);
+  for (const auto& [offset, length] : display_list.structure_spans)
+  {
+    display_list.structure.insert(display_list.structure.end(), contents.begin() + offset,
+                                  contents.begin() + offset + length);
+  }
+
+  const u32 cycles = display_list.cycles;
+  display_list.base = nullptr;
+  s_display_list_cache.emplace(key, std::move(display_list));
+  return cycles;
+}
+
 static u32 InterpretDisplayList(u32 address, u32 size)
 {
   u8* startAddress;
@@ -53,7 +233,11 @@ static u32 InterpretDisplayList(u32 address, u32 size)
     // temporarily swap dl and non-dl (small "hack" for the stats)
     g_stats.SwapDL();
 
-    Run(DataReader(startAddress, startAddress + size), &cycles, true);
+    // The FIFO recorder needs to see each command as it's decoded.
+    if (g_bRecordFifoData)
+      Run(DataReader(startAddress, startAddress + size), &cycles, true);
+    else
+      cycles = RunCachedDisplayList(address, startAddress, size);
     INCSTAT(g_stats.this_frame.num_dlists_called);
 
     // un-swap
@@ -78,10 +262,25 @@ static void InterpretDisplayListPreprocess(u32 address, u32 size)
 void Init()
 {
   s_bFifoErrorSeen = false;
+  s_display_list_cache.clear();
+  s_num_cached_commands = 0;
 }
 
 template <bool is_preprocess>
 u8* Run(DataReader src, u32* cycles, bool in_display_list, u32* need_size)
+{
+  // Preprocessing isn't counted, as the commands are decoded again when they are run.
+  std::optional<FrameProfiler::ScopedSection> section;
+  if (!is_preprocess)
+    section.emplace(FrameProfiler::Section::OpcodeDecoder);
+
+  return RunCommands<is_preprocess>(src, cycles, in_display_list, need_size, nullptr);
+}
+
+// If recording is set, the commands which have an effect are added to it as they are run.
+template <bool is_preprocess>
+static u8* RunCommands(DataReader src, u32* cycles, bool in_display_list, u32* need_size,
+                       DecodedDisplayList* recording)
 {
   int refarray;
   u8* opcodeStart;
@@ -115,6 +314,8 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list, u32* need_size)
       LoadCPReg(sub_cmd, value, is_preprocess);
       if (!is_preprocess)
         INCSTAT(g_stats.this_frame.num_cp_loads);
+      if (recording)
+        recording->commands.push_back({cmd_byte, sub_cmd, 0, value, 0});
     }
     break;
 
@@ -137,6 +338,12 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list, u32* need_size)
 
         INCSTAT(g_stats.this_frame.num_xf_loads);
       }
+      if (recording)
+      {
+        recording->commands.push_back(
+            {cmd_byte, 0, 0, Cmd2, u32(src.GetPointer() - recording->base)});
+        AddPayload(recording, src.GetPointer(), transfer_size * sizeof(u32));
+      }
       src.Skip<u32>(transfer_size);
     }
     break;
@@ -158,9 +365,16 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list, u32* need_size)
         goto end;
       totalCycles += 6;
       if (is_preprocess)
+      {
         PreprocessIndexedXF(src.Read<u32>(), refarray);
+      }
       else
-        LoadIndexedXF(src.Read<u32>(), refarray);
+      {
+        const u32 value = src.Read<u32>();
+        LoadIndexedXF(value, refarray);
+        if (recording)
+          recording->commands.push_back({cmd_byte, u8(refarray), 0, value, 0});
+      }
       break;
 
     case GX_CMD_CALL_DL:
@@ -212,6 +426,8 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list, u32* need_size)
         {
           LoadBPReg(bp_cmd);
           INCSTAT(g_stats.this_frame.num_bp_loads);
+          if (recording)
+            recording->commands.push_back({cmd_byte, 0, 0, bp_cmd, 0});
         }
       }
       break;
@@ -239,6 +455,12 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list, u32* need_size)
 
           if(!is_preprocess)
             VertexLoaderManager::RunVertices(vtx_attr_group, primitive, num_vertices, src);
+          if (recording)
+          {
+            recording->commands.push_back(
+                {cmd_byte, 0, num_vertices, 0, u32(src.GetPointer() - recording->base)});
+            AddPayload(recording, src.GetPointer(), bytes);
+          }
 
           src.Skip(bytes);
 
@@ -254,6 +476,8 @@ u8* Run(DataReader src, u32* cycles, bool in_display_list, u32* need_size)
                   opcodeStart, is_preprocess ? "yes" : "no");
         s_bFifoErrorSeen = true;
         totalCycles += 1;
+        if (recording)
+          recording->cacheable = false;
       }
       break;
     }
@@ -0,0 +1,124 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/PipelineUIDCorpus.h"
+
+#include <algorithm>
+
+#include "Common/File.h"
+
+namespace VideoCommon
+{
+namespace
+{
+constexpr u32 FILE_MAGIC = 0x46495550;      // PUIF
+constexpr u32 OLD_FILE_MAGIC = 0x44495550;  // PUID
+constexpr u64 HEADER_SIZE = sizeof(u32) + sizeof(u32);
+}  // namespace
+
+bool PipelineUIDCorpus::Add(const SerializedGXPipelineUid& uid, u32 first_use_frame)
+{
+  const auto [iter, inserted] = m_entries.emplace(uid, first_use_frame);
+  if (!inserted)
+    iter->second = std::min(iter->second, first_use_frame);
+  return inserted;
+}
+
+void PipelineUIDCorpus::Merge(const PipelineUIDCorpus& other)
+{
+  for (const auto& [uid, first_use_frame] : other.m_entries)
+    Add(uid, first_use_frame);
+}
+
+std::optional<u32> PipelineUIDCorpus::GetFirstUseFrame(const SerializedGXPipelineUid& uid) const
+{
+  const auto iter = m_entries.find(uid);
+  if (iter == m_entries.end())
+    return std::nullopt;
+  return iter->second;
+}
+
+std::vector<PipelineUIDCorpus::Entry> PipelineUIDCorpus::GetEntriesByFirstUse() const
+{
+  std::vector<Entry> entries;
+  entries.reserve(m_entries.size());
+  for (const auto& [uid, first_use_frame] : m_entries)
+    entries.push_back(Entry{uid, first_use_frame});
+
+  // The map is ordered by UID, so this is deterministic for equal frames.
+  std::stable_sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+    return lhs.first_use_frame < rhs.first_use_frame;
+  });
+  return entries;
+}
+
+bool PipelineUIDCorpus::Load(const std::string& path)
+{
+  File::IOFile file(path, "rb");
+  return file.IsOpen() && ReadFile(file);
+}
+
+bool PipelineUIDCorpus::Save(const std::string& path) const
+{
+  File::IOFile file(path, "wb");
+  if (!WriteHeader(file))
+    return false;
+
+  const std::vector<Entry> entries = GetEntriesByFirstUse();
+  return file.WriteArray(entries.data(), entries.size());
+}
+
+bool PipelineUIDCorpus::ReadFile(File::IOFile& file, bool* is_old_format)
+{
+  u32 magic;
+  u32 version;
+  if (!file.ReadBytes(&magic, sizeof(magic)) || !file.ReadBytes(&version, sizeof(version)) ||
+      (magic != FILE_MAGIC && magic != OLD_FILE_MAGIC) || version != GX_PIPELINE_UID_VERSION)
+  {
+    return false;
+  }
+
+  const bool old_format = magic == OLD_FILE_MAGIC;
+  if (is_old_format)
+    *is_old_format = old_format;
+
+  // A size which isn't a multiple of the entry size means the file was cut off (e.g. Dolphin
+  // crashed while writing it), and the remaining entries may be garbage.
+  const u64 file_size = file.GetSize();
+  const size_t entry_size = old_format ? sizeof(SerializedGXPipelineUid) : sizeof(Entry);
+  if ((file_size - HEADER_SIZE) % entry_size != 0)
+    return false;
+
+  const size_t num_entries = static_cast<size_t>((file_size - HEADER_SIZE) / entry_size);
+  if (old_format)
+  {
+    std::vector<SerializedGXPipelineUid> uids(num_entries);
+    if (!file.ReadArray(uids.data(), uids.size()))
+      return false;
+
+    for (const SerializedGXPipelineUid& uid : uids)
+      Add(uid, 0);
+    return true;
+  }
+
+  std::vector<Entry> entries(num_entries);
+  if (!file.ReadArray(entries.data(), entries.size()))
+    return false;
+
+  for (const Entry& entry : entries)
+    Add(entry.uid, entry.first_use_frame);
+  return true;
+}
+
+bool PipelineUIDCorpus::WriteHeader(File::IOFile& file)
+{
+  return file.WriteBytes(&FILE_MAGIC, sizeof(FILE_MAGIC)) &&
+         file.WriteBytes(&GX_PIPELINE_UID_VERSION, sizeof(GX_PIPELINE_UID_VERSION));
+}
+
+bool PipelineUIDCorpus::WriteEntry(File::IOFile& file, const Entry& entry)
+{
+  return file.WriteBytes(&entry, sizeof(entry));
+}
+}  // namespace VideoCommon
@@ -0,0 +1,77 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "VideoCommon/GXPipelineTypes.h"
+
+namespace File
+{
+class IOFile;
+}
+
+namespace VideoCommon
+{
+// A set of the pipeline UIDs a game uses, each with the frame it was first used in.
+//
+// Serialized UIDs don't depend on the backend or the host, so corpora recorded on different
+// machines can be merged and precompiled anywhere. The file format is a header of a magic number
+// and GX_PIPELINE_UID_VERSION, followed by Entry records. The per-game UID cache uses the same
+// format, so it can be shared as-is. Files in the older format of the UID cache, which only had
+// the UIDs after a different magic number, are read as if all UIDs were first used in frame 0.
+class PipelineUIDCorpus
+{
+public:
+#pragma pack(push, 1)
+  struct Entry
+  {
+    SerializedGXPipelineUid uid;
+    u32 first_use_frame;
+  };
+#pragma pack(pop)
+
+  std::size_t size() const { return m_entries.size(); }
+  bool empty() const { return m_entries.empty(); }
+  void clear() { m_entries.clear(); }
+
+  // Returns true if the UID is new. Otherwise, the earlier of the two first use frames is kept.
+  bool Add(const SerializedGXPipelineUid& uid, u32 first_use_frame);
+  void Merge(const PipelineUIDCorpus& other);
+  std::optional<u32> GetFirstUseFrame(const SerializedGXPipelineUid& uid) const;
+
+  // Entries ordered by the frame they were first used in.
+  std::vector<Entry> GetEntriesByFirstUse() const;
+
+  // Merges the entries of a corpus file. If the file is missing, was written for a different UID
+  // version or is truncated, nothing is merged and false is returned.
+  bool Load(const std::string& path);
+  bool Save(const std::string& path) const;
+
+  // For files which are kept open to append entries to. ReadFile expects the file to be
+  // positioned at its start, and on success leaves it positioned at its end. is_old_format is set
+  // if the file has to be rewritten before new entries can be appended to it.
+  bool ReadFile(File::IOFile& file, bool* is_old_format = nullptr);
+  static bool WriteHeader(File::IOFile& file);
+  static bool WriteEntry(File::IOFile& file, const Entry& entry);
+
+private:
+  struct UIDLess
+  {
+    bool operator()(const SerializedGXPipelineUid& lhs, const SerializedGXPipelineUid& rhs) const
+    {
+      return std::memcmp(&lhs, &rhs, sizeof(lhs)) < 0;
+    }
+  };
+
+  std::map<SerializedGXPipelineUid, u32, UIDLess> m_entries;
+};
+}  // namespace VideoCommon
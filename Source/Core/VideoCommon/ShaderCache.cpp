@@ -4,13 +4,21 @@
 
 #include "VideoCommon/ShaderCache.h"
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 #include "Common/Assert.h"
+#include "Common/CommonPaths.h"
+#include "Common/FileSearch.h"
 #include "Common/FileUtil.h"
 #include "Common/MsgHandler.h"
+#include "Common/StringUtil.h"
 #include "Core/ConfigManager.h"
 
 #include "VideoCommon/FramebufferManager.h"
 #include "VideoCommon/FramebufferShaderGen.h"
+#include "VideoCommon/FrameProfiler.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderManager.h"
@@ -47,6 +55,7 @@ void ShaderCache::InitializeShaderCache()
   {
     LoadCaches();
     LoadPipelineUIDCache();
+    LoadSharedPipelineUIDs();
   }
 
   // Compile all known UIDs.
@@ -81,6 +90,8 @@ void ShaderCache::Reload()
 
 void ShaderCache::RetrieveAsyncShaders()
 {
+  FrameProfiler::ScopedSection section(FrameProfiler::Section::ShaderCache);
+
   m_async_shader_compiler->RetrieveWorkItems();
 }
 
@@ -96,25 +107,39 @@ void ShaderCache::Shutdown()
 
 const AbstractPipeline* ShaderCache::GetPipelineForUid(const GXPipelineUid& uid)
 {
+  FrameProfiler::ScopedSection section(FrameProfiler::Section::ShaderCache);
+
   auto it = m_gx_pipeline_cache.find(uid);
   if (it != m_gx_pipeline_cache.end() && !it->second.second)
+  {
+    if (m_shared_gx_pipeline_uids.count(uid) != 0)
+      AppendGXPipelineUID(uid);
     return it->second.first.get();
+  }
 
   const bool exists_in_cache = it != m_gx_pipeline_cache.end();
   std::unique_ptr<AbstractPipeline> pipeline;
   std::optional<AbstractPipelineConfig> pipeline_config = GetGXPipelineConfig(uid);
   if (pipeline_config)
-    pipeline = g_renderer->CreatePipeline(*pipeline_config);
-  if (g_ActiveConfig.bShaderCache && !exists_in_cache)
+    pipeline = CreateGXPipeline(uid, *pipeline_config);
+  if (g_ActiveConfig.bShaderCache &&
+      (!exists_in_cache || m_shared_gx_pipeline_uids.count(uid) != 0))
+  {
     AppendGXPipelineUID(uid);
+  }
   return InsertGXPipeline(uid, std::move(pipeline));
 }
 
 std::optional<const AbstractPipeline*> ShaderCache::GetPipelineForUidAsync(const GXPipelineUid& uid)
 {
+  FrameProfiler::ScopedSection section(FrameProfiler::Section::ShaderCache);
+
   auto it = m_gx_pipeline_cache.find(uid);
   if (it != m_gx_pipeline_cache.end())
   {
+    if (m_shared_gx_pipeline_uids.count(uid) != 0)
+      AppendGXPipelineUID(uid);
+
     // .second is the pending flag, i.e. compiling in the background.
     if (!it->second.second)
       return it->second.first.get();
@@ -165,114 +190,53 @@ static void UnserializePipelineUid(const SerializedUidType& uid, UidType& real_u
   real_uid.blending_state.hex = uid.blending_state_bits;
 }
 
-template <ShaderStage stage, typename K, typename T>
-void ShaderCache::LoadShaderCache(T& cache, APIType api_type, const char* type, bool include_gameid)
+template <typename K>
+static void OpenDiskCache(IndexedDiskCache<K>& disk_cache, APIType api_type, const char* type,
+                          bool include_gameid)
 {
-  class CacheReader : public LinearDiskCacheReader<K, u8>
-  {
-  public:
-    CacheReader(T& cache_) : cache(cache_) {}
-    void Read(const K& key, const u8* value, u32 value_size)
-    {
-      auto shader = g_renderer->CreateShaderFromBinary(stage, value, value_size);
-      if (shader)
-      {
-        auto& entry = cache.shader_map[key];
-        entry.shader = std::move(shader);
-        entry.pending = false;
-
-        switch (stage)
-        {
-        case ShaderStage::Vertex:
-          INCSTAT(g_stats.num_vertex_shaders_created);
-          INCSTAT(g_stats.num_vertex_shaders_alive);
-          break;
-        case ShaderStage::Pixel:
-          INCSTAT(g_stats.num_pixel_shaders_created);
-          INCSTAT(g_stats.num_pixel_shaders_alive);
-          break;
-        default:
-          break;
-        }
-      }
-    }
-
-  private:
-    T& cache;
-  };
-
+  // This only maps the file. Cached binaries are read when the shader or pipeline is first needed.
   std::string filename = GetDiskShaderCacheFileName(api_type, type, include_gameid, true);
-  CacheReader reader(cache);
-  u32 count = cache.disk_cache.OpenAndRead(filename, reader);
-  INFO_LOG(VIDEO, "Loaded %u cached shaders from %s", count, filename.c_str());
+  u32 count = disk_cache.Open(filename);
+  INFO_LOG(VIDEO, "Opened %s with %u cache entries", filename.c_str(), count);
 }
 
-template <typename T>
-void ShaderCache::ClearShaderCache(T& cache)
+template <typename K>
+static std::unique_ptr<AbstractShader>
+CreateShaderFromDiskCache(ShaderStage stage, const IndexedDiskCache<K>& disk_cache, const K& uid)
 {
-  cache.disk_cache.Sync();
-  cache.disk_cache.Close();
-  cache.shader_map.clear();
+  const auto binary = disk_cache.Find(uid);
+  if (!binary)
+    return nullptr;
+
+  return g_renderer->CreateShaderFromBinary(stage, binary->data, binary->size);
 }
 
-template <typename KeyType, typename DiskKeyType, typename T>
-void ShaderCache::LoadPipelineCache(T& cache, LinearDiskCache<DiskKeyType, u8>& disk_cache,
-                                    APIType api_type, const char* type, bool include_gameid)
+// Objects created from the disk cache usually hand back the data they were created from. Only
+// write data which is new or differs from the cached data, e.g. because the cached data failed to
+// load after a driver update. The stale entry is then dropped when the cache is next opened.
+template <typename K>
+static void AppendToDiskCache(IndexedDiskCache<K>& disk_cache, const K& key,
+                              const std::vector<u8>& data)
 {
-  class CacheReader : public LinearDiskCacheReader<DiskKeyType, u8>
-  {
-  public:
-    CacheReader(ShaderCache* this_ptr_, T& cache_) : this_ptr(this_ptr_), cache(cache_) {}
-    bool AnyFailed() const { return failed; }
-    void Read(const DiskKeyType& key, const u8* value, u32 value_size)
-    {
-      KeyType real_uid;
-      UnserializePipelineUid(key, real_uid);
-
-      // Skip those which are already compiled.
-      if (failed || cache.find(real_uid) != cache.end())
-        return;
-
-      auto config = this_ptr->GetGXPipelineConfig(real_uid);
-      if (!config)
-        return;
-
-      auto pipeline = g_renderer->CreatePipeline(*config, value, value_size);
-      if (!pipeline)
-      {
-        // If any of the pipelines fail to create, consider the cache stale.
-        failed = true;
-        return;
-      }
+  if (data.empty())
+    return;
 
-      auto& entry = cache[real_uid];
-      entry.first = std::move(pipeline);
-      entry.second = false;
-    }
+  const auto cached = disk_cache.Find(key);
+  if (cached && cached->size == data.size() &&
+      std::memcmp(cached->data, data.data(), data.size()) == 0)
+  {
+    return;
+  }
 
-  private:
-    ShaderCache* this_ptr;
-    T& cache;
-    bool failed = false;
-  };
+  disk_cache.Append(key, data.data(), static_cast<u32>(data.size()));
+}
 
-  std::string filename = GetDiskShaderCacheFileName(api_type, type, include_gameid, true);
-  CacheReader reader(this, cache);
-  u32 count = disk_cache.OpenAndRead(filename, reader);
-  INFO_LOG(VIDEO, "Loaded %u cached pipelines from %s", count, filename.c_str());
-
-  // If any of the pipelines in the cache failed to create, it's likely because of a change of
-  // driver version, or system configuration. In this case, when the UID cache picks up the pipeline
-  // later on, we'll write a duplicate entry to the pipeline cache. There's also no point in keeping
-  // the old cache data around, so discard and recreate the disk cache.
-  if (reader.AnyFailed())
-  {
-    WARN_LOG(VIDEO, "Failed to load one or more pipelines from cache '%s'. Discarding.",
-             filename.c_str());
-    disk_cache.Close();
-    File::Delete(filename);
-    disk_cache.OpenAndRead(filename, reader);
-  }
+template <typename T>
+void ShaderCache::ClearShaderCache(T& cache)
+{
+  cache.disk_cache.Sync();
+  cache.disk_cache.Close();
+  cache.shader_map.clear();
 }
 
 template <typename T, typename Y>
@@ -296,21 +260,15 @@ void ShaderCache::LoadCaches()
   {
     // We also share geometry shaders, as there aren't many variants.
     if (m_host_config.backend_geometry_shaders)
-      LoadShaderCache<ShaderStage::Geometry, GeometryShaderUid>(m_gs_cache, m_api_type, "gs",
-                                                                false);
+      OpenDiskCache(m_gs_cache.disk_cache, m_api_type, "gs", false);
 
     // Specialized shaders, gameid-specific.
-    LoadShaderCache<ShaderStage::Vertex, VertexShaderUid>(m_vs_cache, m_api_type, "specialized-vs",
-                                                          true);
-    LoadShaderCache<ShaderStage::Pixel, PixelShaderUid>(m_ps_cache, m_api_type, "specialized-ps",
-                                                        true);
+    OpenDiskCache(m_vs_cache.disk_cache, m_api_type, "specialized-vs", true);
+    OpenDiskCache(m_ps_cache.disk_cache, m_api_type, "specialized-ps", true);
   }
 
   if (g_ActiveConfig.backend_info.bSupportsPipelineCacheData)
-  {
-    LoadPipelineCache<GXPipelineUid, SerializedGXPipelineUid>(
-        m_gx_pipeline_cache, m_gx_pipeline_disk_cache, m_api_type, "specialized-pipeline", true);
-  }
+    OpenDiskCache(m_gx_pipeline_disk_cache, m_api_type, "specialized-pipeline", true);
 }
 
 void ShaderCache::ClearCaches()
@@ -328,16 +286,27 @@ void ShaderCache::ClearCaches()
 
 void ShaderCache::CompileMissingPipelines()
 {
-  // Queue all uids with a null pipeline for compilation.
+  // Queue all uids with a null pipeline for compilation. Work items of the same priority are
+  // compiled in the order they were queued, so queue the pipelines which were first used the
+  // earliest first, as they're the ones needed soonest after booting.
+  std::vector<std::pair<u32, const GXPipelineUid*>> missing;
   for (auto& it : m_gx_pipeline_cache)
   {
     if (!it.second.first)
-      QueuePipelineCompile(it.first, COMPILE_PRIORITY_SHADERCACHE_PIPELINE);
+      missing.emplace_back(GetFirstUseFrame(it.first), &it.first);
   }
+
+  std::stable_sort(missing.begin(), missing.end(),
+                   [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+  for (const auto& it : missing)
+    QueuePipelineCompile(*it.second, COMPILE_PRIORITY_SHADERCACHE_PIPELINE);
 }
 
 std::unique_ptr<AbstractShader> ShaderCache::CompileVertexShader(const VertexShaderUid& uid) const
 {
+  if (auto shader = CreateShaderFromDiskCache(ShaderStage::Vertex, m_vs_cache.disk_cache, uid))
+    return shader;
+
   const ShaderCode source_code =
       GenerateVertexShaderCode(m_api_type, m_host_config, uid.GetUidData());
   return g_renderer->CreateShaderFromSource(ShaderStage::Vertex, source_code.GetBuffer());
@@ -345,6 +314,9 @@ std::unique_ptr<AbstractShader> ShaderCache::CompileVertexShader(const VertexSha
 
 std::unique_ptr<AbstractShader> ShaderCache::CompilePixelShader(const PixelShaderUid& uid) const
 {
+  if (auto shader = CreateShaderFromDiskCache(ShaderStage::Pixel, m_ps_cache.disk_cache, uid))
+    return shader;
+
   const ShaderCode source_code =
       GeneratePixelShaderCode(m_api_type, m_host_config, uid.GetUidData());
   return g_renderer->CreateShaderFromSource(ShaderStage::Pixel, source_code.GetBuffer());
@@ -359,11 +331,7 @@ const AbstractShader* ShaderCache::InsertVertexShader(const VertexShaderUid& uid
   if (shader && !entry.shader)
   {
     if (g_ActiveConfig.bShaderCache && g_ActiveConfig.backend_info.bSupportsShaderBinaries)
-    {
-      auto binary = shader->GetBinary();
-      if (!binary.empty())
-        m_vs_cache.disk_cache.Append(uid, binary.data(), static_cast<u32>(binary.size()));
-    }
+      AppendToDiskCache(m_vs_cache.disk_cache, uid, shader->GetBinary());
     INCSTAT(g_stats.num_vertex_shaders_created);
     INCSTAT(g_stats.num_vertex_shaders_alive);
     entry.shader = std::move(shader);
@@ -381,11 +349,7 @@ const AbstractShader* ShaderCache::InsertPixelShader(const PixelShaderUid& uid,
   if (shader && !entry.shader)
   {
     if (g_ActiveConfig.bShaderCache && g_ActiveConfig.backend_info.bSupportsShaderBinaries)
-    {
-      auto binary = shader->GetBinary();
-      if (!binary.empty())
-        m_ps_cache.disk_cache.Append(uid, binary.data(), static_cast<u32>(binary.size()));
-    }
+      AppendToDiskCache(m_ps_cache.disk_cache, uid, shader->GetBinary());
     INCSTAT(g_stats.num_pixel_shaders_created);
     INCSTAT(g_stats.num_pixel_shaders_alive);
     entry.shader = std::move(shader);
@@ -396,10 +360,14 @@ const AbstractShader* ShaderCache::InsertPixelShader(const PixelShaderUid& uid,
 
 const AbstractShader* ShaderCache::CreateGeometryShader(const GeometryShaderUid& uid)
 {
-  const ShaderCode source_code =
-      GenerateGeometryShaderCode(m_api_type, m_host_config, uid.GetUidData());
   std::unique_ptr<AbstractShader> shader =
-      g_renderer->CreateShaderFromSource(ShaderStage::Geometry, source_code.GetBuffer());
+      CreateShaderFromDiskCache(ShaderStage::Geometry, m_gs_cache.disk_cache, uid);
+  if (!shader)
+  {
+    const ShaderCode source_code =
+        GenerateGeometryShaderCode(m_api_type, m_host_config, uid.GetUidData());
+    shader = g_renderer->CreateShaderFromSource(ShaderStage::Geometry, source_code.GetBuffer());
+  }
 
   auto& entry = m_gs_cache.shader_map[uid];
   entry.pending = false;
@@ -407,11 +375,7 @@ const AbstractShader* ShaderCache::CreateGeometryShader(const GeometryShaderUid&
   if (shader && !entry.shader)
   {
     if (g_ActiveConfig.bShaderCache && g_ActiveConfig.backend_info.bSupportsShaderBinaries)
-    {
-      auto binary = shader->GetBinary();
-      if (!binary.empty())
-        m_gs_cache.disk_cache.Append(uid, binary.data(), static_cast<u32>(binary.size()));
-    }
+      AppendToDiskCache(m_gs_cache.disk_cache, uid, shader->GetBinary());
     entry.shader = std::move(shader);
   }
 
@@ -423,6 +387,26 @@ bool ShaderCache::NeedsGeometryShader(const GeometryShaderUid& uid) const
   return m_host_config.backend_geometry_shaders && !uid.GetUidData()->IsPassthrough();
 }
 
+std::unique_ptr<AbstractPipeline>
+ShaderCache::CreateGXPipeline(const GXPipelineUid& uid, const AbstractPipelineConfig& config) const
+{
+  if (g_ActiveConfig.backend_info.bSupportsPipelineCacheData)
+  {
+    SerializedGXPipelineUid disk_uid;
+    SerializePipelineUid(uid, disk_uid);
+
+    // Cached data goes stale when e.g. the driver is updated, so fall back to creating it anew.
+    const auto cache_data = m_gx_pipeline_disk_cache.Find(disk_uid);
+    if (cache_data)
+    {
+      if (auto pipeline = g_renderer->CreatePipeline(config, cache_data->data, cache_data->size))
+        return pipeline;
+    }
+  }
+
+  return g_renderer->CreatePipeline(config);
+}
+
 AbstractPipelineConfig ShaderCache::GetGXPipelineConfig(
     const NativeVertexFormat* vertex_format, const AbstractShader* vertex_shader,
     const AbstractShader* geometry_shader, const AbstractShader* pixel_shader,
@@ -497,16 +481,11 @@ const AbstractPipeline* ShaderCache::InsertGXPipeline(const GXPipelineUid& confi
   {
     entry.first = std::move(pipeline);
 
-    if (g_ActiveConfig.bShaderCache)
+    if (g_ActiveConfig.bShaderCache && g_ActiveConfig.backend_info.bSupportsPipelineCacheData)
     {
-      auto cache_data = entry.first->GetCacheData();
-      if (!cache_data.empty())
-      {
-        SerializedGXPipelineUid disk_uid;
-        SerializePipelineUid(config, disk_uid);
-        m_gx_pipeline_disk_cache.Append(disk_uid, cache_data.data(),
-                                        static_cast<u32>(cache_data.size()));
-      }
+      SerializedGXPipelineUid disk_uid;
+      SerializePipelineUid(config, disk_uid);
+      AppendToDiskCache(m_gx_pipeline_disk_cache, disk_uid, entry.first->GetCacheData());
     }
   }
 
@@ -515,53 +494,31 @@ const AbstractPipeline* ShaderCache::InsertGXPipeline(const GXPipelineUid& confi
 
 void ShaderCache::LoadPipelineUIDCache()
 {
-  constexpr u32 CACHE_FILE_MAGIC = 0x44495550;  // PUID
-  constexpr size_t CACHE_HEADER_SIZE = sizeof(u32) + sizeof(u32);
   std::string filename =
       File::GetUserPath(D_CACHE_IDX) + SConfig::GetInstance().GetGameID() + ".uidcache";
   if (m_gx_pipeline_uid_cache_file.Open(filename, "rb+"))
   {
-    // If an existing case exists, validate the version before reading entries.
-    u32 existing_magic;
-    u32 existing_version;
-    bool uid_file_valid = false;
-    if (m_gx_pipeline_uid_cache_file.ReadBytes(&existing_magic, sizeof(existing_magic)) &&
-        m_gx_pipeline_uid_cache_file.ReadBytes(&existing_version, sizeof(existing_version)) &&
-        existing_magic == CACHE_FILE_MAGIC && existing_version == GX_PIPELINE_UID_VERSION)
+    // If an existing cache exists, it's only used if it's for the current UID version and isn't
+    // cut off. Otherwise, the cache file may be corrupted, and we should not proceed with loading
+    // potentially garbage or invalid UIDs.
+    PipelineUIDCorpus corpus;
+    bool is_old_format = false;
+    bool uid_file_valid = corpus.ReadFile(m_gx_pipeline_uid_cache_file, &is_old_format);
+    if (uid_file_valid)
     {
-      // Ensure the expected size matches the actual size of the file. If it doesn't, it means
-      // the cache file may be corrupted, and we should not proceed with loading potentially
-      // garbage or invalid UIDs.
-      const u64 file_size = m_gx_pipeline_uid_cache_file.GetSize();
-      const size_t uid_count =
-          static_cast<size_t>(file_size - CACHE_HEADER_SIZE) / sizeof(SerializedGXPipelineUid);
-      const size_t expected_size = uid_count * sizeof(SerializedGXPipelineUid) + CACHE_HEADER_SIZE;
-      uid_file_valid = file_size == expected_size;
-      if (uid_file_valid)
-      {
-        for (size_t i = 0; i < uid_count; i++)
-        {
-          SerializedGXPipelineUid serialized_uid;
-          if (m_gx_pipeline_uid_cache_file.ReadBytes(&serialized_uid, sizeof(serialized_uid)))
-          {
-            // This just adds the pipeline to the map, it is compiled later.
-            AddSerializedGXPipelineUID(serialized_uid);
-          }
-          else
-          {
-            uid_file_valid = false;
-            break;
-          }
-        }
-      }
-
-      // We open the file for reading and writing, so we must seek to the end before writing.
-      if (uid_file_valid)
-        uid_file_valid = m_gx_pipeline_uid_cache_file.Seek(expected_size, SEEK_SET);
+      // This just adds the pipelines to the map, they are compiled later.
+      for (const PipelineUIDCorpus::Entry& entry : corpus.GetEntriesByFirstUse())
+        AddSerializedGXPipelineUID(entry.uid);
+      m_gx_pipeline_uid_corpus.Merge(corpus);
     }
 
+    // We open the file for reading and writing, so we must seek to the end before writing. Caches
+    // in the old format are rewritten below, keeping their UIDs.
+    if (uid_file_valid && !is_old_format)
+      uid_file_valid = m_gx_pipeline_uid_cache_file.Seek(0, SEEK_END);
+
     // If the file is invalid, close it. We re-open and truncate it below.
-    if (!uid_file_valid)
+    if (!uid_file_valid || is_old_format)
       m_gx_pipeline_uid_cache_file.Close();
   }
 
@@ -571,23 +528,83 @@ void ShaderCache::LoadPipelineUIDCache()
     if (m_gx_pipeline_uid_cache_file.Open(filename, "wb"))
     {
       // Write the version identifier.
-      m_gx_pipeline_uid_cache_file.WriteBytes(&CACHE_FILE_MAGIC, sizeof(GX_PIPELINE_UID_VERSION));
-      m_gx_pipeline_uid_cache_file.WriteBytes(&GX_PIPELINE_UID_VERSION,
-                                              sizeof(GX_PIPELINE_UID_VERSION));
+      PipelineUIDCorpus::WriteHeader(m_gx_pipeline_uid_cache_file);
 
       // Write any current UIDs out to the file.
       // This way, if we load a UID cache where the data was incomplete (e.g. Dolphin crashed),
-      // we don't lose the existing UIDs which were previously at the beginning.
+      // we don't lose the existing UIDs which were previously at the beginning. UIDs converted
+      // from the old format keep their first use frame of 0.
+      for (const PipelineUIDCorpus::Entry& entry : m_gx_pipeline_uid_corpus.GetEntriesByFirstUse())
+        PipelineUIDCorpus::WriteEntry(m_gx_pipeline_uid_cache_file, entry);
       for (const auto& it : m_gx_pipeline_cache)
         AppendGXPipelineUID(it.first);
     }
   }
 }
 
+void ShaderCache::LoadSharedPipelineUIDs()
+{
+  // UID files from other machines, usually copies of their UID caches or pipeline UID dumps, can
+  // be placed in Load/PipelineUIDs. All files whose names start with the game ID are merged, and
+  // their pipelines are precompiled along with the ones from the local cache. The local cache
+  // only lists the pipelines this machine has used, so shared UIDs are only appended to it once
+  // the game uses them.
+  const std::string& game_id = SConfig::GetInstance().GetGameID();
+  if (game_id.empty())
+    return;
+
+  PipelineUIDCorpus shared_corpus;
+  const std::string directory = File::GetUserPath(D_LOAD_IDX) + PIPELINE_UIDS_DIR DIR_SEP;
+  for (const std::string& path : Common::DoFileSearch({directory}, {".uidcache"}, true))
+  {
+    std::string filename;
+    SplitPath(path, nullptr, &filename, nullptr);
+    if (!StringBeginsWith(filename, game_id))
+      continue;
+
+    if (!shared_corpus.Load(path))
+      WARN_LOG(VIDEO, "Ignoring outdated or corrupted pipeline UID file %s", path.c_str());
+  }
+
+  if (shared_corpus.empty())
+    return;
+
+  for (const PipelineUIDCorpus::Entry& entry : shared_corpus.GetEntriesByFirstUse())
+  {
+    if (!m_gx_pipeline_uid_corpus.GetFirstUseFrame(entry.uid))
+    {
+      GXPipelineUid uid;
+      UnserializePipelineUid(entry.uid, uid);
+      m_shared_gx_pipeline_uids.insert(uid);
+    }
+    AddSerializedGXPipelineUID(entry.uid);
+  }
+  m_gx_pipeline_uid_corpus.Merge(shared_corpus);
+  INFO_LOG(VIDEO, "Loaded %zu shared pipeline UIDs", shared_corpus.size());
+}
+
 void ShaderCache::ClosePipelineUIDCache()
 {
-  // This is left as a method in case we need to append extra data to the file in the future.
   m_gx_pipeline_uid_cache_file.Close();
+
+  if (g_ActiveConfig.bDumpPipelineUIDs && !m_gx_pipeline_uid_corpus.empty())
+    DumpPipelineUIDs();
+}
+
+void ShaderCache::DumpPipelineUIDs() const
+{
+  // The dump contains both the local and the shared UIDs, deduplicated and ordered by first use,
+  // and can be shared with other machines as-is. It's merged with any previous dump, so that UIDs
+  // from earlier sessions aren't lost.
+  const std::string path = File::GetUserPath(D_DUMP_IDX) + PIPELINE_UIDS_DIR DIR_SEP +
+                           SConfig::GetInstance().GetGameID() + ".uidcache";
+  File::CreateFullPath(path);
+
+  PipelineUIDCorpus corpus;
+  corpus.Load(path);
+  corpus.Merge(m_gx_pipeline_uid_corpus);
+  if (!corpus.Save(path))
+    ERROR_LOG(VIDEO, "Failed to dump pipeline UIDs to %s", path.c_str());
 }
 
 void ShaderCache::AddSerializedGXPipelineUID(const SerializedGXPipelineUid& uid)
@@ -606,18 +623,32 @@ void ShaderCache::AddSerializedGXPipelineUID(const SerializedGXPipelineUid& uid)
 
 void ShaderCache::AppendGXPipelineUID(const GXPipelineUid& config)
 {
-  if (!m_gx_pipeline_uid_cache_file.IsOpen())
+  PipelineUIDCorpus::Entry entry;
+  SerializePipelineUid(config, entry.uid);
+  entry.first_use_frame = static_cast<u32>(g_renderer->GetFrameCount());
+  // Shared UIDs are in the corpus already, but not in the local cache yet.
+  const bool is_shared = m_shared_gx_pipeline_uids.erase(config) != 0;
+  if ((!m_gx_pipeline_uid_corpus.Add(entry.uid, entry.first_use_frame) && !is_shared) ||
+      !m_gx_pipeline_uid_cache_file.IsOpen())
+  {
     return;
+  }
 
-  SerializedGXPipelineUid disk_uid;
-  SerializePipelineUid(config, disk_uid);
-  if (!m_gx_pipeline_uid_cache_file.WriteBytes(&disk_uid, sizeof(disk_uid)))
+  if (!PipelineUIDCorpus::WriteEntry(m_gx_pipeline_uid_cache_file, entry))
   {
     WARN_LOG(VIDEO, "Writing pipeline UID to cache failed, closing file.");
     m_gx_pipeline_uid_cache_file.Close();
   }
 }
 
+u32 ShaderCache::GetFirstUseFrame(const GXPipelineUid& config) const
+{
+  SerializedGXPipelineUid disk_uid;
+  SerializePipelineUid(config, disk_uid);
+  return m_gx_pipeline_uid_corpus.GetFirstUseFrame(disk_uid).value_or(
+      std::numeric_limits<u32>::max());
+}
+
 void ShaderCache::QueueVertexShaderCompile(const VertexShaderUid& uid, u32 priority)
 {
   class VertexShaderWorkItem final : public AsyncShaderCompiler::WorkItem
@@ -713,7 +744,7 @@ void ShaderCache::QueuePipelineCompile(const GXPipelineUid& uid, u32 priority)
     bool Compile() override
     {
       if (config)
-        pipeline = g_renderer->CreatePipeline(*config);
+        pipeline = shader_cache->CreateGXPipeline(uid, *config);
       return true;
     }
 
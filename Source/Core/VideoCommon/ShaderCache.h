@@ -10,19 +10,21 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <utility>
 
 #include "Common/CommonTypes.h"
 #include "Common/File.h"
-#include "Common/LinearDiskCache.h"
+#include "Common/IndexedDiskCache.h"
 
 #include "VideoCommon/AbstractPipeline.h"
 #include "VideoCommon/AbstractShader.h"
 #include "VideoCommon/AsyncShaderCompiler.h"
 #include "VideoCommon/GXPipelineTypes.h"
 #include "VideoCommon/GeometryShaderGen.h"
+#include "VideoCommon/PipelineUIDCorpus.h"
 #include "VideoCommon/PixelShaderGen.h"
 #include "VideoCommon/RenderState.h"
 #include "VideoCommon/TextureCacheBase.h"
@@ -107,7 +109,9 @@ private:
   void LoadCaches();
   void ClearCaches();
   void LoadPipelineUIDCache();
+  void LoadSharedPipelineUIDs();
   void ClosePipelineUIDCache();
+  void DumpPipelineUIDs() const;
   void CompileMissingPipelines();
   bool CompileSharedPipelines();
 
@@ -122,6 +126,8 @@ private:
   bool NeedsGeometryShader(const GeometryShaderUid& uid) const;
 
   // GX pipeline compiler methods
+  std::unique_ptr<AbstractPipeline> CreateGXPipeline(const GXPipelineUid& uid,
+                                                     const AbstractPipelineConfig& config) const;
   AbstractPipelineConfig
   GetGXPipelineConfig(const NativeVertexFormat* vertex_format, const AbstractShader* vertex_shader,
                       const AbstractShader* geometry_shader, const AbstractShader* pixel_shader,
@@ -132,6 +138,7 @@ private:
                                            std::unique_ptr<AbstractPipeline> pipeline);
   void AddSerializedGXPipelineUID(const SerializedGXPipelineUid& uid);
   void AppendGXPipelineUID(const GXPipelineUid& config);
+  u32 GetFirstUseFrame(const GXPipelineUid& config) const;
 
   // ASync Compiler Methods
   void QueueVertexShaderCompile(const VertexShaderUid& uid, u32 priority);
@@ -139,13 +146,8 @@ private:
   void QueuePipelineCompile(const GXPipelineUid& uid, u32 priority);
 
   // Populating various caches.
-  template <ShaderStage stage, typename K, typename T>
-  void LoadShaderCache(T& cache, APIType api_type, const char* type, bool include_gameid);
   template <typename T>
   void ClearShaderCache(T& cache);
-  template <typename KeyType, typename DiskKeyType, typename T>
-  void LoadPipelineCache(T& cache, LinearDiskCache<DiskKeyType, u8>& disk_cache, APIType api_type,
-                         const char* type, bool include_gameid);
   template <typename T, typename Y>
   void ClearPipelineCache(T& cache, Y& disk_cache);
 
@@ -181,7 +183,7 @@ private:
       bool pending;
     };
     std::map<Uid, Shader> shader_map;
-    LinearDiskCache<Uid, u8> disk_cache;
+    IndexedDiskCache<Uid> disk_cache;
   };
   ShaderModuleCache<VertexShaderUid> m_vs_cache;
   ShaderModuleCache<GeometryShaderUid> m_gs_cache;
@@ -190,7 +192,10 @@ private:
   // GX Pipeline Caches - .first - pipeline, .second - pending
   std::map<GXPipelineUid, std::pair<std::unique_ptr<AbstractPipeline>, bool>> m_gx_pipeline_cache;
   File::IOFile m_gx_pipeline_uid_cache_file;
-  LinearDiskCache<SerializedGXPipelineUid, u8> m_gx_pipeline_disk_cache;
+  PipelineUIDCorpus m_gx_pipeline_uid_corpus;
+  // UIDs only known from shared UID files, which are appended to the local cache once used.
+  std::set<GXPipelineUid> m_shared_gx_pipeline_uids;
+  IndexedDiskCache<SerializedGXPipelineUid> m_gx_pipeline_disk_cache;
 
   // EFB copy to VRAM/RAM pipelines
   std::map<TextureConversionShaderGen::TCShaderUid, std::unique_ptr<AbstractPipeline>>
@@ -46,6 +46,10 @@ struct Statistics
     int bytes_index_streamed;
     int bytes_uniform_streamed;
 
+    int num_vertex_loader_cache_hits;
+    int num_vertex_loader_cache_misses;
+    int bytes_vertex_loader_cache_saved;
+
     int num_triangles_clipped;
     int num_triangles_in;
     int num_triangles_rejected;
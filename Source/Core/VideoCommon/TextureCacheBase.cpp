@@ -7,6 +7,7 @@
 #include <cstring>
 #include <memory>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 #if defined(_M_X86) || defined(_M_X86_64)
@@ -23,6 +24,7 @@
 #include "Common/MathUtil.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtil.h"
+#include "Common/ThreadPool.h"
 
 #include "Core/Config/GraphicsSettings.h"
 #include "Core/ConfigManager.h"
@@ -34,6 +36,7 @@
 #include "VideoCommon/AbstractStagingTexture.h"
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/FramebufferManager.h"
+#include "VideoCommon/FrameProfiler.h"
 #include "VideoCommon/HiresTextures.h"
 #include "VideoCommon/PixelShaderManager.h"
 #include "VideoCommon/RenderBase.h"
@@ -68,7 +71,11 @@ TextureCacheBase::TCacheEntry::TCacheEntry(std::unique_ptr<AbstractTexture> tex,
 TextureCacheBase::TCacheEntry::~TCacheEntry()
 {
   for (auto& reference : references)
-    reference->references.erase(this);
+  {
+    auto& other_references = reference->references;
+    other_references.erase(std::remove(other_references.begin(), other_references.end(), this),
+                           other_references.end());
+  }
 }
 
 void TextureCacheBase::CheckTempSize(size_t required_size)
@@ -87,6 +94,7 @@ TextureCacheBase::TextureCacheBase()
 
   temp_size = 2048 * 2048 * 4;
   temp = static_cast<u8*>(Common::AllocateAlignedMemory(temp_size, 16));
+  m_decode_thread_pool = std::make_unique<Common::ThreadPool>("Texture decoder");
 
   TexDecoder_SetTexFmtOverlayOptions(backup_config.texfmt_overlay,
                                      backup_config.texfmt_overlay_center);
@@ -134,6 +142,7 @@ void TextureCacheBase::Invalidate()
     delete tex.second;
   }
   textures_by_address.clear();
+  textures_by_range.clear();
   textures_by_hash.clear();
 
   texture_pool.clear();
@@ -318,7 +327,7 @@ TextureCacheBase::ApplyPaletteToEntry(TCacheEntry* entry, u8* palette, TLUTForma
     g_renderer->EndUtilityDrawing();
   }
 
-  textures_by_address.emplace(decoded_entry->addr, decoded_entry);
+  AddToAddressCache(decoded_entry);
 
   return decoded_entry;
 }
@@ -365,7 +374,7 @@ TextureCacheBase::TCacheEntry* TextureCacheBase::ReinterpretEntry(const TCacheEn
   g_renderer->EndUtilityDrawing();
   reinterpreted_entry->texture->FinishedRendering();
 
-  textures_by_address.emplace(reinterpreted_entry->addr, reinterpreted_entry);
+  AddToAddressCache(reinterpreted_entry);
 
   return reinterpreted_entry;
 }
@@ -561,10 +570,13 @@ void TextureCacheBase::DoSaveState(PointerWrap& p)
     }
     for (const auto& it : textures_by_hash)
     {
-      if (ShouldSaveEntry(it.second))
+      for (TCacheEntry* entry : it.second)
       {
-        u32 id = AddCacheEntryToMap(it.second);
-        textures_by_hash_list.push_back(std::make_pair(it.first, id));
+        if (ShouldSaveEntry(entry))
+        {
+          u32 id = AddCacheEntryToMap(entry);
+          textures_by_hash_list.push_back(std::make_pair(it.first, id));
+        }
       }
     }
   }
@@ -656,7 +668,6 @@ void TextureCacheBase::DoLoadState(PointerWrap& p)
     // to update the point in the state state. We'll just throw it away if it's invalid.
     auto tex = g_texture_cache->DeserializeTexture(p);
     TCacheEntry* entry = new TCacheEntry(std::move(tex->texture), std::move(tex->framebuffer));
-    entry->textures_by_hash_iter = g_texture_cache->textures_by_hash.end();
     entry->DoState(p);
     if (entry->texture && commit_state)
       id_map.emplace(i, entry);
@@ -689,7 +700,7 @@ void TextureCacheBase::DoLoadState(PointerWrap& p)
 
     TCacheEntry* entry = GetEntry(id);
     if (entry)
-      textures_by_address.emplace(addr, entry);
+      AddToAddressCache(entry);
   }
 
   // Fill in hash map.
@@ -703,7 +714,7 @@ void TextureCacheBase::DoLoadState(PointerWrap& p)
 
     TCacheEntry* entry = GetEntry(id);
     if (entry)
-      entry->textures_by_hash_iter = textures_by_hash.emplace(hash, entry);
+      AddToHashCache(entry, hash);
   }
 }
 
@@ -756,12 +767,12 @@ TextureCacheBase::DoPartialTextureUpdates(TCacheEntry* entry_to_update, u8* pale
 
   u32 numBlocksX = (entry_to_update->native_width + block_width - 1) / block_width;
 
-  auto iter = FindOverlappingTextures(entry_to_update->addr, entry_to_update->size_in_bytes);
-  while (iter.first != iter.second)
+  for (TexAddrCache::iterator iter :
+       FindOverlappingTextures(entry_to_update->addr, entry_to_update->size_in_bytes))
   {
-    TCacheEntry* entry = iter.first->second;
+    TCacheEntry* entry = iter->second;
     if (entry != entry_to_update && entry->IsCopy() && !entry->tmem_only &&
-        entry->references.count(entry_to_update) == 0 &&
+        !entry->HasReference(entry_to_update) &&
         entry->OverlapsMemoryRange(entry_to_update->addr, entry_to_update->size_in_bytes) &&
         entry->memory_stride == numBlocksX * block_size)
     {
@@ -772,7 +783,6 @@ TextureCacheBase::DoPartialTextureUpdates(TCacheEntry* entry_to_update, u8* pale
         {
           if (!CanReinterpretTextureOnGPU(entry_to_update->format.texfmt, entry->format.texfmt))
           {
-            ++iter.first;
             continue;
           }
 
@@ -796,7 +806,6 @@ TextureCacheBase::DoPartialTextureUpdates(TCacheEntry* entry_to_update, u8* pale
           }
           else
           {
-            ++iter.first;
             continue;
           }
         }
@@ -858,7 +867,6 @@ TextureCacheBase::DoPartialTextureUpdates(TCacheEntry* entry_to_update, u8* pale
             static_cast<u32>(dst_x + copy_width) > entry_to_update->GetWidth() ||
             static_cast<u32>(dst_y + copy_height) > entry_to_update->GetHeight())
         {
-          ++iter.first;
           continue;
         }
 
@@ -884,7 +892,7 @@ TextureCacheBase::DoPartialTextureUpdates(TCacheEntry* entry_to_update, u8* pale
         {
           // Remove the temporary converted texture, it won't be used anywhere else
           // TODO: It would be nice to convert and copy in one step, but this code path isn't common
-          iter.first = InvalidateTexture(iter.first);
+          InvalidateTexture(iter);
           continue;
         }
         else
@@ -898,11 +906,9 @@ TextureCacheBase::DoPartialTextureUpdates(TCacheEntry* entry_to_update, u8* pale
       else
       {
         // If the hash does not match, this EFB copy will not be used for anything, so remove it
-        iter.first = InvalidateTexture(iter.first);
-        continue;
+        InvalidateTexture(iter);
       }
     }
-    ++iter.first;
   }
 
   return entry_to_update;
@@ -1000,6 +1006,8 @@ static void SetSamplerState(u32 index, float custom_tex_scale, bool custom_tex,
 
 void TextureCacheBase::BindTextures()
 {
+  FrameProfiler::ScopedSection section(FrameProfiler::Section::TextureCache);
+
   for (u32 i = 0; i < bound_textures.size(); i++)
   {
     const TCacheEntry* tentry = bound_textures[i];
@@ -1161,6 +1169,8 @@ private:
 
 TextureCacheBase::TCacheEntry* TextureCacheBase::Load(const u32 stage)
 {
+  FrameProfiler::ScopedSection section(FrameProfiler::Section::TextureCache);
+
   // if this stage was not invalidated by changes to texture registers, keep the current texture
   if (g_ActiveConfig.bTMEMCacheEmulation && IsValidBindPoint(stage) && bound_textures[stage])
   {
@@ -1468,20 +1478,21 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   if (textureCacheSafetyColorSampleSize == 0 ||
       std::max(texture_size, palette_size) <= (u32)textureCacheSafetyColorSampleSize * 8)
   {
-    auto hash_range = textures_by_hash.equal_range(full_hash);
-    TexHashCache::iterator hash_iter = hash_range.first;
-    while (hash_iter != hash_range.second)
+    const std::vector<TCacheEntry*>* hash_entries = textures_by_hash.find(full_hash);
+    if (hash_entries)
     {
-      TCacheEntry* entry = hash_iter->second;
-      // All parameters, except the address, need to match here
-      if (entry->format == full_format && entry->native_levels >= tex_levels &&
-          entry->native_width == nativeW && entry->native_height == nativeH)
+      for (TCacheEntry* entry : *hash_entries)
       {
-        entry = DoPartialTextureUpdates(hash_iter->second, &texMem[tlutaddr], tlutfmt);
-        entry->texture->FinishedRendering();
-        return entry;
+        // All parameters, except the address, need to match here
+        if (entry->format == full_format && entry->native_levels >= tex_levels &&
+            entry->native_width == nativeW && entry->native_height == nativeH)
+        {
+          // This may modify textures_by_hash, so stop iterating afterwards.
+          entry = DoPartialTextureUpdates(entry, &texMem[tlutaddr], tlutfmt);
+          entry->texture->FinishedRendering();
+          return entry;
+        }
       }
-      ++hash_iter;
     }
   }
 
@@ -1570,8 +1581,8 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
       dst_buffer = temp;
       if (!(texformat == TextureFormat::RGBA8 && from_tmem))
       {
-        TexDecoder_Decode(dst_buffer, src_data, expandedWidth, expandedHeight, texformat, tlut,
-                          tlutfmt);
+        TexDecoder_DecodeParallel(*m_decode_thread_pool, dst_buffer, src_data, expandedWidth,
+                                  expandedHeight, texformat, tlut, tlutfmt);
       }
       else
       {
@@ -1588,13 +1599,6 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
     }
   }
 
-  iter = textures_by_address.emplace(address, entry);
-  if (textureCacheSafetyColorSampleSize == 0 ||
-      std::max(texture_size, palette_size) <= (u32)textureCacheSafetyColorSampleSize * 8)
-  {
-    entry->textures_by_hash_iter = textures_by_hash.emplace(full_hash, entry);
-  }
-
   entry->SetGeneralParameters(address, texture_size, full_format, false);
   entry->SetDimensions(nativeW, nativeH, tex_levels);
   entry->SetHashes(base_hash, full_hash);
@@ -1602,6 +1606,13 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
   entry->memory_stride = entry->BytesPerRow();
   entry->SetNotCopy();
 
+  iter = AddToAddressCache(entry);
+  if (textureCacheSafetyColorSampleSize == 0 ||
+      std::max(texture_size, palette_size) <= (u32)textureCacheSafetyColorSampleSize * 8)
+  {
+    AddToHashCache(entry, full_hash);
+  }
+
   std::string basename;
   if (g_ActiveConfig.bDumpTextures && !hires_tex)
   {
@@ -1649,8 +1660,9 @@ TextureCacheBase::GetTexture(u32 address, u32 width, u32 height, const TextureFo
       {
         // No need to call CheckTempSize here, as the whole buffer is preallocated at the beginning
         const u32 decoded_mip_size = expanded_mip_width * sizeof(u32) * expanded_mip_height;
-        TexDecoder_Decode(dst_buffer, mip_src_data, expanded_mip_width, expanded_mip_height,
-                          texformat, tlut, tlutfmt);
+        TexDecoder_DecodeParallel(*m_decode_thread_pool, dst_buffer, mip_src_data,
+                                  expanded_mip_width, expanded_mip_height, texformat, tlut,
+                                  tlutfmt);
         entry->texture->Load(level, mip_width, mip_height, expanded_mip_width, dst_buffer,
                              decoded_mip_size);
 
@@ -1751,7 +1763,7 @@ TextureCacheBase::GetXFBTexture(u32 address, u32 width, u32 height, u32 stride,
   entry->texture->FinishedRendering();
 
   // Insert into the texture cache so we can re-use it next frame, if needed.
-  textures_by_address.emplace(entry->addr, entry);
+  AddToAddressCache(entry);
   SETSTAT(g_stats.num_textures_alive, static_cast<int>(textures_by_address.size()));
   INCSTAT(g_stats.num_textures_uploaded);
 
@@ -1815,15 +1827,15 @@ void TextureCacheBase::StitchXFBCopy(TCacheEntry* stitched_entry)
   std::vector<TCacheEntry*> candidates;
   bool create_upscaled_copy = false;
 
-  auto iter = FindOverlappingTextures(stitched_entry->addr, stitched_entry->size_in_bytes);
-  while (iter.first != iter.second)
+  for (TexAddrCache::iterator iter :
+       FindOverlappingTextures(stitched_entry->addr, stitched_entry->size_in_bytes))
   {
     // Currently, this checks the stride of the VRAM copy against the VI request. Therefore, for
     // interlaced modes, VRAM copies won't be considered candidates. This is okay for now, because
     // our force progressive hack means that an XFB copy should always have a matching stride. If
     // the hack is disabled, XFB2RAM should also be enabled. Should we wish to implement interlaced
     // stitching in the future, this would require a shader which grabs every second line.
-    TCacheEntry* entry = iter.first->second;
+    TCacheEntry* entry = iter->second;
     if (entry != stitched_entry && entry->IsCopy() && !entry->tmem_only &&
         entry->OverlapsMemoryRange(stitched_entry->addr, stitched_entry->size_in_bytes) &&
         entry->memory_stride == stitched_entry->memory_stride)
@@ -1839,11 +1851,9 @@ void TextureCacheBase::StitchXFBCopy(TCacheEntry* stitched_entry)
       else
       {
         // If the hash does not match, this EFB copy will not be used for anything, so remove it
-        iter.first = InvalidateTexture(iter.first);
-        continue;
+        InvalidateTexture(iter);
       }
     }
-    ++iter.first;
   }
 
   if (candidates.empty())
@@ -1997,6 +2007,8 @@ void TextureCacheBase::CopyRenderTargetToTexture(
     float gamma, bool clamp_top, bool clamp_bottom,
     const CopyFilterCoefficients::Values& filter_coefficients)
 {
+  FrameProfiler::ScopedSection section(FrameProfiler::Section::TextureCache);
+
   // Emulation methods:
   //
   // - EFB to RAM:
@@ -2238,10 +2250,9 @@ void TextureCacheBase::CopyRenderTargetToTexture(
   // as our efb copy are marked to check them for partial texture updates.
   // TODO: The logic to detect overlapping strided efb copies is not 100% accurate.
   bool strided_efb_copy = dstStride != bytes_per_row;
-  auto iter = FindOverlappingTextures(dstAddr, covered_range);
-  while (iter.first != iter.second)
+  for (TexAddrCache::iterator iter : FindOverlappingTextures(dstAddr, covered_range))
   {
-    TCacheEntry* overlapping_entry = iter.first->second;
+    TCacheEntry* overlapping_entry = iter->second;
 
     if (overlapping_entry->addr == dstAddr && overlapping_entry->is_xfb_copy)
     {
@@ -2263,7 +2274,7 @@ void TextureCacheBase::CopyRenderTargetToTexture(
       {
         // Pending EFB copies which are completely covered by this new copy can simply be tossed,
         // instead of having to flush them later on, since this copy will write over everything.
-        iter.first = InvalidateTexture(iter.first, true);
+        InvalidateTexture(iter, true);
         continue;
       }
 
@@ -2287,13 +2298,8 @@ void TextureCacheBase::CopyRenderTargetToTexture(
 
       // Do not load textures by hash, if they were at least partly overwritten by an efb copy.
       // In this case, comparing the hash is not enough to check, if two textures are identical.
-      if (overlapping_entry->textures_by_hash_iter != textures_by_hash.end())
-      {
-        textures_by_hash.erase(overlapping_entry->textures_by_hash_iter);
-        overlapping_entry->textures_by_hash_iter = textures_by_hash.end();
-      }
+      RemoveFromHashCache(overlapping_entry);
     }
-    ++iter.first;
   }
 
   if (g_bRecordFifoData)
@@ -2314,7 +2320,7 @@ void TextureCacheBase::CopyRenderTargetToTexture(
   {
     const u64 hash = entry->CalculateHash();
     entry->SetHashes(hash, hash);
-    textures_by_address.emplace(dstAddr, entry);
+    AddToAddressCache(entry);
   }
 }
 
@@ -2362,8 +2368,7 @@ void TextureCacheBase::FlushEFBCopy(TCacheEntry* entry)
   if (entry->is_xfb_copy)
   {
     const u32 covered_range = entry->pending_efb_copy_height * entry->memory_stride;
-    auto range = FindOverlappingTextures(entry->addr, covered_range);
-    for (auto iter = range.first; iter != range.second; ++iter)
+    for (TexAddrCache::iterator iter : FindOverlappingTextures(entry->addr, covered_range))
     {
       TCacheEntry* overlapping_entry = iter->second;
       if (overlapping_entry->may_have_overlapping_textures && overlapping_entry->is_xfb_copy &&
@@ -2449,7 +2454,6 @@ TextureCacheBase::TCacheEntry* TextureCacheBase::AllocateCacheEntry(const Textur
 
   TCacheEntry* cacheEntry =
       new TCacheEntry(std::move(alloc->texture), std::move(alloc->framebuffer));
-  cacheEntry->textures_by_hash_iter = textures_by_hash.end();
   cacheEntry->id = last_entry_id++;
   return cacheEntry;
 }
@@ -2520,21 +2524,50 @@ TextureCacheBase::GetTexCacheIter(TextureCacheBase::TCacheEntry* entry)
   return textures_by_address.end();
 }
 
-std::pair<TextureCacheBase::TexAddrCache::iterator, TextureCacheBase::TexAddrCache::iterator>
-TextureCacheBase::FindOverlappingTextures(u32 addr, u32 size_in_bytes)
+TextureCacheBase::TexAddrCache::iterator TextureCacheBase::AddToAddressCache(TCacheEntry* entry)
+{
+  auto iter = textures_by_address.emplace(entry->addr, entry);
+  textures_by_range.Insert(entry->addr, entry->size_in_bytes, iter);
+  return iter;
+}
+
+void TextureCacheBase::AddToHashCache(TCacheEntry* entry, u64 hash)
+{
+  textures_by_hash[hash].push_back(entry);
+  entry->textures_by_hash_key = hash;
+}
+
+void TextureCacheBase::RemoveFromHashCache(TCacheEntry* entry)
 {
-  // We index by the starting address only, so there is no way to query all textures
-  // which end after the given addr. But the GC textures have a limited size, so we
-  // look for all textures which have a start address bigger than addr minus the maximal
-  // texture size. But this yields false-positives which must be checked later on.
+  if (!entry->textures_by_hash_key)
+    return;
 
-  // 1024 x 1024 texel times 8 nibbles per texel
-  constexpr u32 max_texture_size = 1024 * 1024 * 4;
-  u32 lower_addr = addr > max_texture_size ? addr - max_texture_size : 0;
-  auto begin = textures_by_address.lower_bound(lower_addr);
-  auto end = textures_by_address.upper_bound(addr + size_in_bytes);
+  const u64 hash = *entry->textures_by_hash_key;
+  std::vector<TCacheEntry*>* entries = textures_by_hash.find(hash);
+  entries->erase(std::find(entries->begin(), entries->end(), entry));
+  if (entries->empty())
+    textures_by_hash.erase(hash);
 
-  return std::make_pair(begin, end);
+  entry->textures_by_hash_key.reset();
+}
+
+std::vector<TextureCacheBase::TexAddrCache::iterator>
+TextureCacheBase::FindOverlappingTextures(u32 addr, u32 size_in_bytes)
+{
+  std::vector<TexAddrCache::iterator> overlapping;
+  textures_by_range.ForEachOverlapping(addr, size_in_bytes,
+                                       [&overlapping](TexAddrCache::iterator iter) {
+                                         overlapping.push_back(iter);
+                                       });
+
+  // Partial texture updates and XFB stitching apply overlapping copies in this order, so keep it
+  // the same as a walk over textures_by_address. Entries at the same address are in the order
+  // they were created.
+  std::sort(overlapping.begin(), overlapping.end(),
+            [](TexAddrCache::iterator a, TexAddrCache::iterator b) {
+              return std::tie(a->first, a->second->id) < std::tie(b->first, b->second->id);
+            });
+  return overlapping;
 }
 
 TextureCacheBase::TexAddrCache::iterator
@@ -2545,11 +2578,7 @@ TextureCacheBase::InvalidateTexture(TexAddrCache::iterator iter, bool discard_pe
 
   TCacheEntry* entry = iter->second;
 
-  if (entry->textures_by_hash_iter != textures_by_hash.end())
-  {
-    textures_by_hash.erase(entry->textures_by_hash_iter);
-    entry->textures_by_hash_iter = textures_by_hash.end();
-  }
+  RemoveFromHashCache(entry);
 
   for (size_t i = 0; i < bound_textures.size(); ++i)
   {
@@ -2597,6 +2626,7 @@ TextureCacheBase::InvalidateTexture(TexAddrCache::iterator iter, bool discard_pe
   if (!entry->pending_efb_copy)
     delete entry;
 
+  textures_by_range.Erase(iter->first, iter);
   return textures_by_address.erase(iter);
 }
 
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <bitset>
 #include <map>
@@ -12,11 +13,12 @@
 #include <string>
 #include <tuple>
 #include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/FlatHashMap.h"
 #include "Common/MathUtil.h"
+#include "Common/RangeIndex.h"
 #include "VideoCommon/AbstractTexture.h"
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/TextureConfig.h"
@@ -115,14 +117,15 @@ public:
     // used to delete textures which haven't been used for TEXTURE_KILL_THRESHOLD frames
     int frameCount = FRAMECOUNT_INVALID;
 
-    // Keep an iterator to the entry in textures_by_hash, so it does not need to be searched when
-    // removing the cache entry
-    std::multimap<u64, TCacheEntry*>::iterator textures_by_hash_iter;
+    // The hash this entry is stored under in textures_by_hash, if any. This can differ from the
+    // current hash, as XFB copies are rehashed when they are overwritten.
+    std::optional<u64> textures_by_hash_key;
 
     // This is used to keep track of both:
     //   * efb copies used by this partially updated texture
     //   * partially updated textures which refer to this efb copy
-    std::unordered_set<TCacheEntry*> references;
+    // There are rarely more than a few, so a plain vector is faster than a set.
+    std::vector<TCacheEntry*> references;
 
     // Pending EFB copy
     std::unique_ptr<AbstractStagingTexture> pending_efb_copy;
@@ -162,9 +165,17 @@ public:
     // This texture entry is used by the other entry as a sub-texture
     void CreateReference(TCacheEntry* other_entry)
     {
+      if (HasReference(other_entry))
+        return;
+
       // References are two-way, so they can easily be destroyed later
-      this->references.emplace(other_entry);
-      other_entry->references.emplace(this);
+      this->references.push_back(other_entry);
+      other_entry->references.push_back(this);
+    }
+
+    bool HasReference(const TCacheEntry* other_entry) const
+    {
+      return std::find(references.begin(), references.end(), other_entry) != references.end();
     }
 
     void SetXfbCopy(u32 stride);
@@ -276,7 +287,10 @@ protected:
 
 private:
   using TexAddrCache = std::multimap<u32, TCacheEntry*>;
-  using TexHashCache = std::multimap<u64, TCacheEntry*>;
+  // Every texture in textures_by_address is also in textures_by_range, which indexes the memory
+  // range [addr, addr + size_in_bytes] of the textures for overlap queries.
+  using TexRangeCache = Common::RangeIndex<TexAddrCache::iterator>;
+  using TexHashCache = Common::FlatHashMap<u64, std::vector<TCacheEntry*>>;
   using TexPool = std::unordered_multimap<TextureConfig, TexPoolEntry>;
 
   bool CreateUtilityTextures();
@@ -301,10 +315,16 @@ private:
   TexPool::iterator FindMatchingTextureFromPool(const TextureConfig& config);
   TexAddrCache::iterator GetTexCacheIter(TCacheEntry* entry);
 
-  // Return all possible overlapping textures. As addr+size of the textures is not
-  // indexed, this may return false positives.
-  std::pair<TexAddrCache::iterator, TexAddrCache::iterator>
-  FindOverlappingTextures(u32 addr, u32 size_in_bytes);
+  // Adds the entry to textures_by_address and textures_by_range. The address and size of the
+  // entry must be set up beforehand.
+  TexAddrCache::iterator AddToAddressCache(TCacheEntry* entry);
+  void AddToHashCache(TCacheEntry* entry, u64 hash);
+  void RemoveFromHashCache(TCacheEntry* entry);
+
+  // Return all textures which overlap or touch the given memory range, sorted by address.
+  // Callers still need to check OverlapsMemoryRange, and may invalidate the returned textures
+  // while iterating over them, but no others.
+  std::vector<TexAddrCache::iterator> FindOverlappingTextures(u32 addr, u32 size_in_bytes);
 
   // Removes and unlinks texture from texture cache and returns it to the pool
   TexAddrCache::iterator InvalidateTexture(TexAddrCache::iterator t_iter,
@@ -334,6 +354,7 @@ private:
   void DoLoadState(PointerWrap& p);
 
   TexAddrCache textures_by_address;
+  TexRangeCache textures_by_range;
   TexHashCache textures_by_hash;
   TexPool texture_pool;
   u64 last_entry_id = 0;
@@ -360,6 +381,9 @@ private:
   // Decoding texture used for GPU texture decoding.
   std::unique_ptr<AbstractTexture> m_decoding_texture;
 
+  // Worker threads used to decode large textures on the CPU.
+  std::unique_ptr<Common::ThreadPool> m_decode_thread_pool;
+
   // Pool of readback textures used for deferred EFB copies.
   std::vector<std::unique_ptr<AbstractStagingTexture>> m_efb_copy_staging_texture_pool;
 
@@ -5,8 +5,15 @@
 #pragma once
 
 #include <tuple>
+#include <vector>
+
 #include "Common/CommonTypes.h"
 
+namespace Common
+{
+class ThreadPool;
+}
+
 enum
 {
   TMEM_SIZE = 1024 * 1024,
@@ -151,6 +158,11 @@ TextureFormat TexDecoder_GetEFBCopyBaseFormat(EFBCopyFormat format);
 
 void TexDecoder_Decode(u8* dst, const u8* src, int width, int height, TextureFormat texformat,
                        const u8* tlut, TLUTFormat tlutfmt);
+// Produces the same output as TexDecoder_Decode, but splits large textures into bands of block
+// rows that are decoded in parallel on the given pool.
+void TexDecoder_DecodeParallel(Common::ThreadPool& pool, u8* dst, const u8* src, int width,
+                               int height, TextureFormat texformat, const u8* tlut,
+                               TLUTFormat tlutfmt);
 void TexDecoder_DecodeRGBA8FromTmem(u8* dst, const u8* src_ar, const u8* src_gb, int width,
                                     int height);
 void TexDecoder_DecodeTexel(u8* dst, const u8* src, int s, int t, int imageWidth,
@@ -161,6 +173,11 @@ void TexDecoder_DecodeXFB(u8* dst, const u8* src, u32 width, u32 height, u32 str
 
 void TexDecoder_SetTexFmtOverlayOptions(bool enable, bool center);
 
-/* Internal method, implemented by TextureDecoder_Generic and TextureDecoder_x64. */
+/* Internal methods, implemented by TextureDecoder_Generic and TextureDecoder_x64. */
+// Decodes the TLUT into the table of texels that _TexDecoder_DecodeImpl looks texels up in, if it
+// uses one for this texture. Returns an empty table otherwise. This lets the bands of a parallel
+// decode share one table instead of each building its own.
+std::vector<u32> _TexDecoder_DecodeTLUTTable(int width, int height, TextureFormat texformat,
+                                             const u8* tlut, TLUTFormat tlutfmt);
 void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, TextureFormat texformat,
-                            const u8* tlut, TLUTFormat tlutfmt);
+                            const u8* tlut, TLUTFormat tlutfmt, const u32* tlut_table = nullptr);
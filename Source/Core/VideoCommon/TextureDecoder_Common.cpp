@@ -5,10 +5,12 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <vector>
 
 #include "Common/CommonTypes.h"
 #include "Common/MsgHandler.h"
 #include "Common/Swap.h"
+#include "Common/ThreadPool.h"
 
 #include "VideoCommon/LookUpTables.h"
 #include "VideoCommon/TextureDecoder.h"
@@ -379,6 +381,51 @@ void TexDecoder_Decode(u8* dst, const u8* src, int width, int height, TextureFor
     TexDecoder_DrawOverlay(dst, width, height, texformat);
 }
 
+void TexDecoder_DecodeParallel(Common::ThreadPool& pool, u8* dst, const u8* src, int width,
+                               int height, TextureFormat texformat, const u8* tlut,
+                               TLUTFormat tlutfmt)
+{
+  // Smaller textures don't decode for long enough to make waking up the workers worthwhile.
+  constexpr int MIN_TEXELS_PER_BAND = 128 * 128;
+
+  const size_t threads = pool.GetThreadCount();
+  const int block_height = TexDecoder_GetBlockHeightInTexels(texformat);
+  const int block_rows = (height + block_height - 1) / block_height;
+  const int min_block_rows_per_band =
+      std::max(1, MIN_TEXELS_PER_BAND / std::max(1, width * block_height));
+
+  // Aim for a couple of bands per thread so that uneven bands don't leave threads idle.
+  const int block_rows_per_band = std::max(
+      min_block_rows_per_band, static_cast<int>((block_rows + threads * 2 - 1) / (threads * 2)));
+  const int num_bands = (block_rows + block_rows_per_band - 1) / block_rows_per_band;
+
+  if (threads == 1 || num_bands <= 1 || width % TexDecoder_GetBlockWidthInTexels(texformat) != 0)
+  {
+    TexDecoder_Decode(dst, src, width, height, texformat, tlut, tlutfmt);
+    return;
+  }
+
+  // Every decoder walks the texture in whole rows of blocks, and the blocks of a row are stored
+  // contiguously. A band of block rows can therefore be decoded on its own as a shorter texture,
+  // which gives exactly the same texels as decoding it as part of the whole texture.
+  const int band_height = block_rows_per_band * block_height;
+  const int band_size = TexDecoder_GetTextureSizeInBytes(width, band_height, texformat);
+
+  // Build any TLUT table once for the whole texture rather than once per band.
+  const std::vector<u32> tlut_table =
+      _TexDecoder_DecodeTLUTTable(width, height, texformat, tlut, tlutfmt);
+
+  pool.ParallelFor(num_bands, [&](size_t band) {
+    const int y = static_cast<int>(band) * band_height;
+    _TexDecoder_DecodeImpl(reinterpret_cast<u32*>(dst) + y * width, src + band * band_size, width,
+                           std::min(band_height, height - y), texformat, tlut, tlutfmt,
+                           tlut_table.empty() ? nullptr : tlut_table.data());
+  });
+
+  if (TexFmt_Overlay_Enable)
+    TexDecoder_DrawOverlay(dst, width, height, texformat);
+}
+
 static inline u32 DecodePixel_IA8(u16 val)
 {
   int a = val & 0xFF;
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <vector>
 
 #include "Common/CPUDetect.h"
 #include "Common/CommonTypes.h"
@@ -195,8 +196,14 @@ static void DecodeDXTBlock(u32* dst, const DXTBlock* src, int pitch)
 // TODO: complete SSE2 optimization of less often used texture formats.
 // TODO: refactor algorithms using _mm_loadl_epi64 unaligned loads to prefer 128-bit aligned loads.
 
+std::vector<u32> _TexDecoder_DecodeTLUTTable(int width, int height, TextureFormat texformat,
+                                             const u8* tlut, TLUTFormat tlutfmt)
+{
+  return {};
+}
+
 void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, TextureFormat texformat,
-                            const u8* tlut, TLUTFormat tlutfmt)
+                            const u8* tlut, TLUTFormat tlutfmt, const u32* tlut_table)
 {
   const int Wsteps4 = (width + 3) / 4;
   const int Wsteps8 = (width + 7) / 8;
@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <vector>
 
 #include "Common/CPUDetect.h"
 #include "Common/CommonTypes.h"
@@ -1409,8 +1410,375 @@ static void TexDecoder_DecodeImpl_CMPR(u32* dst, const u8* src, int width, int h
   }
 }
 
+// AVX2 decoders. The palette formats decode their TLUT into a table once per texture and then
+// look up eight texels at a time with a gather, instead of converting every texel separately.
+// CMPR builds the four colors of each block with scalar code and looks its texels up with a
+// permute.
+//
+// I4, I8 and IA8 only need a byte shuffle per row, which already saturates memory bandwidth with
+// SSSE3, so they have no AVX2 versions.
+//
+// There are no AVX-512 versions because CPUDetect doesn't report AVX-512. ARM64 builds use
+// TextureDecoder_Generic.cpp. It has no NEON paths because no NEON decoder has been checked
+// against the generic one on ARM64 hardware yet, and a wrong decoder corrupts textures silently.
+
+// C14X2 palettes have 16384 entries, so building the table only pays off for larger textures.
+constexpr int MIN_TEXELS_FOR_C14X2_PALETTE_TABLE = 16384;
+
+static bool DecodePalette(u32* palette, const u8* tlut_, TLUTFormat tlutfmt, int count)
+{
+  const u16* tlut = (u16*)tlut_;
+  switch (tlutfmt)
+  {
+  case TLUTFormat::IA8:
+    for (int i = 0; i < count; i++)
+      palette[i] = DecodePixel_IA8(tlut[i]);
+    return true;
+  case TLUTFormat::RGB565:
+    for (int i = 0; i < count; i++)
+      palette[i] = DecodePixel_RGB565(Common::swap16(tlut[i]));
+    return true;
+  case TLUTFormat::RGB5A3:
+    for (int i = 0; i < count; i++)
+      palette[i] = DecodePixel_RGB5A3(Common::swap16(tlut[i]));
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Expands the 4 bytes of a 4-bit block row to 8 texels, high nibble first.
+FUNCTION_TARGET_AVX2
+static inline __m256i ExpandNibbles_AVX2(const u8* src)
+{
+  const __m256i shifts = _mm256_set_epi32(24, 28, 16, 20, 8, 12, 0, 4);
+  u32 row;
+  std::memcpy(&row, src, sizeof(row));
+  return _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(row), shifts),
+                          _mm256_set1_epi32(0xF));
+}
+
+// Loads 32 bytes of big-endian 16-bit texels (two rows of a 4x4 block per 128-bit lane) and
+// returns them byte-swapped and zero-extended to 32 bits: rows 0 and 1 in *rows01, rows 2 and 3
+// in *rows23.
+FUNCTION_TARGET_AVX2
+static inline void LoadBlock16_AVX2(const u8* src, __m256i* rows01, __m256i* rows23)
+{
+  const __m256i swap16 = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+                                          1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+  const __m256i raw = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)src), swap16);
+  *rows01 = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(raw));
+  *rows23 = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(raw, 1));
+}
+
+// Stores 8 decoded texels as 4 texels in each of two consecutive rows.
+FUNCTION_TARGET_AVX2
+static inline void StoreTwoRows_AVX2(u32* dst, int width, __m256i texels)
+{
+  _mm_storeu_si128((__m128i*)dst, _mm256_castsi256_si128(texels));
+  _mm_storeu_si128((__m128i*)(dst + width), _mm256_extracti128_si256(texels, 1));
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_C4_AVX2(u32* dst, const u8* src, int width, int height,
+                                          TextureFormat texformat, const u8* tlut,
+                                          TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  alignas(32) u32 palette[16];
+  if (!DecodePalette(palette, tlut, tlutfmt, 16))
+    return;
+
+  for (int y = 0; y < height; y += 8)
+  {
+    for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+    {
+      const u8* src2 = src + 32 * yStep;
+      for (int iy = 0; iy < 8; iy++)
+      {
+        const __m256i indices = ExpandNibbles_AVX2(src2 + 4 * iy);
+        _mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x),
+                            _mm256_i32gather_epi32((const int*)palette, indices, 4));
+      }
+    }
+  }
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_C8_AVX2(u32* dst, const u8* src, int width, int height,
+                                          TextureFormat texformat, const u8* tlut,
+                                          TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  alignas(32) u32 palette[256];
+  if (!DecodePalette(palette, tlut, tlutfmt, 256))
+    return;
+
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+    {
+      const u8* src2 = src + 32 * yStep;
+      for (int iy = 0; iy < 4; iy++)
+      {
+        const __m256i indices =
+            _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src2 + 8 * iy)));
+        _mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x),
+                            _mm256_i32gather_epi32((const int*)palette, indices, 4));
+      }
+    }
+  }
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_IA4_AVX2(u32* dst, const u8* src, int width, int height,
+                                           TextureFormat texformat, const u8* tlut,
+                                           TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  const __m256i kMask_x0f = _mm256_set1_epi32(0x0F);
+  const __m256i kReplicateI = _mm256_set1_epi32(0x00111111);
+  const __m256i kReplicateA = _mm256_set1_epi32(0x11000000);
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps8; x < width; x += 8, yStep++)
+    {
+      const u8* src2 = src + 32 * yStep;
+      for (int iy = 0; iy < 4; iy++)
+      {
+        const __m256i v =
+            _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src2 + 8 * iy)));
+        const __m256i i = _mm256_mullo_epi32(_mm256_and_si256(v, kMask_x0f), kReplicateI);
+        const __m256i a = _mm256_mullo_epi32(_mm256_srli_epi32(v, 4), kReplicateA);
+        _mm256_storeu_si256((__m256i*)(dst + (y + iy) * width + x), _mm256_or_si256(i, a));
+      }
+    }
+  }
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_C14X2_AVX2(u32* dst, const u8* src, int width, int height,
+                                             const u32* palette, int Wsteps4)
+{
+  const __m256i kMask_x3fff = _mm256_set1_epi32(0x3FFF);
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+    {
+      __m256i rows01, rows23;
+      LoadBlock16_AVX2(src + 32 * yStep, &rows01, &rows23);
+      rows01 = _mm256_i32gather_epi32((const int*)palette, _mm256_and_si256(rows01, kMask_x3fff), 4);
+      rows23 = _mm256_i32gather_epi32((const int*)palette, _mm256_and_si256(rows23, kMask_x3fff), 4);
+
+      StoreTwoRows_AVX2(dst + y * width + x, width, rows01);
+      StoreTwoRows_AVX2(dst + (y + 2) * width + x, width, rows23);
+    }
+  }
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i DecodeRGB565_AVX2(__m256i val)
+{
+  const __m256i kMask_x1f = _mm256_set1_epi32(0x1F);
+  const __m256i kMask_x3f = _mm256_set1_epi32(0x3F);
+
+  const __m256i r5 = _mm256_srli_epi32(val, 11);
+  const __m256i g6 = _mm256_and_si256(_mm256_srli_epi32(val, 5), kMask_x3f);
+  const __m256i b5 = _mm256_and_si256(val, kMask_x1f);
+
+  const __m256i r = _mm256_or_si256(_mm256_slli_epi32(r5, 3), _mm256_srli_epi32(r5, 2));
+  const __m256i g = _mm256_or_si256(_mm256_slli_epi32(g6, 2), _mm256_srli_epi32(g6, 4));
+  const __m256i b = _mm256_or_si256(_mm256_slli_epi32(b5, 3), _mm256_srli_epi32(b5, 2));
+
+  return _mm256_or_si256(_mm256_or_si256(r, _mm256_slli_epi32(g, 8)),
+                         _mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_set1_epi32(0xFF000000)));
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_RGB565_AVX2(u32* dst, const u8* src, int width, int height,
+                                              TextureFormat texformat, const u8* tlut,
+                                              TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+    {
+      __m256i rows01, rows23;
+      LoadBlock16_AVX2(src + 32 * yStep, &rows01, &rows23);
+      StoreTwoRows_AVX2(dst + y * width + x, width, DecodeRGB565_AVX2(rows01));
+      StoreTwoRows_AVX2(dst + (y + 2) * width + x, width, DecodeRGB565_AVX2(rows23));
+    }
+  }
+}
+
+FUNCTION_TARGET_AVX2
+static inline __m256i DecodeRGB5A3_AVX2(__m256i val)
+{
+  const __m256i kMask_x07 = _mm256_set1_epi32(0x07);
+  const __m256i kMask_x0f = _mm256_set1_epi32(0x0F);
+  const __m256i kMask_x1f = _mm256_set1_epi32(0x1F);
+  const __m256i kReplicate4 = _mm256_set1_epi32(0x11);
+
+  // Opaque texels: RGB555 with alpha 0xFF.
+  const __m256i r5 = _mm256_and_si256(_mm256_srli_epi32(val, 10), kMask_x1f);
+  const __m256i g5 = _mm256_and_si256(_mm256_srli_epi32(val, 5), kMask_x1f);
+  const __m256i b5 = _mm256_and_si256(val, kMask_x1f);
+  const __m256i r8 = _mm256_or_si256(_mm256_slli_epi32(r5, 3), _mm256_srli_epi32(r5, 2));
+  const __m256i g8 = _mm256_or_si256(_mm256_slli_epi32(g5, 3), _mm256_srli_epi32(g5, 2));
+  const __m256i b8 = _mm256_or_si256(_mm256_slli_epi32(b5, 3), _mm256_srli_epi32(b5, 2));
+  const __m256i opaque =
+      _mm256_or_si256(_mm256_or_si256(r8, _mm256_slli_epi32(g8, 8)),
+                      _mm256_or_si256(_mm256_slli_epi32(b8, 16), _mm256_set1_epi32(0xFF000000)));
+
+  // Translucent texels: ARGB3444.
+  const __m256i a3 = _mm256_and_si256(_mm256_srli_epi32(val, 12), kMask_x07);
+  const __m256i r4 = _mm256_and_si256(_mm256_srli_epi32(val, 8), kMask_x0f);
+  const __m256i g4 = _mm256_and_si256(_mm256_srli_epi32(val, 4), kMask_x0f);
+  const __m256i b4 = _mm256_and_si256(val, kMask_x0f);
+  const __m256i a8 =
+      _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(a3, 5), _mm256_slli_epi32(a3, 2)),
+                      _mm256_srli_epi32(a3, 1));
+  const __m256i translucent = _mm256_or_si256(
+      _mm256_or_si256(_mm256_mullo_epi32(r4, kReplicate4),
+                      _mm256_slli_epi32(_mm256_mullo_epi32(g4, kReplicate4), 8)),
+      _mm256_or_si256(_mm256_slli_epi32(_mm256_mullo_epi32(b4, kReplicate4), 16),
+                      _mm256_slli_epi32(a8, 24)));
+
+  // Bit 15 selects the encoding.
+  const __m256i is_opaque = _mm256_srai_epi32(_mm256_slli_epi32(val, 16), 31);
+  return _mm256_blendv_epi8(translucent, opaque, is_opaque);
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_RGB5A3_AVX2(u32* dst, const u8* src, int width, int height,
+                                              TextureFormat texformat, const u8* tlut,
+                                              TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+    {
+      __m256i rows01, rows23;
+      LoadBlock16_AVX2(src + 32 * yStep, &rows01, &rows23);
+      StoreTwoRows_AVX2(dst + y * width + x, width, DecodeRGB5A3_AVX2(rows01));
+      StoreTwoRows_AVX2(dst + (y + 2) * width + x, width, DecodeRGB5A3_AVX2(rows23));
+    }
+  }
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_RGBA8_AVX2(u32* dst, const u8* src, int width, int height,
+                                             TextureFormat texformat, const u8* tlut,
+                                             TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  // The first 32 bytes of a block hold AR pairs, the second 32 bytes GB pairs. Interleaving them
+  // gives AGRB texels, with rows 0 and 2 (low) or 1 and 3 (high) in the two lanes.
+  const __m256i mask0312 = _mm256_setr_epi8(2, 1, 3, 0, 6, 5, 7, 4, 10, 9, 11, 8, 14, 13, 15, 12,
+                                            2, 1, 3, 0, 6, 5, 7, 4, 10, 9, 11, 8, 14, 13, 15, 12);
+  for (int y = 0; y < height; y += 4)
+  {
+    for (int x = 0, yStep = (y / 4) * Wsteps4; x < width; x += 4, yStep++)
+    {
+      const u8* src2 = src + 64 * yStep;
+      const __m256i ar = _mm256_loadu_si256((const __m256i*)src2);
+      const __m256i gb = _mm256_loadu_si256((const __m256i*)(src2 + 32));
+
+      const __m256i rows02 = _mm256_shuffle_epi8(_mm256_unpacklo_epi8(ar, gb), mask0312);
+      const __m256i rows13 = _mm256_shuffle_epi8(_mm256_unpackhi_epi8(ar, gb), mask0312);
+
+      u32* dst2 = dst + y * width + x;
+      _mm_storeu_si128((__m128i*)dst2, _mm256_castsi256_si128(rows02));
+      _mm_storeu_si128((__m128i*)(dst2 + width), _mm256_castsi256_si128(rows13));
+      _mm_storeu_si128((__m128i*)(dst2 + 2 * width), _mm256_extracti128_si256(rows02, 1));
+      _mm_storeu_si128((__m128i*)(dst2 + 3 * width), _mm256_extracti128_si256(rows13, 1));
+    }
+  }
+}
+
+// Decodes the 4x4 DXT block at src into dst, which has the given pitch in texels.
+FUNCTION_TARGET_AVX2
+static inline void DecodeDXTBlock_AVX2(u32* dst, const DXTBlock* src, int pitch)
+{
+  const u16 c1 = Common::swap16(src->color1);
+  const u16 c2 = Common::swap16(src->color2);
+  const int blue1 = Convert5To8(c1 & 0x1F);
+  const int blue2 = Convert5To8(c2 & 0x1F);
+  const int green1 = Convert6To8((c1 >> 5) & 0x3F);
+  const int green2 = Convert6To8((c2 >> 5) & 0x3F);
+  const int red1 = Convert5To8((c1 >> 11) & 0x1F);
+  const int red2 = Convert5To8((c2 >> 11) & 0x1F);
+
+  alignas(16) u32 colors[4];
+  colors[0] = MakeRGBA(red1, green1, blue1, 255);
+  colors[1] = MakeRGBA(red2, green2, blue2, 255);
+  if (c1 > c2)
+  {
+    colors[2] =
+        MakeRGBA(DXTBlend(red2, red1), DXTBlend(green2, green1), DXTBlend(blue2, blue1), 255);
+    colors[3] =
+        MakeRGBA(DXTBlend(red1, red2), DXTBlend(green1, green2), DXTBlend(blue1, blue2), 255);
+  }
+  else
+  {
+    colors[2] = MakeRGBA((red1 + red2) / 2, (green1 + green2) / 2, (blue1 + blue2) / 2, 255);
+    colors[3] = MakeRGBA((red1 + red2) / 2, (green1 + green2) / 2, (blue1 + blue2) / 2, 0);
+  }
+  const __m256i palette = _mm256_castsi128_si256(_mm_load_si128((const __m128i*)colors));
+
+  // Each line byte holds the 2-bit color indices of a row, leftmost texel in the top bits.
+  u32 lines;
+  std::memcpy(&lines, src->lines, sizeof(lines));
+  const __m256i shifts01 = _mm256_setr_epi32(6, 4, 2, 0, 14, 12, 10, 8);
+  const __m256i shifts23 = _mm256_add_epi32(shifts01, _mm256_set1_epi32(16));
+  const __m256i kMask_x03 = _mm256_set1_epi32(0x03);
+  const __m256i all_lines = _mm256_set1_epi32(lines);
+
+  const __m256i indices01 = _mm256_and_si256(_mm256_srlv_epi32(all_lines, shifts01), kMask_x03);
+  const __m256i indices23 = _mm256_and_si256(_mm256_srlv_epi32(all_lines, shifts23), kMask_x03);
+  StoreTwoRows_AVX2(dst, pitch, _mm256_permutevar8x32_epi32(palette, indices01));
+  StoreTwoRows_AVX2(dst + 2 * pitch, pitch, _mm256_permutevar8x32_epi32(palette, indices23));
+}
+
+FUNCTION_TARGET_AVX2
+static void TexDecoder_DecodeImpl_CMPR_AVX2(u32* dst, const u8* src, int width, int height,
+                                            TextureFormat texformat, const u8* tlut,
+                                            TLUTFormat tlutfmt, int Wsteps4, int Wsteps8)
+{
+  for (int y = 0; y < height; y += 8)
+  {
+    for (int x = 0, yStep = (y / 8) * Wsteps8; x < width; x += 8, yStep++)
+    {
+      const DXTBlock* blocks = reinterpret_cast<const DXTBlock*>(src) + 4 * yStep;
+      u32* dst2 = dst + y * width + x;
+      DecodeDXTBlock_AVX2(dst2, &blocks[0], width);
+      DecodeDXTBlock_AVX2(dst2 + 4, &blocks[1], width);
+      DecodeDXTBlock_AVX2(dst2 + 4 * width, &blocks[2], width);
+      DecodeDXTBlock_AVX2(dst2 + 4 * width + 4, &blocks[3], width);
+    }
+  }
+}
+
+std::vector<u32> _TexDecoder_DecodeTLUTTable(int width, int height, TextureFormat texformat,
+                                             const u8* tlut, TLUTFormat tlutfmt)
+{
+  std::vector<u32> palette;
+  if (texformat != TextureFormat::C14X2 || !cpu_info.bAVX2 ||
+      width * height < MIN_TEXELS_FOR_C14X2_PALETTE_TABLE)
+  {
+    return palette;
+  }
+
+  // A TLUT near the end of TMEM can't have all 16384 entries. Texels using the missing entries
+  // don't decode to anything meaningful on any path, so they are left at zero.
+  int palette_size = 0x4000;
+  if (tlut >= texMem && tlut < texMem + TMEM_SIZE)
+    palette_size = std::min<int>(palette_size, static_cast<int>(texMem + TMEM_SIZE - tlut) / 2);
+
+  palette.resize(0x4000);
+  if (!DecodePalette(palette.data(), tlut, tlutfmt, palette_size))
+    palette.clear();
+  return palette;
+}
+
 void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, TextureFormat texformat,
-                            const u8* tlut, TLUTFormat tlutfmt)
+                            const u8* tlut, TLUTFormat tlutfmt, const u32* tlut_table)
 {
   int Wsteps4 = (width + 3) / 4;
   int Wsteps8 = (width + 7) / 8;
@@ -1418,7 +1786,11 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, Text
   switch (texformat)
   {
   case TextureFormat::C4:
-    TexDecoder_DecodeImpl_C4(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_C4_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                    Wsteps8);
+    else
+      TexDecoder_DecodeImpl_C4(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
     break;
 
   case TextureFormat::I4:
@@ -1438,11 +1810,20 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, Text
     break;
 
   case TextureFormat::C8:
-    TexDecoder_DecodeImpl_C8(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_C8_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                    Wsteps8);
+    else
+      TexDecoder_DecodeImpl_C8(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
     break;
 
   case TextureFormat::IA4:
-    TexDecoder_DecodeImpl_IA4(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_IA4_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                     Wsteps8);
+    else
+      TexDecoder_DecodeImpl_IA4(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                Wsteps8);
     break;
 
   case TextureFormat::IA8:
@@ -1455,17 +1836,36 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, Text
     break;
 
   case TextureFormat::C14X2:
-    TexDecoder_DecodeImpl_C14X2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
-                                Wsteps8);
+  {
+    std::vector<u32> palette;
+    if (!tlut_table)
+    {
+      palette = _TexDecoder_DecodeTLUTTable(width, height, texformat, tlut, tlutfmt);
+      if (!palette.empty())
+        tlut_table = palette.data();
+    }
+    if (tlut_table)
+      TexDecoder_DecodeImpl_C14X2_AVX2(dst, src, width, height, tlut_table, Wsteps4);
+    else
+      TexDecoder_DecodeImpl_C14X2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                  Wsteps8);
     break;
+  }
 
   case TextureFormat::RGB565:
-    TexDecoder_DecodeImpl_RGB565(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
-                                 Wsteps8);
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_RGB565_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                        Wsteps8);
+    else
+      TexDecoder_DecodeImpl_RGB565(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                   Wsteps8);
     break;
 
   case TextureFormat::RGB5A3:
-    if (cpu_info.bSSSE3)
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_RGB5A3_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                        Wsteps8);
+    else if (cpu_info.bSSSE3)
       TexDecoder_DecodeImpl_RGB5A3_SSSE3(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
                                          Wsteps8);
     else
@@ -1474,7 +1874,10 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, Text
     break;
 
   case TextureFormat::RGBA8:
-    if (cpu_info.bSSSE3)
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_RGBA8_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                       Wsteps8);
+    else if (cpu_info.bSSSE3)
       TexDecoder_DecodeImpl_RGBA8_SSSE3(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
                                         Wsteps8);
     else
@@ -1483,7 +1886,12 @@ void _TexDecoder_DecodeImpl(u32* dst, const u8* src, int width, int height, Text
     break;
 
   case TextureFormat::CMPR:
-    TexDecoder_DecodeImpl_CMPR(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4, Wsteps8);
+    if (cpu_info.bAVX2)
+      TexDecoder_DecodeImpl_CMPR_AVX2(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                      Wsteps8);
+    else
+      TexDecoder_DecodeImpl_CMPR(dst, src, width, height, texformat, tlut, tlutfmt, Wsteps4,
+                                 Wsteps8);
     break;
 
   case TextureFormat::XFB:
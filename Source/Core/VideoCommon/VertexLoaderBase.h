@@ -72,6 +72,9 @@ public:
 
   virtual std::string GetName() const = 0;
 
+  const TVtxDesc& GetVtxDesc() const { return m_VtxDesc; }
+  const TVtxAttr& GetVtxAttr() const { return m_VtxAttr; }
+
   // per loader public state
   int m_VertexSize = 0;  // number of bytes of a raw GC vertex
   PortableVertexDeclaration m_native_vtx_decl{};
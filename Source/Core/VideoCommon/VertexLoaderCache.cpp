@@ -0,0 +1,304 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include "VideoCommon/VertexLoaderCache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "Common/Hash.h"
+#include "Common/Swap.h"
+
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/DataReader.h"
+#include "VideoCommon/Statistics.h"
+#include "VideoCommon/VertexLoaderBase.h"
+#include "VideoCommon/VertexLoaderManager.h"
+#include "VideoCommon/VertexLoader_Normal.h"
+#include "VideoCommon/VertexLoader_Position.h"
+#include "VideoCommon/VertexLoader_TextCoord.h"
+
+namespace
+{
+// Hashing and looking up the input only pays off for batches of some size.
+constexpr int MIN_CACHED_VERTICES = 32;
+
+// Sparse indices can make the range of a vertex array to hash much larger than the data which is
+// actually read, at which point running the loader is cheaper.
+constexpr u64 MAX_ARRAY_BYTES_PER_VERTEX = 256;
+
+constexpr std::size_t MAX_CACHE_SIZE = 64 * 1024 * 1024;
+
+u32 GetComponentSize(u32 format)
+{
+  switch (format)
+  {
+  case FORMAT_UBYTE:
+  case FORMAT_BYTE:
+    return 1;
+  case FORMAT_USHORT:
+  case FORMAT_SHORT:
+    return 2;
+  default:
+    return 4;
+  }
+}
+
+u32 GetColorSize(u32 format)
+{
+  switch (format)
+  {
+  case FORMAT_16B_565:
+  case FORMAT_16B_4444:
+    return 2;
+  case FORMAT_24B_888:
+  case FORMAT_24B_6666:
+    return 3;
+  default:
+    return 4;
+  }
+}
+
+u64 CombineHash(u64 hash, u64 value)
+{
+  return hash ^ (value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2));
+}
+}  // namespace
+
+int VertexLoaderCache::RunVertices(VertexLoaderBase* loader, const VertexArrays& arrays,
+                                   const DataReader& src, DataReader dst, int count, u32 frame)
+{
+  const std::optional<u64> key =
+      count >= MIN_CACHED_VERTICES ? ComputeKey(loader, arrays, src.GetPointer(), count) :
+                                     std::nullopt;
+  if (!key)
+    return loader->RunVertices(src, dst, count);
+
+  const u32 input_size = count * loader->m_VertexSize;
+  auto iter = m_entries.find(*key);
+  if (iter != m_entries.end() && iter->second.loader == loader &&
+      iter->second.input_size == input_size && iter->second.count)
+  {
+    Entry& entry = iter->second;
+    entry.last_used_frame = frame;
+    std::memcpy(dst.GetPointer(), entry.output.data(), entry.output.size());
+
+    std::memcpy(VertexLoaderManager::position_cache, entry.position_cache,
+                sizeof(entry.position_cache));
+    if (loader->GetVtxDesc().PosMatIdx)
+    {
+      std::memcpy(VertexLoaderManager::position_matrix_index, entry.position_matrix_index,
+                  sizeof(entry.position_matrix_index));
+    }
+    loader->m_numLoadedVertices += count;
+
+    INCSTAT(g_stats.this_frame.num_vertex_loader_cache_hits);
+    ADDSTAT(g_stats.this_frame.bytes_vertex_loader_cache_saved, entry.output.size());
+    return *entry.count;
+  }
+
+  INCSTAT(g_stats.this_frame.num_vertex_loader_cache_misses);
+  const int loaded_count = loader->RunVertices(src, dst, count);
+
+  // The first time some input is seen, only remember that it was.
+  const bool seen_before = iter != m_entries.end() && iter->second.loader == loader &&
+                           iter->second.input_size == input_size;
+  if (!seen_before)
+  {
+    if (iter == m_entries.end())
+    {
+      if (!MakeRoom(sizeof(Entry), frame))
+        return loaded_count;
+
+      iter = m_entries.emplace(*key, Entry{}).first;
+      m_size += sizeof(Entry);
+    }
+
+    Entry& entry = iter->second;
+    m_size -= entry.output.capacity();
+    entry = Entry{loader, input_size, frame};
+    return loaded_count;
+  }
+
+  const std::size_t output_size =
+      static_cast<std::size_t>(loaded_count) * loader->m_native_vtx_decl.stride;
+  iter->second.last_used_frame = frame;
+  if (!MakeRoom(output_size, frame))
+    return loaded_count;
+
+  Entry& entry = iter->second;
+  entry.count = loaded_count;
+  entry.output.assign(dst.GetPointer(), dst.GetPointer() + output_size);
+  m_size += entry.output.capacity();
+
+  std::memcpy(entry.position_cache, VertexLoaderManager::position_cache,
+              sizeof(entry.position_cache));
+  std::memcpy(entry.position_matrix_index, VertexLoaderManager::position_matrix_index,
+              sizeof(entry.position_matrix_index));
+  return loaded_count;
+}
+
+void VertexLoaderCache::Clear()
+{
+  m_layouts.clear();
+  m_entries.clear();
+  m_size = 0;
+  m_full_frame.reset();
+}
+
+const VertexLoaderCache::Layout& VertexLoaderCache::GetLayout(const VertexLoaderBase* loader)
+{
+  const auto iter = m_layouts.find(loader);
+  if (iter != m_layouts.end())
+    return iter->second;
+
+  Layout& layout = m_layouts[loader];
+  const TVtxDesc& desc = loader->GetVtxDesc();
+  const TVtxAttr& attr = loader->GetVtxAttr();
+
+  // The size tables can't be indexed with invalid formats. Loaders for them never appear in
+  // practice, so they're just not cached.
+  if (attr.PosFormat > FORMAT_FLOAT || attr.NormalFormat > FORMAT_FLOAT ||
+      std::any_of(std::begin(attr.texCoord), std::end(attr.texCoord),
+                  [](const TexAttr& tex_attr) { return tex_attr.Format > FORMAT_FLOAT; }))
+  {
+    return layout;
+  }
+
+  // Matrix indices come first, and are always one byte and direct.
+  u32 offset = 0;
+  for (u32 i = 0; i < 9; i++)
+    offset += (desc.Hex >> i) & 1;
+
+  const auto add = [&layout, &offset](u32 array, u64 type, u32 size, u32 read_size) {
+    if (type & MASK_INDEXED)
+    {
+      const u32 index_size = type == INDEX16 ? 2 : 1;
+      layout.indexed_attributes.push_back(
+          IndexedAttribute{array, offset, index_size, size / index_size, read_size});
+    }
+    offset += size;
+  };
+
+  add(ARRAY_POSITION, desc.Position,
+      VertexLoader_Position::GetSize(desc.Position, attr.PosFormat, attr.PosElements),
+      (attr.PosElements ? 3 : 2) * GetComponentSize(attr.PosFormat));
+
+  // NBT normals read three vectors, either from one index or from one index each.
+  add(ARRAY_NORMAL, desc.Normal,
+      VertexLoader_Normal::GetSize(desc.Normal, attr.NormalFormat, attr.NormalElements,
+                                   attr.NormalIndex3),
+      (attr.NormalElements ? 9 : 3) * GetComponentSize(attr.NormalFormat));
+
+  const u64 colors[2] = {desc.Color0, desc.Color1};
+  for (u32 i = 0; i < 2; i++)
+  {
+    const u32 color_size = GetColorSize(attr.color[i].Comp);
+    u32 size = 0;
+    if (colors[i] == DIRECT)
+      size = color_size;
+    else if (colors[i] != NOT_PRESENT)
+      size = colors[i] == INDEX16 ? 2 : 1;
+    add(ARRAY_COLOR + i, colors[i], size, color_size);
+  }
+
+  const u64 tex_coords[8] = {desc.Tex0Coord, desc.Tex1Coord, desc.Tex2Coord, desc.Tex3Coord,
+                             desc.Tex4Coord, desc.Tex5Coord, desc.Tex6Coord, desc.Tex7Coord};
+  for (u32 i = 0; i < 8; i++)
+  {
+    const TexAttr& tex_attr = attr.texCoord[i];
+    add(ARRAY_TEXCOORD0 + i, tex_coords[i],
+        VertexLoader_TextCoord::GetSize(tex_coords[i], tex_attr.Format, tex_attr.Elements),
+        (tex_attr.Elements ? 2 : 1) * GetComponentSize(tex_attr.Format));
+  }
+
+  layout.cacheable = offset == static_cast<u32>(loader->m_VertexSize);
+  return layout;
+}
+
+std::optional<u64> VertexLoaderCache::ComputeKey(const VertexLoaderBase* loader,
+                                                 const VertexArrays& arrays, const u8* src,
+                                                 int count)
+{
+  const Layout& layout = GetLayout(loader);
+  if (!layout.cacheable)
+    return std::nullopt;
+
+  const u32 vertex_size = loader->m_VertexSize;
+  u64 key = Common::GetHash64(src, count * vertex_size, 0);
+  key = CombineHash(key, reinterpret_cast<std::uintptr_t>(loader));
+
+  // The output depends on the array data the indices point at, but not on where it is.
+  for (const IndexedAttribute& attribute : layout.indexed_attributes)
+  {
+    // A position index with all bits set skips the vertex, so nothing is read for it.
+    u32 skip_index = std::numeric_limits<u32>::max();
+    if (attribute.array == ARRAY_POSITION)
+      skip_index = attribute.index_size == 2 ? 0xFFFF : 0xFF;
+
+    u32 min_index = std::numeric_limits<u32>::max();
+    u32 max_index = 0;
+    const u8* vertex = src + attribute.offset;
+    for (int i = 0; i < count; i++, vertex += vertex_size)
+    {
+      for (u32 j = 0; j < attribute.num_indices; j++)
+      {
+        const u8* index_data = vertex + j * attribute.index_size;
+        const u32 index = attribute.index_size == 2 ? Common::swap16(index_data) : *index_data;
+        if (index == skip_index)
+          continue;
+
+        min_index = std::min(min_index, index);
+        max_index = std::max(max_index, index);
+      }
+    }
+    if (min_index > max_index)
+      continue;
+
+    const VertexArray& array = arrays[attribute.array];
+    const u64 begin = u64(min_index) * array.stride;
+    const u64 end = u64(max_index) * array.stride + attribute.read_size;
+    if (!array.base || end > array.readable_size ||
+        end - begin > MAX_ARRAY_BYTES_PER_VERTEX * count)
+    {
+      return std::nullopt;
+    }
+
+    key = CombineHash(key, Common::GetHash64(array.base + begin, u32(end - begin), 0));
+    key = CombineHash(key, array.stride);
+  }
+
+  return key;
+}
+
+bool VertexLoaderCache::MakeRoom(std::size_t size, u32 frame)
+{
+  if (m_size + size <= MAX_CACHE_SIZE)
+    return true;
+
+  // Once everything which wasn't used this frame is gone, don't try again until the next frame.
+  if (m_full_frame == frame)
+    return false;
+
+  for (auto iter = m_entries.begin(); iter != m_entries.end();)
+  {
+    if (iter->second.last_used_frame != frame)
+    {
+      m_size -= sizeof(Entry) + iter->second.output.capacity();
+      iter = m_entries.erase(iter);
+    }
+    else
+    {
+      ++iter;
+    }
+  }
+
+  if (m_size + size <= MAX_CACHE_SIZE)
+    return true;
+
+  m_full_frame = frame;
+  return false;
+}
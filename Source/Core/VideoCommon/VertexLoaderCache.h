@@ -0,0 +1,88 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+
+class DataReader;
+class VertexLoaderBase;
+
+// Keeps the output of the vertex loaders for input which is loaded again, which is common for
+// static geometry in display lists. Entries are keyed by a hash of the vertex data and of the parts
+// of the vertex arrays it indexes, so cached output is only used if neither has changed.
+//
+// Output is only cached the second time some input is seen, so that geometry which changes every
+// frame costs no more than hashing it.
+class VertexLoaderCache
+{
+public:
+  // A vertex array as the vertex loaders see it. readable_size is the number of bytes after base
+  // which are in emulated memory.
+  struct VertexArray
+  {
+    const u8* base = nullptr;
+    u32 stride = 0;
+    u32 readable_size = 0;
+  };
+  using VertexArrays = std::array<VertexArray, 12>;
+
+  // Loads count vertices from src into dst, either by running the loader or by copying its earlier
+  // output for the same input. Returns the number of vertices written, like the loader does.
+  int RunVertices(VertexLoaderBase* loader, const VertexArrays& arrays, const DataReader& src,
+                  DataReader dst, int count, u32 frame);
+
+  // Must be called before the vertex loaders are destroyed.
+  void Clear();
+
+  std::size_t GetSize() const { return m_size; }
+
+private:
+  // An index in the vertex data. NBT normals may have three.
+  struct IndexedAttribute
+  {
+    u32 array;
+    u32 offset;
+    u32 index_size;
+    u32 num_indices;
+    u32 read_size;
+  };
+
+  struct Layout
+  {
+    bool cacheable = false;
+    std::vector<IndexedAttribute> indexed_attributes;
+  };
+
+  struct Entry
+  {
+    const VertexLoaderBase* loader;
+    u32 input_size;
+    u32 last_used_frame;
+
+    // The number of vertices the loader returned, or nullopt if the input was only seen once.
+    std::optional<int> count;
+    std::vector<u8> output;
+
+    // Written by the loaders for zfreeze.
+    float position_cache[3][4];
+    u32 position_matrix_index[4];
+  };
+
+  const Layout& GetLayout(const VertexLoaderBase* loader);
+  std::optional<u64> ComputeKey(const VertexLoaderBase* loader, const VertexArrays& arrays,
+                                const u8* src, int count);
+  bool MakeRoom(std::size_t size, u32 frame);
+
+  std::unordered_map<const VertexLoaderBase*, Layout> m_layouts;
+  std::unordered_map<u64, Entry> m_entries;
+  std::size_t m_size = 0;
+  std::optional<u32> m_full_frame;
+};
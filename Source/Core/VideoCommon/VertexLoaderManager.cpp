@@ -20,13 +20,16 @@
 #include "VideoCommon/BPMemory.h"
 #include "VideoCommon/CommandProcessor.h"
 #include "VideoCommon/DataReader.h"
+#include "VideoCommon/FrameProfiler.h"
 #include "VideoCommon/IndexGenerator.h"
 #include "VideoCommon/NativeVertexFormat.h"
 #include "VideoCommon/RenderBase.h"
 #include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderBase.h"
+#include "VideoCommon/VertexLoaderCache.h"
 #include "VideoCommon/VertexManagerBase.h"
 #include "VideoCommon/VertexShaderManager.h"
+#include "VideoCommon/VideoConfig.h"
 
 namespace VertexLoaderManager
 {
@@ -47,6 +50,9 @@ static VertexLoaderMap s_vertex_loader_map;
 
 u8* cached_arraybases[12];
 
+static VertexLoaderCache s_vertex_loader_cache;
+static VertexLoaderCache::VertexArrays s_cached_arrays;
+
 void Init()
 {
   MarkAllDirty();
@@ -60,10 +66,28 @@ void Init()
 void Clear()
 {
   std::lock_guard<std::mutex> lk(s_vertex_loader_map_lock);
+  s_vertex_loader_cache.Clear();
   s_vertex_loader_map.clear();
   s_native_vertex_map.clear();
 }
 
+// Returns the number of bytes from address to the end of the memory region it's in, for the
+// addresses Memory::GetPointer accepts.
+static u32 GetReadableSize(u32 address)
+{
+  address &= 0x3FFFFFFF;
+  if (address < Memory::GetRamSizeReal())
+    return Memory::GetRamSizeReal() - address;
+
+  if (Memory::m_pEXRAM && (address >> 28) == 0x1 &&
+      (address & 0x0fffffff) < Memory::GetExRamSizeReal())
+  {
+    return Memory::GetExRamSizeReal() - (address & 0x0fffffff);
+  }
+
+  return 0;
+}
+
 void UpdateVertexArrayPointers()
 {
   // Anything to update?
@@ -79,7 +103,12 @@ void UpdateVertexArrayPointers()
   {
     // Only update the array base if the vertex description states we are going to use it.
     if (g_main_cp_state.vtx_desc.GetVertexArrayStatus(i) & MASK_INDEXED)
+    {
       cached_arraybases[i] = Memory::GetPointer(g_main_cp_state.array_bases[i]);
+      s_cached_arrays[i].base = cached_arraybases[i];
+      s_cached_arrays[i].readable_size =
+          cached_arraybases[i] ? GetReadableSize(g_main_cp_state.array_bases[i]) : 0;
+    }
   }
 
   g_main_cp_state.bases_dirty = false;
@@ -220,9 +249,24 @@ void RunVertices(int vtx_attr_group, int primitive, int count, const DataReader&
   DataReader dst = g_vertex_manager->PrepareForAdditionalData(
       primitive, count, loader->m_native_vtx_decl.stride, cullall);
 
-  count = loader->RunVertices(src, dst, count);
+  {
+    FrameProfiler::ScopedSection section(FrameProfiler::Section::VertexLoader);
 
-  IndexGenerator::AddIndices(primitive, count);
+    if (g_ActiveConfig.bVertexLoaderCache)
+    {
+      // Strides can change without marking the bases dirty.
+      for (int i = 0; i < 12; i++)
+        s_cached_arrays[i].stride = g_main_cp_state.array_strides[i];
+      count = s_vertex_loader_cache.RunVertices(loader, s_cached_arrays, src, dst, count,
+                                                g_renderer->GetFrameCount());
+    }
+    else
+    {
+      count = loader->RunVertices(src, dst, count);
+    }
+
+    IndexGenerator::AddIndices(primitive, count);
+  }
 
   g_vertex_manager->FlushData(count, loader->m_native_vtx_decl.stride);
 
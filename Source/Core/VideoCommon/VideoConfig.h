@@ -92,6 +92,7 @@ struct VideoConfig final
   bool bDumpEFBTarget;
   bool bDumpXFBTarget;
   bool bDumpFramesAsImages;
+  bool bDumpPipelineUIDs;
   bool bUseFFV1;
   std::string sDumpCodec;
   std::string sDumpEncoder;
@@ -128,6 +129,7 @@ struct VideoConfig final
   bool bApproximateLogicOpWithBlending;
   bool bFastDepthCalc;
   bool bVertexRounding;
+  bool bVertexLoaderCache;
   bool bVISkip;
   int iEFBAccessTileSize;
   int iLog;           // CONF_ bits
@@ -144,6 +146,7 @@ struct VideoConfig final
   bool bDumpObjects;
   bool bDumpTevStages;
   bool bDumpTevTextureFetches;
+  int iSWThreads;  // 0 picks a count based on the number of cores
 
   // Enable API validation layers, currently only supported with Vulkan.
   bool bEnableValidationLayer;
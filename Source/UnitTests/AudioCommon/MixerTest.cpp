@@ -0,0 +1,113 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "AudioCommon/Mixer.h"
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+constexpr u32 SAMPLE_RATE = 48000;
+constexpr u32 CALLBACK_SAMPLES = 256;
+// How long the backend goes without asking for samples, which it then asks for all at once.
+constexpr u32 STALL_SAMPLES = SAMPLE_RATE * 40 / 1000;
+// The mixer lowers its target latency after 5 seconds without underruns.
+constexpr u32 DECAY_SAMPLES = SAMPLE_RATE * 5;
+
+// Waits for the worker thread to mix at least min_ms ahead.
+void WaitForBuffered(const Mixer& mixer, u32 min_ms)
+{
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (mixer.GetStatistics().buffered_ms < min_ms)
+  {
+    ASSERT_LT(std::chrono::steady_clock::now(), deadline);
+    std::this_thread::yield();
+  }
+}
+
+// Drives the mixer like a backend whose callback runs late once.
+void RunStall(Mixer& mixer, const std::function<void(u32)>& mix)
+{
+  // The first callback can come before anything was mixed for the output it uses.
+  mix(CALLBACK_SAMPLES);
+  WaitForBuffered(mixer, mixer.GetStatistics().target_latency_ms);
+  const Mixer::Statistics before_stall = mixer.GetStatistics();
+
+  mix(STALL_SAMPLES);
+  const Mixer::Statistics after_stall = mixer.GetStatistics();
+  EXPECT_EQ(before_stall.underruns + 1, after_stall.underruns);
+  // The output was short by the stall minus what was buffered, and the target grows by that.
+  EXPECT_GT(after_stall.target_latency_ms, STALL_SAMPLES * 1000 / SAMPLE_RATE);
+  EXPECT_GT(after_stall.target_latency_ms, before_stall.target_latency_ms);
+
+  // Callbacks which are on time again. Waiting for a callback's worth of samples keeps the
+  // worker thread from falling behind on a busy machine.
+  const u32 callback_ms = (CALLBACK_SAMPLES * 1000 + SAMPLE_RATE - 1) / SAMPLE_RATE;
+  u32 lowest_target_ms = after_stall.target_latency_ms;
+  for (u32 samples = 0; samples < DECAY_SAMPLES * 2; samples += CALLBACK_SAMPLES)
+  {
+    WaitForBuffered(mixer, callback_ms);
+    mix(CALLBACK_SAMPLES);
+    const Mixer::Statistics stats = mixer.GetStatistics();
+    ASSERT_EQ(after_stall.underruns, stats.underruns);
+    // The target never grows without an underrun.
+    EXPECT_LE(stats.target_latency_ms, lowest_target_ms);
+    lowest_target_ms = stats.target_latency_ms;
+  }
+
+  // But it doesn't drop below what the backend asked for at once either.
+  EXPECT_LT(lowest_target_ms, after_stall.target_latency_ms);
+  EXPECT_GE(lowest_target_ms, STALL_SAMPLES * 1000 / SAMPLE_RATE);
+}
+}  // namespace
+
+class MixerTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_profile_path = File::CreateTempDir();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+  }
+
+  void TearDown() override
+  {
+    SConfig::Shutdown();
+    Config::Shutdown();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  std::string m_profile_path;
+};
+
+TEST_F(MixerTest, StereoLatencyFollowsStalls)
+{
+  Mixer mixer(SAMPLE_RATE);
+  std::vector<short> samples(STALL_SAMPLES * 2);
+  RunStall(mixer, [&](u32 num_samples) {
+    EXPECT_EQ(num_samples, mixer.Mix(samples.data(), num_samples));
+  });
+}
+
+TEST_F(MixerTest, SurroundLatencyFollowsStalls)
+{
+  Mixer mixer(SAMPLE_RATE);
+  std::vector<float> samples(STALL_SAMPLES * 6);
+  RunStall(mixer, [&](u32 num_samples) {
+    EXPECT_EQ(num_samples, mixer.MixSurround(samples.data(), num_samples));
+  });
+}
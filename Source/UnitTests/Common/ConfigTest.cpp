@@ -0,0 +1,149 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+
+namespace
+{
+enum class TestEnum
+{
+  A,
+  B,
+  C,
+};
+
+const Config::ConfigInfo<bool> TEST_BOOL{{Config::System::Main, "Test", "Bool"}, false};
+const Config::ConfigInfo<int> TEST_INT{{Config::System::Main, "Test", "Int"}, 5};
+const Config::ConfigInfo<float> TEST_FLOAT{{Config::System::Main, "Test", "Float"}, 1.5f};
+const Config::ConfigInfo<u64> TEST_U64{{Config::System::Main, "Test", "U64"}, 1};
+const Config::ConfigInfo<std::string> TEST_STRING{{Config::System::Main, "Test", "String"},
+                                                  "default"};
+const Config::ConfigInfo<TestEnum> TEST_ENUM{{Config::System::Main, "Test", "Enum"}, TestEnum::B};
+
+class ConfigTest : public testing::Test
+{
+protected:
+  ConfigTest()
+  {
+    Config::Init();
+    Config::AddLayer(std::make_unique<Config::Layer>(Config::LayerType::Base));
+  }
+  ~ConfigTest() override { Config::Shutdown(); }
+};
+}  // namespace
+
+TEST_F(ConfigTest, Defaults)
+{
+  EXPECT_FALSE(Config::Get(TEST_BOOL));
+  EXPECT_EQ(5, Config::Get(TEST_INT));
+  EXPECT_EQ(1.5f, Config::Get(TEST_FLOAT));
+  EXPECT_EQ(1u, Config::Get(TEST_U64));
+  EXPECT_EQ("default", Config::Get(TEST_STRING));
+  EXPECT_EQ(TestEnum::B, Config::Get(TEST_ENUM));
+}
+
+TEST_F(ConfigTest, CachedValuesFollowChanges)
+{
+  // Read everything once so that the values are cached.
+  Config::Get(TEST_BOOL);
+  Config::Get(TEST_INT);
+  Config::Get(TEST_FLOAT);
+  Config::Get(TEST_U64);
+  Config::Get(TEST_STRING);
+  Config::Get(TEST_ENUM);
+
+  Config::SetBase(TEST_BOOL, true);
+  Config::SetBase(TEST_INT, -3);
+  Config::SetBase(TEST_FLOAT, 0.25f);
+  Config::SetBase<u64>(TEST_U64, 0x123456789ABCDEF);
+  Config::SetBase(TEST_STRING, "base");
+  Config::SetBase(TEST_ENUM, TestEnum::C);
+  EXPECT_TRUE(Config::Get(TEST_BOOL));
+  EXPECT_EQ(-3, Config::Get(TEST_INT));
+  EXPECT_EQ(0.25f, Config::Get(TEST_FLOAT));
+  EXPECT_EQ(0x123456789ABCDEFu, Config::Get(TEST_U64));
+  EXPECT_EQ("base", Config::Get(TEST_STRING));
+  EXPECT_EQ(TestEnum::C, Config::Get(TEST_ENUM));
+
+  // Higher priority layers override the base layer.
+  Config::SetCurrent(TEST_INT, 7);
+  Config::SetCurrent(TEST_STRING, "current");
+  EXPECT_EQ(7, Config::Get(TEST_INT));
+  EXPECT_EQ("current", Config::Get(TEST_STRING));
+  EXPECT_EQ(-3, Config::GetBase(TEST_INT));
+
+  Config::ClearCurrentRunLayer();
+  EXPECT_EQ(-3, Config::Get(TEST_INT));
+  EXPECT_EQ("base", Config::Get(TEST_STRING));
+
+  // Changes made directly to a layer are picked up too.
+  Config::GetLayer(Config::LayerType::Base)->DeleteKey(TEST_INT.location);
+  EXPECT_EQ(5, Config::Get(TEST_INT));
+  Config::GetLayer(Config::LayerType::Base)->Set(TEST_INT, 9);
+  EXPECT_EQ(9, Config::Get(TEST_INT));
+
+  Config::AddLayer(std::make_unique<Config::Layer>(Config::LayerType::Base));
+  EXPECT_FALSE(Config::Get(TEST_BOOL));
+  EXPECT_EQ("default", Config::Get(TEST_STRING));
+}
+
+TEST_F(ConfigTest, CopiesDontShareCache)
+{
+  Config::SetBase(TEST_INT, 1);
+  EXPECT_EQ(1, Config::Get(TEST_INT));
+
+  Config::ConfigInfo<int> copy = TEST_INT;
+  copy.location.key = "OtherInt";
+  EXPECT_EQ(5, Config::Get(copy));
+}
+
+// Compares a cached read with the lookup and parse which Config::Get used to do on every call,
+// with a realistic number of keys and layers.
+TEST_F(ConfigTest, DISABLED_GetThroughput)
+{
+  constexpr int ITERATIONS = 10000000;
+
+  for (Config::LayerType type : {Config::LayerType::GlobalGame, Config::LayerType::LocalGame,
+                                 Config::LayerType::CommandLine})
+  {
+    Config::AddLayer(std::make_unique<Config::Layer>(type));
+  }
+  for (int i = 0; i < 500; ++i)
+  {
+    Config::SetBase(
+        Config::ConfigInfo<int>{{Config::System::Main, "Core", "Key" + std::to_string(i)}, 0}, i);
+  }
+  Config::SetBase(TEST_INT, 42);
+
+  const auto measure = [](const char* name, auto get) {
+    u64 sum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i)
+      sum += get();
+    const auto end = std::chrono::steady_clock::now();
+
+    const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    std::printf("%-24s %8.2f ns per call (%llu)\n", name, ns / ITERATIONS,
+                static_cast<unsigned long long>(sum));
+  };
+
+  measure("Uncached int", [] {
+    return Config::GetLayer(Config::GetActiveLayerForConfig(TEST_INT))->Get(TEST_INT);
+  });
+  measure("Cached int", [] { return Config::Get(TEST_INT); });
+  measure("Uncached string", [] {
+    return Config::GetLayer(Config::GetActiveLayerForConfig(TEST_STRING))
+        ->Get(TEST_STRING)
+        .size();
+  });
+  measure("Cached string", [] { return Config::Get(TEST_STRING).size(); });
+}
@@ -0,0 +1,69 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <mbedtls/sha1.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Crypto/SHA1.h"
+
+namespace
+{
+Common::SHA1::Digest FromString(const std::string& string)
+{
+  return Common::SHA1::CalculateDigest(reinterpret_cast<const u8*>(string.data()), string.size());
+}
+
+Common::SHA1::Digest CalculateWithMbedtls(const u8* data, size_t size)
+{
+  Common::SHA1::Digest digest;
+  mbedtls_sha1_ret(data, size, digest.data());
+  return digest;
+}
+}  // namespace
+
+TEST(SHA1, KnownDigests)
+{
+  EXPECT_EQ(Common::SHA1::Digest({0xda, 0x39, 0xa3, 0xee, 0x5e, 0x6b, 0x4b, 0x0d, 0x32, 0x55,
+                                  0xbf, 0xef, 0x95, 0x60, 0x18, 0x90, 0xaf, 0xd8, 0x07, 0x09}),
+            FromString(""));
+  EXPECT_EQ(Common::SHA1::Digest({0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e,
+                                  0x25, 0x71, 0x78, 0x50, 0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d}),
+            FromString("abc"));
+  EXPECT_EQ(Common::SHA1::Digest({0x84, 0x98, 0x3e, 0x44, 0x1c, 0x3b, 0xd2, 0x6e, 0xba, 0xae,
+                                  0x4a, 0xa1, 0xf9, 0x51, 0x29, 0xe5, 0xe5, 0x46, 0x70, 0xf1}),
+            FromString("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"));
+}
+
+TEST(SHA1, MatchesMbedtls)
+{
+  std::mt19937 rng(1234);
+  std::vector<u8> data(0x10000);
+  for (u8& byte : data)
+    byte = static_cast<u8>(rng());
+
+  for (size_t size = 0; size < 300; ++size)
+  {
+    EXPECT_EQ(CalculateWithMbedtls(data.data(), size),
+              Common::SHA1::CalculateDigest(data.data(), size))
+        << "size " << size;
+  }
+
+  // Updates of arbitrary sizes give the same result as hashing everything at once.
+  std::uniform_int_distribution<size_t> update_size(0, 200);
+  Common::SHA1::Context context;
+  size_t offset = 0;
+  while (offset < data.size())
+  {
+    const size_t size = std::min(update_size(rng), data.size() - offset);
+    context.Update(data.data() + offset, size);
+    offset += size;
+  }
+  EXPECT_EQ(CalculateWithMbedtls(data.data(), data.size()), context.Finish());
+}
@@ -0,0 +1,100 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <map>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/FlatHashMap.h"
+
+TEST(FlatHashMap, Simple)
+{
+  Common::FlatHashMap<u32, int> map;
+
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(nullptr, map.find(5));
+  EXPECT_FALSE(map.erase(5));
+
+  map[5] = 50;
+  map[6] = 60;
+  EXPECT_EQ(2u, map.size());
+  ASSERT_NE(nullptr, map.find(5));
+  EXPECT_EQ(50, *map.find(5));
+  EXPECT_EQ(60, map[6]);
+  EXPECT_EQ(2u, map.size());
+
+  EXPECT_TRUE(map.erase(5));
+  EXPECT_FALSE(map.contains(5));
+  EXPECT_TRUE(map.contains(6));
+  EXPECT_EQ(1u, map.size());
+
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.contains(6));
+}
+
+TEST(FlatHashMap, Iteration)
+{
+  Common::FlatHashMap<u32, u32> map;
+  for (u32 i = 0; i < 1000; ++i)
+    map[i * 32] = i;
+
+  u32 count = 0;
+  u64 sum = 0;
+  for (const auto& entry : map)
+  {
+    EXPECT_EQ(entry.first, entry.second * 32);
+    sum += entry.second;
+    ++count;
+  }
+  EXPECT_EQ(1000u, count);
+  EXPECT_EQ(999u * 1000u / 2, sum);
+}
+
+TEST(FlatHashMap, MatchesStdMap)
+{
+  // Random inserts and erases over a small key range cause lots of collisions, which exercises
+  // the backward-shift deletion.
+  Common::FlatHashMap<u32, u32> map;
+  std::map<u32, u32> reference;
+  std::mt19937 rng(1234);
+
+  for (int i = 0; i < 100000; ++i)
+  {
+    const u32 key = rng() % 2048 * 0x100;
+    if (rng() % 3 == 0)
+    {
+      EXPECT_EQ(reference.erase(key) != 0, map.erase(key));
+    }
+    else
+    {
+      const u32 value = rng();
+      reference[key] = value;
+      map[key] = value;
+    }
+  }
+
+  EXPECT_EQ(reference.size(), map.size());
+  for (const auto& entry : reference)
+  {
+    const u32* value = map.find(entry.first);
+    ASSERT_NE(nullptr, value);
+    EXPECT_EQ(entry.second, *value);
+  }
+}
+
+TEST(FlatHashMap, NonTrivialValues)
+{
+  Common::FlatHashMap<u32, std::vector<int>> map;
+  for (u32 i = 0; i < 100; ++i)
+    map[i % 10].push_back(static_cast<int>(i));
+
+  EXPECT_EQ(10u, map.size());
+  EXPECT_EQ(10u, map[3].size());
+  EXPECT_TRUE(map.erase(3));
+  EXPECT_TRUE(map[3].empty());
+}
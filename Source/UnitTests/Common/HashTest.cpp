@@ -0,0 +1,90 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Hash.h"
+
+namespace
+{
+std::vector<u8> GenerateData(size_t size)
+{
+  std::vector<u8> data(size);
+  std::mt19937 rng(1234);
+  for (u8& byte : data)
+    byte = static_cast<u8>(rng());
+  return data;
+}
+}  // namespace
+
+TEST(Hash, FullHashCoversEveryByte)
+{
+  Common::SetHash64Function();
+
+  std::vector<u8> data = GenerateData(4096 + 3);
+  const u32 size = static_cast<u32>(data.size());
+  const u64 hash = Common::GetHash64(data.data(), size, 0);
+  EXPECT_EQ(hash, Common::GetHash64(data.data(), size, 0));
+
+  for (u8& byte : data)
+  {
+    byte ^= 1;
+    EXPECT_NE(hash, Common::GetHash64(data.data(), size, 0));
+    byte ^= 1;
+  }
+}
+
+TEST(Hash, SampledHash)
+{
+  Common::SetHash64Function();
+
+  const std::vector<u8> data = GenerateData(0x10000);
+  const u32 size = static_cast<u32>(data.size());
+  EXPECT_EQ(Common::GetHash64(data.data(), size, 128), Common::GetHash64(data.data(), size, 128));
+  EXPECT_NE(Common::GetHash64(data.data(), size, 128), Common::GetHash64(data.data(), size, 0));
+
+  // Asking for at least one sample per block is the same as hashing everything.
+  EXPECT_EQ(Common::GetHash64(data.data(), size, 0),
+            Common::GetHash64(data.data(), size, size / 8));
+}
+
+TEST(Hash, DISABLED_Throughput)
+{
+  Common::SetHash64Function();
+
+  // Roughly the size of a 512x512 RGBA8 texture.
+  constexpr u32 SIZE = 1024 * 1024;
+  constexpr int ITERATIONS = 200;
+  const std::vector<u8> data = GenerateData(SIZE);
+
+  const auto measure = [&data](const char* name, auto hash_function) {
+    u64 result = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; ++i)
+      result += hash_function(data.data(), SIZE);
+    const auto end = std::chrono::steady_clock::now();
+
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    std::printf("%-32s %10.1f MiB/s (%016llx)\n", name, ITERATIONS * (SIZE / 1048576.0) / seconds,
+                static_cast<unsigned long long>(result));
+  };
+
+  measure("GetHash64, full (XXH3)",
+          [](const u8* src, u32 len) { return Common::GetHash64(src, len, 0); });
+  // Just below one sample per block, the CRC32/MurmurHash3 functions still hash every block.
+  measure("GetHash64, full (legacy)",
+          [](const u8* src, u32 len) { return Common::GetHash64(src, len, len / 8 - 1); });
+  measure("GetHash64, 512 samples",
+          [](const u8* src, u32 len) { return Common::GetHash64(src, len, 512); });
+  measure("GetHash64, 128 samples",
+          [](const u8* src, u32 len) { return Common::GetHash64(src, len, 128); });
+  measure("HashAdler32", [](const u8* src, u32 len) { return Common::HashAdler32(src, len); });
+  measure("HashFletcher", [](const u8* src, u32 len) { return Common::HashFletcher(src, len); });
+}
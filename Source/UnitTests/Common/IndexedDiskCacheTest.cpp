@@ -0,0 +1,171 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/IndexedDiskCache.h"
+
+namespace
+{
+struct Key
+{
+  u32 id;
+  u32 variant;
+};
+
+Key MakeKey(u32 id)
+{
+  return Key{id, id * 3};
+}
+
+std::vector<u8> MakeValue(u32 id, u32 size)
+{
+  std::vector<u8> value(size);
+  for (u32 i = 0; i < size; i++)
+    value[i] = static_cast<u8>(id + i);
+  return value;
+}
+
+void Append(IndexedDiskCache<Key>& cache, u32 id, const std::vector<u8>& value)
+{
+  cache.Append(MakeKey(id), value.data(), static_cast<u32>(value.size()));
+}
+
+std::optional<std::vector<u8>> Find(const IndexedDiskCache<Key>& cache, u32 id)
+{
+  const auto value = cache.Find(MakeKey(id));
+  if (!value)
+    return std::nullopt;
+  return std::vector<u8>(value->data, value->data + value->size);
+}
+
+class IndexedDiskCacheTest : public testing::Test
+{
+protected:
+  IndexedDiskCacheTest() : m_directory(File::CreateTempDir())
+  {
+    if (!m_directory.empty())
+      m_path = m_directory + "/test.cache";
+  }
+  ~IndexedDiskCacheTest() override
+  {
+    if (!m_directory.empty())
+      File::DeleteDirRecursively(m_directory);
+  }
+
+  std::string m_directory;
+  std::string m_path;
+};
+}  // namespace
+
+TEST_F(IndexedDiskCacheTest, AppendAndReopen)
+{
+  ASSERT_FALSE(m_path.empty());
+
+  IndexedDiskCache<Key> cache;
+  EXPECT_EQ(0u, cache.Open(m_path));
+  for (u32 i = 0; i < 100; i++)
+    Append(cache, i, MakeValue(i, i % 7 * 10));
+  EXPECT_EQ(MakeValue(5, 50), Find(cache, 5));
+  cache.Close();
+
+  // The first reopen moves everything into the index.
+  EXPECT_EQ(100u, cache.Open(m_path));
+  for (u32 i = 0; i < 100; i++)
+    EXPECT_EQ(MakeValue(i, i % 7 * 10), Find(cache, i));
+  EXPECT_FALSE(Find(cache, 100));
+  cache.Close();
+
+  // A few new records stay appended to the end rather than rewriting the file.
+  const u64 indexed_size = File::GetSize(m_path);
+  cache.Open(m_path);
+  Append(cache, 100, MakeValue(100, 16));
+  Append(cache, 1000, MakeValue(1000, 0));
+  cache.Close();
+  EXPECT_EQ(102u, cache.Open(m_path));
+  EXPECT_EQ(MakeValue(100, 16), Find(cache, 100));
+  EXPECT_EQ(std::vector<u8>(), Find(cache, 1000));
+  EXPECT_EQ(MakeValue(99, 99 % 7 * 10), Find(cache, 99));
+  cache.Close();
+  EXPECT_LT(indexed_size, File::GetSize(m_path));
+}
+
+TEST_F(IndexedDiskCacheTest, LatestValueWins)
+{
+  ASSERT_FALSE(m_path.empty());
+
+  IndexedDiskCache<Key> cache;
+  cache.Open(m_path);
+  for (u32 i = 0; i < 20; i++)
+    Append(cache, i, MakeValue(i, 100));
+  cache.Close();
+  cache.Open(m_path);
+  const u64 compacted_size = File::GetSize(m_path);
+
+  // Replace one of the indexed values, then replace the replacement.
+  Append(cache, 3, MakeValue(50, 100));
+  EXPECT_EQ(MakeValue(50, 100), Find(cache, 3));
+  Append(cache, 3, MakeValue(60, 100));
+  EXPECT_EQ(MakeValue(60, 100), Find(cache, 3));
+  EXPECT_EQ(20u, cache.GetEntryCount());
+  cache.Close();
+
+  // The replaced values are dropped when reopening.
+  EXPECT_EQ(20u, cache.Open(m_path));
+  EXPECT_EQ(MakeValue(60, 100), Find(cache, 3));
+  EXPECT_EQ(MakeValue(4, 100), Find(cache, 4));
+  cache.Close();
+  EXPECT_EQ(compacted_size, File::GetSize(m_path));
+}
+
+TEST_F(IndexedDiskCacheTest, DropsTornRecords)
+{
+  ASSERT_FALSE(m_path.empty());
+
+  IndexedDiskCache<Key> cache;
+  cache.Open(m_path);
+  for (u32 i = 0; i < 50; i++)
+    Append(cache, i, MakeValue(i, 40));
+  cache.Close();
+  cache.Open(m_path);
+  Append(cache, 50, MakeValue(50, 40));
+  Append(cache, 51, MakeValue(51, 40));
+  cache.Close();
+
+  // Cut the last record short, as if the process died while writing it.
+  {
+    File::IOFile file(m_path, "r+b");
+    ASSERT_TRUE(file.Resize(file.GetSize() - 3));
+  }
+
+  EXPECT_EQ(51u, cache.Open(m_path));
+  EXPECT_EQ(MakeValue(50, 40), Find(cache, 50));
+  EXPECT_FALSE(Find(cache, 51));
+  Append(cache, 51, MakeValue(52, 40));
+  cache.Close();
+
+  EXPECT_EQ(52u, cache.Open(m_path));
+  EXPECT_EQ(MakeValue(52, 40), Find(cache, 51));
+}
+
+TEST_F(IndexedDiskCacheTest, RecreatesInvalidFile)
+{
+  ASSERT_FALSE(m_path.empty());
+  ASSERT_TRUE(File::WriteStringToFile(m_path, "DCAC and some data which is not a valid header"));
+
+  IndexedDiskCache<Key> cache;
+  EXPECT_EQ(0u, cache.Open(m_path));
+  Append(cache, 1, MakeValue(1, 8));
+  cache.Close();
+
+  EXPECT_EQ(1u, cache.Open(m_path));
+  EXPECT_EQ(MakeValue(1, 8), Find(cache, 1));
+}
@@ -0,0 +1,173 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/RangeIndex.h"
+
+namespace
+{
+struct Range
+{
+  u32 start;
+  u32 size;
+  int id;
+};
+
+std::vector<int> FindOverlapping(const Common::RangeIndex<int>& index, u32 start, u32 size)
+{
+  std::vector<int> result;
+  index.ForEachOverlapping(start, size, [&result](int id) { result.push_back(id); });
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+std::vector<int> FindOverlappingBruteForce(const std::vector<Range>& ranges, u32 start, u32 size)
+{
+  std::vector<int> result;
+  for (const Range& range : ranges)
+  {
+    if (range.start <= start + size && range.start + range.size >= start)
+      result.push_back(range.id);
+  }
+  std::sort(result.begin(), result.end());
+  return result;
+}
+}  // namespace
+
+TEST(RangeIndex, Simple)
+{
+  Common::RangeIndex<int> index;
+  EXPECT_TRUE(index.empty());
+  EXPECT_FALSE(index.Erase(0x1000, 1));
+
+  index.Insert(0x1000, 0x100, 1);
+  index.Insert(0x1100, 0x100, 2);
+  index.Insert(0x80000, 0x40000, 3);
+  EXPECT_EQ(3u, index.size());
+
+  EXPECT_EQ(std::vector<int>({1}), FindOverlapping(index, 0x1000, 0x10));
+  // Touching ranges are reported.
+  EXPECT_EQ(std::vector<int>({1, 2}), FindOverlapping(index, 0x1100, 0x10));
+  EXPECT_EQ(std::vector<int>(), FindOverlapping(index, 0x2000, 0x1000));
+  // Values spanning several regions are only reported once.
+  EXPECT_EQ(std::vector<int>({3}), FindOverlapping(index, 0x70000, 0x100000));
+  EXPECT_EQ(std::vector<int>({3}), FindOverlapping(index, 0xA0000, 0x10));
+
+  EXPECT_FALSE(index.Erase(0x1000, 2));
+  EXPECT_TRUE(index.Erase(0x1000, 1));
+  EXPECT_TRUE(index.Erase(0x80000, 3));
+  EXPECT_EQ(std::vector<int>({2}), FindOverlapping(index, 0, 0xFFFFFFFF));
+  EXPECT_EQ(1u, index.size());
+
+  index.clear();
+  EXPECT_TRUE(index.empty());
+  EXPECT_EQ(std::vector<int>(), FindOverlapping(index, 0, 0xFFFFFFFF));
+}
+
+TEST(RangeIndex, EndOfAddressSpace)
+{
+  Common::RangeIndex<int> index;
+  index.Insert(0xFFFFF000, 0x2000, 1);
+  EXPECT_EQ(std::vector<int>({1}), FindOverlapping(index, 0xFFFFFFF0, 0x100));
+  EXPECT_TRUE(index.Erase(0xFFFFF000, 1));
+  EXPECT_TRUE(index.empty());
+}
+
+TEST(RangeIndex, MatchesBruteForce)
+{
+  Common::RangeIndex<int> index;
+  std::vector<Range> ranges;
+  std::mt19937 rng(1234);
+  int next_id = 0;
+
+  for (int i = 0; i < 20000; ++i)
+  {
+    const u32 start = rng() % 0x1000000 & ~0x1F;
+    const u32 size = rng() % 0x40000;
+    const u32 action = rng() % 4;
+    if (action == 0 && !ranges.empty())
+    {
+      const size_t victim = rng() % ranges.size();
+      EXPECT_TRUE(index.Erase(ranges[victim].start, ranges[victim].id));
+      ranges.erase(ranges.begin() + victim);
+    }
+    else if (action == 1)
+    {
+      ASSERT_EQ(FindOverlappingBruteForce(ranges, start, size),
+                FindOverlapping(index, start, size));
+    }
+    else
+    {
+      index.Insert(start, size, next_id);
+      ranges.push_back({start, size, next_id});
+      ++next_id;
+    }
+  }
+
+  EXPECT_EQ(ranges.size(), index.size());
+}
+
+// Models the overlap queries of the texture cache in an EFB copy heavy game: thousands of small
+// textures and copies, plus a few framebuffer-sized copies. Compares against the previous approach
+// of scanning a start address sorted map from the maximum texture size below the query.
+TEST(RangeIndex, DISABLED_Throughput)
+{
+  constexpr u32 MAX_TEXTURE_SIZE = 1024 * 1024 * 4;
+  constexpr int NUM_ENTRIES = 8000;
+  constexpr int NUM_QUERIES = 20000;
+
+  std::mt19937 rng(1234);
+  std::vector<Range> ranges;
+  for (int i = 0; i < NUM_ENTRIES; ++i)
+  {
+    const u32 size = i % 100 == 0 ? 640 * 528 * 2 : 0x400 << (rng() % 6);
+    ranges.push_back({static_cast<u32>(rng() % 0x1800000 & ~0x1F), size, i});
+  }
+
+  Common::RangeIndex<int> index;
+  std::multimap<u32, const Range*> by_address;
+  for (const Range& range : ranges)
+  {
+    index.Insert(range.start, range.size, range.id);
+    by_address.emplace(range.start, &range);
+  }
+
+  std::vector<std::pair<u32, u32>> queries;
+  for (int i = 0; i < NUM_QUERIES; ++i)
+    queries.emplace_back(rng() % 0x1800000 & ~0x1F, 0x400 << (rng() % 6));
+
+  u64 index_hits = 0;
+  const auto index_start = std::chrono::steady_clock::now();
+  for (const auto& query : queries)
+    index.ForEachOverlapping(query.first, query.second, [&index_hits](int) { ++index_hits; });
+  const auto index_end = std::chrono::steady_clock::now();
+
+  u64 scanned = 0;
+  const auto map_start = std::chrono::steady_clock::now();
+  for (const auto& query : queries)
+  {
+    const u32 lower = query.first > MAX_TEXTURE_SIZE ? query.first - MAX_TEXTURE_SIZE : 0;
+    const auto end = by_address.upper_bound(query.first + query.second);
+    for (auto iter = by_address.lower_bound(lower); iter != end; ++iter)
+      ++scanned;
+  }
+  const auto map_end = std::chrono::steady_clock::now();
+
+  const auto to_ms = [](auto duration) {
+    return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(duration).count();
+  };
+  std::printf("RangeIndex: %.2f ms, %llu hits\n", to_ms(index_end - index_start),
+              static_cast<unsigned long long>(index_hits));
+  std::printf("Sorted map scan: %.2f ms, %llu candidates\n", to_ms(map_end - map_start),
+              static_cast<unsigned long long>(scanned));
+}
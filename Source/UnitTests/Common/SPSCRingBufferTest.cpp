@@ -0,0 +1,90 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/SPSCRingBuffer.h"
+
+TEST(SPSCRingBuffer, Simple)
+{
+  Common::SPSCRingBuffer<u32> ring(5);
+  EXPECT_EQ(8u, ring.Capacity());
+  EXPECT_EQ(0u, ring.Size());
+  EXPECT_EQ(8u, ring.FreeSpace());
+
+  const std::array<u32, 6> values{1, 2, 3, 4, 5, 6};
+  EXPECT_EQ(6u, ring.Push(values.data(), values.size()));
+  EXPECT_EQ(6u, ring.Size());
+
+  // Only as much as fits is pushed.
+  EXPECT_EQ(2u, ring.Push(values.data(), values.size()));
+  EXPECT_EQ(0u, ring.FreeSpace());
+
+  std::array<u32, 8> popped{};
+  EXPECT_EQ(4u, ring.Pop(popped.data(), 4));
+  EXPECT_EQ(1u, popped[0]);
+  EXPECT_EQ(4u, popped[3]);
+
+  // Wrap around the end of the buffer.
+  EXPECT_EQ(4u, ring.Push(values.data(), 4));
+  EXPECT_EQ(8u, ring.Pop(popped.data(), popped.size()));
+  const std::array<u32, 8> expected{5, 6, 1, 2, 1, 2, 3, 4};
+  EXPECT_EQ(expected, popped);
+
+  // Only as much as is available is popped.
+  EXPECT_EQ(0u, ring.Pop(popped.data(), popped.size()));
+
+  ring.Push(values.data(), 3);
+  ring.Clear();
+  EXPECT_EQ(0u, ring.Size());
+}
+
+TEST(SPSCRingBuffer, MultiThreaded)
+{
+  constexpr u32 COUNT = 100000;
+  Common::SPSCRingBuffer<u32> ring(64);
+
+  auto producer = [&ring]() {
+    std::array<u32, 7> block;
+    u32 next = 0;
+    while (next < COUNT)
+    {
+      u32 count = 0;
+      for (; count < block.size() && next + count < COUNT; ++count)
+        block[count] = next + count;
+      size_t pushed = 0;
+      while (pushed < count)
+      {
+        const size_t just_pushed = ring.Push(block.data() + pushed, count - pushed);
+        if (just_pushed == 0)
+          std::this_thread::yield();
+        pushed += just_pushed;
+      }
+      next += count;
+    }
+  };
+
+  auto consumer = [&ring]() {
+    std::array<u32, 5> block;
+    u32 expected = 0;
+    while (expected < COUNT)
+    {
+      const size_t popped = ring.Pop(block.data(), block.size());
+      if (popped == 0)
+        std::this_thread::yield();
+      for (size_t i = 0; i < popped; ++i)
+        EXPECT_EQ(expected++, block[i]);
+    }
+  };
+
+  std::thread consumer_thread(consumer);
+  std::thread producer_thread(producer);
+
+  consumer_thread.join();
+  producer_thread.join();
+}
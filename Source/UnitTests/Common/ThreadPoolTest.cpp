@@ -0,0 +1,40 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/ThreadPool.h"
+
+TEST(ThreadPool, RunsEveryIterationOnce)
+{
+  Common::ThreadPool pool("ThreadPoolTest", 4);
+  EXPECT_EQ(5u, pool.GetThreadCount());
+
+  for (size_t count : {0, 1, 2, 7, 1000})
+  {
+    std::vector<std::atomic<int>> calls(count);
+    pool.ParallelFor(count, [&](size_t i) { calls[i]++; });
+
+    for (size_t i = 0; i < count; ++i)
+      EXPECT_EQ(1, calls[i].load());
+  }
+}
+
+TEST(ThreadPool, RepeatedLoops)
+{
+  Common::ThreadPool pool("ThreadPoolTest", 3);
+
+  std::vector<u64> values(64);
+  for (u64 round = 0; round < 500; ++round)
+  {
+    pool.ParallelFor(values.size(), [&](size_t i) { values[i] += i + round; });
+  }
+
+  for (size_t i = 0; i < values.size(); ++i)
+    EXPECT_EQ(500 * i + 499 * 500 / 2, values[i]);
+}
@@ -6,6 +6,8 @@
 
 #include <array>
 #include <bitset>
+#include <chrono>
+#include <random>
 #include <string>
 
 #include "Common/Config/Config.h"
@@ -347,3 +349,104 @@ TEST(CoreTiming, Overclocking)
   SConfig::GetInstance().m_OCFactor = 1.0;
   AdvanceAndCheck(4, MAX_SLICE_LENGTH);
 }
+
+namespace ChurnTest
+{
+constexpr u32 NUM_TYPES = 64;
+
+static std::array<u32, NUM_TYPES> s_pending;
+static std::array<u64, NUM_TYPES> s_removed_before;
+static s64 s_last_time;
+static u64 s_last_sequence;
+static u64 s_ran;
+
+// userdata is the order the event was scheduled in, followed by the index of its type.
+static void ChurnCallback(u64 userdata, s64 lateness)
+{
+  const u64 sequence = userdata / NUM_TYPES;
+  const u32 type_index = static_cast<u32>(userdata % NUM_TYPES);
+  const s64 time = CoreTiming::g.global_timer - lateness;
+
+  EXPECT_GE(lateness, 0);
+  EXPECT_GE(sequence, s_removed_before[type_index]);
+  EXPECT_TRUE(time > s_last_time || (time == s_last_time && sequence > s_last_sequence));
+  s_last_time = time;
+  s_last_sequence = sequence;
+
+  --s_pending[type_index];
+  ++s_ran;
+}
+}  // namespace ChurnTest
+
+// A benchmark which schedules and removes lots of events, like games which do a lot of IO do.
+TEST(CoreTiming, ScheduleAndRemoveChurn)
+{
+  using namespace ChurnTest;
+
+  ScopeInit guard;
+
+  std::array<CoreTiming::EventType*, NUM_TYPES> types;
+  for (u32 i = 0; i < NUM_TYPES; ++i)
+    types[i] = CoreTiming::RegisterEvent("churn" + std::to_string(i), ChurnCallback);
+
+  s_pending = {};
+  s_removed_before = {};
+  s_last_time = -1;
+  s_last_sequence = 0;
+  s_ran = 0;
+
+  // Enter slice 0
+  CoreTiming::Advance();
+
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<u32> type_dist(0, NUM_TYPES - 1);
+  std::uniform_int_distribution<s64> delay_dist(0, 50000);
+  u64 sequence = 0;
+  u64 scheduled = 0;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < 200; ++frame)
+  {
+    for (int i = 0; i < 2000; ++i)
+    {
+      const u32 type_index = type_dist(rng);
+      // Many events share a time, which has to be broken by the order they were scheduled in.
+      const s64 delay = i % 4 == 0 ? 1000 : delay_dist(rng);
+      CoreTiming::ScheduleEvent(delay, types[type_index], sequence++ * NUM_TYPES + type_index);
+      ++s_pending[type_index];
+      ++scheduled;
+    }
+
+    for (int i = 0; i < 16; ++i)
+    {
+      const u32 type_index = type_dist(rng);
+      CoreTiming::RemoveEvent(types[type_index]);
+      scheduled -= s_pending[type_index];
+      s_pending[type_index] = 0;
+      s_removed_before[type_index] = sequence;
+    }
+
+    const s64 frame_end = CoreTiming::g.global_timer + 25000;
+    while (CoreTiming::g.global_timer < frame_end)
+    {
+      PowerPC::ppcState.downcount = 0;
+      CoreTiming::Advance();
+    }
+  }
+
+  // Run everything which is still pending.
+  const s64 end = CoreTiming::g.global_timer + delay_dist.max();
+  while (CoreTiming::g.global_timer <= end)
+  {
+    PowerPC::ppcState.downcount = 0;
+    CoreTiming::Advance();
+  }
+  const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+
+  EXPECT_EQ(scheduled, s_ran);
+  for (u32 pending : s_pending)
+    EXPECT_EQ(0u, pending);
+
+  RecordProperty("elapsed_us", static_cast<int>(elapsed.count()));
+}
@@ -0,0 +1,192 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/HW/DSPHLE/UCodes/AXMix.h"
+
+namespace
+{
+constexpr size_t NUM_BUSES = 9;
+constexpr u32 SAMPLES_PER_FRAME = 96;
+constexpr size_t BENCHMARK_VOICES = 64;
+constexpr int BENCHMARK_FRAMES = 2000;
+
+// The mixing loop the kernels replace, one bus at a time.
+void ReferenceMixAdd(int* out, const s16* input, u32 count, u16* pvol, s16* dpop, bool ramp)
+{
+  u16& volume = pvol[0];
+  u16 volume_delta = pvol[1];
+
+  if (!ramp)
+    volume_delta = 0;
+
+  for (u32 i = 0; i < count; ++i)
+  {
+    s64 sample = input[i];
+    sample *= volume;
+    sample >>= 15;
+    sample = std::clamp((s32)sample, -32767, 32767);
+
+    out[i] += (s16)sample;
+    volume += volume_delta;
+
+    *dpop = (s16)sample;
+  }
+}
+
+struct Voice
+{
+  std::vector<s16> samples;
+  std::array<u16, NUM_BUSES * 2> volumes;
+  std::array<s16, NUM_BUSES> dpop;
+  std::array<bool, NUM_BUSES> enabled;
+  std::array<bool, NUM_BUSES> ramp;
+};
+
+using Buffers = std::array<std::vector<int>, NUM_BUSES>;
+
+Voice MakeVoice(std::mt19937& rng, u32 count)
+{
+  // Favour the extremes, which is where clamping and wrapping happen.
+  const auto random_u16 = [&rng] {
+    const u32 kind = rng() % 4;
+    if (kind == 0)
+      return static_cast<u16>(0xFFFF - rng() % 4);
+    if (kind == 1)
+      return static_cast<u16>(rng() % 4);
+    return static_cast<u16>(rng());
+  };
+
+  Voice voice;
+  voice.samples.resize(count);
+  for (s16& sample : voice.samples)
+    sample = static_cast<s16>(random_u16());
+  for (u16& volume : voice.volumes)
+    volume = random_u16();
+  voice.dpop.fill(0);
+  for (size_t i = 0; i < NUM_BUSES; ++i)
+  {
+    voice.enabled[i] = rng() % 4 != 0;
+    voice.ramp[i] = rng() % 2 != 0;
+  }
+  return voice;
+}
+
+void MixReference(Voice& voice, Buffers& buffers)
+{
+  for (size_t i = 0; i < NUM_BUSES; ++i)
+  {
+    if (voice.enabled[i])
+    {
+      ReferenceMixAdd(buffers[i].data(), voice.samples.data(),
+                      static_cast<u32>(voice.samples.size()), &voice.volumes[i * 2],
+                      &voice.dpop[i], voice.ramp[i]);
+    }
+  }
+}
+
+void Mix(Voice& voice, Buffers& buffers)
+{
+  std::array<DSP::HLE::AXMixBus, NUM_BUSES> buses;
+  size_t num_buses = 0;
+  for (size_t i = 0; i < NUM_BUSES; ++i)
+  {
+    if (voice.enabled[i])
+    {
+      buses[num_buses++] = {buffers[i].data(), &voice.volumes[i * 2], &voice.dpop[i],
+                            voice.ramp[i]};
+    }
+  }
+  DSP::HLE::MixAdd(voice.samples.data(), static_cast<u32>(voice.samples.size()), buses.data(),
+                   num_buses);
+}
+
+Buffers MakeBuffers(u32 count)
+{
+  Buffers buffers;
+  for (std::vector<int>& buffer : buffers)
+    buffer.assign(count, 0x1234);
+  return buffers;
+}
+
+void ClearBuffers(Buffers& buffers)
+{
+  for (std::vector<int>& buffer : buffers)
+    std::fill(buffer.begin(), buffer.end(), 0);
+}
+}  // namespace
+
+TEST(AXMix, MatchesReference)
+{
+  std::mt19937 rng(0);
+
+  // AX GC and AX Wii frames, Wii Remote frames, and lengths that do not fill whole vectors.
+  for (u32 count : {0u, 1u, 3u, 6u, 7u, 18u, 32u, 33u, 96u})
+  {
+    for (int i = 0; i < 200; ++i)
+    {
+      Voice expected = MakeVoice(rng, count);
+      Voice voice = expected;
+
+      Buffers expected_buffers = MakeBuffers(count);
+      Buffers buffers = expected_buffers;
+
+      MixReference(expected, expected_buffers);
+      Mix(voice, buffers);
+
+      ASSERT_TRUE(expected_buffers == buffers) << "count " << count;
+      ASSERT_TRUE(expected.volumes == voice.volumes) << "count " << count;
+      ASSERT_TRUE(expected.dpop == voice.dpop) << "count " << count;
+    }
+  }
+}
+
+TEST(AXMix, Benchmark)
+{
+  std::mt19937 rng(1);
+  std::vector<Voice> voices;
+  for (size_t i = 0; i < BENCHMARK_VOICES; ++i)
+  {
+    voices.push_back(MakeVoice(rng, SAMPLES_PER_FRAME));
+    voices.back().enabled.fill(true);
+  }
+
+  std::vector<Voice> expected_voices = voices;
+  Buffers expected_buffers = MakeBuffers(SAMPLES_PER_FRAME);
+  Buffers buffers = expected_buffers;
+
+  const auto reference_start = std::chrono::steady_clock::now();
+  for (int frame = 0; frame < BENCHMARK_FRAMES; ++frame)
+  {
+    ClearBuffers(expected_buffers);
+    for (Voice& voice : expected_voices)
+      MixReference(voice, expected_buffers);
+  }
+  const auto reference_end = std::chrono::steady_clock::now();
+
+  for (int frame = 0; frame < BENCHMARK_FRAMES; ++frame)
+  {
+    ClearBuffers(buffers);
+    for (Voice& voice : voices)
+      Mix(voice, buffers);
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  EXPECT_TRUE(expected_buffers == buffers);
+
+  const auto to_ms = [](auto duration) {
+    return std::to_string(std::chrono::duration<double, std::milli>(duration).count());
+  };
+  RecordProperty("reference_ms", to_ms(reference_end - reference_start));
+  RecordProperty("mix_ms", to_ms(end - reference_end));
+}
@@ -186,3 +186,83 @@ TEST(DSPAccelerator, CurrentAddressSkips)
   accelerator.TestRead();
   EXPECT_EQ(accelerator.GetCurrentAddress(), 0x00000013u);
 }
+
+// An accelerator over a block of random ADPCM data.
+class ADPCMTestAccelerator : public DSP::Accelerator
+{
+public:
+  explicit ADPCMTestAccelerator(u32 seed)
+  {
+    u32 value = seed;
+    for (u8& byte : m_memory)
+    {
+      value = value * 1103515245 + 12345;
+      byte = static_cast<u8>(value >> 16);
+    }
+  }
+
+  u32 GetEndExceptionCount() const { return m_end_exceptions; }
+
+protected:
+  // Loop like the AX ucodes do.
+  void OnEndException() override
+  {
+    m_end_exceptions++;
+    SetYn2(GetYn2());
+  }
+  u8 ReadMemory(u32 address) override { return m_memory[address % m_memory.size()]; }
+  void WriteMemory(u32 address, u8 value) override {}
+
+private:
+  std::array<u8, 0x100> m_memory;
+  u32 m_end_exceptions = 0;
+};
+
+TEST(DSPAccelerator, ReadSamplesMatchesRead)
+{
+  std::array<s16, 16> coefs;
+  for (size_t i = 0; i < coefs.size(); ++i)
+    coefs[i] = static_cast<s16>(0x0800 - 0x0123 * static_cast<int>(i));
+
+  // End addresses around the special cases for 16-byte aligned and XXXXXXX1 addresses.
+  for (u32 end_address : {0x40u, 0x41u, 0x42u, 0x4fu, 0x53u, 0x5eu})
+  {
+    ADPCMTestAccelerator expected(end_address);
+    ADPCMTestAccelerator accelerator(end_address);
+    for (DSP::Accelerator* a : {static_cast<DSP::Accelerator*>(&expected),
+                                static_cast<DSP::Accelerator*>(&accelerator)})
+    {
+      a->SetSampleFormat(0x00);
+      a->SetStartAddress(0x02);
+      a->SetEndAddress(end_address);
+      a->SetCurrentAddress(0x05);
+      a->SetPredScale(0x23);
+      a->SetYn1(0x1234);
+      a->SetYn2(-0x0567);
+    }
+
+    // Read in uneven batches to start runs at every position in a frame.
+    for (u32 count = 1; count < 40; ++count)
+    {
+      std::array<s16, 40> expected_samples;
+      for (u32 i = 0; i < count; ++i)
+        expected_samples[i] = static_cast<s16>(expected.Read(coefs.data()));
+
+      std::array<s16, 40> samples;
+      accelerator.ReadSamples(coefs.data(), samples.data(), count);
+
+      for (u32 i = 0; i < count; ++i)
+        ASSERT_EQ(expected_samples[i], samples[i]) << "end " << end_address << " count " << count;
+      ASSERT_EQ(expected.GetCurrentAddress(), accelerator.GetCurrentAddress());
+      ASSERT_EQ(expected.GetYn1(), accelerator.GetYn1());
+      ASSERT_EQ(expected.GetYn2(), accelerator.GetYn2());
+      ASSERT_EQ(expected.GetPredScale(), accelerator.GetPredScale());
+    }
+    // The special cases loop without raising the exception.
+    if ((end_address & 0xf) > 1)
+    {
+      EXPECT_NE(0u, accelerator.GetEndExceptionCount());
+    }
+    EXPECT_EQ(expected.GetEndExceptionCount(), accelerator.GetEndExceptionCount());
+  }
+}
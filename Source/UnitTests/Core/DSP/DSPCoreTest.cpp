@@ -0,0 +1,179 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Common/MemoryUtil.h"
+#include "Common/MsgHandler.h"
+#include "Core/ConfigLoaders/BaseConfigLoader.h"
+#include "Core/ConfigManager.h"
+#include "Core/CoreTiming.h"
+#include "Core/DSP/DSPAnalyzer.h"
+#include "Core/DSP/DSPCore.h"
+#include "Core/DSP/DSPHWInterface.h"
+#include "Core/DSP/DSPTables.h"
+#include "Core/DSP/Interpreter/DSPInterpreter.h"
+#include "Core/DSP/Jit/DSPEmitterBase.h"
+#include "Core/HW/DSP.h"
+#include "UICommon/UICommon.h"
+
+#include "DSPTestBinary.h"
+#include "HermesBinary.h"
+
+namespace
+{
+constexpr u16 ENTRY_POINT = 0x0010;
+constexpr int CYCLES_PER_SLICE = 1000;
+constexpr int SLICES = 2000;
+constexpr int MAX_SETTLE_STEPS = 1000;
+constexpr size_t MAX_MAILS = 100;
+constexpr size_t CPU_RAM_SIZE = 0x100000;
+
+// The x64 recompiler skips updating the flags the analyzer considers dead, so only the control
+// bits of $sr can be compared.
+constexpr u16 SR_COMPARE_MASK = 0xff00;
+
+struct Result
+{
+  std::array<u16, 32> regs;
+  u16 pc;
+  std::vector<u16> dram;
+  std::vector<u32> mails;
+  double elapsed_ms;
+};
+
+// The tests run without DSP ROMs, so let DSPCore_Init go on when asked about their hashes.
+bool MsgAlertHandler(const char*, const char*, bool, Common::MsgType style)
+{
+  return style != Common::MsgType::Question;
+}
+
+Result RunUCode(const std::vector<u16>& code, DSP::DSPInitOptions::CoreType core_type)
+{
+  const std::string profile_path = File::CreateTempDir();
+  UICommon::SetUserDirectory(profile_path);
+  Config::Init();
+  Config::AddLayer(ConfigLoaders::GenerateBaseConfigLoader());
+  SConfig::Init();
+  SConfig::GetInstance().bDSPThread = false;
+  CoreTiming::Init();
+  DSP::Init(true);
+  Common::RegisterMsgAlertHandler(MsgAlertHandler);
+
+  DSP::InitInstructionTable();
+  DSP::DSPInitOptions opts;
+  opts.irom_contents.fill(0);
+  opts.coef_contents.fill(0);
+  opts.core_type = core_type;
+  EXPECT_TRUE(DSP::DSPCore_Init(opts));
+
+  std::vector<u8> cpu_ram(CPU_RAM_SIZE);
+  DSP::g_dsp.cpu_ram = cpu_ram.data();
+
+  // Load the ucode the way the DMA from the CPU does, and start it where the ROM would.
+  Common::UnWriteProtectMemory(DSP::g_dsp.iram, DSP::DSP_IRAM_BYTE_SIZE, false);
+  std::copy(code.begin(), code.end(), DSP::g_dsp.iram);
+  Common::WriteProtectMemory(DSP::g_dsp.iram, DSP::DSP_IRAM_BYTE_SIZE, false);
+  if (DSP::g_dsp_jit)
+    DSP::g_dsp_jit->ClearIRAM();
+  DSP::Analyzer::Analyze();
+  DSP::g_dsp.pc = ENTRY_POINT;
+  DSP::g_dsp.cr &= ~DSP::CR_HALT;
+
+  Result result;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < SLICES && result.mails.size() < MAX_MAILS; i++)
+  {
+    DSP::DSPCore_RunCycles(CYCLES_PER_SLICE);
+
+    // Stand in for the CPU: read the mails the ucode sends, and give it a reply pointing at the
+    // start of RAM when it wants one. This is only done while the ucode waits in an idle loop, so
+    // that it does not depend on where each core ends its slices.
+    if (!(DSP::Analyzer::GetCodeFlags(DSP::g_dsp.pc) & DSP::Analyzer::CODE_IDLE_SKIP))
+      continue;
+
+    if (DSP::gdsp_mbox_peek(DSP::MAILBOX_DSP) & 0x80000000)
+    {
+      result.mails.push_back(DSP::gdsp_mbox_peek(DSP::MAILBOX_DSP));
+      DSP::gdsp_mbox_read_l(DSP::MAILBOX_DSP);
+    }
+    if (!(DSP::gdsp_mbox_peek(DSP::MAILBOX_CPU) & 0x80000000))
+    {
+      DSP::gdsp_mbox_write_h(DSP::MAILBOX_CPU, 0x8000);
+      DSP::gdsp_mbox_write_l(DSP::MAILBOX_CPU, 0x0000);
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  // The recompiler only stops between blocks, so step to the start of the loop the ucode waits in
+  // to compare both cores at the same place.
+  for (int i = 0; i < MAX_SETTLE_STEPS; i++)
+  {
+    if (DSP::g_dsp.cr & DSP::CR_HALT)
+      break;
+    if (DSP::Analyzer::GetCodeFlags(DSP::g_dsp.pc) & DSP::Analyzer::CODE_IDLE_SKIP)
+      break;
+    DSP::Interpreter::Step();
+  }
+
+  for (size_t i = 0; i < result.regs.size(); i++)
+    result.regs[i] = DSP::DSPCore_ReadRegister(i);
+  result.pc = DSP::g_dsp.pc;
+  result.dram.assign(DSP::g_dsp.dram, DSP::g_dsp.dram + DSP::DSP_DRAM_SIZE);
+  result.elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+  DSP::g_dsp.cpu_ram = nullptr;
+  DSP::DSPCore_Shutdown();
+  DSP::Shutdown();
+  CoreTiming::Shutdown();
+  SConfig::Shutdown();
+  Config::Shutdown();
+  File::DeleteDirRecursively(profile_path);
+  return result;
+}
+
+void ExpectSameState(const Result& expected, const Result& result)
+{
+  EXPECT_EQ(expected.pc, result.pc);
+  for (size_t i = 0; i < expected.regs.size(); i++)
+  {
+    const u16 mask = i == DSP::DSP_REG_SR ? SR_COMPARE_MASK : 0xffff;
+    EXPECT_EQ(expected.regs[i] & mask, result.regs[i] & mask) << "register " << i;
+  }
+  EXPECT_TRUE(expected.mails == result.mails);
+  EXPECT_TRUE(expected.dram == result.dram);
+}
+
+void TestUCode(const std::vector<u16>& code)
+{
+  const Result expected = RunUCode(code, DSP::DSPInitOptions::CoreType::Interpreter);
+  EXPECT_FALSE(expected.mails.empty());
+  ::testing::Test::RecordProperty("interpreter_ms", std::to_string(expected.elapsed_ms));
+
+#ifdef _M_X86
+  const Result result = RunUCode(code, DSP::DSPInitOptions::CoreType::JIT);
+  ExpectSameState(expected, result);
+  ::testing::Test::RecordProperty("jit_ms", std::to_string(result.elapsed_ms));
+#endif
+}
+}  // namespace
+
+TEST(DSPCore, DSPTestBinary)
+{
+  TestUCode(s_dsp_test_bin);
+}
+
+TEST(DSPCore, HermesBinary)
+{
+  TestUCode(s_hermes_bin);
+}
@@ -0,0 +1,150 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "Common/MsgHandler.h"
+#include "Core/FifoPlayer/FifoDataFile.h"
+
+namespace
+{
+class ScopeInit final
+{
+public:
+  ScopeInit() : m_path(File::CreateTempDir())
+  {
+    Config::Init();
+    Config::AddLayer(std::make_unique<Config::Layer>(Config::LayerType::Base));
+    Common::SetEnableAlert(false);
+  }
+  ~ScopeInit()
+  {
+    Common::SetEnableAlert(true);
+    Config::Shutdown();
+    File::DeleteDirRecursively(m_path);
+  }
+
+  std::string GetPath(const std::string& name) const { return m_path + DIR_SEP + name; }
+
+private:
+  std::string m_path;
+};
+
+std::unique_ptr<FifoDataFile> CreateTestFile()
+{
+  auto file = std::make_unique<FifoDataFile>();
+  file->SetIsWii(true);
+  for (u32 i = 0; i < 8; ++i)
+  {
+    FifoFrameInfo frame;
+    frame.fifoData = std::vector<u8>(100 + i * 17, static_cast<u8>(i));
+    frame.fifoStart = 0x1000 * i;
+    frame.fifoEnd = 0x1000 * i + 0x800;
+    for (u32 j = 0; j < i % 3; ++j)
+    {
+      MemoryUpdate update;
+      update.fifoPosition = j * 4;
+      update.address = 0x80000000 + j * 0x100;
+      update.data = std::vector<u8>(32 * j + 1, static_cast<u8>(i + j));
+      update.type = MemoryUpdate::TEXTURE_MAP;
+      frame.memoryUpdates.push_back(update);
+    }
+    file->AddFrame(frame);
+  }
+  return file;
+}
+
+void ExpectSameData(const FifoData& expected, const FifoData& actual)
+{
+  EXPECT_EQ(std::vector<u8>(expected.begin(), expected.end()),
+            std::vector<u8>(actual.begin(), actual.end()));
+}
+
+void ExpectSameFrames(const FifoDataFile& expected, const FifoDataFile& actual)
+{
+  ASSERT_EQ(expected.GetFrameCount(), actual.GetFrameCount());
+  for (u32 i = 0; i < expected.GetFrameCount(); ++i)
+  {
+    const FifoFrameInfo& expected_frame = expected.GetFrame(i);
+    const FifoFrameInfo& actual_frame = actual.GetFrame(i);
+    ExpectSameData(expected_frame.fifoData, actual_frame.fifoData);
+    EXPECT_EQ(expected_frame.fifoStart, actual_frame.fifoStart);
+    EXPECT_EQ(expected_frame.fifoEnd, actual_frame.fifoEnd);
+
+    ASSERT_EQ(expected_frame.memoryUpdates.size(), actual_frame.memoryUpdates.size());
+    for (size_t j = 0; j < expected_frame.memoryUpdates.size(); ++j)
+    {
+      const MemoryUpdate& expected_update = expected_frame.memoryUpdates[j];
+      const MemoryUpdate& actual_update = actual_frame.memoryUpdates[j];
+      EXPECT_EQ(expected_update.fifoPosition, actual_update.fifoPosition);
+      EXPECT_EQ(expected_update.address, actual_update.address);
+      EXPECT_EQ(expected_update.type, actual_update.type);
+      ExpectSameData(expected_update.data, actual_update.data);
+    }
+  }
+}
+}  // namespace
+
+TEST(FifoDataFile, SaveAndLoad)
+{
+  ScopeInit guard;
+  std::unique_ptr<FifoDataFile> file = CreateTestFile();
+  const std::string path = guard.GetPath("test.dff");
+  ASSERT_TRUE(file->Save(path));
+
+  std::unique_ptr<FifoDataFile> loaded = FifoDataFile::Load(path, false);
+  ASSERT_TRUE(loaded);
+  EXPECT_TRUE(loaded->GetIsWii());
+  ExpectSameFrames(*file, *loaded);
+}
+
+TEST(FifoDataFile, SaveAndLoadCompressed)
+{
+  ScopeInit guard;
+  std::unique_ptr<FifoDataFile> file = CreateTestFile();
+  const std::string path = guard.GetPath("compressed.dff");
+  ASSERT_TRUE(file->Save(path, true));
+
+  std::unique_ptr<FifoDataFile> loaded = FifoDataFile::Load(path, false);
+  ASSERT_TRUE(loaded);
+  EXPECT_TRUE(loaded->GetIsWii());
+
+  // Frames can be loaded out of order.
+  ExpectSameData(file->GetFrame(5).fifoData, loaded->GetFrame(5).fifoData);
+  ExpectSameFrames(*file, *loaded);
+
+  // Saving a loaded compressed file without compression gives the same file as saving the
+  // original uncompressed.
+  const std::string uncompressed_path = guard.GetPath("uncompressed.dff");
+  const std::string resaved_path = guard.GetPath("resaved.dff");
+  ASSERT_TRUE(file->Save(uncompressed_path));
+  ASSERT_TRUE(loaded->Save(resaved_path));
+  std::string uncompressed, resaved;
+  ASSERT_TRUE(File::ReadFileToString(uncompressed_path, uncompressed));
+  ASSERT_TRUE(File::ReadFileToString(resaved_path, resaved));
+  EXPECT_EQ(uncompressed, resaved);
+}
+
+TEST(FifoDataFile, TruncatedFileFailsToLoad)
+{
+  ScopeInit guard;
+  const std::string path = guard.GetPath("test.dff");
+  ASSERT_TRUE(CreateTestFile()->Save(path));
+
+  std::string data;
+  ASSERT_TRUE(File::ReadFileToString(path, data));
+  data.resize(data.size() - 1);
+  ASSERT_TRUE(File::WriteStringToFile(path, data));
+
+  EXPECT_FALSE(FifoDataFile::Load(path, false));
+}
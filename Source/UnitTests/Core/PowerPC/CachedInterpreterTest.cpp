@@ -0,0 +1,188 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigLoaders/BaseConfigLoader.h"
+#include "Core/ConfigManager.h"
+#include "Core/Core.h"
+#include "Core/CoreTiming.h"
+#include "Core/HW/CPU.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/PowerPC.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+constexpr u32 CODE_ADDRESS = 0x3000;
+constexpr u32 TABLE_ADDRESS = 0x10000;
+constexpr u32 ITERATIONS = 0x40000;
+constexpr int CHECK_INTERVAL = 100000;
+
+constexpr u32 DForm(u32 opcode, u32 d, u32 a, u32 immediate)
+{
+  return opcode << 26 | d << 21 | a << 16 | (immediate & 0xFFFF);
+}
+
+constexpr u32 XForm(u32 d, u32 a, u32 b, u32 subop)
+{
+  return 31 << 26 | d << 21 | a << 16 | b << 11 | subop << 1;
+}
+
+constexpr u32 Rlwinm(u32 a, u32 s, u32 sh, u32 mb, u32 me)
+{
+  return 21 << 26 | s << 21 | a << 16 | sh << 11 | mb << 6 | me << 1;
+}
+
+// A loop over a table of words made of the instruction sequences games spend most of their time
+// in: loads, compares followed by branches, rotates and integer arithmetic. It ends at a branch to
+// itself.
+std::vector<u32> MakeProgram()
+{
+  std::vector<u32> code;
+  code.push_back(DForm(15, 3, 0, TABLE_ADDRESS >> 16));  // lis r3, table
+  code.push_back(DForm(14, 4, 0, 0));                    // li r4, 0
+  code.push_back(DForm(14, 5, 0, 0));                    // li r5, 0
+  code.push_back(DForm(15, 6, 0, ITERATIONS >> 16));     // lis r6, iterations
+
+  const u32 loop = static_cast<u32>(code.size());
+  code.push_back(Rlwinm(7, 4, 2, 22, 29));  // rlwinm r7, r4, 2, 22, 29
+  code.push_back(XForm(8, 3, 7, 266));      // add r8, r3, r7
+  code.push_back(DForm(32, 9, 8, 0));       // lwz r9, 0(r8)
+  code.push_back(Rlwinm(10, 9, 8, 24, 31));   // rlwinm r10, r9, 8, 24, 31
+  code.push_back(Rlwinm(11, 9, 16, 16, 31));  // rlwinm r11, r9, 16, 16, 31
+  code.push_back(Rlwinm(11, 11, 3, 0, 28));   // rlwinm r11, r11, 3, 0, 28
+  code.push_back(XForm(5, 5, 10, 266));       // add r5, r5, r10
+  code.push_back(XForm(5, 5, 11, 316));       // xor r5, r5, r11
+  code.push_back(DForm(34, 12, 8, 1));        // lbz r12, 1(r8)
+  code.push_back(DForm(10, 0, 12, 0x80));     // cmplwi r12, 0x80
+  code.push_back(16 << 26 | 12 << 21 | 0 << 16 | 8);  // blt +8
+  code.push_back(DForm(14, 5, 5, 1));                  // addi r5, r5, 1
+  code.push_back(DForm(40, 13, 8, 2));                 // lhz r13, 2(r8)
+  code.push_back(DForm(11, 1 << 2, 13, 0x4000));       // cmpwi cr1, r13, 0x4000
+  code.push_back(XForm(14, 0, 0, 19));                 // mfcr r14
+  code.push_back(XForm(5, 5, 14, 266));                // add r5, r5, r14
+  code.push_back(DForm(11, 0, 9, static_cast<u32>(-1)));  // cmpwi r9, -1
+  code.push_back(16 << 26 | 4 << 21 | 1 << 16 | 8);       // ble +8
+  code.push_back(DForm(14, 15, 15, 1));                   // addi r15, r15, 1
+  code.push_back(DForm(14, 4, 4, 1));                     // addi r4, r4, 1
+  code.push_back(XForm(0, 4, 6, 0));                      // cmpw r4, r6
+  const u32 back = (loop - static_cast<u32>(code.size())) * 4;
+  code.push_back(16 << 26 | 12 << 21 | 0 << 16 | (back & 0xFFFC));  // blt loop
+
+  code.push_back(18 << 26);  // b .
+  return code;
+}
+
+u32 GetEndAddress()
+{
+  return CODE_ADDRESS + static_cast<u32>(MakeProgram().size() - 1) * 4;
+}
+
+struct Result
+{
+  std::array<u32, 32> gpr;
+  u32 cr;
+  u32 pc;
+  double elapsed_ms;
+};
+
+CoreTiming::EventType* s_check_end_event;
+
+void CheckEnd(u64 userdata, s64 cycles_late)
+{
+  if (PC == GetEndAddress())
+    CPU::Break();
+  else
+    CoreTiming::ScheduleEvent(CHECK_INTERVAL, s_check_end_event);
+}
+
+Result RunProgram(PowerPC::CPUCore core, bool block_linking, bool mmu)
+{
+  const std::string profile_path = File::CreateTempDir();
+  Core::DeclareAsCPUThread();
+  UICommon::SetUserDirectory(profile_path);
+  Config::Init();
+  Config::AddLayer(ConfigLoaders::GenerateBaseConfigLoader());
+  SConfig::Init();
+  SConfig::GetInstance().bJITNoBlockLinking = !block_linking;
+  SConfig::GetInstance().bMMU = mmu;
+  Memory::Init();
+  CPU::Init(core);
+  CoreTiming::Init();
+
+  const std::vector<u32> program = MakeProgram();
+  for (u32 i = 0; i < program.size(); i++)
+    Memory::Write_U32(program[i], CODE_ADDRESS + i * 4);
+
+  u32 value = 0x12345678;
+  for (u32 i = 0; i < 0x100; i++)
+  {
+    value = value * 1103515245 + 12345;
+    Memory::Write_U32(value, TABLE_ADDRESS + i * 4);
+  }
+
+  PC = CODE_ADDRESS;
+  s_check_end_event = CoreTiming::RegisterEvent("CheckEnd", CheckEnd);
+  CoreTiming::ScheduleEvent(CHECK_INTERVAL, s_check_end_event);
+
+  const auto start = std::chrono::steady_clock::now();
+  CPU::EnableStepping(false);
+  PowerPC::RunLoop();
+  const auto end = std::chrono::steady_clock::now();
+
+  Result result;
+  std::copy(std::begin(rGPR), std::end(rGPR), result.gpr.begin());
+  result.cr = PowerPC::ppcState.cr.Get();
+  result.pc = PC;
+  result.elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+  CoreTiming::Shutdown();
+  CPU::Shutdown();
+  Memory::Shutdown();
+  SConfig::Shutdown();
+  Config::Shutdown();
+  Core::UndeclareAsCPUThread();
+  File::DeleteDirRecursively(profile_path);
+  return result;
+}
+}  // namespace
+
+TEST(CachedInterpreter, MatchesInterpreter)
+{
+  const Result expected = RunProgram(PowerPC::CPUCore::Interpreter, false, false);
+  ASSERT_EQ(GetEndAddress(), expected.pc);
+  EXPECT_EQ(ITERATIONS, expected.gpr[4]);
+  RecordProperty("interpreter_ms", std::to_string(expected.elapsed_ms));
+
+  struct Variant
+  {
+    const char* name;
+    bool block_linking;
+    bool mmu;
+  };
+  constexpr Variant variants[] = {{"cached_interpreter_ms", false, false},
+                                  {"cached_interpreter_linked_ms", true, false},
+                                  {"cached_interpreter_mmu_ms", true, true}};
+
+  for (const Variant& variant : variants)
+  {
+    const Result result =
+        RunProgram(PowerPC::CPUCore::CachedInterpreter, variant.block_linking, variant.mmu);
+    EXPECT_EQ(expected.pc, result.pc) << variant.name;
+    EXPECT_EQ(expected.cr, result.cr) << variant.name;
+    for (size_t i = 0; i < expected.gpr.size(); i++)
+      EXPECT_EQ(expected.gpr[i], result.gpr[i]) << variant.name << " r" << i;
+
+    RecordProperty(variant.name, std::to_string(result.elapsed_ms));
+  }
+}
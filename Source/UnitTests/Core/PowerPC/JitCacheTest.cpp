@@ -0,0 +1,171 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <initializer_list>
+#include <random>
+#include <set>
+#include <string>
+
+#include <gtest/gtest.h>
+
+// The JIT headers pull in the x64Emitter, whose TEST method conflicts with gtest's TEST macro.
+// Only TEST_F is used here.
+#undef TEST
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigManager.h"
+#include "Core/PowerPC/CachedInterpreter/CachedInterpreter.h"
+#include "Core/PowerPC/CachedInterpreter/InterpreterBlockCache.h"
+#include "Core/PowerPC/JitCommon/JitCache.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+// The block cache writes links through the exit pointers, give them all somewhere to go.
+const u8* s_link_target;
+
+// Adds a block made of num_instructions consecutive instructions, with exits to the given
+// addresses. The tests run with address translation off, so addresses are physical.
+JitBlock* AddBlock(JitBaseBlockCache& cache, u32 address, u32 num_instructions,
+                   std::initializer_list<u32> exits = {})
+{
+  JitBlock* block = cache.AllocateBlock(address);
+  block->originalSize = num_instructions;
+  for (u32 exit : exits)
+    block->linkData.push_back({reinterpret_cast<u8*>(&s_link_target), exit, false, false});
+
+  std::set<u32> physical_addresses;
+  for (u32 i = 0; i < num_instructions; i++)
+    physical_addresses.insert(address + i * 4);
+  cache.FinalizeBlock(*block, true, physical_addresses);
+  return block;
+}
+}  // namespace
+
+class JitCacheTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_profile_path = File::CreateTempDir();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    SConfig::Init();
+    m_cache.Init();
+  }
+
+  void TearDown() override
+  {
+    m_cache.Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  std::string m_profile_path;
+  CachedInterpreter m_jit;
+  BlockCache m_cache{m_jit};
+};
+
+TEST_F(JitCacheTest, InvalidateICacheErasesOverlappingBlocks)
+{
+  AddBlock(m_cache, 0x3000, 4, {0x30f8});
+  AddBlock(m_cache, 0x3020, 4);
+  // Spans two of the 0x100 byte ranges the cache groups blocks in.
+  AddBlock(m_cache, 0x30f8, 4, {0x3000});
+
+  m_cache.InvalidateICache(0x3100, 32, false);
+  EXPECT_NE(nullptr, m_cache.GetBlockFromStartAddress(0x3000, 0));
+  EXPECT_NE(nullptr, m_cache.GetBlockFromStartAddress(0x3020, 0));
+  EXPECT_EQ(nullptr, m_cache.GetBlockFromStartAddress(0x30f8, 0));
+
+  // The cacheline has no code left, so this is a no-op.
+  m_cache.InvalidateICache(0x3100, 32, false);
+
+  m_cache.InvalidateICache(0x3000, 32, false);
+  EXPECT_EQ(nullptr, m_cache.GetBlockFromStartAddress(0x3000, 0));
+  EXPECT_NE(nullptr, m_cache.GetBlockFromStartAddress(0x3020, 0));
+}
+
+TEST_F(JitCacheTest, ErasePhysicalRangeErasesEachBlockOnce)
+{
+  // Blocks spanning several ranges and pages, and blocks sharing a start address.
+  AddBlock(m_cache, 0x4ff0, 0x10);
+  AddBlock(m_cache, 0x5000, 0x100);
+  AddBlock(m_cache, 0x5000, 0x8);
+  AddBlock(m_cache, 0x6000, 0x8);
+
+  m_cache.ErasePhysicalRange(0x4000, 0x2000);
+  size_t remaining = 0;
+  m_cache.RunOnBlocks([&remaining](const JitBlock& block) {
+    EXPECT_EQ(0x6000u, block.physicalAddress);
+    remaining++;
+  });
+  EXPECT_EQ(1u, remaining);
+
+  // Freed blocks are reused.
+  AddBlock(m_cache, 0x5000, 0x8);
+  EXPECT_NE(nullptr, m_cache.GetBlockFromStartAddress(0x5000, 0));
+}
+
+// Replays a synthetic trace of a game swapping code overlays: each swap invalidates a region full
+// of linked blocks, either in one go like a DMA does or one cacheline at a time like icbi loops
+// do, and compiles it again.
+TEST_F(JitCacheTest, DISABLED_InvalidationThroughput)
+{
+  constexpr u32 OVERLAY_BASE = 0x00400000;
+  constexpr u32 OVERLAY_SIZE = 0x20000;
+  constexpr u32 NUM_OVERLAYS = 4;
+  constexpr int SWAPS = 200;
+
+  std::mt19937 rng(0);
+  const auto compile_overlay = [&](u32 base) {
+    u32 address = base;
+    while (address < base + OVERLAY_SIZE - 0x100)
+    {
+      const u32 num_instructions = 4 + rng() % 28;
+      const u32 target = base + (rng() % (OVERLAY_SIZE / 4)) * 4;
+      AddBlock(m_cache, address, num_instructions, {target, address + num_instructions * 4});
+      address += num_instructions * 4;
+    }
+  };
+
+  for (u32 i = 0; i < NUM_OVERLAYS; i++)
+    compile_overlay(OVERLAY_BASE + i * OVERLAY_SIZE);
+
+  double dma_seconds = 0;
+  double icbi_seconds = 0;
+  double compile_seconds = 0;
+  for (int swap = 0; swap < SWAPS; swap++)
+  {
+    const u32 base = OVERLAY_BASE + (rng() % NUM_OVERLAYS) * OVERLAY_SIZE;
+
+    const auto start = std::chrono::steady_clock::now();
+    if (swap % 2 == 0)
+    {
+      m_cache.InvalidateICache(base, OVERLAY_SIZE, false);
+    }
+    else
+    {
+      for (u32 address = base; address < base + OVERLAY_SIZE; address += 32)
+        m_cache.InvalidateICache(address, 32, false);
+    }
+    const auto invalidate_end = std::chrono::steady_clock::now();
+    compile_overlay(base);
+    const auto end = std::chrono::steady_clock::now();
+
+    const double invalidate = std::chrono::duration<double>(invalidate_end - start).count();
+    (swap % 2 == 0 ? dma_seconds : icbi_seconds) += invalidate;
+    compile_seconds += std::chrono::duration<double>(end - invalidate_end).count();
+  }
+
+  std::printf("%-32s %10.3f ms/swap\n", "Invalidate overlay at once", dma_seconds * 2000 / SWAPS);
+  std::printf("%-32s %10.3f ms/swap\n", "Invalidate overlay by line", icbi_seconds * 2000 / SWAPS);
+  std::printf("%-32s %10.3f ms/swap\n", "Allocate, finalize and link",
+              compile_seconds * 1000 / SWAPS);
+}
@@ -0,0 +1,363 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonPaths.h"
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Core/ConfigLoaders/BaseConfigLoader.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "Core/PowerPC/Interpreter/Interpreter.h"
+#include "Core/PowerPC/JitCommon/JitDiskCache.h"
+#include "Core/PowerPC/PPCAnalyst.h"
+#include "Core/PowerPC/PPCTables.h"
+#include "UICommon/UICommon.h"
+
+namespace
+{
+struct AnalysisState
+{
+  AnalysisState() : buffer(16)
+  {
+    block.m_stats = &stats;
+    block.m_gpa = &gpa;
+    block.m_fpa = &fpa;
+  }
+
+  PPCAnalyst::BlockStats stats{};
+  PPCAnalyst::BlockRegStats gpa{};
+  PPCAnalyst::BlockRegStats fpa{};
+  PPCAnalyst::CodeBlock block{};
+  PPCAnalyst::CodeBuffer buffer;
+};
+
+void FillTestBlock(AnalysisState& state)
+{
+  // addi r3, r3, 1; cmpwi r3, 16; blt -8; blr
+  constexpr u32 instructions[] = {0x38630001, 0x2c030010, 0x4180fff8, 0x4e800020};
+
+  state.block.m_address = 0x80003100;
+  state.block.m_num_instructions = 4;
+  state.block.m_broken = false;
+  state.block.m_gqr_used = BitSet8(0);
+  state.block.m_gqr_modified = BitSet8(0);
+  state.block.m_gpr_inputs = BitSet32{3};
+  state.stats.numCycles = 4;
+  state.gpa.Clear();
+  state.gpa.SetInputRegister(3, 0);
+  state.gpa.SetOutputRegister(3, 0);
+  state.fpa.Clear();
+
+  for (u32 i = 0; i < 4; i++)
+  {
+    PPCAnalyst::CodeOp& op = state.buffer[i];
+    op = {};
+    op.inst.hex = instructions[i];
+    op.opinfo = PPCTables::GetOpInfo(op.inst);
+    op.address = state.block.m_address + i * 4;
+    op.branchTo = UINT32_MAX;
+    op.regsIn = BitSet32{3};
+  }
+  state.buffer[2].branchTo = 0x80003100;
+  state.buffer[2].branchIsIdleLoop = true;
+}
+}  // namespace
+
+class JitDiskCacheTest : public testing::Test
+{
+protected:
+  void SetUp() override { Interpreter::getInstance()->Init(); }
+};
+
+TEST_F(JitDiskCacheTest, RoundTrip)
+{
+  AnalysisState original;
+  FillTestBlock(original);
+
+  const std::vector<u8> data =
+      JitDiskCache::SerializeBlock(original.block, original.buffer, 0x80003110);
+
+  AnalysisState loaded;
+  u32 next_pc = 0;
+  ASSERT_TRUE(JitDiskCache::DeserializeBlock(data, loaded.buffer.size(), &loaded.block,
+                                             &loaded.buffer, &next_pc));
+
+  EXPECT_EQ(0x80003110u, next_pc);
+  EXPECT_EQ(original.block.m_address, loaded.block.m_address);
+  EXPECT_EQ(original.block.m_num_instructions, loaded.block.m_num_instructions);
+  EXPECT_EQ(original.block.m_gpr_inputs, loaded.block.m_gpr_inputs);
+  EXPECT_EQ(original.stats.numCycles, loaded.stats.numCycles);
+  EXPECT_EQ(original.gpa.numReads[3], loaded.gpa.numReads[3]);
+
+  for (u32 i = 0; i < original.block.m_num_instructions; i++)
+  {
+    EXPECT_EQ(original.buffer[i].inst.hex, loaded.buffer[i].inst.hex);
+    EXPECT_EQ(original.buffer[i].address, loaded.buffer[i].address);
+    EXPECT_EQ(original.buffer[i].branchTo, loaded.buffer[i].branchTo);
+    EXPECT_EQ(original.buffer[i].branchIsIdleLoop, loaded.buffer[i].branchIsIdleLoop);
+    EXPECT_EQ(original.buffer[i].opinfo, loaded.buffer[i].opinfo);
+  }
+}
+
+TEST_F(JitDiskCacheTest, RejectsTruncatedData)
+{
+  AnalysisState original;
+  FillTestBlock(original);
+
+  std::vector<u8> data = JitDiskCache::SerializeBlock(original.block, original.buffer, 0);
+  data.resize(data.size() - 1);
+
+  AnalysisState loaded;
+  u32 next_pc = 0;
+  EXPECT_FALSE(JitDiskCache::DeserializeBlock(data, loaded.buffer.size(), &loaded.block,
+                                              &loaded.buffer, &next_pc));
+}
+
+TEST_F(JitDiskCacheTest, RejectsBlocksLargerThanBuffer)
+{
+  AnalysisState original;
+  FillTestBlock(original);
+
+  const std::vector<u8> data = JitDiskCache::SerializeBlock(original.block, original.buffer, 0);
+
+  AnalysisState loaded;
+  u32 next_pc = 0;
+  EXPECT_FALSE(JitDiskCache::DeserializeBlock(data, 2, &loaded.block, &loaded.buffer, &next_pc));
+}
+
+TEST_F(JitDiskCacheTest, ExceptionSettingsAreKeyed)
+{
+  const std::string profile_path = File::CreateTempDir();
+  UICommon::SetUserDirectory(profile_path);
+  Config::Init();
+  Config::AddLayer(ConfigLoaders::GenerateBaseConfigLoader());
+  SConfig::Init();
+  Memory::Init();
+
+  // fdivs f1, f2, f3; fdivs f1, f2, f3; blr
+  // Only the second division's exception analysis depends on the settings, as the first FPU
+  // instruction of a block can always raise one.
+  constexpr u32 address = 0x00003100;
+  Memory::Write_U32(0xec221824, address);
+  Memory::Write_U32(0xec221824, address + 4);
+  Memory::Write_U32(0x4e800020, address + 8);
+
+  SConfig& config = SConfig::GetInstance();
+  PPCAnalyst::PPCAnalyzer analyzer;
+  JitDiskCache cache;
+  cache.Init("GTEST01");
+  EXPECT_TRUE(cache.IsEnabled());
+
+  const auto analyze_and_store = [&] {
+    AnalysisState state;
+    const u32 next_pc =
+        analyzer.Analyze(address, &state.block, &state.buffer, state.buffer.size());
+    cache.Store(0, JitDiskCache::GetKeyOptions(analyzer), state.block, state.buffer, next_pc);
+    return state.buffer[1].canCauseException;
+  };
+  // Returns whether there was a hit, and if so, whether the entry has the second division raising
+  // exceptions.
+  bool can_cause_exception = false;
+  const auto lookup = [&] {
+    AnalysisState state;
+    u32 next_pc;
+    if (!cache.Lookup(address, 0, JitDiskCache::GetKeyOptions(analyzer), state.buffer.size(),
+                      &state.block, &state.buffer, &next_pc))
+    {
+      return false;
+    }
+    can_cause_exception = state.buffer[1].canCauseException;
+    return true;
+  };
+
+  config.bFloatExceptions = false;
+  config.bDivideByZeroExceptions = false;
+  EXPECT_FALSE(analyze_and_store());
+  EXPECT_TRUE(lookup());
+  EXPECT_FALSE(can_cause_exception);
+
+  config.bFloatExceptions = true;
+  EXPECT_FALSE(lookup());
+  EXPECT_TRUE(analyze_and_store());
+  EXPECT_TRUE(lookup());
+  EXPECT_TRUE(can_cause_exception);
+
+  config.bFloatExceptions = false;
+  config.bDivideByZeroExceptions = true;
+  EXPECT_FALSE(lookup());
+  EXPECT_TRUE(analyze_and_store());
+  EXPECT_TRUE(lookup());
+  EXPECT_TRUE(can_cause_exception);
+
+  cache.Shutdown();
+  Memory::Shutdown();
+  SConfig::Shutdown();
+  Config::Shutdown();
+  File::DeleteDirRecursively(profile_path);
+}
+
+class JitDiskCacheFileTest : public JitDiskCacheTest
+{
+protected:
+  void SetUp() override
+  {
+    JitDiskCacheTest::SetUp();
+    m_profile_path = File::CreateTempDir();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    Config::AddLayer(ConfigLoaders::GenerateBaseConfigLoader());
+    SConfig::Init();
+    Memory::Init();
+  }
+
+  void TearDown() override
+  {
+    m_cache.Shutdown();
+    Memory::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  // Writes blocks of num_instructions - 1 additions and a blr, one every BLOCK_STRIDE bytes.
+  static void WriteBlocks(u32 num_blocks, u32 num_instructions)
+  {
+    for (u32 block = 0; block < num_blocks; block++)
+    {
+      const u32 address = FIRST_BLOCK + block * BLOCK_STRIDE;
+      for (u32 i = 0; i < num_instructions - 1; i++)
+        Memory::Write_U32(0x38630001, address + i * 4);
+      Memory::Write_U32(0x4e800020, address + (num_instructions - 1) * 4);
+    }
+  }
+
+  static u32 BlockAddress(u32 block) { return FIRST_BLOCK + block * BLOCK_STRIDE; }
+
+  std::size_t AnalyzeAndStore(u32 block)
+  {
+    AnalysisState state;
+    const u32 next_pc = m_analyzer.Analyze(BlockAddress(block), &state.block, &state.buffer,
+                                           state.buffer.size());
+    m_cache.Store(0, JitDiskCache::GetKeyOptions(m_analyzer), state.block, state.buffer,
+                  next_pc);
+    return JitDiskCache::SerializeBlock(state.block, state.buffer, next_pc).size();
+  }
+
+  bool Lookup(u32 block)
+  {
+    AnalysisState state;
+    u32 next_pc;
+    return m_cache.Lookup(BlockAddress(block), 0, JitDiskCache::GetKeyOptions(m_analyzer),
+                          state.buffer.size(), &state.block, &state.buffer, &next_pc);
+  }
+
+  static constexpr u32 FIRST_BLOCK = 0x00010000;
+  static constexpr u32 BLOCK_STRIDE = 0x40;
+
+  std::string m_profile_path;
+  PPCAnalyst::PPCAnalyzer m_analyzer;
+  JitDiskCache m_cache;
+};
+
+TEST_F(JitDiskCacheFileTest, CompactsOnLoad)
+{
+  constexpr u32 NUM_BLOCKS = 16;
+  WriteBlocks(NUM_BLOCKS, 2);
+
+  m_cache.Init("GTEST02");
+  std::size_t entry_size = 0;
+  for (u32 block = 0; block < NUM_BLOCKS; block++)
+    entry_size = AnalyzeAndStore(block);
+  // Replaced records, which make the file worth compacting.
+  for (int i = 0; i < 4; i++)
+    AnalyzeAndStore(NUM_BLOCKS - 1);
+
+  m_cache.Init("GTEST02");
+  EXPECT_EQ(NUM_BLOCKS + 4, m_cache.GetStats().loaded_records);
+  EXPECT_EQ(NUM_BLOCKS, m_cache.GetStats().loaded_entries);
+  EXPECT_TRUE(m_cache.GetStats().compacted);
+  // Using the oldest blocks moves them to the end of the file.
+  for (u32 block = 0; block < 4; block++)
+    EXPECT_TRUE(Lookup(block));
+
+  // Only half of the entries fit, which are the ones used last.
+  m_cache.Init("GTEST02", entry_size * NUM_BLOCKS / 2);
+  EXPECT_EQ(NUM_BLOCKS + 4, m_cache.GetStats().loaded_records);
+  EXPECT_TRUE(m_cache.GetStats().compacted);
+  for (u32 block = 0; block < NUM_BLOCKS; block++)
+    EXPECT_EQ(block < 4 || block >= NUM_BLOCKS - 4, Lookup(block)) << block;
+
+  // The lookups moved the four blocks at the start of the compacted file to its end again.
+  m_cache.Init("GTEST02");
+  EXPECT_EQ(NUM_BLOCKS / 2 + 4, m_cache.GetStats().loaded_records);
+  EXPECT_EQ(NUM_BLOCKS / 2, m_cache.GetStats().loaded_entries);
+  EXPECT_TRUE(m_cache.GetStats().compacted);
+
+  m_cache.Init("GTEST02");
+  EXPECT_EQ(NUM_BLOCKS / 2, m_cache.GetStats().loaded_records);
+  EXPECT_FALSE(m_cache.GetStats().compacted);
+}
+
+// Compares loading the cache and looking blocks up in it against analyzing the blocks, for a game
+// with 20000 blocks of 8 instructions.
+TEST_F(JitDiskCacheFileTest, DISABLED_Throughput)
+{
+  constexpr u32 NUM_BLOCKS = 20000;
+  WriteBlocks(NUM_BLOCKS, 8);
+
+  const auto measure = [](const auto& function) {
+    const auto start = std::chrono::steady_clock::now();
+    function();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  };
+
+  m_cache.Init("GTEST03");
+  const double store_seconds = measure([&] {
+    for (u32 block = 0; block < NUM_BLOCKS; block++)
+      AnalyzeAndStore(block);
+  });
+  const double analyze_seconds = measure([&] {
+    for (u32 block = 0; block < NUM_BLOCKS; block++)
+    {
+      AnalysisState state;
+      m_analyzer.Analyze(BlockAddress(block), &state.block, &state.buffer, state.buffer.size());
+    }
+  });
+  // A quarter of the blocks analyzed again, e.g. after their entries went stale.
+  for (u32 block = 0; block < NUM_BLOCKS / 4; block++)
+    AnalyzeAndStore(block);
+
+  const double compacting_load_seconds = measure([&] { m_cache.Init("GTEST03"); });
+  const double load_seconds = measure([&] { m_cache.Init("GTEST03"); });
+  u32 hits = 0;
+  const double lookup_seconds = measure([&] {
+    for (u32 block = 0; block < NUM_BLOCKS; block++)
+      hits += Lookup(block);
+  });
+  // Without appending the entries from the older half of the file again.
+  const double second_lookup_seconds = measure([&] {
+    for (u32 block = 0; block < NUM_BLOCKS; block++)
+      hits += Lookup(block);
+  });
+  EXPECT_EQ(NUM_BLOCKS * 2, hits);
+
+  const u64 file_size =
+      File::GetSize(File::GetUserPath(D_CACHE_IDX) + "JIT" DIR_SEP "GTEST03.cache");
+  std::printf("%-32s %10.1f ns/block\n", "Analyze", analyze_seconds * 1e9 / NUM_BLOCKS);
+  std::printf("%-32s %10.1f ns/block\n", "Analyze and store", store_seconds * 1e9 / NUM_BLOCKS);
+  std::printf("%-32s %10.1f ns/block\n", "First lookup", lookup_seconds * 1e9 / NUM_BLOCKS);
+  std::printf("%-32s %10.1f ns/block\n", "Second lookup",
+              second_lookup_seconds * 1e9 / NUM_BLOCKS);
+  std::printf("%-32s %10.3f ms\n", "Load and compact", compacting_load_seconds * 1e3);
+  std::printf("%-32s %10.3f ms\n", "Load", load_seconds * 1e3);
+  std::printf("%-32s %10.1f KiB\n", "File size", file_size / 1024.0);
+}
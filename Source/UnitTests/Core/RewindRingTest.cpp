@@ -0,0 +1,183 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Core/RewindRing.h"
+
+using State::RewindRing;
+
+namespace
+{
+constexpr size_t PAGE_SIZE = RewindRing::PAGE_SIZE;
+
+// Not a multiple of the page size, so the last page is a partial one.
+std::vector<u8> MakeState(std::mt19937& rng, size_t size = 16 * PAGE_SIZE + 123)
+{
+  std::vector<u8> state(size);
+  for (u8& byte : state)
+    byte = static_cast<u8>(rng());
+  return state;
+}
+}  // namespace
+
+TEST(RewindRing, DeltaRoundTrip)
+{
+  std::mt19937 rng(0);
+  const std::vector<u8> keyframe = MakeState(rng);
+  std::vector<u8> state = keyframe;
+  state[3 * PAGE_SIZE + 7] ^= 0xff;
+  state[9 * PAGE_SIZE] ^= 0x01;
+  state.back() ^= 0x80;
+
+  std::vector<u8> delta;
+  ASSERT_TRUE(RewindRing::BuildDelta(state, keyframe, &delta));
+  EXPECT_EQ(2 * (sizeof(u32) + PAGE_SIZE) + sizeof(u32) + 123, delta.size());
+
+  std::vector<u8> result = keyframe;
+  ASSERT_TRUE(RewindRing::ApplyDelta(delta, &result));
+  EXPECT_EQ(state, result);
+
+  // An unchanged state has an empty delta.
+  ASSERT_TRUE(RewindRing::BuildDelta(keyframe, keyframe, &delta));
+  EXPECT_TRUE(delta.empty());
+}
+
+TEST(RewindRing, DeltaNeedsKeyframe)
+{
+  std::mt19937 rng(1);
+  const std::vector<u8> keyframe = MakeState(rng);
+  std::vector<u8> delta;
+
+  EXPECT_FALSE(RewindRing::BuildDelta(MakeState(rng), keyframe, &delta));
+  EXPECT_FALSE(RewindRing::BuildDelta(MakeState(rng, keyframe.size() + 1), keyframe, &delta));
+}
+
+TEST(RewindRing, ApplyDeltaRejectsBadDelta)
+{
+  std::mt19937 rng(2);
+  const std::vector<u8> keyframe = MakeState(rng);
+  std::vector<u8> state = keyframe;
+  state[PAGE_SIZE] ^= 0xff;
+
+  std::vector<u8> delta;
+  ASSERT_TRUE(RewindRing::BuildDelta(state, keyframe, &delta));
+
+  std::vector<u8> result = keyframe;
+  std::vector<u8> truncated(delta.begin(), delta.end() - 1);
+  EXPECT_FALSE(RewindRing::ApplyDelta(truncated, &result));
+
+  // The page index is past the end of a smaller state.
+  std::vector<u8> small_state(PAGE_SIZE);
+  EXPECT_FALSE(RewindRing::ApplyDelta(delta, &small_state));
+}
+
+TEST(RewindRing, PopReturnsPushedStates)
+{
+  std::mt19937 rng(3);
+  RewindRing ring;
+  ring.SetCapacity(8);
+
+  std::vector<std::vector<u8>> states;
+  std::vector<u8> state = MakeState(rng);
+  for (u64 frame = 0; frame < 20; ++frame)
+  {
+    // Mostly small changes against the keyframe, with a new keyframe every now and then.
+    if (frame % 7 == 6)
+      state = MakeState(rng);
+    else
+      state[rng() % state.size()] ^= 0x55;
+
+    states.push_back(state);
+    ring.Push(state, frame, 0.0);
+    // Wait for the worker, so that no snapshot gets dropped.
+    ASSERT_EQ(std::min<size_t>(frame + 1, 8), ring.GetSize());
+  }
+
+  const State::RewindStats stats = ring.GetStats();
+  EXPECT_EQ(20u, stats.snapshots);
+  EXPECT_EQ(0u, stats.dropped_snapshots);
+  EXPECT_EQ(3u, stats.keyframes);
+  EXPECT_EQ(19u, stats.frames);
+
+  for (size_t i = 0; i < 8; ++i)
+  {
+    std::vector<u8> popped;
+    ASSERT_TRUE(ring.Pop(&popped));
+    EXPECT_EQ(states[states.size() - 1 - i], popped);
+  }
+
+  std::vector<u8> popped;
+  EXPECT_FALSE(ring.Pop(&popped));
+}
+
+TEST(RewindRing, CapacityZeroFreesSnapshots)
+{
+  std::mt19937 rng(4);
+  RewindRing ring;
+
+  // Disabled rings ignore snapshots.
+  ring.Push(MakeState(rng), 0, 0.0);
+  EXPECT_EQ(0u, ring.GetSize());
+
+  ring.SetCapacity(4);
+  ring.Push(MakeState(rng), 0, 0.0);
+  EXPECT_EQ(1u, ring.GetSize());
+  ring.SetCapacity(0);
+  EXPECT_EQ(0u, ring.GetSize());
+  EXPECT_EQ(0u, ring.GetStats().snapshots);
+}
+
+// A 24 MiB state with 2% of its pages changing between snapshots, which is roughly what a
+// GameCube game looks like at one snapshot per 30 frames.
+TEST(RewindRing, DISABLED_Throughput)
+{
+  constexpr size_t STATE_SIZE = 24 * 1024 * 1024;
+  constexpr int SNAPSHOTS = 100;
+
+  std::mt19937 rng(5);
+  std::vector<u8> state(STATE_SIZE);
+  for (size_t i = 0; i < STATE_SIZE; i += 8)
+    state[i] = static_cast<u8>(rng() % 4);
+
+  RewindRing ring;
+  ring.SetCapacity(SNAPSHOTS);
+
+  double push_seconds = 0;
+  for (int i = 0; i < SNAPSHOTS; ++i)
+  {
+    for (size_t page = 0; page < STATE_SIZE / PAGE_SIZE / 50; ++page)
+      state[(rng() % (STATE_SIZE / PAGE_SIZE)) * PAGE_SIZE + rng() % PAGE_SIZE] ^= 0xff;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<u8> buffer = ring.GetBuffer();
+    buffer.assign(state.begin(), state.end());
+    ring.Push(std::move(buffer), i * 30, 0.0);
+    push_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Give the worker the time the emulator would spend on the next 30 frames.
+    ring.GetSize();
+  }
+
+  const State::RewindStats stats = ring.GetStats();
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<u8> popped;
+  ring.Pop(&popped);
+  const double pop_seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::printf("%-32s %10.3f ms/snapshot\n", "Copy and push", push_seconds * 1000 / SNAPSHOTS);
+  std::printf("%-32s %10.3f ms/snapshot\n", "Diff and compress (worker)",
+              stats.compress_ms / stats.snapshots);
+  std::printf("%-32s %10.1f bytes/frame\n", "Compressed size",
+              static_cast<double>(stats.compressed_bytes) / stats.frames);
+  std::printf("%-32s %10.3f ms\n", "Pop", pop_seconds * 1000);
+}
@@ -0,0 +1,170 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "DiscIO/Blob.h"
+#include "DiscIO/WIABlob.h"
+
+namespace
+{
+constexpr u64 IMAGE_SIZE = 64 * 1024 * 1024;
+constexpr int CHUNK_SIZE = 128 * 1024;
+
+// Without a disc header, the whole image is stored as raw data, which is split into groups of
+// CHUNK_SIZE like the data of a GameCube disc. Runs of random data are mixed with runs of
+// repeated bytes, so that some groups compress well and others barely.
+std::vector<u8> MakeImage()
+{
+  std::mt19937 rng(0);
+  std::vector<u8> image(IMAGE_SIZE);
+  for (u64 offset = 0; offset < IMAGE_SIZE; offset += 0x1000)
+  {
+    if (rng() % 2)
+      std::generate_n(&image[offset], 0x1000, [&rng] { return static_cast<u8>(rng()); });
+    else
+      std::fill_n(&image[offset], 0x1000, static_cast<u8>(offset >> 12));
+  }
+  return image;
+}
+}  // namespace
+
+class WIABlobTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_directory = File::CreateTempDir();
+    ASSERT_FALSE(m_directory.empty());
+    m_image = MakeImage();
+
+    const std::string iso_path = m_directory + "/image.iso";
+    m_rvz_path = m_directory + "/image.rvz";
+    ASSERT_TRUE(File::IOFile(iso_path, "wb").WriteBytes(m_image.data(), m_image.size()));
+
+    std::unique_ptr<DiscIO::BlobReader> iso = DiscIO::CreateBlobReader(iso_path);
+    ASSERT_TRUE(iso);
+    ASSERT_TRUE(DiscIO::ConvertToWIAOrRVZ(iso.get(), iso_path, m_rvz_path, true,
+                                          DiscIO::WIARVZCompressionType::Zstd, 1, CHUNK_SIZE,
+                                          [](const std::string&, float) { return true; }));
+  }
+
+  void TearDown() override
+  {
+    if (!m_directory.empty())
+      File::DeleteDirRecursively(m_directory);
+  }
+
+  std::unique_ptr<DiscIO::RVZFileReader> OpenRVZ()
+  {
+    return DiscIO::RVZFileReader::Create(File::IOFile(m_rvz_path, "rb"), m_rvz_path);
+  }
+
+  bool ReadMatches(DiscIO::BlobReader* reader, u64 offset, u64 size)
+  {
+    std::vector<u8> buffer(size);
+    return reader->Read(offset, size, buffer.data()) &&
+           std::memcmp(buffer.data(), &m_image[offset], size) == 0;
+  }
+
+  std::string m_directory;
+  std::string m_rvz_path;
+  std::vector<u8> m_image;
+};
+
+TEST_F(WIABlobTest, SequentialReadsArePrefetched)
+{
+  std::unique_ptr<DiscIO::RVZFileReader> rvz = OpenRVZ();
+  ASSERT_TRUE(rvz);
+  ASSERT_EQ(IMAGE_SIZE, rvz->GetDataSize());
+
+  // Like a game streaming a file, in reads smaller than a group.
+  for (u64 offset = 0; offset < IMAGE_SIZE; offset += 0x8000)
+    ASSERT_TRUE(ReadMatches(rvz.get(), offset, 0x8000)) << offset;
+
+  const DiscIO::RVZFileReader::GroupCacheStats& stats = rvz->GetGroupCacheStats();
+  // The start of the image, where a disc header would be, is stored in small groups of its own.
+  EXPECT_GE(stats.lookups, IMAGE_SIZE / CHUNK_SIZE);
+  // Only the first few groups of the run come before the read-ahead has grown.
+  EXPECT_GE(stats.prefetch_hits + stats.prefetch_waits, stats.lookups - 4);
+  EXPECT_EQ(0u, stats.unused_prefetches);
+  // At least the groups before the read-ahead starts are decompressed on the reading thread.
+  EXPECT_GT(std::accumulate(stats.sync_decompression_us.begin(),
+                            stats.sync_decompression_us.end(), u64(0)),
+            0u);
+}
+
+TEST_F(WIABlobTest, RandomReadsMatch)
+{
+  std::unique_ptr<DiscIO::RVZFileReader> rvz = OpenRVZ();
+  ASSERT_TRUE(rvz);
+
+  // Short sequential runs, so that groups keep getting prefetched, with jumps in between that
+  // evict prefetched groups before they are used, some of them likely while being decompressed.
+  std::mt19937 rng(1);
+  for (int run = 0; run < 200; ++run)
+  {
+    u64 offset = rng() % IMAGE_SIZE;
+    for (int i = 0; i < 8 && offset < IMAGE_SIZE; ++i)
+    {
+      const u64 size = std::min<u64>(1 + rng() % (CHUNK_SIZE * 3), IMAGE_SIZE - offset);
+      ASSERT_TRUE(ReadMatches(rvz.get(), offset, size)) << offset << " " << size;
+      offset += size;
+    }
+  }
+
+  const DiscIO::RVZFileReader::GroupCacheStats& stats = rvz->GetGroupCacheStats();
+  EXPECT_GT(stats.prefetch_hits + stats.prefetch_waits, 0u);
+  EXPECT_GT(stats.unused_prefetches, 0u);
+}
+
+// Readers on several threads share the prefetch workers. Each reader is destroyed right after a
+// jump, while groups it queued may still be waiting for or being decompressed by a worker.
+TEST_F(WIABlobTest, ConcurrentReadersMatch)
+{
+  std::vector<std::thread> threads;
+  std::vector<int> failures(4);
+  for (size_t t = 0; t < failures.size(); ++t)
+  {
+    threads.emplace_back([this, t, &failures] {
+      std::mt19937 rng(static_cast<u32>(t));
+      for (int reader = 0; reader < 4; ++reader)
+      {
+        std::unique_ptr<DiscIO::RVZFileReader> rvz = OpenRVZ();
+        if (!rvz)
+        {
+          ++failures[t];
+          continue;
+        }
+
+        for (int run = 0; run < 4; ++run)
+        {
+          u64 offset = rng() % (IMAGE_SIZE / 2);
+          for (int i = 0; i < 16; ++i, offset += 0x8000)
+          {
+            if (!ReadMatches(rvz.get(), offset, 0x8000))
+              ++failures[t];
+          }
+        }
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (size_t t = 0; t < failures.size(); ++t)
+    EXPECT_EQ(0, failures[t]) << "thread " << t;
+}
@@ -0,0 +1,296 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/EfbInterface.h"
+#include "VideoBackends/Software/NativeVertexFormat.h"
+#include "VideoBackends/Software/Rasterizer.h"
+#include "VideoCommon/BPMemory.h"
+#include "VideoCommon/TextureDecoder.h"
+#include "VideoCommon/VideoCommon.h"
+#include "VideoCommon/VideoConfig.h"
+
+namespace
+{
+struct Efb
+{
+  std::vector<u32> color;
+  std::vector<u32> depth;
+};
+
+// One stage which outputs the rasterized color, blended over the EFB after a depth test, so that
+// both the depth test and blending depend on the order triangles are drawn in.
+void SetUpState()
+{
+  std::memset(&bpmem, 0, sizeof(bpmem));
+  bpmem.genMode.numcolchans = 1;
+  bpmem.tevorders[0].colorchan0 = 0;
+  bpmem.combiners[0].colorC.a = 15;
+  bpmem.combiners[0].colorC.b = 15;
+  bpmem.combiners[0].colorC.c = 15;
+  bpmem.combiners[0].colorC.d = 10;
+  bpmem.combiners[0].colorC.clamp = 1;
+  bpmem.combiners[0].alphaC.a = 7;
+  bpmem.combiners[0].alphaC.b = 7;
+  bpmem.combiners[0].alphaC.c = 7;
+  bpmem.combiners[0].alphaC.d = 5;
+  bpmem.combiners[0].alphaC.clamp = 1;
+  // The identity swap table.
+  bpmem.tevksel[0].swap1 = 0;
+  bpmem.tevksel[0].swap2 = 1;
+  bpmem.tevksel[1].swap1 = 2;
+  bpmem.tevksel[1].swap2 = 3;
+
+  bpmem.alpha_test.comp0 = AlphaTest::ALWAYS;
+  bpmem.alpha_test.comp1 = AlphaTest::ALWAYS;
+  bpmem.zmode.testenable = 1;
+  bpmem.zmode.func = ZMode::LEQUAL;
+  bpmem.zmode.updateenable = 1;
+  bpmem.blendmode.blendenable = 1;
+  bpmem.blendmode.srcfactor = BlendMode::SRCALPHA;
+  bpmem.blendmode.dstfactor = BlendMode::INVSRCALPHA;
+  bpmem.blendmode.colorupdate = 1;
+  bpmem.zcontrol.pixel_format = PEControl::RGB8_Z24;
+
+  // A scissor rectangle covering the whole EFB.
+  bpmem.scissorOffset.x = 171;
+  bpmem.scissorOffset.y = 171;
+  bpmem.scissorTL.x = 342;
+  bpmem.scissorTL.y = 342;
+  bpmem.scissorBR.x = 341 + EFB_WIDTH;
+  bpmem.scissorBR.y = 341 + EFB_HEIGHT;
+}
+
+// Two stages that read Tev state no earlier stage of the pixel wrote, so that it would come from
+// whichever pixel the Tev drew before. The first stage has texturing disabled but reads the texture
+// color, adds its unused texture coordinate to the previous one with fb_addprev, and uses the
+// second color channel, which isn't rasterized. Both stages read the alpha bump from an indirect
+// texture which isn't sampled. The second stage samples a texture at the accumulated coordinate.
+void SetUpCarriedState()
+{
+  SetUpState();
+  bpmem.blendmode.blendenable = 0;
+  bpmem.genMode.numtexgens = 1;
+  bpmem.genMode.numtevstages = 1;
+
+  bpmem.tevorders[0].texcoord0 = 1;
+  bpmem.tevorders[0].enable0 = 0;
+  bpmem.tevorders[0].colorchan0 = 1;
+  bpmem.tevorders[0].texmap1 = 0;
+  bpmem.tevorders[0].texcoord1 = 0;
+  bpmem.tevorders[0].enable1 = 1;
+  bpmem.tevorders[0].colorchan1 = 5;
+  for (TevStageIndirect& indirect : bpmem.tevind)
+  {
+    indirect.bs = ITBA_S;
+    indirect.fb_addprev = 1;
+  }
+
+  // texc / 2 + rasc / 2
+  bpmem.combiners[0].colorC.a = 8;
+  bpmem.combiners[0].colorC.b = 10;
+  bpmem.combiners[0].colorC.c = 13;
+  bpmem.combiners[0].colorC.d = 15;
+  // rasa + cprev / 2 + texc / 2
+  bpmem.combiners[1].colorC.a = 0;
+  bpmem.combiners[1].colorC.b = 8;
+  bpmem.combiners[1].colorC.c = 13;
+  bpmem.combiners[1].colorC.d = 11;
+  bpmem.combiners[1].colorC.clamp = 1;
+  bpmem.combiners[1].alphaC.d = 5;
+  bpmem.combiners[1].alphaC.clamp = 1;
+
+  // A 64x64 RGB565 texture of random texels, preloaded into TMEM, which repeats.
+  bpmem.tex[0].texMode0[0].wrap_s = 1;
+  bpmem.tex[0].texMode0[0].wrap_t = 1;
+  bpmem.tex[0].texImage0[0].width = 63;
+  bpmem.tex[0].texImage0[0].height = 63;
+  bpmem.tex[0].texImage0[0].format = static_cast<u32>(TextureFormat::RGB565);
+  bpmem.tex[0].texImage1[0].image_type = 1;
+  std::mt19937 rng(1);
+  std::generate(texMem, texMem + 64 * 64 * 2, [&rng] { return static_cast<u8>(rng()); });
+}
+
+void ClearEfb()
+{
+  u8 black[4] = {};
+  for (u16 y = 0; y < EFB_HEIGHT; y++)
+  {
+    for (u16 x = 0; x < EFB_WIDTH; x++)
+    {
+      EfbInterface::SetColor(x, y, black);
+      EfbInterface::SetDepth(x, y, 0xFFFFFF);
+    }
+  }
+}
+
+Efb ReadEfb()
+{
+  Efb efb;
+  for (u16 y = 0; y < EFB_HEIGHT; y++)
+  {
+    for (u16 x = 0; x < EFB_WIDTH; x++)
+    {
+      efb.color.push_back(EfbInterface::GetColor(x, y));
+      efb.depth.push_back(EfbInterface::GetDepth(x, y));
+    }
+  }
+  return efb;
+}
+
+OutputVertexData MakeVertex(std::mt19937& rng, float x, float y, float z)
+{
+  OutputVertexData vertex;
+  vertex.screenPosition = {x, y, z};
+  vertex.projectedPosition.w = 1.0f;
+  for (auto& color : vertex.color)
+  {
+    for (u8& component : color)
+      component = static_cast<u8>(rng());
+  }
+  for (Vec3& coord : vertex.texCoords)
+    coord = {static_cast<float>(rng() % 64), static_cast<float>(rng() % 64), 1.0f};
+  return vertex;
+}
+
+// Draws random triangles of up to max_size pixels across, flushing every batch_size of them.
+// Each triangle has one of a few depths, so that many of them tie in the depth test.
+void DrawTriangles(u32 seed, int count, int batch_size, float max_size)
+{
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> position(-16.0f, EFB_WIDTH + 16.0f);
+  std::uniform_real_distribution<float> offset(-max_size / 2, max_size / 2);
+
+  for (int i = 0; i < count; i++)
+  {
+    const float x = position(rng);
+    const float y = position(rng) * EFB_HEIGHT / EFB_WIDTH;
+    const float z = static_cast<float>(rng() % 4) * 0x400000;
+    OutputVertexData v0 = MakeVertex(rng, x + offset(rng), y + offset(rng), z);
+    OutputVertexData v1 = MakeVertex(rng, x + offset(rng), y + offset(rng), z);
+    OutputVertexData v2 = MakeVertex(rng, x + offset(rng), y + offset(rng), z);
+
+    // The rasterizer only covers pixels of triangles with this winding.
+    const Vec3& p0 = v0.screenPosition;
+    const Vec3& p1 = v1.screenPosition;
+    const Vec3& p2 = v2.screenPosition;
+    if ((p0.x - p1.x) * (p2.y - p0.y) - (p0.y - p1.y) * (p2.x - p0.x) < 0)
+      std::swap(v1, v2);
+
+    Rasterizer::DrawTriangleFrontFace(&v0, &v1, &v2);
+    if (i % batch_size == batch_size - 1)
+      Rasterizer::Flush();
+  }
+  Rasterizer::Flush();
+}
+}  // namespace
+
+class RasterizerTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    SetUpState();
+    m_threads = g_ActiveConfig.iSWThreads;
+  }
+
+  void TearDown() override
+  {
+    Rasterizer::Shutdown();
+    g_ActiveConfig.iSWThreads = m_threads;
+  }
+
+  void InitRasterizer(int threads)
+  {
+    Rasterizer::Shutdown();
+    g_ActiveConfig.iSWThreads = threads;
+    Rasterizer::Init();
+    ClearEfb();
+  }
+
+  int m_threads = 0;
+};
+
+TEST_F(RasterizerTest, ThreadsMatchSerial)
+{
+  InitRasterizer(1);
+  DrawTriangles(0, 2000, 100, 160.0f);
+  const Efb serial = ReadEfb();
+
+  // Not everything should lose the depth test against the clear value.
+  const size_t drawn = std::count_if(serial.depth.begin(), serial.depth.end(),
+                                     [](u32 depth) { return depth != 0xFFFFFF; });
+  EXPECT_GT(drawn, serial.depth.size() / 2);
+
+  for (int threads : {2, 4})
+  {
+    InitRasterizer(threads);
+    DrawTriangles(0, 2000, 100, 160.0f);
+    const Efb threaded = ReadEfb();
+
+    for (size_t i = 0; i < serial.color.size(); i++)
+    {
+      ASSERT_EQ(serial.color[i], threaded.color[i])
+          << threads << " threads, pixel " << i % EFB_WIDTH << "," << i / EFB_WIDTH;
+      ASSERT_EQ(serial.depth[i], threaded.depth[i])
+          << threads << " threads, pixel " << i % EFB_WIDTH << "," << i / EFB_WIDTH;
+    }
+  }
+}
+
+TEST_F(RasterizerTest, CarriedTevStateMatchesSerial)
+{
+  SetUpCarriedState();
+
+  InitRasterizer(1);
+  DrawTriangles(1, 500, 50, 160.0f);
+  const Efb serial = ReadEfb();
+
+  for (int threads : {2, 4})
+  {
+    InitRasterizer(threads);
+    DrawTriangles(1, 500, 50, 160.0f);
+    const Efb threaded = ReadEfb();
+
+    for (size_t i = 0; i < serial.color.size(); i++)
+    {
+      ASSERT_EQ(serial.color[i], threaded.color[i])
+          << threads << " threads, pixel " << i % EFB_WIDTH << "," << i / EFB_WIDTH;
+    }
+  }
+}
+
+// Batches of mid-sized triangles, roughly what a game's frame looks like to the rasterizer.
+TEST_F(RasterizerTest, DISABLED_Throughput)
+{
+  constexpr int FRAMES = 10;
+  constexpr int TRIANGLES = 4000;
+
+  std::vector<int> thread_counts{1, 2, 4};
+  const int cores = static_cast<int>(std::thread::hardware_concurrency());
+  if (cores > 4)
+    thread_counts.push_back(cores);
+
+  for (int threads : thread_counts)
+  {
+    InitRasterizer(threads);
+    const auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < FRAMES; frame++)
+      DrawTriangles(frame, TRIANGLES, 200, 64.0f);
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%2d threads %10.3f ms/frame\n", threads, seconds * 1000 / FRAMES);
+  }
+}
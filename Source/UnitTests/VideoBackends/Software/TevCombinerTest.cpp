@@ -0,0 +1,272 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "VideoBackends/Software/TevCombiner.h"
+#include "VideoCommon/BPMemory.h"
+
+namespace
+{
+struct InputRegType
+{
+  unsigned a : 8;
+  unsigned b : 8;
+  unsigned c : 8;
+  signed d : 11;
+};
+
+constexpr s16 BIAS[4] = {0, 128, -128, 0};
+constexpr u8 LSHIFT[4] = {0, 1, 2, 0};
+constexpr u8 RSHIFT[4] = {0, 0, 0, 1};
+
+s16 Clamp(s16 value, bool clamp)
+{
+  if (clamp)
+    return value > 255 ? 255 : (value < 0 ? 0 : value);
+  return value > 1023 ? 1023 : (value < -1024 ? -1024 : value);
+}
+
+// The component loops of the scalar TEV, for one component.
+s16 Reference(u32 bias, u32 op, u32 clamp, u32 shift, bool alpha, const InputRegType& input)
+{
+  const u16 c = input.c + (input.c >> 7);
+
+  s32 temp = input.a * (256 - c) + (input.b * c);
+  temp <<= LSHIFT[shift];
+  temp += (shift == 3) ? 0 : (op == 1) ? 127 : 128;
+  if (alpha)
+  {
+    temp = op ? (-temp >> 8) : (temp >> 8);
+  }
+  else
+  {
+    temp >>= 8;
+    temp = op ? -temp : temp;
+  }
+
+  s32 result = ((input.d + BIAS[bias]) << LSHIFT[shift]) + temp;
+  result = result >> RSHIFT[shift];
+  return Clamp(static_cast<s16>(result), clamp);
+}
+}  // namespace
+
+TEST(TevCombiner, MatchesScalarCombiner)
+{
+  std::mt19937 rng(1234);
+  std::uniform_int_distribution<int> any_value(-32768, 32767);
+  std::uniform_int_distribution<int> register_value(-1024, 1023);
+
+  for (u32 color_mode = 0; color_mode < 48; color_mode++)
+  {
+    for (u32 alpha_mode = 0; alpha_mode < 48; alpha_mode++)
+    {
+      TevStageCombiner::ColorCombiner cc{};
+      cc.bias = color_mode % 3;
+      cc.op = color_mode / 3 % 2;
+      cc.clamp = color_mode / 6 % 2;
+      cc.shift = color_mode / 12;
+      TevStageCombiner::AlphaCombiner ac{};
+      ac.bias = alpha_mode % 3;
+      ac.op = alpha_mode / 3 % 2;
+      ac.clamp = alpha_mode / 6 % 2;
+      ac.shift = alpha_mode / 12;
+      const TevCombiner::RegularStage stage = TevCombiner::MakeRegularStage(cc, ac);
+
+      for (int i = 0; i < 64; i++)
+      {
+        // Inputs are usually in the range registers are clamped to, but mix in some which aren't
+        // to cover the truncation.
+        auto& dist = i % 4 == 0 ? any_value : register_value;
+        s16 a[4], b[4], c[4], d[4];
+        for (int lane = 0; lane < 4; lane++)
+        {
+          a[lane] = dist(rng);
+          b[lane] = dist(rng);
+          c[lane] = dist(rng);
+          d[lane] = dist(rng);
+        }
+
+        s16 out[4];
+        TevCombiner::CombineRegular(stage, a, b, c, d, out);
+
+        for (int lane = 0; lane < 4; lane++)
+        {
+          InputRegType input;
+          input.a = a[lane];
+          input.b = b[lane];
+          input.c = c[lane];
+          input.d = d[lane];
+          const s16 expected =
+              lane == 0 ? Reference(ac.bias, ac.op, ac.clamp, ac.shift, true, input) :
+                          Reference(cc.bias, cc.op, cc.clamp, cc.shift, false, input);
+          ASSERT_EQ(expected, out[lane]) << "color mode " << color_mode << ", alpha mode "
+                                         << alpha_mode << ", lane " << lane;
+        }
+      }
+    }
+  }
+}
+
+// Runs random chains of stages over a register file with the vectorized combiner and with the
+// scalar one, feeding each stage the registers earlier stages wrote.
+TEST(TevCombiner, RandomStageChainsMatchScalarCombiner)
+{
+  constexpr u32 NUM_STAGES = 16;
+
+  std::mt19937 rng(5678);
+  std::uniform_int_distribution<int> register_value(-1024, 1023);
+
+  for (int setup = 0; setup < 1000; setup++)
+  {
+    s16 vector_regs[4][4];
+    for (auto& reg : vector_regs)
+    {
+      for (s16& comp : reg)
+        comp = register_value(rng);
+    }
+    s16 scalar_regs[4][4];
+    std::memcpy(scalar_regs, vector_regs, sizeof(vector_regs));
+
+    for (u32 stage = 0; stage < NUM_STAGES; stage++)
+    {
+      // Random settings, including the bits the combiner doesn't use, but no compare modes. The
+      // input selections pick one of the four registers here.
+      TevStageCombiner::ColorCombiner cc;
+      cc.hex = rng() & 0xFFFFFF;
+      cc.bias = cc.bias % 3;
+      TevStageCombiner::AlphaCombiner ac;
+      ac.hex = rng() & 0xFFFFFF;
+      ac.bias = ac.bias % 3;
+
+      const TevCombiner::RegularStage regular_stage = TevCombiner::MakeRegularStage(cc, ac);
+      s16 a[4], b[4], c[4], d[4];
+      a[0] = vector_regs[ac.a % 4][0];
+      b[0] = vector_regs[ac.b % 4][0];
+      c[0] = vector_regs[ac.c % 4][0];
+      d[0] = vector_regs[ac.d % 4][0];
+      for (int lane = 1; lane < 4; lane++)
+      {
+        a[lane] = vector_regs[cc.a % 4][lane];
+        b[lane] = vector_regs[cc.b % 4][lane];
+        c[lane] = vector_regs[cc.c % 4][lane];
+        d[lane] = vector_regs[cc.d % 4][lane];
+      }
+      s16 out[4];
+      TevCombiner::CombineRegular(regular_stage, a, b, c, d, out);
+      vector_regs[ac.dest][0] = out[0];
+      for (int lane = 1; lane < 4; lane++)
+        vector_regs[cc.dest][lane] = out[lane];
+
+      // Both results are computed before either is written, as in the scalar TEV.
+      s16 scalar_out[4];
+      for (int lane = 0; lane < 4; lane++)
+      {
+        const bool alpha = lane == 0;
+        InputRegType input;
+        input.a = scalar_regs[(alpha ? ac.a : cc.a) % 4][lane];
+        input.b = scalar_regs[(alpha ? ac.b : cc.b) % 4][lane];
+        input.c = scalar_regs[(alpha ? ac.c : cc.c) % 4][lane];
+        input.d = scalar_regs[(alpha ? ac.d : cc.d) % 4][lane];
+        scalar_out[lane] = alpha ? Reference(ac.bias, ac.op, ac.clamp, ac.shift, true, input) :
+                                   Reference(cc.bias, cc.op, cc.clamp, cc.shift, false, input);
+      }
+      scalar_regs[ac.dest][0] = scalar_out[0];
+      for (int lane = 1; lane < 4; lane++)
+        scalar_regs[cc.dest][lane] = scalar_out[lane];
+    }
+
+    for (int reg = 0; reg < 4; reg++)
+    {
+      for (int lane = 0; lane < 4; lane++)
+      {
+        ASSERT_EQ(scalar_regs[reg][lane], vector_regs[reg][lane])
+            << "setup " << setup << ", register " << reg << ", lane " << lane;
+      }
+    }
+  }
+}
+
+// Run with --gtest_also_run_disabled_tests to compare the vectorized combiner with the scalar one
+// on the same random stages and inputs.
+TEST(TevCombiner, DISABLED_Throughput)
+{
+  constexpr int NUM_STAGES = 64;
+  constexpr int NUM_INPUTS = 1024;
+  constexpr int ITERATIONS = 200;
+
+  std::mt19937 rng(91011);
+  std::uniform_int_distribution<int> register_value(-1024, 1023);
+
+  std::vector<TevStageCombiner::ColorCombiner> color_combiners(NUM_STAGES);
+  std::vector<TevStageCombiner::AlphaCombiner> alpha_combiners(NUM_STAGES);
+  std::vector<TevCombiner::RegularStage> stages;
+  for (int i = 0; i < NUM_STAGES; i++)
+  {
+    color_combiners[i].hex = rng() & 0xFFFFFF;
+    color_combiners[i].bias = color_combiners[i].bias % 3;
+    alpha_combiners[i].hex = rng() & 0xFFFFFF;
+    alpha_combiners[i].bias = alpha_combiners[i].bias % 3;
+    stages.push_back(TevCombiner::MakeRegularStage(color_combiners[i], alpha_combiners[i]));
+  }
+
+  std::vector<std::array<s16, 16>> inputs(NUM_INPUTS);
+  for (auto& input : inputs)
+  {
+    for (s16& value : input)
+      value = register_value(rng);
+  }
+
+  const auto time = [&](auto combine) {
+    s32 checksum = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < ITERATIONS; iteration++)
+    {
+      for (int stage = 0; stage < NUM_STAGES; stage++)
+      {
+        for (const auto& input : inputs)
+        {
+          s16 out[4];
+          combine(stage, &input[0], &input[4], &input[8], &input[12], out);
+          checksum += out[0] + out[1] + out[2] + out[3];
+        }
+      }
+    }
+    const std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    // Keep the results alive.
+    EXPECT_NE(checksum, 0x7FFFFFFF);
+    return elapsed.count() / (double(ITERATIONS) * NUM_STAGES * NUM_INPUTS);
+  };
+
+  const double vector_ns = time([&](int stage, const s16* a, const s16* b, const s16* c,
+                                    const s16* d, s16* out) {
+    TevCombiner::CombineRegular(stages[stage], a, b, c, d, out);
+  });
+  const double scalar_ns = time([&](int stage, const s16* a, const s16* b, const s16* c,
+                                    const s16* d, s16* out) {
+    const TevStageCombiner::ColorCombiner& cc = color_combiners[stage];
+    const TevStageCombiner::AlphaCombiner& ac = alpha_combiners[stage];
+    for (int lane = 0; lane < 4; lane++)
+    {
+      InputRegType input;
+      input.a = a[lane];
+      input.b = b[lane];
+      input.c = c[lane];
+      input.d = d[lane];
+      out[lane] = lane == 0 ? Reference(ac.bias, ac.op, ac.clamp, ac.shift, true, input) :
+                              Reference(cc.bias, cc.op, cc.clamp, cc.shift, false, input);
+    }
+  });
+
+  std::printf("vectorized %6.2f ns/stage, scalar %6.2f ns/stage\n", vector_ns, scalar_ns);
+}
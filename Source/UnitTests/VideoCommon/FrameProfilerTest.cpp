@@ -0,0 +1,64 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "VideoCommon/FrameProfiler.h"
+
+namespace
+{
+constexpr u64 SLEEP_NS = 20000000;
+
+void Sleep()
+{
+  std::this_thread::sleep_for(std::chrono::nanoseconds(SLEEP_NS));
+}
+
+u64 GetTime(const FrameProfiler::Times& times, FrameProfiler::Section section)
+{
+  return times[static_cast<std::size_t>(section)];
+}
+}  // namespace
+
+TEST(FrameProfiler, DoesNothingWhenDisabled)
+{
+  FrameProfiler::SetEnabled(false);
+  FrameProfiler::TakeTimes();
+  {
+    FrameProfiler::ScopedSection section(FrameProfiler::Section::OpcodeDecoder);
+    Sleep();
+  }
+
+  for (u64 time : FrameProfiler::TakeTimes())
+    EXPECT_EQ(0u, time);
+}
+
+TEST(FrameProfiler, NestedSectionsAreExclusive)
+{
+  FrameProfiler::SetEnabled(true);
+  FrameProfiler::TakeTimes();
+  {
+    FrameProfiler::ScopedSection outer(FrameProfiler::Section::OpcodeDecoder);
+    {
+      FrameProfiler::ScopedSection inner(FrameProfiler::Section::VertexLoader);
+      Sleep();
+    }
+  }
+  FrameProfiler::SetEnabled(false);
+
+  const FrameProfiler::Times times = FrameProfiler::TakeTimes();
+  const u64 outer_time = GetTime(times, FrameProfiler::Section::OpcodeDecoder);
+  const u64 inner_time = GetTime(times, FrameProfiler::Section::VertexLoader);
+  EXPECT_GE(inner_time, SLEEP_NS);
+  // The outer section didn't also count the time of the inner one.
+  EXPECT_LT(outer_time, SLEEP_NS);
+  EXPECT_EQ(0u, GetTime(times, FrameProfiler::Section::TextureCache));
+
+  // Taking the times starts over.
+  for (u64 time : FrameProfiler::TakeTimes())
+    EXPECT_EQ(0u, time);
+}
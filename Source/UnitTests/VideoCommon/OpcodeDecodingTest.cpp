@@ -0,0 +1,167 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/Config/Config.h"
+#include "Common/FileUtil.h"
+#include "Common/Hash.h"
+#include "Common/Swap.h"
+#include "Core/ConfigLoaders/BaseConfigLoader.h"
+#include "Core/ConfigManager.h"
+#include "Core/HW/Memmap.h"
+#include "UICommon/UICommon.h"
+#include "VideoCommon/CPMemory.h"
+#include "VideoCommon/DataReader.h"
+#include "VideoCommon/OpcodeDecoding.h"
+
+namespace
+{
+constexpr u32 DISPLAY_LIST_ADDRESS = 0x1000;
+
+void AppendU32(std::vector<u8>* data, u32 value)
+{
+  const u32 swapped = Common::swap32(value);
+  const u8* bytes = reinterpret_cast<const u8*>(&swapped);
+  data->insert(data->end(), bytes, bytes + sizeof(swapped));
+}
+
+// Loads the array stride registers, which don't change the vertex formats the cache checks.
+void AppendStrideLoad(std::vector<u8>* data, u32 array, u8 stride)
+{
+  data->push_back(OpcodeDecoder::GX_LOAD_CP_REG);
+  data->push_back(static_cast<u8>(0xB0 | array));
+  AppendU32(data, stride);
+}
+
+std::array<u8, 9> MakeCall(u32 address, u32 size)
+{
+  std::vector<u8> call{OpcodeDecoder::GX_CMD_CALL_DL};
+  AppendU32(&call, address);
+  AppendU32(&call, size);
+
+  std::array<u8, 9> result;
+  std::copy(call.begin(), call.end(), result.begin());
+  return result;
+}
+
+u32 RunFifo(std::array<u8, 9>& fifo)
+{
+  u32 cycles = 0;
+  OpcodeDecoder::Run(DataReader(fifo.data(), fifo.data() + fifo.size()), &cycles, false);
+  return cycles;
+}
+}  // namespace
+
+class OpcodeDecodingTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    m_profile_path = File::CreateTempDir();
+    UICommon::SetUserDirectory(m_profile_path);
+    Config::Init();
+    Config::AddLayer(ConfigLoaders::GenerateBaseConfigLoader());
+    SConfig::Init();
+    Memory::Init();
+    OpcodeDecoder::Init();
+    g_main_cp_state = {};
+  }
+
+  void TearDown() override
+  {
+    Memory::Shutdown();
+    SConfig::Shutdown();
+    Config::Shutdown();
+    File::DeleteDirRecursively(m_profile_path);
+  }
+
+  std::string m_profile_path;
+};
+
+TEST_F(OpcodeDecodingTest, CachedDisplayListSeesWrites)
+{
+  std::vector<u8> display_list;
+  AppendStrideLoad(&display_list, 0, 0x11);
+  display_list.push_back(OpcodeDecoder::GX_NOP);
+  // A primitive without vertices, which has no vertex data to skip.
+  display_list.insert(display_list.end(), {0x90, 0x00, 0x00});
+  AppendStrideLoad(&display_list, 1, 0x22);
+  Memory::CopyToEmu(DISPLAY_LIST_ADDRESS, display_list.data(), display_list.size());
+
+  std::array<u8, 9> fifo = MakeCall(DISPLAY_LIST_ADDRESS, u32(display_list.size()));
+  u32 first_cycles = 0;
+  // Decodes and caches the display list, then replays it from the cache.
+  for (int i = 0; i < 3; i++)
+  {
+    g_main_cp_state.array_strides[0] = 0;
+    g_main_cp_state.array_strides[1] = 0;
+    const u32 cycles = RunFifo(fifo);
+    if (i == 0)
+      first_cycles = cycles;
+    EXPECT_EQ(first_cycles, cycles);
+    EXPECT_EQ(0x11u, g_main_cp_state.array_strides[0]);
+    EXPECT_EQ(0x22u, g_main_cp_state.array_strides[1]);
+  }
+
+  // Change the value of the second load, and then the register it loads.
+  Memory::Write_U8(0x33, DISPLAY_LIST_ADDRESS + u32(display_list.size()) - 1);
+  RunFifo(fifo);
+  EXPECT_EQ(0x11u, g_main_cp_state.array_strides[0]);
+  EXPECT_EQ(0x33u, g_main_cp_state.array_strides[1]);
+
+  Memory::Write_U8(0xB2, DISPLAY_LIST_ADDRESS + u32(display_list.size()) - 5);
+  g_main_cp_state.array_strides[1] = 0;
+  RunFifo(fifo);
+  EXPECT_EQ(0u, g_main_cp_state.array_strides[1]);
+  EXPECT_EQ(0x33u, g_main_cp_state.array_strides[2]);
+
+  // Turning the NOP into a CP load changes where every later command starts.
+  Memory::Write_U8(OpcodeDecoder::GX_LOAD_CP_REG, DISPLAY_LIST_ADDRESS + 6);
+  g_main_cp_state.array_strides[2] = 0;
+  RunFifo(fifo);
+  EXPECT_EQ(0u, g_main_cp_state.array_strides[2]);
+}
+
+// Compares hashing a display list, which is what checking an entry used to cost, against decoding
+// and replaying it. The list only has CP loads, so every byte of it has to be compared.
+TEST_F(OpcodeDecodingTest, DISABLED_DisplayListThroughput)
+{
+  constexpr int NUM_LOADS = 4096;
+  constexpr int CALLS = 2000;
+
+  std::vector<u8> display_list;
+  for (int i = 0; i < NUM_LOADS; i++)
+    AppendStrideLoad(&display_list, i & 15, static_cast<u8>(i));
+  Memory::CopyToEmu(DISPLAY_LIST_ADDRESS, display_list.data(), display_list.size());
+  u8* const start = Memory::GetPointer(DISPLAY_LIST_ADDRESS);
+  const u32 size = u32(display_list.size());
+
+  std::array<u8, 9> fifo = MakeCall(DISPLAY_LIST_ADDRESS, size);
+  const auto measure = [](const char* name, const auto& function) {
+    const auto begin = std::chrono::steady_clock::now();
+    u64 sink = 0;
+    for (int i = 0; i < CALLS; i++)
+      sink += function();
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    std::printf("%-32s %10.3f us/call (%llu)\n", name, seconds * 1e6 / CALLS,
+                static_cast<unsigned long long>(sink & 1));
+  };
+
+  measure("Hash", [&] { return Common::GetHash64(start, size, 0); });
+  measure("Decode", [&] {
+    u32 cycles = 0;
+    OpcodeDecoder::Run(DataReader(start, start + size), &cycles, true);
+    return cycles;
+  });
+  measure("Call cached", [&] { return RunFifo(fifo); });
+}
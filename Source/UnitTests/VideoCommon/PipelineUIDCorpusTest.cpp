@@ -0,0 +1,154 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CommonTypes.h"
+#include "Common/File.h"
+#include "Common/FileUtil.h"
+#include "VideoCommon/GXPipelineTypes.h"
+#include "VideoCommon/PipelineUIDCorpus.h"
+
+using VideoCommon::PipelineUIDCorpus;
+using VideoCommon::SerializedGXPipelineUid;
+
+namespace
+{
+SerializedGXPipelineUid MakeUid(u32 id)
+{
+  SerializedGXPipelineUid uid;
+  std::memset(static_cast<void*>(&uid), 0, sizeof(uid));
+  uid.rasterization_state_bits = id;
+  return uid;
+}
+
+std::vector<std::pair<u32, u32>> GetIdsAndFrames(const PipelineUIDCorpus& corpus)
+{
+  std::vector<std::pair<u32, u32>> result;
+  for (const PipelineUIDCorpus::Entry& entry : corpus.GetEntriesByFirstUse())
+    result.emplace_back(entry.uid.rasterization_state_bits, entry.first_use_frame);
+  return result;
+}
+
+class PipelineUIDCorpusTest : public testing::Test
+{
+protected:
+  PipelineUIDCorpusTest() : m_directory(File::CreateTempDir()) {}
+  ~PipelineUIDCorpusTest() override
+  {
+    if (!m_directory.empty())
+      File::DeleteDirRecursively(m_directory);
+  }
+
+  std::string m_directory;
+};
+}  // namespace
+
+TEST(PipelineUIDCorpus, KeepsEarliestFirstUse)
+{
+  PipelineUIDCorpus corpus;
+  EXPECT_TRUE(corpus.Add(MakeUid(1), 50));
+  EXPECT_TRUE(corpus.Add(MakeUid(2), 10));
+  EXPECT_FALSE(corpus.Add(MakeUid(1), 20));
+  EXPECT_FALSE(corpus.Add(MakeUid(2), 30));
+
+  EXPECT_EQ(2u, corpus.size());
+  EXPECT_EQ(20u, corpus.GetFirstUseFrame(MakeUid(1)));
+  EXPECT_EQ(10u, corpus.GetFirstUseFrame(MakeUid(2)));
+  EXPECT_FALSE(corpus.GetFirstUseFrame(MakeUid(3)));
+}
+
+TEST(PipelineUIDCorpus, MergeDeduplicates)
+{
+  PipelineUIDCorpus a;
+  a.Add(MakeUid(1), 100);
+  a.Add(MakeUid(2), 5);
+
+  PipelineUIDCorpus b;
+  b.Add(MakeUid(1), 7);
+  b.Add(MakeUid(3), 5);
+
+  a.Merge(b);
+  EXPECT_EQ((std::vector<std::pair<u32, u32>>{{2, 5}, {3, 5}, {1, 7}}), GetIdsAndFrames(a));
+}
+
+TEST_F(PipelineUIDCorpusTest, SaveAndLoad)
+{
+  ASSERT_FALSE(m_directory.empty());
+  const std::string path = m_directory + "/GALE01.uidcache";
+
+  PipelineUIDCorpus corpus;
+  EXPECT_FALSE(corpus.Load(path));
+
+  for (u32 i = 0; i < 100; ++i)
+    corpus.Add(MakeUid(i), 1000 - i * 10);
+  ASSERT_TRUE(corpus.Save(path));
+
+  PipelineUIDCorpus loaded;
+  loaded.Add(MakeUid(5), 1);
+  ASSERT_TRUE(loaded.Load(path));
+  EXPECT_EQ(100u, loaded.size());
+  EXPECT_EQ(1u, loaded.GetFirstUseFrame(MakeUid(5)));
+  EXPECT_EQ(10u, loaded.GetFirstUseFrame(MakeUid(99)));
+}
+
+TEST_F(PipelineUIDCorpusTest, RejectsTruncatedFile)
+{
+  ASSERT_FALSE(m_directory.empty());
+  const std::string path = m_directory + "/GALE01.uidcache";
+
+  PipelineUIDCorpus corpus;
+  corpus.Add(MakeUid(1), 0);
+  corpus.Add(MakeUid(2), 0);
+  ASSERT_TRUE(corpus.Save(path));
+  {
+    File::IOFile file(path, "r+b");
+    ASSERT_TRUE(file.Resize(file.GetSize() - 1));
+  }
+
+  PipelineUIDCorpus loaded;
+  EXPECT_FALSE(loaded.Load(path));
+  EXPECT_TRUE(loaded.empty());
+}
+
+TEST_F(PipelineUIDCorpusTest, ReadsOldCacheFormat)
+{
+  ASSERT_FALSE(m_directory.empty());
+  const std::string path = m_directory + "/GALE01.uidcache";
+  {
+    // The UID cache before first use frames were added: a different magic and bare UIDs.
+    File::IOFile file(path, "wb");
+    const u32 magic = 0x44495550;
+    ASSERT_TRUE(file.WriteBytes(&magic, sizeof(magic)));
+    ASSERT_TRUE(file.WriteBytes(&VideoCommon::GX_PIPELINE_UID_VERSION,
+                                sizeof(VideoCommon::GX_PIPELINE_UID_VERSION)));
+    for (u32 i = 1; i <= 3; ++i)
+    {
+      const SerializedGXPipelineUid uid = MakeUid(i);
+      ASSERT_TRUE(file.WriteBytes(&uid, sizeof(uid)));
+    }
+  }
+
+  PipelineUIDCorpus corpus;
+  corpus.Add(MakeUid(4), 50);
+  File::IOFile file(path, "rb");
+  bool is_old_format = false;
+  ASSERT_TRUE(corpus.ReadFile(file, &is_old_format));
+  EXPECT_TRUE(is_old_format);
+  EXPECT_EQ((std::vector<std::pair<u32, u32>>{{1, 0}, {2, 0}, {3, 0}, {4, 50}}),
+            GetIdsAndFrames(corpus));
+
+  // Converting it writes the new format.
+  const std::string converted_path = m_directory + "/converted.uidcache";
+  ASSERT_TRUE(corpus.Save(converted_path));
+  File::IOFile converted(converted_path, "rb");
+  PipelineUIDCorpus loaded;
+  ASSERT_TRUE(loaded.ReadFile(converted, &is_old_format));
+  EXPECT_FALSE(is_old_format);
+  EXPECT_EQ(GetIdsAndFrames(corpus), GetIdsAndFrames(loaded));
+}
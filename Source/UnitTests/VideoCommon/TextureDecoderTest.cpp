@@ -0,0 +1,217 @@
+// Copyright 2020 Dolphin Emulator Project
+// Licensed under GPLv2+
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "Common/CPUDetect.h"
+#include "Common/CommonTypes.h"
+#include "Common/ThreadPool.h"
+#include "VideoCommon/TextureDecoder.h"
+
+namespace
+{
+constexpr TextureFormat formats[] = {
+    TextureFormat::I4,     TextureFormat::I8,     TextureFormat::IA4,   TextureFormat::IA8,
+    TextureFormat::RGB565, TextureFormat::RGB5A3, TextureFormat::RGBA8, TextureFormat::C4,
+    TextureFormat::C8,     TextureFormat::C14X2,  TextureFormat::CMPR,  TextureFormat::XFB};
+constexpr TLUTFormat tlut_formats[] = {TLUTFormat::IA8, TLUTFormat::RGB565, TLUTFormat::RGB5A3};
+
+class TextureDecoderTest : public testing::Test
+{
+protected:
+  // Large enough for a 1024x1024 RGBA8 texture and for every C14X2 palette index.
+  TextureDecoderTest() : src(1024 * 1024 * 4), tlut(0x4000 * 2)
+  {
+    std::mt19937 rng(1234);
+    for (u8& byte : src)
+      byte = static_cast<u8>(rng());
+    for (u8& byte : tlut)
+      byte = static_cast<u8>(rng());
+  }
+
+  // Runs func with the given vector instruction sets reported as unavailable.
+  template <typename Func>
+  static void WithCPUFeatures(bool avx2, bool ssse3, Func func)
+  {
+    const CPUInfo saved = cpu_info;
+    cpu_info.bAVX2 &= avx2;
+    cpu_info.bSSSE3 &= ssse3;
+    func();
+    cpu_info = saved;
+  }
+
+  std::vector<u8> src;
+  std::vector<u8> tlut;
+};
+}  // namespace
+
+TEST_F(TextureDecoderTest, AllCodePathsMatch)
+{
+  static constexpr int sizes[][2] = {{8, 8}, {64, 32}, {256, 256}};
+
+  for (TextureFormat format : formats)
+  {
+    for (TLUTFormat tlut_format : tlut_formats)
+    {
+      for (const auto& size : sizes)
+      {
+        const int width = size[0];
+        const int height = size[1];
+        std::vector<u8> reference(width * height * 4);
+        std::vector<u8> ssse3(width * height * 4);
+        std::vector<u8> avx2(width * height * 4);
+
+        WithCPUFeatures(false, false, [&] {
+          TexDecoder_Decode(reference.data(), src.data(), width, height, format, tlut.data(),
+                            tlut_format);
+        });
+        WithCPUFeatures(false, true, [&] {
+          TexDecoder_Decode(ssse3.data(), src.data(), width, height, format, tlut.data(),
+                            tlut_format);
+        });
+        WithCPUFeatures(true, true, [&] {
+          TexDecoder_Decode(avx2.data(), src.data(), width, height, format, tlut.data(),
+                            tlut_format);
+        });
+
+        EXPECT_EQ(reference, ssse3) << "format " << static_cast<int>(format) << ", tlut "
+                                    << static_cast<int>(tlut_format) << ", " << width << "x"
+                                    << height;
+        EXPECT_EQ(reference, avx2) << "format " << static_cast<int>(format) << ", tlut "
+                                   << static_cast<int>(tlut_format) << ", " << width << "x"
+                                   << height;
+      }
+    }
+  }
+}
+
+TEST_F(TextureDecoderTest, C14X2PaletteNearEndOfTMEM)
+{
+  if (!cpu_info.bAVX2)
+    return;
+
+  // Large enough to use the AVX2 palette table, with every texel using the last palette entry.
+  constexpr int width = 128;
+  constexpr int height = 128;
+  std::vector<u8> indices(width * height * 2);
+  for (size_t i = 0; i < indices.size(); i += 2)
+  {
+    indices[i] = 0x3F;
+    indices[i + 1] = 0xFF;
+  }
+  std::vector<u8> dst(width * height * 4);
+
+  // Fill the whole table first.
+  TexDecoder_Decode(dst.data(), indices.data(), width, height, TextureFormat::C14X2, tlut.data(),
+                    TLUTFormat::RGB5A3);
+  ASSERT_NE(std::vector<u8>(dst.size()), dst);
+
+  // A TLUT with only 32 entries left in TMEM mustn't reuse the earlier colors.
+  TexDecoder_Decode(dst.data(), indices.data(), width, height, TextureFormat::C14X2,
+                    texMem + TMEM_SIZE - 64, TLUTFormat::RGB5A3);
+  EXPECT_EQ(std::vector<u8>(dst.size()), dst);
+}
+
+// Run with --gtest_also_run_disabled_tests to print the decoding throughput of every format on
+// every code path that this CPU supports.
+TEST_F(TextureDecoderTest, DISABLED_Throughput)
+{
+  constexpr int width = 1024;
+  constexpr int height = 1024;
+  constexpr int iterations = 50;
+  std::vector<u8> dst(width * height * 4);
+
+  static constexpr struct
+  {
+    const char* name;
+    bool avx2;
+    bool ssse3;
+  } paths[] = {{"SSE2", false, false}, {"SSSE3", false, true}, {"AVX2", true, true}};
+
+  for (TextureFormat format : formats)
+  {
+    for (const auto& path : paths)
+    {
+      WithCPUFeatures(path.avx2, path.ssse3, [&] {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i)
+        {
+          TexDecoder_Decode(dst.data(), src.data(), width, height, format, tlut.data(),
+                            TLUTFormat::RGB5A3);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        const double texels = static_cast<double>(width) * height * iterations;
+        std::printf("format 0x%X %-5s %8.1f Mtexels/s\n", static_cast<int>(format), path.name,
+                    texels / elapsed.count() / 1e6);
+      });
+    }
+  }
+}
+
+TEST_F(TextureDecoderTest, ParallelDecodeMatchesSerialDecode)
+{
+  static constexpr int sizes[][2] = {{64, 64}, {512, 512}, {1024, 1000}, {8, 2048}};
+
+  Common::ThreadPool pool("TextureDecoderTest", 3);
+
+  for (TextureFormat format : formats)
+  {
+    for (const auto& size : sizes)
+    {
+      const int width = size[0];
+      const int height = size[1];
+      std::vector<u8> serial(width * height * 4);
+      std::vector<u8> parallel(width * height * 4);
+
+      TexDecoder_Decode(serial.data(), src.data(), width, height, format, tlut.data(),
+                        TLUTFormat::RGB5A3);
+      TexDecoder_DecodeParallel(pool, parallel.data(), src.data(), width, height, format,
+                                tlut.data(), TLUTFormat::RGB5A3);
+
+      EXPECT_EQ(serial, parallel) << "format " << static_cast<int>(format) << ", " << width << "x"
+                                  << height;
+    }
+  }
+}
+
+// Run with --gtest_also_run_disabled_tests to compare serial decoding of a 1024x1024 texture with
+// decoding it on a pool with one worker per core.
+TEST_F(TextureDecoderTest, DISABLED_ParallelThroughput)
+{
+  constexpr int width = 1024;
+  constexpr int height = 1024;
+  constexpr int iterations = 50;
+  std::vector<u8> dst(width * height * 4);
+
+  Common::ThreadPool pool("TextureDecoderTest");
+
+  for (TextureFormat format : formats)
+  {
+    const auto time = [&](auto decode) {
+      const auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < iterations; ++i)
+        decode();
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      return static_cast<double>(width) * height * iterations / elapsed.count() / 1e6;
+    };
+
+    const double serial = time([&] {
+      TexDecoder_Decode(dst.data(), src.data(), width, height, format, tlut.data(),
+                        TLUTFormat::RGB5A3);
+    });
+    const double parallel = time([&] {
+      TexDecoder_DecodeParallel(pool, dst.data(), src.data(), width, height, format, tlut.data(),
+                                TLUTFormat::RGB5A3);
+    });
+
+    std::printf("format 0x%X %8.1f Mtexels/s serial, %8.1f Mtexels/s on %zu threads\n",
+                static_cast<int>(format), serial, parallel, pool.GetThreadCount());
+  }
+}
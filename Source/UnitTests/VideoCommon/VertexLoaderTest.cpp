@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <cstring>
 #include <limits>
 #include <memory>
 #include <tuple>
@@ -12,10 +13,13 @@
 
 #include "Common/BitUtils.h"
 #include "Common/Common.h"
+#include "Common/Swap.h"
 #include "VideoCommon/CPMemory.h"
 #include "VideoCommon/DataReader.h"
 #include "VideoCommon/OpcodeDecoding.h"
+#include "VideoCommon/Statistics.h"
 #include "VideoCommon/VertexLoaderBase.h"
+#include "VideoCommon/VertexLoaderCache.h"
 #include "VideoCommon/VertexLoaderManager.h"
 
 TEST(VertexLoaderUID, UniqueEnough)
@@ -245,6 +249,99 @@ TEST_F(VertexLoaderTest, PositionIndex16FloatXY)
   ExpectOut(2);
 }
 
+class VertexLoaderCacheTest : public VertexLoaderTest
+{
+protected:
+  void SetUp() override
+  {
+    VertexLoaderTest::SetUp();
+    g_stats.ResetFrame();
+  }
+
+  // Runs the vertices through the cache, and checks that the output matches the loader's.
+  void RunCachedVertices(int count)
+  {
+    const size_t output_size = count * m_loader->m_native_vtx_decl.stride;
+    RunVertices(count);
+    const std::vector<u8> expected(output_memory, output_memory + output_size);
+
+    memset(output_memory, 0xFF, output_size);
+    ResetPointers();
+    EXPECT_EQ(count, m_cache.RunVertices(m_loader.get(), m_arrays, m_src, m_dst, count, 0));
+    EXPECT_EQ(0, memcmp(expected.data(), output_memory, output_size));
+  }
+
+  VertexLoaderCache m_cache;
+  VertexLoaderCache::VertexArrays m_arrays{};
+};
+
+TEST_F(VertexLoaderCacheTest, DirectPositions)
+{
+  m_vtx_desc.Position = DIRECT;
+  m_vtx_attr.g0.PosElements = 1;
+  m_vtx_attr.g0.PosFormat = FORMAT_FLOAT;
+  CreateAndCheckSizes(3 * sizeof(float), 3 * sizeof(float));
+  for (int i = 0; i < 3 * 64; i++)
+    Input(static_cast<float>(i));
+
+  // Output is kept the second time, and used the third.
+  for (int i = 0; i < 3; i++)
+    RunCachedVertices(64);
+  EXPECT_EQ(2, g_stats.this_frame.num_vertex_loader_cache_misses);
+  EXPECT_EQ(1, g_stats.this_frame.num_vertex_loader_cache_hits);
+  EXPECT_EQ(64 * 3 * int(sizeof(float)), g_stats.this_frame.bytes_vertex_loader_cache_saved);
+
+  // Different vertex data mustn't be looked up.
+  ResetPointers();
+  Input(-1.f);
+  RunCachedVertices(64);
+  EXPECT_EQ(3, g_stats.this_frame.num_vertex_loader_cache_misses);
+
+  // Neither are batches too small to be worth hashing.
+  RunCachedVertices(8);
+  RunCachedVertices(8);
+  RunCachedVertices(8);
+  EXPECT_EQ(3, g_stats.this_frame.num_vertex_loader_cache_misses);
+  EXPECT_EQ(1, g_stats.this_frame.num_vertex_loader_cache_hits);
+}
+
+TEST_F(VertexLoaderCacheTest, IndexedPositions)
+{
+  m_vtx_desc.Position = INDEX8;
+  m_vtx_attr.g0.PosElements = 1;
+  m_vtx_attr.g0.PosFormat = FORMAT_FLOAT;
+  CreateAndCheckSizes(sizeof(u8), 3 * sizeof(float));
+  for (int i = 0; i < 64; i++)
+    Input<u8>(i % 16);
+
+  u8* const array = input_memory + 1024;
+  VertexLoaderManager::cached_arraybases[ARRAY_POSITION] = array;
+  g_main_cp_state.array_strides[ARRAY_POSITION] = 3 * sizeof(float);
+  m_arrays[ARRAY_POSITION] = {array, 3 * sizeof(float), 16 * 3 * sizeof(float)};
+  for (int i = 0; i < 16 * 3; i++)
+  {
+    const u32 value = Common::swap32(Common::BitCast<u32>(static_cast<float>(i)));
+    std::memcpy(array + i * sizeof(float), &value, sizeof(value));
+  }
+
+  for (int i = 0; i < 3; i++)
+    RunCachedVertices(64);
+  EXPECT_EQ(1, g_stats.this_frame.num_vertex_loader_cache_hits);
+
+  // Changing the array data the indices point at must invalidate the output.
+  array[5 * 3 * sizeof(float)] = 0x40;
+  RunCachedVertices(64);
+  EXPECT_EQ(1, g_stats.this_frame.num_vertex_loader_cache_hits);
+  EXPECT_EQ(3, g_stats.this_frame.num_vertex_loader_cache_misses);
+
+  // Indices past the readable part of the array aren't cached at all.
+  m_arrays[ARRAY_POSITION].readable_size = 8 * 3 * sizeof(float);
+  for (int i = 0; i < 3; i++)
+    RunCachedVertices(64);
+  EXPECT_EQ(3, g_stats.this_frame.num_vertex_loader_cache_misses);
+  EXPECT_EQ(1, g_stats.this_frame.num_vertex_loader_cache_hits);
+}
+
 class VertexLoaderSpeedTest : public VertexLoaderTest,
                               public ::testing::WithParamInterface<std::tuple<int, int>>
 {